@@ -45,6 +45,8 @@
 #include <stdbool.h>
 #include "ad7124.h"
 #include "delay.h"
+#include "error.h"
+#include "crc8.h"
 
 /* Error codes */
 #define INVALID_VAL -1 /* Invalid argument */
@@ -58,6 +60,7 @@
  */
 #define AD7124_POST_RESET_DELAY      4
 
+DECLARE_CRC8_CONST_TABLE(ad7124_crc8, AD7124_CRC8_POLYNOMIAL_REPRESENTATION);
 
 /***************************************************************************//**
  * @brief Reads the value of the specified register without checking if the
@@ -137,26 +140,48 @@ int32_t ad7124_no_check_read_register(struct ad7124_dev *dev,
 }
 
 /***************************************************************************//**
- * @brief Writes the value of the specified register without checking if the
- *        device is ready to accept user requests.
+ * @brief Runs a full duplex SPI transfer on a single buffer.
  *
- * @param dev - The handler of the instance of the driver.
- * @param reg - Register structure holding info about the register to be written
+ * @param dev       - The handler of the instance of the driver.
+ * @param buf       - Data to send, overwritten with the received data.
+ * @param size      - Number of bytes.
+ * @param cs_change - Deassert the chip select at the end of the transfer. When
+ *                    0, it is kept asserted until the next transfer.
  *
  * @return Returns 0 for success or negative error code.
 *******************************************************************************/
-int32_t ad7124_no_check_write_register(struct ad7124_dev *dev,
-				       struct ad7124_st_reg reg)
+static int32_t ad7124_spi_xfer(struct ad7124_dev *dev, uint8_t *buf,
+			       uint32_t size, uint8_t cs_change)
+{
+	struct spi_msg msg = {
+		.tx_buff = buf,
+		.rx_buff = buf,
+		.bytes_number = size,
+		.cs_change = cs_change,
+	};
+
+	return spi_transfer(dev->spi_desc, &msg, 1);
+}
+
+/***************************************************************************//**
+ * @brief Writes a register, optionally keeping the chip select asserted.
+ *
+ * @param dev       - The handler of the instance of the driver.
+ * @param reg       - Register structure holding info about the register to be
+ *                    written.
+ * @param cs_change - Deassert the chip select at the end of the write.
+ *
+ * @return Returns 0 for success or negative error code.
+*******************************************************************************/
+static int32_t ad7124_write_register_cs(struct ad7124_dev *dev,
+					struct ad7124_st_reg reg,
+					uint8_t cs_change)
 {
-	int32_t ret = 0;
 	int32_t reg_value = 0;
 	uint8_t wr_buf[8] = {0, 0, 0, 0, 0, 0, 0, 0};
 	uint8_t i = 0;
 	uint8_t crc8 = 0;
 
-	if(!dev)
-		return INVALID_VAL;
-
 	/* Build the Command word */
 	wr_buf[0] = AD7124_COMM_REG_WEN | AD7124_COMM_REG_WR |
 		    AD7124_COMM_REG_RA(reg.addr);
@@ -175,12 +200,27 @@ int32_t ad7124_no_check_write_register(struct ad7124_dev *dev,
 	}
 
 	/* Write data to the device */
-	ret = spi_write_and_read(dev->spi_desc,
-				 wr_buf,
-				 (dev->use_crc != AD7124_DISABLE_CRC) ? reg.size + 2
-				 : reg.size + 1);
+	return ad7124_spi_xfer(dev, wr_buf,
+			       (dev->use_crc != AD7124_DISABLE_CRC) ? reg.size + 2
+			       : reg.size + 1, cs_change);
+}
 
-	return ret;
+/***************************************************************************//**
+ * @brief Writes the value of the specified register without checking if the
+ *        device is ready to accept user requests.
+ *
+ * @param dev - The handler of the instance of the driver.
+ * @param reg - Register structure holding info about the register to be written
+ *
+ * @return Returns 0 for success or negative error code.
+*******************************************************************************/
+int32_t ad7124_no_check_write_register(struct ad7124_dev *dev,
+				       struct ad7124_st_reg reg)
+{
+	if(!dev)
+		return INVALID_VAL;
+
+	return ad7124_write_register_cs(dev, reg, 1);
 }
 
 /***************************************************************************//**
@@ -441,6 +481,288 @@ int32_t ad7124_read_data(struct ad7124_dev *dev,
 	return ret;
 }
 
+/***************************************************************************//**
+ * @brief Waits until the DOUT/RDY line goes low, signaling a new conversion.
+ *
+ * DOUT/RDY is also the SPI data out line, so the edges seen while data is
+ * clocked out are filtered by checking the level of the line.
+ *
+ * @param dev        - The handler of the instance of the driver.
+ * @param timeout_us - Maximum time to wait for an edge, in microseconds.
+ *
+ * @return Returns 0 for success or negative error code.
+*******************************************************************************/
+static int32_t ad7124_wait_for_rdy_low(struct ad7124_dev *dev,
+				       uint32_t timeout_us)
+{
+	int32_t ret;
+	uint8_t value;
+
+	while (true) {
+		ret = gpio_get_value(dev->gpio_rdy, &value);
+		if (ret < 0)
+			return ret;
+		if (value == GPIO_LOW)
+			return 0;
+
+		ret = gpio_wait_edge(dev->gpio_rdy, GPIO_EDGE_FALLING,
+				     &timeout_us);
+		if (ret == -ENOTSUP) {
+			/* No edge detection on this platform, poll the line */
+			if (!timeout_us--)
+				return TIMEOUT;
+			udelay(1);
+		} else if (ret == -ETIMEDOUT) {
+			return TIMEOUT;
+		} else if (ret < 0) {
+			return ret;
+		}
+	}
+}
+
+/***************************************************************************//**
+ * @brief Leaves the continuous read mode by resetting the device.
+ *
+ * Used when the mode can not be left with a read data command, because no
+ * conversion comes or the SPI bus failed. The registers below the offset
+ * registers are restored from the cached values, as done by ad7124_setup(),
+ * with ADC_Control set back to its value from before the continuous read mode.
+ *
+ * @param dev - The handler of the instance of the driver.
+ *
+ * @return Returns 0 for success or negative error code.
+*******************************************************************************/
+static int32_t ad7124_continuous_read_reset(struct ad7124_dev *dev)
+{
+	int32_t ret;
+	enum ad7124_registers reg_nr;
+
+	dev->cont_read = 0;
+	dev->regs[AD7124_ADC_Control].value = dev->saved_adc_ctrl;
+
+	ret = ad7124_reset(dev);
+	if (ret < 0)
+		return ret;
+
+	for(reg_nr = AD7124_Status; reg_nr < AD7124_Offset_0; reg_nr++) {
+		if (dev->regs[reg_nr].rw == AD7124_RW) {
+			ret = ad7124_write_register(dev, dev->regs[reg_nr]);
+			if (ret < 0)
+				return ret;
+		}
+
+		if (reg_nr == AD7124_Error_En)
+			ad7124_update_crcsetting(dev);
+	}
+
+	return 0;
+}
+
+/***************************************************************************//**
+ * @brief Enters the continuous read mode.
+ *
+ * The status register is appended to the data so that every frame tells the
+ * channel it was converted on. Registers can not be accessed until
+ * ad7124_continuous_read_stop() is called. The DOUT/RDY line is only driven
+ * while the chip select is asserted, so it is kept asserted from the write
+ * that enters the mode until the mode is left. This needs a platform that
+ * implements spi_transfer() with cs_change.
+ *
+ * @param dev - The handler of the instance of the driver.
+ *
+ * @return Returns 0 for success, -ENOTSUP if the SPI platform can not keep
+ *         the chip select asserted or negative error code.
+*******************************************************************************/
+int32_t ad7124_continuous_read_start(struct ad7124_dev *dev)
+{
+	int32_t ret;
+	int32_t adc_ctrl;
+
+	/* The conversions can only be detected on the DOUT/RDY line */
+	if(!dev || !dev->gpio_rdy)
+		return INVALID_VAL;
+
+	/* Only a platform transfer op keeps CS asserted between messages */
+	if (!dev->spi_desc->platform_ops ||
+	    !dev->spi_desc->platform_ops->transfer)
+		return -ENOTSUP;
+
+	if (dev->cont_read)
+		return 0;
+
+	if (dev->check_ready) {
+		ret = ad7124_wait_for_spi_ready(dev, dev->spi_rdy_poll_cnt);
+		if (ret < 0)
+			return ret;
+	}
+
+	adc_ctrl = dev->regs[AD7124_ADC_Control].value;
+	dev->saved_adc_ctrl = adc_ctrl;
+	dev->cont_read = 1;
+	dev->regs[AD7124_ADC_Control].value = adc_ctrl |
+					      AD7124_ADC_CTRL_REG_CONT_READ |
+					      AD7124_ADC_CTRL_REG_DATA_STATUS;
+	ret = ad7124_write_register_cs(dev, dev->regs[AD7124_ADC_Control], 0);
+	if (ret < 0) {
+		/* Whether the mode was entered is unknown */
+		ad7124_continuous_read_reset(dev);
+		return ret;
+	}
+
+	return 0;
+}
+
+/***************************************************************************//**
+ * @brief Leaves the continuous read mode.
+ *
+ * A read data command is issued while DOUT/RDY is low, then the ADC_Control
+ * register is restored to its value from before the continuous read mode.
+ * If no conversion comes or the command fails, the device is reset instead,
+ * so the mode is always left.
+ *
+ * @param dev - The handler of the instance of the driver.
+ *
+ * @return Returns 0 for success or negative error code.
+*******************************************************************************/
+int32_t ad7124_continuous_read_stop(struct ad7124_dev *dev)
+{
+	int32_t ret;
+	uint8_t buffer[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+
+	if(!dev)
+		return INVALID_VAL;
+
+	if (!dev->cont_read)
+		return 0;
+
+	ret = ad7124_wait_for_rdy_low(dev, AD7124_CONT_READ_EXIT_TIMEOUT_US);
+	if (ret < 0)
+		return ad7124_continuous_read_reset(dev);
+
+	buffer[0] = AD7124_COMM_REG_WEN | AD7124_COMM_REG_RD |
+		    AD7124_COMM_REG_RA(AD7124_DATA_REG);
+	ret = ad7124_spi_xfer(dev, buffer,
+			      (dev->use_crc != AD7124_DISABLE_CRC) ? 6 : 5, 1);
+	if (ret < 0)
+		return ad7124_continuous_read_reset(dev);
+
+	dev->cont_read = 0;
+
+	return ad7124_write_register2(dev, AD7124_ADC_Control,
+				      dev->saved_adc_ctrl);
+}
+
+/***************************************************************************//**
+ * @brief Reads conversion frames back to back in continuous read mode.
+ *
+ * Each frame holds the data register followed by the status register, use
+ * AD7124_FRAME_DATA() and AD7124_FRAME_CH() to split it. The chip select is
+ * kept asserted between frames. On error the continuous read mode is left.
+ *
+ * @param dev        - The handler of the instance of the driver.
+ * @param frames     - Buffer where the frames are stored.
+ * @param nb_frames  - Number of frames to read.
+ * @param timeout_us - Maximum time to wait for each conversion, in
+ *                     microseconds.
+ *
+ * @return Returns 0 for success or negative error code.
+*******************************************************************************/
+int32_t ad7124_continuous_read_frames(struct ad7124_dev *dev,
+				      uint32_t *frames,
+				      uint32_t nb_frames,
+				      uint32_t timeout_us)
+{
+	int32_t ret;
+	uint32_t i;
+	uint8_t frame_size;
+	uint8_t buffer[6];
+
+	if(!dev || !frames || !dev->cont_read)
+		return INVALID_VAL;
+
+	/* Data, status and optional CRC */
+	frame_size = (dev->use_crc != AD7124_DISABLE_CRC) ? 5 : 4;
+
+	for (i = 0; i < nb_frames; i++) {
+		ret = ad7124_wait_for_rdy_low(dev, timeout_us);
+		if (ret < 0) {
+			/* No conversion to end the mode with a read command */
+			ad7124_continuous_read_reset(dev);
+			return ret;
+		}
+
+		/* DIN must be kept low, any command could end the mode */
+		buffer[1] = 0;
+		buffer[2] = 0;
+		buffer[3] = 0;
+		buffer[4] = 0;
+		buffer[5] = 0;
+		ret = ad7124_spi_xfer(dev, &buffer[1], frame_size, 0);
+		if (ret < 0)
+			goto error;
+
+		if (dev->use_crc == AD7124_USE_CRC) {
+			/* The checksum covers the implied read data command */
+			buffer[0] = AD7124_COMM_REG_WEN | AD7124_COMM_REG_RD |
+				    AD7124_COMM_REG_RA(AD7124_DATA_REG);
+			if (ad7124_compute_crc8(buffer, frame_size + 1) != 0) {
+				ret = COMM_ERR;
+				goto error;
+			}
+		}
+
+		frames[i] = ((uint32_t)buffer[1] << 24) |
+			    ((uint32_t)buffer[2] << 16) |
+			    ((uint32_t)buffer[3] << 8) | buffer[4];
+	}
+
+	return 0;
+
+error:
+	ad7124_continuous_read_stop(dev);
+
+	return ret;
+}
+
+/***************************************************************************//**
+ * @brief Reads conversion frames in continuous read mode into a circular
+ *        buffer.
+ *
+ * The frames are written to the buffer as uint32_t values, as returned by
+ * ad7124_continuous_read_frames().
+ *
+ * @param dev        - The handler of the instance of the driver.
+ * @param cb         - Circular buffer where the frames are stored.
+ * @param nb_frames  - Number of frames to read.
+ * @param timeout_us - Maximum time to wait for each conversion, in
+ *                     microseconds.
+ *
+ * @return Returns 0 for success or negative error code.
+*******************************************************************************/
+int32_t ad7124_continuous_read_cb(struct ad7124_dev *dev,
+				  struct circular_buffer *cb,
+				  uint32_t nb_frames,
+				  uint32_t timeout_us)
+{
+	int32_t ret;
+	uint32_t frame;
+
+	if (!cb)
+		return INVALID_VAL;
+
+	while (nb_frames--) {
+		ret = ad7124_continuous_read_frames(dev, &frame, 1, timeout_us);
+		if (ret < 0)
+			return ret;
+
+		ret = cb_write(cb, &frame, sizeof(frame));
+		if (ret < 0)
+			return ret;
+	}
+
+	return 0;
+}
+
 /**
  * @brief Get the ID of the channel of the latest conversion.
  *
@@ -472,24 +794,7 @@ int32_t ad7124_get_read_chan_id(struct ad7124_dev *dev, uint32_t *status)
 *******************************************************************************/
 uint8_t ad7124_compute_crc8(uint8_t * p_buf, uint8_t buf_size)
 {
-	uint8_t i = 0;
-	uint8_t crc = 0;
-
-	while(buf_size) {
-		for(i = 0x80; i != 0; i >>= 1) {
-			bool cmp1 = (crc & 0x80) != 0;
-			bool cmp2 = (*p_buf & i) != 0;
-			if(cmp1 != cmp2) { /* MSB of CRC register XOR input Bit from Data */
-				crc <<= 1;
-				crc ^= AD7124_CRC8_POLYNOMIAL_REPRESENTATION;
-			} else {
-				crc <<= 1;
-			}
-		}
-		p_buf++;
-		buf_size--;
-	}
-	return crc;
+	return crc8(ad7124_crc8, p_buf, buf_size, 0);
 }
 
 /***************************************************************************//**
@@ -555,7 +860,7 @@ int32_t ad7124_setup(struct ad7124_dev **device,
 	enum ad7124_registers reg_nr;
 	struct ad7124_dev *dev;
 
-	dev = (struct ad7124_dev *)malloc(sizeof(*dev));
+	dev = (struct ad7124_dev *)calloc(1, sizeof(*dev));
 	if (!dev)
 		return INVALID_VAL;
 
@@ -567,6 +872,17 @@ int32_t ad7124_setup(struct ad7124_dev **device,
 	if (ret < 0)
 		return ret;
 
+	/* Initialize the DOUT/RDY GPIO, used by the continuous read mode. */
+	ret = gpio_get_optional(&dev->gpio_rdy, init_param->gpio_rdy);
+	if (ret < 0)
+		return ret;
+
+	if (dev->gpio_rdy) {
+		ret = gpio_direction_input(dev->gpio_rdy);
+		if (ret < 0)
+			return ret;
+	}
+
 	/*  Reset the device interface.*/
 	ret = ad7124_reset(dev);
 	if (ret < 0)
@@ -784,9 +1100,16 @@ int32_t ad7124_set_odr(struct ad7124_dev *dev, float odr,
 *******************************************************************************/
 int32_t ad7124_remove(struct ad7124_dev *dev)
 {
-	int32_t ret;
+	int32_t ret = SUCCESS;
+	int32_t err;
+
+	/* The RDY GPIO is optional */
+	if (dev->gpio_rdy)
+		ret = gpio_remove(dev->gpio_rdy);
 
-	ret = spi_remove(dev->spi_desc);
+	err = spi_remove(dev->spi_desc);
+	if (!ret)
+		ret = err;
 
 	free(dev);
 
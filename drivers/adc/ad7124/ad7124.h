@@ -46,7 +46,9 @@
 /******************************************************************************/
 #include <stdint.h>
 #include "spi.h"
+#include "gpio.h"
 #include "delay.h"
+#include "circular_buffer.h"
 
 /******************************************************************************/
 /******************* Register map and register definitions ********************/
@@ -342,20 +344,30 @@ enum ad7124_registers {
  * @spi_rdy_poll_cnt: Number of times the driver should read the Error register
  *                    to check if the device is ready to accept user requests,
  *                    before a timeout error will be issued.
+ * @gpio_rdy: Optional GPIO connected to the DOUT/RDY pin, needed by the
+ *            continuous read mode.
+ * @cont_read: Whether the device is in continuous read mode.
+ * @saved_adc_ctrl: ADC_Control value restored when continuous read mode ends.
  */
 struct ad7124_dev {
 	/* SPI */
 	spi_desc		*spi_desc;
+	/* GPIO */
+	struct gpio_desc	*gpio_rdy;
 	/* Device Settings */
 	struct ad7124_st_reg	*regs;
 	int16_t use_crc;
 	int16_t check_ready;
 	int16_t spi_rdy_poll_cnt;
+	int16_t cont_read;
+	int32_t saved_adc_ctrl;
 };
 
 struct ad7124_init_param {
 	/* SPI */
 	spi_init_param		*spi_init;
+	/* GPIO */
+	struct gpio_init_param	*gpio_rdy;
 	/* Device Settings */
 	struct ad7124_st_reg	*regs;
 	int16_t spi_rdy_poll_cnt;
@@ -368,6 +380,17 @@ struct ad7124_init_param {
 #define AD7124_DISABLE_CRC 0
 #define AD7124_USE_CRC 1
 
+/* Time allowed for a conversion when leaving the continuous read mode */
+#define AD7124_CONT_READ_EXIT_TIMEOUT_US 5000000
+
+/*
+ * Continuous read frame: the data register followed by the status register,
+ * the status tells the channel the data was converted on.
+ */
+#define AD7124_FRAME_DATA(x)   ((x) >> 8)
+#define AD7124_FRAME_STATUS(x) ((x) & 0xFF)
+#define AD7124_FRAME_CH(x)     AD7124_STATUS_REG_CH_ACTIVE(x)
+
 /******************************************************************************/
 /************************ Functions Declarations ******************************/
 /******************************************************************************/
@@ -415,6 +438,24 @@ int32_t ad7124_wait_for_conv_ready(struct ad7124_dev *dev,
 int32_t ad7124_read_data(struct ad7124_dev *dev,
 			 int32_t* p_data);
 
+/*! Enters the continuous read mode. */
+int32_t ad7124_continuous_read_start(struct ad7124_dev *dev);
+
+/*! Leaves the continuous read mode. */
+int32_t ad7124_continuous_read_stop(struct ad7124_dev *dev);
+
+/*! Reads conversion frames back to back in continuous read mode. */
+int32_t ad7124_continuous_read_frames(struct ad7124_dev *dev,
+				      uint32_t *frames,
+				      uint32_t nb_frames,
+				      uint32_t timeout_us);
+
+/*! Reads conversion frames in continuous read mode into a circular buffer. */
+int32_t ad7124_continuous_read_cb(struct ad7124_dev *dev,
+				  struct circular_buffer *cb,
+				  uint32_t nb_frames,
+				  uint32_t timeout_us);
+
 /*! Get the ID of the channel of the latest conversion. */
 int32_t ad7124_get_read_chan_id(struct ad7124_dev *dev, uint32_t *status);
 
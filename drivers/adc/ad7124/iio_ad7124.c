@@ -51,6 +51,13 @@
 #include "util.h"
 #include "ad7124.h"
 
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/* Maximum time to wait for a conversion in continuous read mode */
+#define AD7124_IIO_CONV_TIMEOUT_US	5000000
+
 /******************************************************************************/
 /************************ Functions Declarations ******************************/
 /******************************************************************************/
@@ -640,6 +647,70 @@ static int32_t iio_ad7124_get_active_channels(struct ad7124_dev * desc,
 	return SUCCESS;
 }
 
+/**
+ * @brief Get a number of samples from all the active channels using the
+ * continuous read mode, at the output data rate of the device.
+ * @param [in] desc - Device descriptor.
+ * @param [out] buff - Sample buffer.
+ * @param [in] nb_samples - Number of samples to get.
+ * @param [in] mask - Active channels.
+ * @return SUCCESS in case of success, error code otherwise.
+ */
+static int32_t iio_ad7124_read_samples_cont(struct ad7124_dev *desc,
+		int32_t *buff, uint32_t nb_samples, uint32_t mask)
+{
+	int32_t ret, ret_stop;
+	uint32_t i, nb_frames, frame;
+	uint32_t ch_id = -1, first_ch;
+
+	nb_frames = 0;
+	while (get_next_ch_idx(mask, ch_id, &ch_id))
+		nb_frames++;
+	nb_frames *= nb_samples;
+	if (!nb_frames)
+		return SUCCESS;
+
+	ch_id = -1;
+	get_next_ch_idx(mask, ch_id, &first_ch);
+
+	ret = ad7124_continuous_read_start(desc);
+	if (ret != SUCCESS)
+		return ret;
+
+	/* Start with the first channel of the sequence */
+	do {
+		ret = ad7124_continuous_read_frames(desc, &frame, 1,
+						    AD7124_IIO_CONV_TIMEOUT_US);
+		if (ret != SUCCESS)
+			goto stop;
+	} while (AD7124_FRAME_CH(frame) != first_ch);
+	buff[0] = frame;
+
+	ret = ad7124_continuous_read_frames(desc, (uint32_t *)&buff[1],
+					    nb_frames - 1,
+					    AD7124_IIO_CONV_TIMEOUT_US);
+	if (ret != SUCCESS)
+		goto stop;
+
+	/* Drop the status bytes, checking that no conversion was missed */
+	ch_id = first_ch;
+	for (i = 0; i < nb_frames; i++) {
+		frame = buff[i];
+		if (AD7124_FRAME_CH(frame) != ch_id) {
+			ret = -EIO;
+			goto stop;
+		}
+		buff[i] = AD7124_FRAME_DATA(frame);
+		if (!get_next_ch_idx(mask, ch_id, &ch_id))
+			ch_id = first_ch;
+	}
+
+stop:
+	ret_stop = ad7124_continuous_read_stop(desc);
+
+	return ret != SUCCESS ? ret : ret_stop;
+}
+
 /**
  * @brief Get a number of samples from all the active channels.
  * @param [in] dev - Device descriptor.
@@ -660,6 +731,17 @@ static int32_t iio_ad7124_read_samples(void *dev, int32_t *buff,
 	if (ret != SUCCESS)
 		return ret;
 
+	/* Without the DOUT/RDY GPIO, or an SPI platform that keeps CS asserted,
+	 * the status register has to be polled */
+	if (desc->gpio_rdy) {
+		ret = iio_ad7124_read_samples_cont(desc, buff, nb_samples,
+						   mask);
+		if (ret == SUCCESS)
+			return nb_samples;
+		if (ret != -ENOTSUP)
+			return ret;
+	}
+
 	get_next_ch_idx(mask, ch_id, &ch_id);
 	do {
 		ret = ad7124_wait_for_conv_ready(desc, 10000);
@@ -45,13 +45,19 @@
 /***************************** Include Files **********************************/
 /******************************************************************************/
 #include <stdlib.h>
+#include <stdbool.h>
 #include "ad717x.h"
+#include "delay.h"
+#include "error.h"
+#include "crc8.h"
 
 /* Error codes */
 #define INVALID_VAL -1 /* Invalid argument */
 #define COMM_ERR    -2 /* Communication error on receive */
 #define TIMEOUT     -3 /* A timeout has occured */
 
+DECLARE_CRC8_CONST_TABLE(ad717x_crc8, AD717X_CRC8_POLYNOMIAL_REPRESENTATION);
+
 /***************************************************************************//**
 * @brief  Searches through the list of registers of the driver instance and
 *         retrieves a pointer to the register that matches the given address.
@@ -152,28 +158,50 @@ int32_t AD717X_ReadRegister(ad717x_dev *device,
 }
 
 /***************************************************************************//**
-* @brief Writes the value of the specified register.
+* @brief Runs a full duplex SPI transfer on a single buffer.
 *
-* @param device - The handler of the instance of the driver.
-* @param addr   - The address of the register to be written with the value stored
-*               inside the register structure that holds info about this
-*               register.
+* @param device    - The handler of the instance of the driver.
+* @param buf       - Data to send, overwritten with the received data.
+* @param size      - Number of bytes.
+* @param cs_change - Deassert the chip select at the end of the transfer. When
+*                    0, it is kept asserted until the next transfer.
 *
 * @return Returns 0 for success or negative error code.
 *******************************************************************************/
-int32_t AD717X_WriteRegister(ad717x_dev *device,
-			     uint8_t addr)
+static int32_t AD717X_SpiXfer(ad717x_dev *device,
+			      uint8_t *buf,
+			      uint32_t size,
+			      uint8_t cs_change)
+{
+	struct spi_msg msg = {
+		.tx_buff = buf,
+		.rx_buff = buf,
+		.bytes_number = size,
+		.cs_change = cs_change,
+	};
+
+	return spi_transfer(device->spi_desc, &msg, 1);
+}
+
+/***************************************************************************//**
+* @brief Writes a register, optionally keeping the chip select asserted.
+*
+* @param device    - The handler of the instance of the driver.
+* @param addr      - The address of the register to be written.
+* @param cs_change - Deassert the chip select at the end of the write.
+*
+* @return Returns 0 for success or negative error code.
+*******************************************************************************/
+static int32_t AD717X_WriteRegisterCS(ad717x_dev *device,
+				      uint8_t addr,
+				      uint8_t cs_change)
 {
-	int32_t ret      = 0;
 	int32_t regValue = 0;
 	uint8_t wrBuf[8] = {0, 0, 0, 0, 0, 0, 0, 0};
 	uint8_t i        = 0;
 	uint8_t crc8     = 0;
 	ad717x_st_reg *preg;
 
-	if(!device)
-		return INVALID_VAL;
-
 	preg = AD717X_GetReg(device, addr);
 	if (!preg)
 		return INVALID_VAL;
@@ -196,12 +224,28 @@ int32_t AD717X_WriteRegister(ad717x_dev *device,
 	}
 
 	/* Write data to the device */
-	ret = spi_write_and_read(device->spi_desc,
-				 wrBuf,
-				 (device->useCRC != AD717X_DISABLE) ?
-				 preg->size + 2 : preg->size + 1);
+	return AD717X_SpiXfer(device, wrBuf,
+			      (device->useCRC != AD717X_DISABLE) ?
+			      preg->size + 2 : preg->size + 1, cs_change);
+}
 
-	return ret;
+/***************************************************************************//**
+* @brief Writes the value of the specified register.
+*
+* @param device - The handler of the instance of the driver.
+* @param addr   - The address of the register to be written with the value stored
+*               inside the register structure that holds info about this
+*               register.
+*
+* @return Returns 0 for success or negative error code.
+*******************************************************************************/
+int32_t AD717X_WriteRegister(ad717x_dev *device,
+			     uint8_t addr)
+{
+	if(!device)
+		return INVALID_VAL;
+
+	return AD717X_WriteRegisterCS(device, addr, 1);
 }
 
 /***************************************************************************//**
@@ -295,6 +339,360 @@ int32_t AD717X_ReadData(ad717x_dev *device,
 	return ret;
 }
 
+/***************************************************************************//**
+* @brief Resets the device and writes the register values held by the driver.
+*
+* @param device - The handler of the instance of the driver.
+*
+* @return Returns 0 for success or negative error code.
+*******************************************************************************/
+static int32_t AD717X_ResetAndSetup(ad717x_dev *device)
+{
+	ad717x_st_reg *preg;
+	int32_t ret;
+
+	/*  Reset the device interface.*/
+	ret = AD717X_Reset(device);
+	if (ret < 0)
+		return ret;
+
+	/* The checksum is disabled after reset */
+	device->useCRC = AD717X_DISABLE;
+
+	/* Initialize ADC mode register. */
+	ret = AD717X_WriteRegister(device, AD717X_ADCMODE_REG);
+	if(ret < 0)
+		return ret;
+
+	/* Initialize Interface mode register. */
+	ret = AD717X_WriteRegister(device, AD717X_IFMODE_REG);
+	if(ret < 0)
+		return ret;
+
+	/* Get CRC State */
+	ret = AD717X_UpdateCRCSetting(device);
+	if(ret < 0)
+		return ret;
+
+	/* Initialize registers AD717X_GPIOCON_REG through AD717X_OFFSET0_REG */
+	preg = AD717X_GetReg(device, AD717X_GPIOCON_REG);
+	if (!preg)
+		return INVALID_VAL;
+
+	while (preg && preg->addr != AD717X_OFFSET0_REG) {
+		if (preg->addr == AD717X_ID_REG) {
+			preg ++;
+			continue;
+		}
+
+		ret = AD717X_WriteRegister(device, preg->addr);
+		if (ret < 0)
+			break;
+		preg ++;
+	}
+
+	return ret;
+}
+
+/***************************************************************************//**
+* @brief Waits until the DOUT/RDY line goes low, signaling a new conversion.
+*
+* DOUT/RDY is also the SPI data out line, so the edges seen while data is
+* clocked out are filtered by checking the level of the line.
+*
+* @param device     - The handler of the instance of the driver.
+* @param timeout_us - Maximum time to wait for an edge, in microseconds.
+*
+* @return Returns 0 for success or negative error code.
+*******************************************************************************/
+static int32_t AD717X_WaitForRdyLow(ad717x_dev *device,
+				    uint32_t timeout_us)
+{
+	int32_t ret;
+	uint8_t value;
+
+	while (true) {
+		ret = gpio_get_value(device->gpio_rdy, &value);
+		if (ret < 0)
+			return ret;
+		if (value == GPIO_LOW)
+			return 0;
+
+		ret = gpio_wait_edge(device->gpio_rdy, GPIO_EDGE_FALLING,
+				     &timeout_us);
+		if (ret == -ENOTSUP) {
+			/* No edge detection on this platform, poll the line */
+			if (!timeout_us--)
+				return TIMEOUT;
+			udelay(1);
+		} else if (ret == -ETIMEDOUT) {
+			return TIMEOUT;
+		} else if (ret < 0) {
+			return ret;
+		}
+	}
+}
+
+/***************************************************************************//**
+* @brief Leaves the continuous read mode by resetting the device.
+*
+* Used when the mode can not be left with a read data command, because no
+* conversion comes or the SPI bus failed. The registers are restored from the
+* values held by the driver, with the interface mode register set back to its
+* value from before the continuous read mode.
+*
+* @param device - The handler of the instance of the driver.
+*
+* @return Returns 0 for success or negative error code.
+*******************************************************************************/
+static int32_t AD717X_ContinuousReadReset(ad717x_dev *device)
+{
+	ad717x_st_reg *ifmodeReg;
+	int32_t ret;
+
+	device->cont_read = 0;
+
+	ifmodeReg = AD717X_GetReg(device, AD717X_IFMODE_REG);
+	if (ifmodeReg)
+		ifmodeReg->value = device->saved_ifmode;
+
+	ret = AD717X_ResetAndSetup(device);
+	if (ret < 0)
+		return ret;
+
+	return AD717X_ComputeDataregSize(device);
+}
+
+/***************************************************************************//**
+* @brief Enters the continuous read mode.
+*
+* The status register is appended to the data so that every frame tells the
+* channel it was converted on. Registers can not be accessed until
+* AD717X_ContinuousReadStop() is called. The DOUT/RDY line is only driven
+* while the chip select is asserted, so it is kept asserted from the write
+* that enters the mode until the mode is left. This needs a platform that
+* implements spi_transfer() with cs_change.
+*
+* @param device - The handler of the instance of the driver.
+*
+* @return Returns 0 for success, -ENOTSUP if the SPI platform can not keep
+*         the chip select asserted or negative error code.
+*******************************************************************************/
+int32_t AD717X_ContinuousReadStart(ad717x_dev *device)
+{
+	ad717x_st_reg *ifmodeReg;
+	int32_t ret;
+
+	/* The conversions can only be detected on the DOUT/RDY line */
+	if(!device || !device->regs || !device->gpio_rdy)
+		return INVALID_VAL;
+
+	/* Only a platform transfer op keeps CS asserted between messages */
+	if (!device->spi_desc->platform_ops ||
+	    !device->spi_desc->platform_ops->transfer)
+		return -ENOTSUP;
+
+	if (device->cont_read)
+		return 0;
+
+	ifmodeReg = AD717X_GetReg(device, AD717X_IFMODE_REG);
+	if (!ifmodeReg)
+		return INVALID_VAL;
+
+	device->saved_ifmode = ifmodeReg->value;
+	device->cont_read = 1;
+	ifmodeReg->value |= AD717X_IFMODE_REG_CONT_READ |
+			    AD717X_IFMODE_REG_DATA_STAT;
+	ret = AD717X_WriteRegisterCS(device, AD717X_IFMODE_REG, 0);
+	if (ret < 0) {
+		/* Whether the mode was entered is unknown */
+		AD717X_ContinuousReadReset(device);
+		return ret;
+	}
+
+	/* The frames now include the status register */
+	ret = AD717X_ComputeDataregSize(device);
+	if (ret < 0) {
+		AD717X_ContinuousReadStop(device);
+		return ret;
+	}
+
+	return 0;
+}
+
+/***************************************************************************//**
+* @brief Leaves the continuous read mode.
+*
+* A read data command is issued while DOUT/RDY is low, then the interface mode
+* register is restored to its value from before the continuous read mode.
+* If no conversion comes or the command fails, the device is reset instead,
+* so the mode is always left.
+*
+* @param device - The handler of the instance of the driver.
+*
+* @return Returns 0 for success or negative error code.
+*******************************************************************************/
+int32_t AD717X_ContinuousReadStop(ad717x_dev *device)
+{
+	ad717x_st_reg *ifmodeReg;
+	ad717x_st_reg *dataReg;
+	uint8_t buffer[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+	int32_t ret;
+
+	if(!device || !device->regs)
+		return INVALID_VAL;
+
+	if (!device->cont_read)
+		return 0;
+
+	ifmodeReg = AD717X_GetReg(device, AD717X_IFMODE_REG);
+	dataReg = AD717X_GetReg(device, AD717X_DATA_REG);
+	if (!ifmodeReg || !dataReg)
+		return AD717X_ContinuousReadReset(device);
+
+	ret = AD717X_WaitForRdyLow(device, AD717X_CONT_READ_EXIT_TIMEOUT_US);
+	if (ret < 0)
+		return AD717X_ContinuousReadReset(device);
+
+	buffer[0] = AD717X_COMM_REG_WEN | AD717X_COMM_REG_RD |
+		    AD717X_COMM_REG_RA(AD717X_DATA_REG);
+	ret = AD717X_SpiXfer(device, buffer,
+			     ((device->useCRC != AD717X_DISABLE) ?
+			      dataReg->size + 1 : dataReg->size) + 1, 1);
+	if (ret < 0)
+		return AD717X_ContinuousReadReset(device);
+
+	device->cont_read = 0;
+
+	ifmodeReg->value = device->saved_ifmode;
+	ret = AD717X_WriteRegister(device, AD717X_IFMODE_REG);
+	if (ret < 0)
+		return ret;
+
+	return AD717X_ComputeDataregSize(device);
+}
+
+/***************************************************************************//**
+* @brief Reads conversion frames back to back in continuous read mode.
+*
+* The chip select is kept asserted between frames. On error the continuous
+* read mode is left.
+*
+* @param device     - The handler of the instance of the driver.
+* @param frames     - Buffer where the frames are stored.
+* @param nb_frames  - Number of frames to read.
+* @param timeout_us - Maximum time to wait for each conversion, in
+*                     microseconds.
+*
+* @return Returns 0 for success or negative error code.
+*******************************************************************************/
+int32_t AD717X_ContinuousReadFrames(ad717x_dev *device,
+				    ad717x_frame *frames,
+				    uint32_t nb_frames,
+				    uint32_t timeout_us)
+{
+	ad717x_st_reg *dataReg;
+	uint8_t buffer[8];
+	uint8_t frameSize;
+	uint8_t check8;
+	uint8_t i;
+	uint32_t n;
+	int32_t ret;
+
+	if(!device || !frames || !device->cont_read)
+		return INVALID_VAL;
+
+	dataReg = AD717X_GetReg(device, AD717X_DATA_REG);
+	if (!dataReg)
+		return INVALID_VAL;
+
+	/* Data, status and optional checksum */
+	frameSize = dataReg->size;
+	if (device->useCRC != AD717X_DISABLE)
+		frameSize++;
+
+	for (n = 0; n < nb_frames; n++) {
+		ret = AD717X_WaitForRdyLow(device, timeout_us);
+		if (ret < 0) {
+			/* No conversion to end the mode with a read command */
+			AD717X_ContinuousReadReset(device);
+			return ret;
+		}
+
+		/* DIN must be kept low, any command could end the mode */
+		for (i = 1; i < frameSize + 1; i++)
+			buffer[i] = 0;
+		ret = AD717X_SpiXfer(device, &buffer[1], frameSize, 0);
+		if (ret < 0)
+			goto error;
+
+		/* The checksum covers the implied read data command */
+		buffer[0] = AD717X_COMM_REG_WEN | AD717X_COMM_REG_RD |
+			    AD717X_COMM_REG_RA(AD717X_DATA_REG);
+		check8 = 0;
+		if (device->useCRC == AD717X_USE_CRC)
+			check8 = AD717X_ComputeCRC8(buffer, frameSize + 1);
+		if (device->useCRC == AD717X_USE_XOR)
+			check8 = AD717X_ComputeXOR8(buffer, frameSize + 1);
+		if (check8 != 0) {
+			ret = COMM_ERR;
+			goto error;
+		}
+
+		frames[n].data = 0;
+		for (i = 1; i < dataReg->size; i++) {
+			frames[n].data <<= 8;
+			frames[n].data += buffer[i];
+		}
+		frames[n].status = buffer[dataReg->size];
+	}
+
+	return 0;
+
+error:
+	AD717X_ContinuousReadStop(device);
+
+	return ret;
+}
+
+/***************************************************************************//**
+* @brief Reads conversion frames in continuous read mode into a circular
+*        buffer.
+*
+* The frames are written to the buffer as ad717x_frame structures.
+*
+* @param device     - The handler of the instance of the driver.
+* @param cb         - Circular buffer where the frames are stored.
+* @param nb_frames  - Number of frames to read.
+* @param timeout_us - Maximum time to wait for each conversion, in
+*                     microseconds.
+*
+* @return Returns 0 for success or negative error code.
+*******************************************************************************/
+int32_t AD717X_ContinuousReadCB(ad717x_dev *device,
+				struct circular_buffer *cb,
+				uint32_t nb_frames,
+				uint32_t timeout_us)
+{
+	ad717x_frame frame;
+	int32_t ret;
+
+	if (!cb)
+		return INVALID_VAL;
+
+	while (nb_frames--) {
+		ret = AD717X_ContinuousReadFrames(device, &frame, 1, timeout_us);
+		if (ret < 0)
+			return ret;
+
+		ret = cb_write(cb, &frame, sizeof(frame));
+		if (ret < 0)
+			return ret;
+	}
+
+	return 0;
+}
+
 /***************************************************************************//**
 * @brief Computes data register read size to account for bit number and status
 * 		 read.
@@ -344,23 +742,7 @@ int32_t AD717X_ComputeDataregSize(ad717x_dev *device)
 uint8_t AD717X_ComputeCRC8(uint8_t * pBuf,
 			   uint8_t bufSize)
 {
-	uint8_t i   = 0;
-	uint8_t crc = 0;
-
-	while(bufSize) {
-		for(i = 0x80; i != 0; i >>= 1) {
-			if(((crc & 0x80) != 0) != ((*pBuf & i) !=
-						   0)) { /* MSB of CRC register XOR input Bit from Data */
-				crc <<= 1;
-				crc ^= AD717X_CRC8_POLYNOMIAL_REPRESENTATION;
-			} else {
-				crc <<= 1;
-			}
-		}
-		pBuf++;
-		bufSize--;
-	}
-	return crc;
+	return crc8(ad717x_crc8, pBuf, bufSize, 0);
 }
 
 /***************************************************************************//**
@@ -428,9 +810,8 @@ int32_t AD717X_Init(ad717x_dev **device,
 {
 	ad717x_dev *dev;
 	int32_t ret;
-	ad717x_st_reg *preg;
 
-	dev = (ad717x_dev *)malloc(sizeof(*dev));
+	dev = (ad717x_dev *)calloc(1, sizeof(*dev));
 	if (!dev)
 		return -1;
 
@@ -442,43 +823,21 @@ int32_t AD717X_Init(ad717x_dev **device,
 	if (ret < 0)
 		return ret;
 
-	/*  Reset the device interface.*/
-	ret = AD717X_Reset(dev);
+	/* Initialize the DOUT/RDY GPIO, used by the continuous read mode. */
+	ret = gpio_get_optional(&dev->gpio_rdy, init_param.gpio_rdy);
 	if (ret < 0)
 		return ret;
 
-	/* Initialize ADC mode register. */
-	ret = AD717X_WriteRegister(dev, AD717X_ADCMODE_REG);
-	if(ret < 0)
-		return ret;
-
-	/* Initialize Interface mode register. */
-	ret = AD717X_WriteRegister(dev, AD717X_IFMODE_REG);
-	if(ret < 0)
-		return ret;
-
-	/* Get CRC State */
-	ret = AD717X_UpdateCRCSetting(dev);
-	if(ret < 0)
-		return ret;
-
-	/* Initialize registers AD717X_GPIOCON_REG through AD717X_OFFSET0_REG */
-	preg = AD717X_GetReg(dev, AD717X_GPIOCON_REG);
-	if (!preg)
-		return INVALID_VAL;
-
-	while (preg && preg->addr != AD717X_OFFSET0_REG) {
-		if (preg->addr == AD717X_ID_REG) {
-			preg ++;
-			continue;
-		}
-
-		ret = AD717X_WriteRegister(dev, preg->addr);
+	if (dev->gpio_rdy) {
+		ret = gpio_direction_input(dev->gpio_rdy);
 		if (ret < 0)
-			break;
-		preg ++;
+			return ret;
 	}
 
+	ret = AD717X_ResetAndSetup(dev);
+	if (ret < 0)
+		return ret;
+
 	/* Read ID register to identify the part */
 	ret = AD717X_ReadRegister(dev, AD717X_ID_REG);
 	if(ret < 0)
@@ -496,9 +855,16 @@ int32_t AD717X_Init(ad717x_dev **device,
 *******************************************************************************/
 int32_t AD717X_remove(ad717x_dev *dev)
 {
-	int32_t ret;
+	int32_t ret = SUCCESS;
+	int32_t err;
+
+	/* The RDY GPIO is optional */
+	if (dev->gpio_rdy)
+		ret = gpio_remove(dev->gpio_rdy);
 
-	ret = spi_remove(dev->spi_desc);
+	err = spi_remove(dev->spi_desc);
+	if (!ret)
+		ret = err;
 
 	free(dev);
 
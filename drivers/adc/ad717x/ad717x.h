@@ -48,6 +48,8 @@
 /******************************************************************************/
 #include <stdint.h>
 #include "spi.h"
+#include "gpio.h"
+#include "circular_buffer.h"
 
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
@@ -73,24 +75,42 @@ typedef struct {
  *       provide when calling the Setup() function.
  * @num_regs: The length of the register list.
  * @userCRC: Error check type to use on SPI transfers.
+ * @gpio_rdy: Optional GPIO connected to the DOUT/RDY pin, needed by the
+ *            continuous read mode.
+ * @cont_read: Whether the device is in continuous read mode.
+ * @saved_ifmode: Interface mode value restored when continuous read mode ends.
  */
 typedef struct {
 	/* SPI */
 	spi_desc		*spi_desc;
+	/* GPIO */
+	struct gpio_desc	*gpio_rdy;
 	/* Device Settings */
 	ad717x_st_reg		*regs;
 	uint8_t			num_regs;
 	ad717x_crc_mode		useCRC;
+	uint8_t			cont_read;
+	int32_t			saved_ifmode;
 } ad717x_dev;
 
 typedef struct {
 	/* SPI */
 	spi_init_param		spi_init;
+	/* GPIO */
+	struct gpio_init_param	*gpio_rdy;
 	/* Device Settings */
 	ad717x_st_reg		*regs;
 	uint8_t			num_regs;
 } ad717x_init_param;
 
+/*! Conversion result read in continuous read mode */
+typedef struct {
+	/* Data register */
+	uint32_t		data;
+	/* Status register, tells the channel the data was converted on */
+	uint8_t			status;
+} ad717x_frame;
+
 /*****************************************************************************/
 /***************** AD717X Register Definitions *******************************/
 /*****************************************************************************/
@@ -282,6 +302,9 @@ typedef struct {
 /*****************************************************************************/
 #define AD717X_CRC8_POLYNOMIAL_REPRESENTATION 0x07 /* x8 + x2 + x + 1 */
 
+/* Time allowed for a conversion when leaving the continuous read mode */
+#define AD717X_CONT_READ_EXIT_TIMEOUT_US 5000000
+
 /*****************************************************************************/
 /************************ Functions Declarations *****************************/
 /*****************************************************************************/
@@ -309,6 +332,24 @@ int32_t AD717X_WaitForReady(ad717x_dev *device,
 int32_t AD717X_ReadData(ad717x_dev *device,
 			int32_t* pData);
 
+/*! Enters the continuous read mode. */
+int32_t AD717X_ContinuousReadStart(ad717x_dev *device);
+
+/*! Leaves the continuous read mode. */
+int32_t AD717X_ContinuousReadStop(ad717x_dev *device);
+
+/*! Reads conversion frames back to back in continuous read mode. */
+int32_t AD717X_ContinuousReadFrames(ad717x_dev *device,
+				    ad717x_frame *frames,
+				    uint32_t nb_frames,
+				    uint32_t timeout_us);
+
+/*! Reads conversion frames in continuous read mode into a circular buffer. */
+int32_t AD717X_ContinuousReadCB(ad717x_dev *device,
+				struct circular_buffer *cb,
+				uint32_t nb_frames,
+				uint32_t timeout_us);
+
 /*! Computes data register read size to account for bit number and status
  *  read. */
 int32_t AD717X_ComputeDataregSize(ad717x_dev *device);
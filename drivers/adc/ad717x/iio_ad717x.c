@@ -0,0 +1,439 @@
+/***************************************************************************//**
+ *   @file   iio_ad717x.c
+ *   @brief  Implementation of the AD717X IIO device.
+********************************************************************************
+ * Copyright 2021(c) Analog Devices, Inc.
+ *
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdbool.h>
+#include <inttypes.h>
+#include "error.h"
+#include "iio.h"
+#include "iio_ad717x.h"
+#include "util.h"
+#include "ad717x.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/* Number of channel registers */
+#define AD717X_IIO_NUM_CH		16
+/* Maximum time to wait for a conversion in continuous read mode */
+#define AD717X_IIO_CONV_TIMEOUT_US	5000000
+/* Number of status polls done while waiting for a conversion */
+#define AD717X_IIO_POLL_CNT		10000
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+static ssize_t ad717x_iio_read_raw_chan(void *device, char *buf, size_t len,
+					const struct iio_ch_info *channel, intptr_t priv);
+
+/******************************************************************************/
+/************************ Variable Declarations *******************************/
+/******************************************************************************/
+
+static struct iio_attribute ad717x_channel_attributes[] = {
+	{
+		.name = "raw",
+		.priv = 0,
+		.show = ad717x_iio_read_raw_chan,
+		.store = NULL
+	},
+	END_ATTRIBUTES_ARRAY
+};
+
+static struct scan_type ad717x_iio_scan_type = {
+	.sign = 'u',
+	.realbits = 24,
+	.storagebits = 32,
+	.shift = 0,
+	.is_big_endian = false
+};
+
+#define AD717X_IIO_CHANN_DEF(nm, ch) \
+	{ \
+		.name = nm, \
+		.ch_type = IIO_VOLTAGE, \
+		.channel = ch, \
+		.scan_index = ch, \
+		.scan_type = &ad717x_iio_scan_type, \
+		.attributes = ad717x_channel_attributes, \
+		.ch_out = 0, \
+		.indexed = 1, \
+	}
+
+static struct iio_channel ad717x_channels[] = {
+	AD717X_IIO_CHANN_DEF("ch0", 0),
+	AD717X_IIO_CHANN_DEF("ch1", 1),
+	AD717X_IIO_CHANN_DEF("ch2", 2),
+	AD717X_IIO_CHANN_DEF("ch3", 3),
+	AD717X_IIO_CHANN_DEF("ch4", 4),
+	AD717X_IIO_CHANN_DEF("ch5", 5),
+	AD717X_IIO_CHANN_DEF("ch6", 6),
+	AD717X_IIO_CHANN_DEF("ch7", 7),
+	AD717X_IIO_CHANN_DEF("ch8", 8),
+	AD717X_IIO_CHANN_DEF("ch9", 9),
+	AD717X_IIO_CHANN_DEF("ch10", 10),
+	AD717X_IIO_CHANN_DEF("ch11", 11),
+	AD717X_IIO_CHANN_DEF("ch12", 12),
+	AD717X_IIO_CHANN_DEF("ch13", 13),
+	AD717X_IIO_CHANN_DEF("ch14", 14),
+	AD717X_IIO_CHANN_DEF("ch15", 15)
+};
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Read one conversion by polling the status register.
+ * @param desc - Device driver descriptor.
+ * @param frame - Conversion result and the status it was read with.
+ * @return SUCCESS in case of success, error code otherwise.
+ */
+static int32_t ad717x_iio_poll_frame(ad717x_dev *desc, ad717x_frame *frame)
+{
+	ad717x_st_reg	*ifmode_reg;
+	ad717x_st_reg	*status_reg;
+	int32_t		value;
+	int32_t		ret;
+
+	ifmode_reg = AD717X_GetReg(desc, AD717X_IFMODE_REG);
+	status_reg = AD717X_GetReg(desc, AD717X_STATUS_REG);
+	if (!ifmode_reg || !status_reg)
+		return -EINVAL;
+
+	ret = AD717X_WaitForReady(desc, AD717X_IIO_POLL_CNT);
+	if (ret < 0)
+		return ret;
+
+	ret = AD717X_ReadData(desc, &value);
+	if (ret < 0)
+		return ret;
+
+	/* The status is appended to the data when DATA_STAT is set */
+	if (ifmode_reg->value & AD717X_IFMODE_REG_DATA_STAT) {
+		frame->data = (uint32_t)value >> 8;
+		frame->status = value & 0xFF;
+
+		return SUCCESS;
+	}
+
+	ret = AD717X_ReadRegister(desc, AD717X_STATUS_REG);
+	if (ret < 0)
+		return ret;
+
+	frame->data = value;
+	frame->status = status_reg->value;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Read and display a single conversion of a channel.
+ * @param device - Device driver descriptor.
+ * @param buf - Output buffer.
+ * @param len - Length of the input buffer.
+ * @param channel - IIO channel information.
+ * @param priv - Attribute private data (not used in this case).
+ * @return Number of bytes printed in the output buffer, or negative error code.
+ */
+static ssize_t ad717x_iio_read_raw_chan(void *device, char *buf, size_t len,
+					const struct iio_ch_info *channel, intptr_t priv)
+{
+	ad717x_dev	*desc = (ad717x_dev *)device;
+	ad717x_st_reg	*chmap_reg;
+	ad717x_frame	frame;
+	int32_t		chmap;
+	int32_t		ret, ret_restore;
+	uint8_t		i;
+
+	chmap_reg = AD717X_GetReg(desc, AD717X_CHMAP0_REG + channel->ch_num);
+	if (!chmap_reg)
+		return -EINVAL;
+
+	chmap = chmap_reg->value;
+	chmap_reg->value |= AD717X_CHMAP_REG_CH_EN;
+	ret = AD717X_WriteRegister(desc, chmap_reg->addr);
+	if (ret < 0)
+		return ret;
+
+	/* Other enabled channels may be converted first */
+	for (i = 0; i <= AD717X_IIO_NUM_CH; i++) {
+		ret = ad717x_iio_poll_frame(desc, &frame);
+		if (ret < 0)
+			break;
+		if (AD717X_STATUS_REG_CH(frame.status) == channel->ch_num)
+			break;
+	}
+	if (i > AD717X_IIO_NUM_CH)
+		ret = -EIO;
+
+	chmap_reg->value = chmap;
+	ret_restore = AD717X_WriteRegister(desc, chmap_reg->addr);
+	if (ret < 0)
+		return ret;
+	if (ret_restore < 0)
+		return ret_restore;
+
+	return snprintf(buf, len, "%"PRIu32"", frame.data);
+}
+
+/**
+ * @brief Enable the channels from the mask and disable the others.
+ * @param dev - Device driver descriptor.
+ * @param mask - Channels to enable.
+ * @return SUCCESS in case of success, error code otherwise.
+ */
+static int32_t ad717x_iio_update_channels(void *dev, uint32_t mask)
+{
+	ad717x_dev	*desc = (ad717x_dev *)dev;
+	ad717x_st_reg	*chmap_reg;
+	int32_t		ret;
+	uint8_t		i;
+
+	for (i = 0; i < AD717X_IIO_NUM_CH; i++) {
+		chmap_reg = AD717X_GetReg(desc, AD717X_CHMAP0_REG + i);
+		if (!chmap_reg) {
+			/* The part has less channels than the IIO device */
+			if (mask & BIT(i))
+				return -EINVAL;
+			continue;
+		}
+
+		if (mask & BIT(i))
+			chmap_reg->value |= AD717X_CHMAP_REG_CH_EN;
+		else
+			chmap_reg->value &= ~AD717X_CHMAP_REG_CH_EN;
+
+		ret = AD717X_WriteRegister(desc, chmap_reg->addr);
+		if (ret < 0)
+			return ret;
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Disable all the channels.
+ * @param dev - Device driver descriptor.
+ * @return SUCCESS in case of success, error code otherwise.
+ */
+static int32_t ad717x_iio_close_channels(void *dev)
+{
+	return ad717x_iio_update_channels(dev, 0);
+}
+
+/**
+ * @brief Get the enabled channels in the form of a mask.
+ * @param desc - Device driver descriptor.
+ * @return The mask of the enabled channels.
+ */
+static uint32_t ad717x_iio_get_active_channels(ad717x_dev *desc)
+{
+	ad717x_st_reg	*chmap_reg;
+	uint32_t	mask;
+	uint8_t		i;
+
+	mask = 0;
+	for (i = 0; i < AD717X_IIO_NUM_CH; i++) {
+		chmap_reg = AD717X_GetReg(desc, AD717X_CHMAP0_REG + i);
+		if (chmap_reg && (chmap_reg->value & AD717X_CHMAP_REG_CH_EN))
+			mask |= BIT(i);
+	}
+
+	return mask;
+}
+
+/**
+ * @brief Get the channel converted after another one.
+ * @param mask - Enabled channels.
+ * @param ch - Current channel.
+ * @return The next enabled channel, the sequence restarts after the last one.
+ */
+static uint8_t ad717x_iio_next_channel(uint32_t mask, uint8_t ch)
+{
+	do {
+		ch = (ch + 1) % AD717X_IIO_NUM_CH;
+	} while (!(mask & BIT(ch)));
+
+	return ch;
+}
+
+/**
+ * @brief Get a number of samples from all the active channels.
+ *
+ * When the DOUT/RDY GPIO is available the samples are read in continuous read
+ * mode, at the output data rate of the device, and a missed conversion is
+ * reported as an error. Otherwise the status register is polled for every
+ * sample.
+ *
+ * @param dev - Device driver descriptor.
+ * @param buff - Sample buffer.
+ * @param nb_samples - Number of samples to get from each channel.
+ * @return Number of samples read, or negative error code.
+ */
+static int32_t ad717x_iio_read_samples(void *dev, int32_t *buff,
+				       uint32_t nb_samples)
+{
+	ad717x_dev	*desc = (ad717x_dev *)dev;
+	ad717x_frame	frame;
+	uint32_t	mask;
+	uint32_t	i, nb_frames, skipped;
+	uint8_t		ch;
+	bool		cont_read;
+	int32_t		ret, ret_stop;
+
+	mask = ad717x_iio_get_active_channels(desc);
+	if (!mask)
+		return -EINVAL;
+
+	nb_frames = nb_samples * (hweight8(mask & 0xFF) + hweight8(mask >> 8));
+	ch = find_first_set_bit(mask);
+	cont_read = desc->gpio_rdy != NULL;
+
+	if (cont_read) {
+		ret = AD717X_ContinuousReadStart(desc);
+		/* The SPI platform can not keep CS asserted, poll instead */
+		if (ret == -ENOTSUP)
+			cont_read = false;
+		else if (ret < 0)
+			return ret;
+	}
+
+	i = 0;
+	skipped = 0;
+	while (i < nb_frames) {
+		if (cont_read)
+			ret = AD717X_ContinuousReadFrames(desc, &frame, 1,
+							  AD717X_IIO_CONV_TIMEOUT_US);
+		else
+			ret = ad717x_iio_poll_frame(desc, &frame);
+		if (ret < 0)
+			break;
+
+		if (AD717X_STATUS_REG_CH(frame.status) != ch) {
+			/* Give up if the expected channel never converts */
+			if (++skipped > AD717X_IIO_POLL_CNT) {
+				ret = -ETIMEDOUT;
+				break;
+			}
+			/* Skip to the start of the sequence on the first read */
+			if (!cont_read || !i)
+				continue;
+			ret = -EIO;
+			break;
+		}
+
+		skipped = 0;
+		buff[i++] = frame.data;
+		ch = ad717x_iio_next_channel(mask, ch);
+	}
+
+	if (cont_read) {
+		ret_stop = AD717X_ContinuousReadStop(desc);
+		if (ret >= 0)
+			ret = ret_stop;
+	}
+
+	if (ret < 0)
+		return ret;
+
+	return nb_samples;
+}
+
+/**
+ * @brief Read a register, used by the IIO debug interface.
+ * @param dev - Device driver descriptor.
+ * @param reg - Address of the register.
+ * @param readval - Value of the register.
+ * @return SUCCESS in case of success, error code otherwise.
+ */
+static int32_t ad717x_iio_reg_read(void *dev, uint32_t reg, uint32_t *readval)
+{
+	ad717x_dev	*desc = (ad717x_dev *)dev;
+	int32_t		ret;
+
+	ret = AD717X_ReadRegister(desc, reg);
+	if (ret < 0)
+		return ret;
+
+	*readval = AD717X_GetReg(desc, reg)->value;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Write a register, used by the IIO debug interface.
+ * @param dev - Device driver descriptor.
+ * @param reg - Address of the register.
+ * @param writeval - New value of the register.
+ * @return SUCCESS in case of success, error code otherwise.
+ */
+static int32_t ad717x_iio_reg_write(void *dev, uint32_t reg, uint32_t writeval)
+{
+	ad717x_dev	*desc = (ad717x_dev *)dev;
+	ad717x_st_reg	*preg;
+
+	preg = AD717X_GetReg(desc, reg);
+	if (!preg)
+		return -EINVAL;
+
+	preg->value = writeval;
+
+	return AD717X_WriteRegister(desc, reg);
+}
+
+struct iio_device iio_ad717x_device = {
+	.num_ch = ARRAY_SIZE(ad717x_channels),
+	.channels = ad717x_channels,
+	.attributes = NULL,
+	.debug_attributes = NULL,
+	.buffer_attributes = NULL,
+	.prepare_transfer = ad717x_iio_update_channels,
+	.end_transfer = ad717x_iio_close_channels,
+	.read_dev = (int32_t (*)())ad717x_iio_read_samples,
+	.debug_reg_read = ad717x_iio_reg_read,
+	.debug_reg_write = ad717x_iio_reg_write
+};
@@ -496,7 +496,7 @@ static int32_t ad9081_setup(struct ad9081_phy *phy)
 
 	/* The 204c calibration routine requires the link to be up */
 	if (phy->jesd_tx_clk) {
-		ret = clk_set_rate(phy->jesd_tx_clk, tx_lane_rate_kbps);
+		ret = clk_set_rate(phy->jesd_tx_clk, tx_lane_rate_kbps * 1000);
 		if (ret < 0) {
 			printf("Failed to set lane rate to %llu kHz: %"PRId32"\n",
 			       tx_lane_rate_kbps, ret);
@@ -673,7 +673,7 @@ static int32_t ad9081_setup(struct ad9081_phy *phy)
 				    phy->adc_frequency_hz,
 				    dcm);
 
-		ret = clk_set_rate(phy->jesd_rx_clk, rx_lane_rate_kbps);
+		ret = clk_set_rate(phy->jesd_rx_clk, rx_lane_rate_kbps * 1000);
 		if (ret < 0) {
 			printf("Failed to set lane rate to %llu kHz: %"PRId32"\n",
 			       rx_lane_rate_kbps, ret);
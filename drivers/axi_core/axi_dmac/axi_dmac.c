@@ -50,17 +50,89 @@
 #include "axi_dmac.h"
 
 /***************************************************************************//**
- * @brief dma_isr
+ * @brief Program the queued segments into the core, as long as it accepts
+ *        them and has free transfer IDs.
 *******************************************************************************/
-void axi_dmac_default_isr(void *instance)
+static void axi_dmac_issue(struct axi_dmac *dmac)
 {
-	struct axi_dmac *dmac = (struct axi_dmac *)instance;
-	uint32_t remaining_size, burst_size;
+	struct axi_dmac_segment *seg;
 	uint32_t reg_val;
+	uint32_t flags;
 
-	/* Get interrupt sources and clear interrupts. */
-	axi_dmac_read(dmac, AXI_DMAC_REG_IRQ_PENDING, &reg_val);
-	axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_PENDING, reg_val);
+	while (dmac->queue_issued < dmac->queue_len &&
+	       dmac->queue_issued < AXI_DMAC_MAX_ISSUED) {
+		/* The register set is free again once the previous one started */
+		axi_dmac_read(dmac, AXI_DMAC_REG_START_TRANSFER, &reg_val);
+		if (reg_val & 1)
+			break;
+
+		seg = &dmac->queue[(dmac->queue_first + dmac->queue_issued) %
+						      AXI_DMAC_QUEUE_SIZE];
+		axi_dmac_read(dmac, AXI_DMAC_REG_TRANSFER_ID, &seg->id);
+
+		if (dmac->direction == DMA_DEV_TO_MEM) {
+			axi_dmac_write(dmac, AXI_DMAC_REG_DEST_ADDRESS, seg->address);
+			axi_dmac_write(dmac, AXI_DMAC_REG_DEST_STRIDE, 0x0);
+		} else {
+			axi_dmac_write(dmac, AXI_DMAC_REG_SRC_ADDRESS, seg->address);
+			axi_dmac_write(dmac, AXI_DMAC_REG_SRC_STRIDE, 0x0);
+		}
+		axi_dmac_write(dmac, AXI_DMAC_REG_X_LENGTH, seg->size - 1);
+		axi_dmac_write(dmac, AXI_DMAC_REG_Y_LENGTH, 0x0);
+
+		flags = dmac->flags & ~DMA_CYCLIC;
+		if (!seg->last)
+			flags &= ~DMA_LAST;
+		axi_dmac_write(dmac, AXI_DMAC_REG_FLAGS, flags);
+
+		axi_dmac_write(dmac, AXI_DMAC_REG_START_TRANSFER, 0x1);
+		dmac->queue_issued++;
+	}
+}
+
+/***************************************************************************//**
+ * @brief Retire the issued segments the core is done with, in order, and
+ *        call the callback of the completed transfers.
+*******************************************************************************/
+static void axi_dmac_complete(struct axi_dmac *dmac)
+{
+	struct axi_dmac_segment *seg;
+	void (*callback)(void *ctx);
+	uint32_t done;
+	void *ctx;
+
+	axi_dmac_read(dmac, AXI_DMAC_REG_TRANSFER_DONE, &done);
+
+	while (dmac->queue_issued) {
+		seg = &dmac->queue[dmac->queue_first];
+		if (!(done & BIT(seg->id)))
+			break;
+
+		callback = seg->callback;
+		ctx = seg->ctx;
+		dmac->queue_first = (dmac->queue_first + 1) % AXI_DMAC_QUEUE_SIZE;
+		dmac->queue_issued--;
+		dmac->queue_len--;
+
+		/* The callback may submit the next transfer */
+		if (callback)
+			callback(ctx);
+	}
+}
+
+/***************************************************************************//**
+ * @brief Handle the SOT and EOT events, from the ISR or the status polling.
+*******************************************************************************/
+static void axi_dmac_handle_events(struct axi_dmac *dmac, uint32_t reg_val)
+{
+	uint32_t remaining_size, burst_size;
+
+	/* Transfers of axi_dmac_submit(), the next one is programmed here */
+	if (dmac->queue_len) {
+		if (reg_val & AXI_DMAC_IRQ_EOT)
+			axi_dmac_complete(dmac);
+		axi_dmac_issue(dmac);
+	}
 
 	if ((reg_val & AXI_DMAC_IRQ_SOT) && (dmac->big_transfer.size != 0)) {
 		remaining_size = dmac->big_transfer.size -
@@ -99,6 +171,39 @@ void axi_dmac_default_isr(void *instance)
 	}
 }
 
+/***************************************************************************//**
+ * @brief dma_isr
+*******************************************************************************/
+void axi_dmac_default_isr(void *instance)
+{
+	struct axi_dmac *dmac = (struct axi_dmac *)instance;
+	uint32_t reg_val;
+
+	/* Get interrupt sources and clear interrupts. */
+	axi_dmac_read(dmac, AXI_DMAC_REG_IRQ_PENDING, &reg_val);
+	axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_PENDING, reg_val);
+
+	axi_dmac_handle_events(dmac, reg_val);
+}
+
+/***************************************************************************//**
+ * @brief Handle the events latched since the last call, without interrupt.
+ *
+ * IRQ_SOURCE latches the events even while they are masked, and is cleared
+ * through IRQ_PENDING.
+*******************************************************************************/
+static void axi_dmac_poll_events(struct axi_dmac *dmac)
+{
+	uint32_t reg_val;
+
+	axi_dmac_read(dmac, AXI_DMAC_REG_IRQ_SOURCE, &reg_val);
+	if (!reg_val)
+		return;
+	axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_PENDING, reg_val);
+
+	axi_dmac_handle_events(dmac, reg_val);
+}
+
 /***************************************************************************//**
  * @brief axi_dmac_read
  *******************************************************************************/
@@ -143,6 +248,7 @@ int32_t axi_dmac_transfer_nonblocking(struct axi_dmac *dmac,
 
 	axi_dmac_read(dmac, AXI_DMAC_REG_START_TRANSFER, &reg_val);
 	if (!(reg_val & 1)) {
+		dmac->big_transfer.transfer_done = false;
 		switch (dmac->direction) {
 		case DMA_DEV_TO_MEM:
 			axi_dmac_write(dmac, AXI_DMAC_REG_DEST_ADDRESS, address);
@@ -193,15 +299,191 @@ int32_t axi_dmac_is_transfer_ready(struct axi_dmac *dmac, bool *rdy)
 	return SUCCESS;
 }
 
+/***************************************************************************//**
+ * @brief Spend one microsecond of a polling timeout.
+ *
+ * @param timeout_us - Time left to wait, updated on return.
+ *
+ * @return SUCCESS if the caller should check its condition again, -ETIMEDOUT
+ *         when the time is up.
+ *******************************************************************************/
+static int32_t axi_dmac_poll_delay(uint32_t *timeout_us)
+{
+	if (!*timeout_us)
+		return -ETIMEDOUT;
+
+	udelay(1);
+	(*timeout_us)--;
+
+	return SUCCESS;
+}
+
+/***************************************************************************//**
+ * @brief Wait for the next DMAC event.
+ *
+ * Where the platform hands the interrupt to the caller (UIO on Linux), sleep
+ * until it fires and run the ISR. If the ISR is run by the interrupt
+ * controller, this only gives it time to do so. Without interrupt, handle the
+ * events latched in the status registers.
+ *
+ * Callers polling a condition of their own, such as AXI_DMAC_REG_TRANSFER_DONE,
+ * call this until the condition holds.
+ *
+ * @param dmac       - DMAC descriptor.
+ * @param timeout_us - Time left to wait, decreased by the time spent waiting.
+ *
+ * @return SUCCESS if the caller should check its condition again, -ETIMEDOUT
+ *         when the time is up, negative error code otherwise.
+ *******************************************************************************/
+int32_t axi_dmac_wait_event(struct axi_dmac *dmac, uint32_t *timeout_us)
+{
+	int32_t ret;
+
+	if (!*timeout_us)
+		return -ETIMEDOUT;
+
+	if (dmac->irq_mode == AXI_DMAC_IRQ_WAIT) {
+		ret = axi_io_wait_irq(dmac->base, timeout_us);
+		if (ret == SUCCESS) {
+			axi_dmac_default_isr(dmac);
+			return SUCCESS;
+		}
+		if (ret != -ENOTSUP)
+			return ret;
+
+		/* The device has no interrupt after all */
+		dmac->irq_mode = AXI_DMAC_IRQ_POLL;
+	}
+
+	if (dmac->irq_mode == AXI_DMAC_IRQ_POLL)
+		axi_dmac_poll_events(dmac);
+
+	return axi_dmac_poll_delay(timeout_us);
+}
+
+/***************************************************************************//**
+ * @brief Let the ISR in again after the queue was updated, if there is one.
+*******************************************************************************/
+static void axi_dmac_submit_unmask(struct axi_dmac *dmac)
+{
+	if (dmac->irq_mode != AXI_DMAC_IRQ_POLL)
+		axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_MASK, 0x0);
+}
+
+/***************************************************************************//**
+ * @brief Queue a transfer and return without waiting for it.
+ *
+ * Transfers larger than the core supports are split into segments. The core
+ * holds up to AXI_DMAC_MAX_ISSUED of them and the ISR programs the next one
+ * as soon as there is room, so back to back transfers leave no gap. The
+ * callback is called from the ISR once the whole transfer is done, and may
+ * submit the next one.
+ *
+ * The ISR must be run on the DMAC interrupt: register axi_dmac_default_isr()
+ * with the interrupt controller and set use_irq, or call axi_dmac_wait() where
+ * the platform delivers the interrupt to the caller (UIO on Linux). Without
+ * interrupt, the interrupts of the core stay masked and the transfers only
+ * progress while axi_dmac_wait() polls the status registers.
+ *
+ * @param dmac     - DMAC descriptor.
+ * @param address  - Address of the buffer.
+ * @param size     - Size of the transfer in bytes.
+ * @param callback - Function called when the transfer is done, may be NULL.
+ * @param ctx      - Parameter of the callback.
+ *
+ * @return SUCCESS in case of success, -EBUSY if the queue is full or a
+ *         blocking transfer is running, negative error code otherwise.
+ *******************************************************************************/
+int32_t axi_dmac_submit(struct axi_dmac *dmac, uint32_t address, uint32_t size,
+			void (*callback)(void *ctx), void *ctx)
+{
+	struct axi_dmac_segment *seg;
+	uint32_t max_size, nb_segs;
+	uint32_t reg_val;
+
+	if (!dmac || !size || (dmac->flags & DMA_CYCLIC) ||
+	    (dmac->direction != DMA_DEV_TO_MEM &&
+	     dmac->direction != DMA_MEM_TO_DEV))
+		return -EINVAL;
+
+	if (dmac->big_transfer.size)
+		return -EBUSY;
+
+	max_size = dmac->transfer_max_size == UINT32_MAX ? UINT32_MAX :
+		   dmac->transfer_max_size + 1;
+	nb_segs = (size - 1) / max_size + 1;
+
+	/* Keep the ISR out while the queue is updated */
+	axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_MASK,
+		       AXI_DMAC_IRQ_SOT | AXI_DMAC_IRQ_EOT);
+
+	if (dmac->queue_len + nb_segs > AXI_DMAC_QUEUE_SIZE) {
+		axi_dmac_submit_unmask(dmac);
+		return -EBUSY;
+	}
+
+	axi_dmac_read(dmac, AXI_DMAC_REG_CTRL, &reg_val);
+	if (!(reg_val & AXI_DMAC_CTRL_ENABLE)) {
+		axi_dmac_write(dmac, AXI_DMAC_REG_CTRL, 0x0);
+		axi_dmac_write(dmac, AXI_DMAC_REG_CTRL, AXI_DMAC_CTRL_ENABLE);
+	}
+
+	while (size) {
+		seg = &dmac->queue[(dmac->queue_first + dmac->queue_len) %
+						      AXI_DMAC_QUEUE_SIZE];
+		seg->address = address;
+		seg->size = min(size, max_size);
+		seg->last = seg->size == size;
+		seg->callback = seg->last ? callback : NULL;
+		seg->ctx = ctx;
+
+		address += seg->size;
+		size -= seg->size;
+		dmac->queue_len++;
+	}
+
+	axi_dmac_issue(dmac);
+
+	axi_dmac_submit_unmask(dmac);
+
+	return SUCCESS;
+}
+
+/***************************************************************************//**
+ * @brief Wait until all the transfers queued by axi_dmac_submit() are done.
+ *
+ * @param dmac       - DMAC descriptor.
+ * @param timeout_us - Maximum time to wait, in microseconds.
+ *
+ * @return SUCCESS in case of success, -ETIMEDOUT if the transfers did not
+ *         finish in time, negative error code otherwise.
+ *******************************************************************************/
+int32_t axi_dmac_wait(struct axi_dmac *dmac, uint32_t timeout_us)
+{
+	int32_t ret;
+
+	if (!dmac)
+		return -EINVAL;
+
+	while (dmac->queue_len) {
+		ret = axi_dmac_wait_event(dmac, &timeout_us);
+		if (ret < 0)
+			return ret;
+	}
+
+	return SUCCESS;
+}
+
 /***************************************************************************//**
  * @brief axi_dmac_transfer
  *******************************************************************************/
 int32_t axi_dmac_transfer(struct axi_dmac *dmac,
 			  uint32_t address, uint32_t size)
 {
+	uint32_t timeout = AXI_DMAC_TIMEOUT_US;
 	uint32_t transfer_id;
 	uint32_t reg_val;
-	uint32_t timeout = 0;
+	int32_t ret;
 
 	if (size == 0)
 		return SUCCESS; /* nothing to do */
@@ -214,6 +496,7 @@ int32_t axi_dmac_transfer(struct axi_dmac *dmac,
 	axi_dmac_read(dmac, AXI_DMAC_REG_TRANSFER_ID, &transfer_id);
 	axi_dmac_read(dmac, AXI_DMAC_REG_IRQ_PENDING, &reg_val);
 	axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_PENDING, reg_val);
+	dmac->big_transfer.transfer_done = false;
 
 	switch (dmac->direction) {
 	case DMA_DEV_TO_MEM:
@@ -242,9 +525,9 @@ int32_t axi_dmac_transfer(struct axi_dmac *dmac,
 		axi_dmac_write(dmac, AXI_DMAC_REG_START_TRANSFER, 0x1);
 
 		while(!dmac->big_transfer.transfer_done) {
-			timeout++;
-			if (timeout == UINT32_MAX)
-				return FAILURE;
+			ret = axi_dmac_wait_event(dmac, &timeout);
+			if (ret < 0)
+				return ret;
 		}
 
 		dmac->big_transfer.address = 0;
@@ -265,23 +548,37 @@ int32_t axi_dmac_transfer(struct axi_dmac *dmac,
 		return SUCCESS;
 
 	/* Wait until the new transfer is queued. */
-	do {
+	while (true) {
 		axi_dmac_read(dmac, AXI_DMAC_REG_START_TRANSFER, &reg_val);
-	} while(reg_val == 1);
+		if (reg_val != 1)
+			break;
+		ret = axi_dmac_poll_delay(&timeout);
+		if (ret < 0)
+			return ret;
+	}
 
 	/* Wait until the current transfer is completed. */
-	do {
+	while (true) {
 		axi_dmac_read(dmac, AXI_DMAC_REG_IRQ_PENDING, &reg_val);
-		if (reg_val == (AXI_DMAC_IRQ_SOT | AXI_DMAC_IRQ_EOT))
+		if (reg_val == (AXI_DMAC_IRQ_SOT | AXI_DMAC_IRQ_EOT) ||
+		    dmac->big_transfer.transfer_done)
 			break;
-	} while(!dmac->big_transfer.transfer_done);
+		ret = axi_dmac_poll_delay(&timeout);
+		if (ret < 0)
+			return ret;
+	}
 	if (reg_val != (AXI_DMAC_IRQ_SOT | AXI_DMAC_IRQ_EOT))
 		axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_PENDING, reg_val);
 
 	/* Wait until the transfer with the ID transfer_id is completed. */
-	do {
+	while (true) {
 		axi_dmac_read(dmac, AXI_DMAC_REG_TRANSFER_DONE, &reg_val);
-	} while((reg_val & (1u << transfer_id)) != (1u << transfer_id));
+		if (reg_val & (1u << transfer_id))
+			break;
+		ret = axi_dmac_poll_delay(&timeout);
+		if (ret < 0)
+			return ret;
+	}
 
 	return SUCCESS;
 }
@@ -293,8 +590,11 @@ int32_t axi_dmac_init(struct axi_dmac **dmac_core,
 		      const struct axi_dmac_init *init)
 {
 	struct axi_dmac *dmac;
+	uint32_t addr_reg, reg_val;
+	uint32_t timeout_us = 0;
+	int32_t ret;
 
-	dmac = (struct axi_dmac *)malloc(sizeof(*dmac));
+	dmac = (struct axi_dmac *)calloc(1, sizeof(*dmac));
 	if (!dmac)
 		return FAILURE;
 
@@ -307,9 +607,28 @@ int32_t axi_dmac_init(struct axi_dmac **dmac_core,
 	dmac->big_transfer.size = 0;
 	dmac->big_transfer.size_done = 0;
 
+	/* A zero timeout only checks whether the platform delivers the
+	 * interrupt to the waiters */
+	if (init->use_irq) {
+		dmac->irq_mode = AXI_DMAC_IRQ_ISR;
+	} else {
+		ret = axi_io_wait_irq(dmac->base, &timeout_us);
+		if (ret == SUCCESS || ret == -ETIMEDOUT)
+			dmac->irq_mode = AXI_DMAC_IRQ_WAIT;
+		else
+			dmac->irq_mode = AXI_DMAC_IRQ_POLL;
+	}
+
 	axi_dmac_write(dmac, AXI_DMAC_REG_X_LENGTH, dmac->transfer_max_size);
 	axi_dmac_read(dmac, AXI_DMAC_REG_X_LENGTH, &dmac->transfer_max_size);
 
+	/* The address bits below the memory interface width read back as 0 */
+	addr_reg = dmac->direction == DMA_DEV_TO_MEM ?
+		   AXI_DMAC_REG_DEST_ADDRESS : AXI_DMAC_REG_SRC_ADDRESS;
+	axi_dmac_write(dmac, addr_reg, 0xffffffff);
+	axi_dmac_read(dmac, addr_reg, &reg_val);
+	dmac->width = reg_val ? ~reg_val + 1 : 1;
+
 	*dmac_core = dmac;
 
 	return SUCCESS;
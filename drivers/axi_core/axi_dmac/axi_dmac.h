@@ -50,6 +50,7 @@
 /******************************************************************************/
 #define AXI_DMAC_REG_IRQ_MASK		0x80
 #define AXI_DMAC_REG_IRQ_PENDING	0x84
+#define AXI_DMAC_REG_IRQ_SOURCE		0x88
 #define AXI_DMAC_IRQ_SOT			BIT(0)
 #define AXI_DMAC_IRQ_EOT			BIT(1)
 
@@ -68,6 +69,13 @@
 #define AXI_DMAC_REG_SRC_STRIDE		0x424
 #define AXI_DMAC_REG_TRANSFER_DONE	0x428
 
+/* Number of transfer IDs tracked by the core */
+#define AXI_DMAC_MAX_ISSUED		4
+/* Number of transfer segments axi_dmac_submit() can queue */
+#define AXI_DMAC_QUEUE_SIZE		16
+/* Default timeout of the blocking transfers */
+#define AXI_DMAC_TIMEOUT_US		10000000
+
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
@@ -81,6 +89,15 @@ enum dma_flags {
 	DMA_LAST = 2
 };
 
+enum axi_dmac_irq_mode {
+	/* No interrupt, the waiters poll the status registers */
+	AXI_DMAC_IRQ_POLL,
+	/* axi_dmac_default_isr() is run by the interrupt controller */
+	AXI_DMAC_IRQ_ISR,
+	/* The interrupt is handed to the waiters by axi_io_wait_irq() */
+	AXI_DMAC_IRQ_WAIT
+};
+
 struct axi_dma_transfer {
 	uint32_t size;
 	uint32_t address;
@@ -88,13 +105,32 @@ struct axi_dma_transfer {
 	volatile bool transfer_done;
 };
 
+struct axi_dmac_segment {
+	uint32_t address;
+	uint32_t size;
+	uint32_t id;
+	/* Only set on the last segment of a submitted transfer */
+	void (*callback)(void *ctx);
+	void *ctx;
+	bool last;
+};
+
 struct axi_dmac {
 	const char *name;
 	uint32_t base;
 	enum dma_direction direction;
 	uint32_t flags;
 	uint32_t transfer_max_size;
+	/* Width of the memory interface in bytes, the buffer addresses and
+	 * sizes are multiples of it */
+	uint32_t width;
+	enum axi_dmac_irq_mode irq_mode;
 	volatile struct axi_dma_transfer big_transfer;
+	/* Queue of axi_dmac_submit(), the first issued segments are in the core */
+	struct axi_dmac_segment queue[AXI_DMAC_QUEUE_SIZE];
+	uint8_t queue_first;
+	volatile uint8_t queue_issued;
+	volatile uint8_t queue_len;
 };
 
 struct axi_dmac_init {
@@ -102,6 +138,8 @@ struct axi_dmac_init {
 	uint32_t base;
 	enum dma_direction direction;
 	uint32_t flags;
+	/* axi_dmac_default_isr() is registered with the interrupt controller */
+	bool use_irq;
 };
 
 /******************************************************************************/
@@ -117,6 +155,10 @@ int32_t axi_dmac_transfer_nonblocking(struct axi_dmac *dmac,
 int32_t axi_dmac_is_transfer_ready(struct axi_dmac *dmac, bool *rdy);
 int32_t axi_dmac_transfer(struct axi_dmac *dmac,
 			  uint32_t address, uint32_t size);
+int32_t axi_dmac_submit(struct axi_dmac *dmac, uint32_t address, uint32_t size,
+			void (*callback)(void *ctx), void *ctx);
+int32_t axi_dmac_wait(struct axi_dmac *dmac, uint32_t timeout_us);
+int32_t axi_dmac_wait_event(struct axi_dmac *dmac, uint32_t *timeout_us);
 int32_t axi_dmac_init(struct axi_dmac **adc_core,
 		      const struct axi_dmac_init *init);
 int32_t axi_dmac_remove(struct axi_dmac *dmac);
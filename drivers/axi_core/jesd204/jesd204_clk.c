@@ -107,18 +107,51 @@ int32_t jesd204_clk_disable(struct jesd204_clk *clk)
 	return SUCCESS;
 }
 
+/**
+ * Get the current frequency of the clock.
+ * @param clk - The clock structure.
+ * @param chan - The clock channel.
+ * @param rate - The lane rate, in Hz.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t jesd204_clk_recalc_rate(struct jesd204_clk *clk, uint32_t chan,
+				uint64_t *rate)
+{
+	if (!clk->xcvr)
+		return FAILURE;
+
+	*rate = (uint64_t)clk->xcvr->lane_rate_khz * 1000;
+
+	return SUCCESS;
+}
+
 /**
  * Change the frequency of the clock.
+ *
+ * The transceiver PLL is computed from the current rate of the reference
+ * clock, when there is one.
  * @param clk - The clock structure.
  * @param chan - The clock channel.
- * @param rate - The desired frequency.
+ * @param rate - The desired lane rate, in Hz.
  * @return SUCCESS in case of success, negative error code otherwise.
  */
 int32_t jesd204_clk_set_rate(struct jesd204_clk *clk, uint32_t chan,
-			     uint32_t rate)
+			     uint64_t rate)
 {
-	if (clk->xcvr)
-		return adxcvr_clk_set_rate(clk->xcvr, rate, clk->xcvr->ref_rate_khz);
+	uint64_t ref_rate;
+	int32_t ret;
 
-	return SUCCESS;
+	if (!clk->xcvr)
+		return SUCCESS;
+
+	if (clk->ref_clk) {
+		ret = clk_recalc_rate(clk->ref_clk, &ref_rate);
+		if (ret)
+			return ret;
+		clk->xcvr->ref_rate_khz = ref_rate / 1000;
+	}
+
+	/* The transceiver works in kHz */
+	return adxcvr_clk_set_rate(clk->xcvr, rate / 1000,
+				   clk->xcvr->ref_rate_khz);
 }
@@ -46,6 +46,7 @@
 #include "axi_adxcvr.h"
 #include "axi_jesd204_rx.h"
 #include "axi_jesd204_tx.h"
+#include "clk.h"
 
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
@@ -54,6 +55,8 @@ struct jesd204_clk {
 	struct adxcvr *xcvr;
 	struct axi_jesd204_rx *jesd_rx;
 	struct axi_jesd204_tx *jesd_tx;
+	/* Reference clock of the transceiver, NULL to use xcvr->ref_rate_khz */
+	struct clk *ref_clk;
 };
 
 /******************************************************************************/
@@ -63,7 +66,10 @@ struct jesd204_clk {
 int32_t jesd204_clk_enable(struct jesd204_clk *clk);
 /* Stop the clock. */
 int32_t jesd204_clk_disable(struct jesd204_clk *clk);
+/* Get the current frequency of the clock. */
+int32_t jesd204_clk_recalc_rate(struct jesd204_clk *clk, uint32_t chan,
+				uint64_t *rate);
 /* Change the frequency of the clock. */
 int32_t jesd204_clk_set_rate(struct jesd204_clk *clk, uint32_t chan,
-			     uint32_t rate);
+			     uint64_t rate);
 #endif
@@ -54,6 +54,7 @@ significant delays */
 
 #include "axi_dmac.h"
 #include "axi_io.h"
+#include "delay.h"
 #include "error.h"
 #include "spi_engine.h"
 
@@ -226,162 +227,28 @@ static int32_t spi_get_sleep_div(struct spi_desc *desc,
 }
 
 /**
- * @brief Create a new commands queue used in a spi transfer
- *
- * @param fifo Command buffer, usualy used in fifo mode
- * @param cmd Command with wich the buffer will be initiated
- * @return int32_t Failure if the memory allocation failed
- */
-static int32_t spi_engine_queue_new_cmd(struct spi_engine_cmd_queue **fifo,
-					uint32_t cmd)
-{
-	struct spi_engine_cmd_queue *local_fifo;
-
-	local_fifo = (spi_engine_cmd_queue*)malloc(sizeof(*local_fifo));
-
-	if(!local_fifo)
-		return FAILURE;
-
-	local_fifo->cmd = cmd;
-	local_fifo->next = NULL;
-	*fifo = local_fifo;
-
-	return SUCCESS;
-}
-
-/**
- * @brief Add a command at the end of an existing queue
- *
- * @param fifo Command buffer, usualy used in fifo mode
- * @param cmd Command to be added
- */
-static void spi_engine_queue_add_cmd(struct spi_engine_cmd_queue **fifo,
-				     uint32_t cmd)
-{
-	struct spi_engine_cmd_queue *to_add = NULL;
-	struct spi_engine_cmd_queue *local_fifo;
-
-	local_fifo = *fifo;
-	while (local_fifo->next != NULL) {
-		// Get the last element
-		local_fifo = local_fifo->next;
-	}
-
-	// Create a new element
-	spi_engine_queue_new_cmd(&to_add, cmd);
-	// Add as the next element
-	local_fifo->next = to_add;
-}
-
-/**
- * @brief Add a command at the beginning of an existing queue
- *
- * @param fifo Command buffer, usualy used in fifo mode
- * @param cmd Command to be added
- */
-static void spi_engine_queue_append_cmd(struct spi_engine_cmd_queue **fifo,
-					uint32_t cmd)
-{
-	struct spi_engine_cmd_queue *to_add = NULL;
-
-	// Create a new element
-	spi_engine_queue_new_cmd(&to_add, cmd);
-	// Interchange the addresses
-	to_add->next = *fifo;
-	*fifo = to_add;
-}
-
-
-/**
- * @brief Get the command from the beginning of the queue
- *
- * @param fifo Command buffer, usualy used in fifo mode
- * @param cmd Value of the command that was extracted
- * @return int32_t Return FAILURE if the queue is empty
- */
-static int32_t spi_engine_queue_get_cmd(struct spi_engine_cmd_queue **fifo,
-					uint32_t *cmd)
-{
-	struct spi_engine_cmd_queue *local_fifo;
-
-	if (!*fifo)
-		return FAILURE;
-
-	local_fifo = *fifo;
-	*cmd = local_fifo->cmd;
-	if ((*fifo)->next) {
-		*fifo = local_fifo->next;
-		free(local_fifo);
-	} else {
-		free(*fifo);
-		*fifo = NULL;
-	}
-
-	return SUCCESS;
-}
-
-/**
- * @brief Free the memory allocated by a queue
- *
- * @param fifo The queue that needs it's memory freed
- * @return int32_t This function allways return SUCCESS
- */
-static int32_t spi_engine_queue_free(struct spi_engine_cmd_queue **fifo)
-{
-	if(*fifo && (*fifo)->next)
-		spi_engine_queue_free(&(*fifo)->next);
-	if((*fifo) != NULL) {
-		free(*fifo);
-		*fifo = NULL;
-	}
-
-	return SUCCESS;
-}
-
-/**
- * @brief Write the SPI engine's command fifo
- *
- * @param desc Decriptor containing SPI Engine's parameters
- * @param cmd The command that will be written
- * @return int32_t Returns FAILURE if the the axi transfer failed
- */
-static int32_t spi_engine_write_cmd_reg(struct spi_engine_desc *desc,
-					uint32_t cmd)
-{
-	int32_t ret;
-
-	/* Check if offload is enabled */
-	if(desc->offload_config & (OFFLOAD_TX_EN | OFFLOAD_RX_EN)) {
-		ret = spi_engine_write(desc,
-				       SPI_ENGINE_REG_OFFLOAD_CMD_MEM(0),
-				       cmd);
-
-	} else {
-		ret = spi_engine_write(desc,
-				       SPI_ENGINE_REG_CMD_FIFO,
-				       cmd);
-	}
-
-	return ret;
-}
-
-/**
- * @brief Write a transfer command to the SPI engine's command fifo
+ * @brief Translate a transfer command into an engine instruction
  *
  * @param desc Decriptor containing SPI Engine's parameters
  * @param read_write Read/Write operation flag
  * @param bytes_number Number of bytes to transfer
- * @return int32_t This function allways returns SUCCESS
+ * @param prog Program whose word counters are updated
+ * @return uint32_t The engine instruction
  */
-static int32_t spi_engine_transfer(struct spi_engine_desc *desc,
-				   uint8_t read_write,
-				   uint8_t bytes_number)
+static uint32_t spi_engine_compile_transfer(struct spi_engine_desc *desc,
+		uint8_t read_write,
+		uint8_t bytes_number,
+		struct spi_engine_program *prog)
 {
 	uint8_t words_number;
 
 	words_number = spi_get_words_number(desc, bytes_number);
 
-	desc->offload_tx_len += words_number;
+	prog->no_words += words_number;
+	if (read_write & SPI_ENGINE_INSTRUCTION_TRANSFER_W)
+		prog->no_sdo_words += words_number;
+	if (read_write & SPI_ENGINE_INSTRUCTION_TRANSFER_R)
+		prog->no_sdi_words += words_number;
 
 	/*
 	 * Engine Wiki:
@@ -391,24 +258,21 @@ static int32_t spi_engine_transfer(struct spi_engine_desc *desc,
 	 * The words number is zero based
 	 */
 
-	spi_engine_write_cmd_reg(desc,
-				 SPI_ENGINE_CMD_TRANSFER(read_write,
-						 words_number  - 1));
-
-	return SUCCESS;
+	return SPI_ENGINE_CMD_TRANSFER(read_write, words_number - 1);
 }
 
 /**
- * @brief Change the state of the chip select port
+ * @brief Translate a chip select command into an engine instruction
  *
  * @param desc Decriptor containing SPI interface parameters
  * @param assert Chip select state.
  * 		 The supported values are :
  * 			-true (HIGH)
  * 			-false (LOW)
+ * @return uint32_t The engine instruction
  */
-static void spi_engine_set_cs(struct spi_desc *desc,
-			      bool assert)
+static uint32_t spi_engine_compile_cs(struct spi_desc *desc,
+				      bool assert)
 {
 	uint8_t			mask;
 	struct spi_engine_desc	*eng_desc;
@@ -420,47 +284,45 @@ static void spi_engine_set_cs(struct spi_desc *desc,
 	if (!assert)
 		mask ^= BIT(desc->chip_select);
 
-	spi_engine_write_cmd_reg(eng_desc,
-				 SPI_ENGINE_CMD_ASSERT(eng_desc->cs_delay,
-						 mask));
+	return SPI_ENGINE_CMD_ASSERT(eng_desc->cs_delay, mask);
 }
 
 /**
- * @brief Add a delay bewtheen the engine commands
+ * @brief Translate a delay between the engine commands into an instruction
  *
  * @param desc Decriptor containing SPI interface parameters
  * @param sleep_time_ns Number of nanoseconds to sleep between commands
+ * @return uint32_t The engine instruction
  */
-static void spi_gen_sleep_ns(struct spi_desc *desc,
-			     uint32_t sleep_time_ns)
+static uint32_t spi_engine_compile_sleep(struct spi_desc *desc,
+		uint32_t sleep_time_ns)
 {
-	uint32_t 		sleep_div;
-	struct spi_engine_desc	*eng_desc;
-
-	eng_desc = desc->extra;
+	uint32_t sleep_div;
 
 	spi_get_sleep_div(desc, sleep_time_ns, &sleep_div);
 
-	spi_engine_write_cmd_reg(eng_desc, SPI_ENGINE_CMD_SLEEP(sleep_div));
+	return SPI_ENGINE_CMD_SLEEP(sleep_div);
 }
 
 /**
- * @brief Spi engine command interpreter
+ * @brief Spi engine command compiler
+ *
+ * Translate one of the commands defined in spi_engine.h into the instruction
+ * the engine executes and append it to the program.
  *
  * @param desc Decriptor containing SPI interface parameters
- * @param cmd Command to send to the engine
- * @return int32_t - SUCCESS if the command is transfered
- *		   - FAILURE if the command format is invalid
+ * @param cmd Command to be compiled
+ * @param prog Program the instruction is appended to
+ * @return int32_t - SUCCESS if the command is compiled
+ *		   - -EINVAL if the command format is invalid
  */
-static int32_t spi_engine_write_cmd(struct spi_desc *desc,
-				    uint32_t cmd)
+static int32_t spi_engine_compile_cmd(struct spi_desc *desc,
+				      uint32_t cmd,
+				      struct spi_engine_program *prog)
 {
 	uint8_t				engine_command;
 	uint8_t				parameter;
 	uint8_t				modifier;
-	struct spi_engine_desc		*desc_extra;
-
-	desc_extra = desc->extra;
 
 	engine_command = (cmd >> 12) & 0x0F;
 	modifier = (cmd >> 8) & 0x0F;
@@ -468,16 +330,20 @@ static int32_t spi_engine_write_cmd(struct spi_desc *desc,
 
 	switch(engine_command) {
 	case SPI_ENGINE_INST_TRANSFER:
-		spi_engine_transfer(desc_extra, modifier, parameter);
+		prog->cmds[prog->no_cmds++] =
+			spi_engine_compile_transfer(desc->extra, modifier,
+						    parameter, prog);
 		break;
 
 	case SPI_ENGINE_INST_ASSERT:
 		if(parameter == 0xFF) {
 			/* Set the CS HIGH */
-			spi_engine_set_cs(desc, true);
+			prog->cmds[prog->no_cmds++] =
+				spi_engine_compile_cs(desc, true);
 		} else if(parameter == 0x00) {
 			/* Set the CS LOW */
-			spi_engine_set_cs(desc, false);
+			prog->cmds[prog->no_cmds++] =
+				spi_engine_compile_cs(desc, false);
 		}
 		break;
 
@@ -486,19 +352,20 @@ static int32_t spi_engine_write_cmd(struct spi_desc *desc,
 	case SPI_ENGINE_INST_SYNC_SLEEP:
 		/* SYNC instruction */
 		if(modifier == 0x00) {
-			spi_engine_write_cmd_reg(desc_extra, cmd);
+			prog->cmds[prog->no_cmds++] = cmd;
 		} else if(modifier == 0x01) {
-			spi_gen_sleep_ns(desc, parameter);
+			prog->cmds[prog->no_cmds++] =
+				spi_engine_compile_sleep(desc, parameter);
 		}
 		break;
 	case SPI_ENGINE_INST_CONFIG:
-		spi_engine_write_cmd_reg(desc_extra, cmd);
+		prog->cmds[prog->no_cmds++] = cmd;
 
 		break;
 
 	default:
 
-		return FAILURE;
+		return -EINVAL;
 		break;
 	}
 
@@ -506,112 +373,143 @@ static int32_t spi_engine_write_cmd(struct spi_desc *desc,
 }
 
 /**
- * @brief Prepare the command queue before sending it to the engine
+ * @brief Compile a list of commands into a program
+ *
+ * The program is prefixed with the configuration of the prescaler, of the
+ * data width and of the spi mode. The final SYNC instruction is not part of the
+ * program, it is added when the program is executed.
  *
  * @param desc Decriptor containing SPI interface parameters
- * @param msg Structure used to store the transfer messages
- * @return int32_t This function allways returns SUCCESS
+ * @param commands Commands to be compiled
+ * @param no_commands Number of commands
+ * @param prog Program whose cmds buffer fits no_commands +
+ * 	SPI_ENGINE_PROGRAM_HEADER_LEN instructions
+ * @return int32_t - SUCCESS if the program was compiled
+ *		   - -EINVAL if one of the commands is invalid
  */
-static int32_t spi_engine_compile_message(struct spi_desc *desc,
-		struct spi_engine_msg *msg)
+static int32_t spi_engine_compile(struct spi_desc *desc,
+				  const uint32_t *commands,
+				  uint32_t no_commands,
+				  struct spi_engine_program *prog)
 {
+	uint32_t		i;
+	int32_t			ret;
 	struct spi_engine_desc	*desc_extra;
 
 	desc_extra = desc->extra;
 
-	/* Configure the prescaler */
-	spi_engine_queue_append_cmd(&msg->cmds,
-				    SPI_ENGINE_CMD_CONFIG(
-					    SPI_ENGINE_CMD_REG_CLK_DIV,
-					    desc_extra->clk_div));
+	prog->no_cmds = 0;
+	prog->no_words = 0;
+	prog->no_sdo_words = 0;
+	prog->no_sdi_words = 0;
 
-	/* Set the data transfer length */
-	spi_engine_queue_append_cmd(&msg->cmds,
-				    SPI_ENGINE_CMD_CONFIG(
-					    SPI_ENGINE_CMD_DATA_TRANSFER_LEN,
-					    desc_extra->data_width));
 	/*
 	 * Configure the spi mode :
 	 *	- 3 wire
 	 *	- CPOL
 	 *	- CPHA
 	 */
-	spi_engine_queue_append_cmd(&msg->cmds,
-				    SPI_ENGINE_CMD_CONFIG(
-					    SPI_ENGINE_CMD_REG_CONFIG,
-					    desc->mode));
+	prog->cmds[prog->no_cmds++] =
+		SPI_ENGINE_CMD_CONFIG(SPI_ENGINE_CMD_REG_CONFIG, desc->mode);
 
-	/* Add a sync command to signal that the transfer has finished */
-	spi_engine_queue_add_cmd(&msg->cmds, SPI_ENGINE_CMD_SYNC(_sync_id));
+	/* Set the data transfer length */
+	prog->cmds[prog->no_cmds++] =
+		SPI_ENGINE_CMD_CONFIG(SPI_ENGINE_CMD_DATA_TRANSFER_LEN,
+				      desc_extra->data_width);
+
+	/* Configure the prescaler */
+	prog->cmds[prog->no_cmds++] =
+		SPI_ENGINE_CMD_CONFIG(SPI_ENGINE_CMD_REG_CLK_DIV,
+				      desc_extra->clk_div);
+
+	for (i = 0; i < no_commands; i++) {
+		ret = spi_engine_compile_cmd(desc, commands[i], prog);
+		if (ret != SUCCESS)
+			return ret;
+	}
 
 	return SUCCESS;
 }
 
 /**
- * @brief Initiate a spi transfer
+ * @brief Load a program into the command fifo or into the offload memory
+ *
+ * @param desc Decriptor containing SPI Engine's parameters
+ * @param prog The compiled program
+ * @param reg_addr SPI_ENGINE_REG_CMD_FIFO or SPI_ENGINE_REG_OFFLOAD_CMD_MEM(0)
+ */
+static void spi_engine_load_program(struct spi_engine_desc *desc,
+				    const struct spi_engine_program *prog,
+				    uint32_t reg_addr)
+{
+	uint32_t i;
+
+	for (i = 0; i < prog->no_cmds; i++)
+		spi_engine_write(desc, reg_addr, prog->cmds[i]);
+
+	/* Add a sync command to signal that the transfer has finished */
+	spi_engine_write(desc, reg_addr, SPI_ENGINE_CMD_SYNC(_sync_id));
+}
+
+/**
+ * @brief Execute a program using the command fifo
  *
  * @param desc Decriptor containing SPI interface parameters
- * @param msg Structure used to store the transfer messages
- * @return int32_t - SUCCESS if the transfer finished
- *		   - FAILURE if the memory allocation failed
+ * @param prog The compiled program
+ * @param tx Words written on the SDO line, prog->no_sdo_words long
+ * @param rx Words read from the SDI line, prog->no_sdi_words long
+ * @return int32_t This function allways returns SUCCESS
  */
-static int32_t spi_engine_transfer_message(struct spi_desc *desc,
-		struct spi_engine_msg *msg)
+static int32_t spi_engine_exec_program(struct spi_desc *desc,
+				       const struct spi_engine_program *prog,
+				       const uint32_t *tx,
+				       uint32_t *rx)
 {
 	uint32_t		i;
-	uint32_t		data;
 	uint32_t		sync_id;
-	bool 			offload_en;
 	struct spi_engine_desc	*desc_extra;
 
 	desc_extra = desc->extra;
 
-	spi_engine_compile_message(desc, msg);
-
-	offload_en = (desc_extra->offload_config & OFFLOAD_TX_EN) |
-		     (desc_extra->offload_config & OFFLOAD_RX_EN);
-
-	/* Write the command fifo buffer */
-	while(msg->cmds != NULL) {
-		spi_engine_queue_get_cmd(&msg->cmds, &data);
-		spi_engine_write_cmd(desc, data);
-	}
+	spi_engine_load_program(desc_extra, prog, SPI_ENGINE_REG_CMD_FIFO);
 
 	/* Write a number of tx_length WORDS on the SDO line */
-
-	if(offload_en) {
-		for(i = 0; i < desc_extra->offload_tx_len; i++)
-			spi_engine_write(desc_extra,
-					 SPI_ENGINE_REG_OFFLOAD_SDO_MEM(0),
-					 msg->tx_buf[i]);
-
-	} else {
-		for(i = 0; i < msg->length; i++)
-			spi_engine_write(desc_extra,
-					 SPI_ENGINE_REG_SDO_DATA_FIFO,
-					 msg->tx_buf[i]);
-		do {
-			spi_engine_read(desc_extra,
-					SPI_ENGINE_REG_SYNC_ID,
-					&sync_id);
-		}
-		/* Wait for the end sync signal */
-		while(sync_id != _sync_id);
-		_sync_id++;
-
-		/* Read a number of rx_length WORDS from the SDI line and store
-		them */
-		for(i = 0; i < msg->length; i++) {
-			spi_engine_read(desc_extra,
-					SPI_ENGINE_REG_SDI_DATA_FIFO,
-					&data);
-			msg->rx_buf[i] = data;
-		}
+	for(i = 0; i < prog->no_sdo_words; i++)
+		spi_engine_write(desc_extra, SPI_ENGINE_REG_SDO_DATA_FIFO,
+				 tx[i]);
+
+	do {
+		spi_engine_read(desc_extra,
+				SPI_ENGINE_REG_SYNC_ID,
+				&sync_id);
 	}
+	/* Wait for the end sync signal */
+	while(sync_id != _sync_id);
+	_sync_id++;
+
+	/* Read a number of rx_length WORDS from the SDI line and store them */
+	for(i = 0; i < prog->no_sdi_words; i++)
+		spi_engine_read(desc_extra, SPI_ENGINE_REG_SDI_DATA_FIFO,
+				&rx[i]);
 
 	return SUCCESS;
 }
 
+/**
+ * @brief Disable the offload module before using the command fifo
+ *
+ * @param desc Decriptor containing SPI Engine's parameters
+ */
+static void spi_engine_offload_disable(struct spi_engine_desc *desc)
+{
+	/* If we want to access SPI interface and SPI engine offload module was
+	 * activated, we need to disable it
+	 * This is set in spi_engine_offload_init() */
+	desc->offload_config = OFFLOAD_DISABLED;
+	/* This is set in spi_engine_offload_transfer() */
+	spi_engine_write(desc, SPI_ENGINE_REG_OFFLOAD_CTRL(0), 0);
+}
+
 /**
  * @brief Initialize the spi engine
  *
@@ -638,10 +536,15 @@ int32_t spi_engine_init(struct spi_desc **desc,
 		return FAILURE;
 	}
 
-	eng_desc = (struct spi_engine_desc*)malloc(sizeof(*eng_desc));
+	eng_desc = (struct spi_engine_desc*)calloc(1, sizeof(*eng_desc));
 
 	if (!eng_desc)
-		return FAILURE;
+		goto error_desc;
+
+	eng_desc->xfer_buf = (uint32_t*)calloc(SPI_ENGINE_MAX_XFER_WORDS,
+					       sizeof(*eng_desc->xfer_buf));
+	if (!eng_desc->xfer_buf)
+		goto error_eng_desc;
 
 	spi_engine_init = param->extra;
 
@@ -678,6 +581,14 @@ int32_t spi_engine_init(struct spi_desc **desc,
 	       (spi_engine_version & 0xFF));
 
 	return SUCCESS;
+
+error_eng_desc:
+	free(eng_desc);
+error_desc:
+	free(*desc);
+	*desc = NULL;
+
+	return FAILURE;
 }
 
 /**
@@ -687,73 +598,165 @@ int32_t spi_engine_init(struct spi_desc **desc,
  * @param data Pointer to data buffer
  * @param bytes_number Number of bytes to transfer
  * @return int32_t - SUCCESS if the transfer finished
- *		   - FAILURE if the memory allocation or transfer failed
+ *		   - -EINVAL if bytes_number doesn't fit in a single transfer
  */
 int32_t spi_engine_write_and_read(struct spi_desc *desc,
 				  uint8_t *data,
 				  uint16_t bytes_number)
 {
-	uint8_t 		i;
-	uint8_t 		word_len;
-	uint8_t 		words_number;
-	int32_t 		ret;
-	struct spi_engine_msg	msg;
-	struct spi_engine_desc	*desc_extra;
+	uint16_t 			i;
+	uint8_t 			word_len;
+	int32_t 			ret;
+	uint32_t			cmds[4 + SPI_ENGINE_PROGRAM_HEADER_LEN];
+	struct spi_engine_program	prog;
+	struct spi_engine_desc		*desc_extra;
+	/* Make sure the CS is HIGH before starting a transaction */
+	const uint32_t			msg_cmds[] = {
+		CS_HIGH,
+		CS_LOW,
+		WRITE_READ(bytes_number),
+		CS_HIGH
+	};
 
 	desc_extra = desc->extra;
 
-	/* If we want to access SPI interface and SPI engine offload module was
-	 * activated, we need to disable it
-	 * This is set in spi_engine_offload_init() */
-	desc_extra->offload_config = OFFLOAD_DISABLED;
-	/* This is set in spi_engine_offload_transfer() */
-	spi_engine_write(desc_extra, SPI_ENGINE_REG_OFFLOAD_CTRL(0), 0);
-
-	words_number = spi_get_words_number(desc_extra, bytes_number);
+	/* The transfer length of WRITE_READ() is 8 bits wide */
+	if (bytes_number > 0xFF)
+		return -EINVAL;
 
-	msg.cmds = (spi_engine_cmd_queue*)malloc(sizeof(*msg.cmds));
-	if (!msg.cmds)
-		return FAILURE;
+	spi_engine_offload_disable(desc_extra);
 
-	msg.tx_buf =(uint32_t*)calloc(words_number, sizeof(msg.tx_buf[0]));
-	msg.rx_buf =(uint32_t*)calloc(words_number, sizeof(msg.rx_buf[0]));
-	msg.length = words_number;
+	prog.cmds = cmds;
+	ret = spi_engine_compile(desc, msg_cmds, ARRAY_SIZE(msg_cmds), &prog);
+	if (ret != SUCCESS)
+		return ret;
 
 	/* Get the length of transfered word */
 	word_len = spi_get_word_lenght(desc_extra);
 
-	/* Make sure the CS is HIGH before starting a transaction */
-	msg.cmds->next = NULL;
-	msg.cmds->cmd = CS_HIGH;
-	spi_engine_queue_add_cmd(&msg.cmds, CS_LOW);
-	spi_engine_queue_add_cmd(&msg.cmds, WRITE_READ(bytes_number));
-	spi_engine_queue_add_cmd(&msg.cmds, CS_HIGH);
-
 	/* Pack the bytes into engine WORDS */
+	for (i = 0; i < prog.no_sdo_words; i++)
+		desc_extra->xfer_buf[i] = 0;
 	for (i = 0; i < bytes_number; i++)
-		msg.tx_buf[i / word_len] |= data[i] << (desc_extra->data_width-
-							(i % word_len + 1) * 8);
+		desc_extra->xfer_buf[i / word_len] |=
+			data[i] << (desc_extra->data_width -
+				    (i % word_len + 1) * 8);
 
-	ret = spi_engine_transfer_message(desc, &msg);
+	ret = spi_engine_exec_program(desc, &prog, desc_extra->xfer_buf,
+				      desc_extra->xfer_buf);
 
 	for (i = 0; i < bytes_number; i++)
-		data[i] = msg.rx_buf[(i) / word_len] >>
+		data[i] = desc_extra->xfer_buf[(i) / word_len] >>
 			  (desc_extra->data_width -
 			   ((i) % word_len + 1) * 8);
 
-	spi_engine_queue_free(&msg.cmds);
-	free(msg.tx_buf);
-	free(msg.rx_buf);
+	return ret;
+}
+
+/**
+ * @brief Compile a list of commands into a reusable program
+ *
+ * The program depends on the speed, the transfer width and the mode of the
+ * device, so it has to be compiled again after any of them is changed.
+ *
+ * @param prog Pointer where the compiled program will be stored
+ * @param desc Decriptor containing SPI interface parameters
+ * @param commands Commands to be compiled (CS_LOW, WRITE(), SLEEP() etc)
+ * @param no_commands Number of commands
+ * @return int32_t - SUCCESS if the program was compiled
+ *		   - -ENOMEM if the memory allocation failed
+ *		   - -EINVAL if one of the commands is invalid
+ */
+int32_t spi_engine_program_init(struct spi_engine_program **prog,
+				struct spi_desc *desc,
+				const uint32_t *commands,
+				uint32_t no_commands)
+{
+	struct spi_engine_program	*p;
+	int32_t				ret;
+
+	if (!prog || !desc || !commands)
+		return -EINVAL;
+
+	p = (struct spi_engine_program *)calloc(1, sizeof(*p));
+	if (!p)
+		return -ENOMEM;
+
+	p->cmds = (uint32_t *)calloc(no_commands + SPI_ENGINE_PROGRAM_HEADER_LEN,
+				     sizeof(*p->cmds));
+	if (!p->cmds) {
+		ret = -ENOMEM;
+		goto error_prog;
+	}
+
+	ret = spi_engine_compile(desc, commands, no_commands, p);
+	if (ret != SUCCESS)
+		goto error_cmds;
+
+	*prog = p;
+
+	return SUCCESS;
+
+error_cmds:
+	free(p->cmds);
+error_prog:
+	free(p);
 
 	return ret;
 }
 
+/**
+ * @brief Free the resources allocated by spi_engine_program_init().
+ *
+ * @param prog The program
+ * @return int32_t This function allways returns SUCCESS
+ */
+int32_t spi_engine_program_remove(struct spi_engine_program *prog)
+{
+	if (!prog)
+		return SUCCESS;
+
+	free(prog->cmds);
+	free(prog);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Execute a compiled program using the command fifo
+ *
+ * @param desc Decriptor containing SPI interface parameters
+ * @param prog The compiled program
+ * @param tx Words written on the SDO line, prog->no_sdo_words long
+ * @param rx Words read from the SDI line, prog->no_sdi_words long
+ * @return int32_t - SUCCESS if the transfer finished
+ *		   - -EINVAL if a needed buffer is missing
+ */
+int32_t spi_engine_program_transfer(struct spi_desc *desc,
+				    const struct spi_engine_program *prog,
+				    const uint32_t *tx,
+				    uint32_t *rx)
+{
+	if (!desc || !prog)
+		return -EINVAL;
+	if ((prog->no_sdo_words && !tx) || (prog->no_sdi_words && !rx))
+		return -EINVAL;
+
+	spi_engine_offload_disable(desc->extra);
+
+	return spi_engine_exec_program(desc, prog, tx, rx);
+}
+
 /**
  * @brief Initialize the SPI engine's offload module
  *
+ * The DMACs are allocated at the first call, following calls only update
+ * their flags.
+ *
  * @param desc Decriptor containing SPI interface parameters
  * @param param Structure containing the offload init parameters
- * @return int32_t This function allways returns SUCCESS
+ * @return int32_t - SUCCESS if the offload module was initialized
+ *		   - FAILURE if a DMAC could not be initialized
  */
 int32_t spi_engine_offload_init(struct spi_desc *desc,
 				const struct spi_engine_offload_init_param *param)
@@ -772,43 +775,102 @@ int32_t spi_engine_offload_init(struct spi_desc *desc,
 		dma_flags = *(param->dma_flags);
 
 	if(param->offload_config & OFFLOAD_TX_EN) {
-		dmac_init.name = "DAC DMAC";
-		dmac_init.base = param->tx_dma_baseaddr;
-		dmac_init.direction = DMA_MEM_TO_DEV;
-		dmac_init.flags = dma_flags;
-		axi_dmac_init(&eng_desc->offload_tx_dma, &dmac_init);
-		if(!eng_desc->offload_tx_dma)
-			return FAILURE;
+		if (eng_desc->offload_tx_dma &&
+		    eng_desc->offload_tx_dma->base != param->tx_dma_baseaddr) {
+			axi_dmac_remove(eng_desc->offload_tx_dma);
+			eng_desc->offload_tx_dma = NULL;
+		}
+		if (!eng_desc->offload_tx_dma) {
+			dmac_init.name = "DAC DMAC";
+			dmac_init.base = param->tx_dma_baseaddr;
+			dmac_init.direction = DMA_MEM_TO_DEV;
+			dmac_init.flags = dma_flags;
+			axi_dmac_init(&eng_desc->offload_tx_dma, &dmac_init);
+			if(!eng_desc->offload_tx_dma)
+				return FAILURE;
+		}
+		eng_desc->offload_tx_dma->flags = dma_flags;
 	}
 	if(param->offload_config & OFFLOAD_RX_EN) {
-		dmac_init.name = "ADC DMAC";
-		dmac_init.base = param->rx_dma_baseaddr;
-		dmac_init.direction = DMA_DEV_TO_MEM;
-		dmac_init.flags = dma_flags;
-		axi_dmac_init(&eng_desc->offload_rx_dma, &dmac_init);
-		if(!eng_desc->offload_rx_dma)
-			return FAILURE;
+		if (eng_desc->offload_rx_dma &&
+		    eng_desc->offload_rx_dma->base != param->rx_dma_baseaddr) {
+			axi_dmac_remove(eng_desc->offload_rx_dma);
+			eng_desc->offload_rx_dma = NULL;
+		}
+		if (!eng_desc->offload_rx_dma) {
+			dmac_init.name = "ADC DMAC";
+			dmac_init.base = param->rx_dma_baseaddr;
+			dmac_init.direction = DMA_DEV_TO_MEM;
+			dmac_init.flags = dma_flags;
+			axi_dmac_init(&eng_desc->offload_rx_dma, &dmac_init);
+			if(!eng_desc->offload_rx_dma)
+				return FAILURE;
+		}
+		eng_desc->offload_rx_dma->flags = dma_flags;
 	}
 
 	return SUCCESS;
 }
 
 /**
- * @brief Initiate a SPI transfer in offload mode
+ * @brief Wait until the offload DMA transfer is completed
+ *
+ * A cyclic transfer never ends, in that case wait for the end of its first
+ * period instead.
+ *
+ * @param dmac The DMAC used by the offload module
+ * @return int32_t - SUCCESS if the transfer is completed
+ *		   - -ETIMEDOUT if the transfer did not complete in time
+ */
+static int32_t spi_engine_offload_wait(struct axi_dmac *dmac)
+{
+	uint32_t timeout = AXI_DMAC_TIMEOUT_US;
+	uint32_t reg_val;
+
+	/* axi_dmac_transfer() only returns once a non cyclic transfer is done */
+	if (!(dmac->flags & DMA_CYCLIC))
+		return SUCCESS;
+
+	/* The end of transfer is either pending or was handled by the ISR */
+	while (!dmac->big_transfer.transfer_done) {
+		axi_dmac_read(dmac, AXI_DMAC_REG_IRQ_PENDING, &reg_val);
+		if (reg_val & AXI_DMAC_IRQ_EOT)
+			return SUCCESS;
+		if (!timeout--)
+			return -ETIMEDOUT;
+		udelay(1);
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Execute a compiled program in offload mode
+ *
+ * The program is loaded in the offload memory and executed at every trigger
+ * until the DMA transfers no_samples times the program's words.
  *
  * @param desc Decriptor containing SPI interface parameters
- * @param msg Offload message that get's to be transferred
- * @param no_samples Number of time the messages will be transferred
- * @return int32_t This function allways returns SUCCESS
+ * @param prog The compiled program
+ * @param commands_data Words written on the SDO line, prog->no_sdo_words long
+ * @param tx_addr The address of the data that will be transmitted
+ * @param rx_addr The address where the received data will be stored
+ * @param no_samples Number of time the program will be executed
+ * @return int32_t - SUCCESS if the transfer finished
+ *		   - FAILURE if offload is disabled
+ *		   - negative error code if a DMA transfer failed
  */
-int32_t spi_engine_offload_transfer(struct spi_desc *desc,
-				    struct spi_engine_offload_message msg,
-				    uint32_t no_samples)
+int32_t spi_engine_offload_program_transfer(struct spi_desc *desc,
+		const struct spi_engine_program *prog,
+		const uint32_t *commands_data,
+		uint32_t tx_addr,
+		uint32_t rx_addr,
+		uint32_t no_samples)
 {
-	struct spi_engine_msg	transfer;
 	struct spi_engine_desc	*eng_desc;
 	uint32_t 		i;
-	uint8_t 		word_length;
+	uint32_t		size;
+	int32_t			ret;
 
 	eng_desc = desc->extra;
 
@@ -817,55 +879,82 @@ int32_t spi_engine_offload_transfer(struct spi_desc *desc,
 	     (eng_desc->offload_config & OFFLOAD_RX_EN)))
 		return FAILURE;
 
+	if (prog->no_sdo_words && !commands_data)
+		return -EINVAL;
+
 	spi_engine_write(eng_desc, SPI_ENGINE_REG_OFFLOAD_RESET(0), 1);
 	spi_engine_write(eng_desc, SPI_ENGINE_REG_OFFLOAD_RESET(0), 0);
 
-	eng_desc->offload_tx_len = 0;
-	eng_desc->offload_rx_len = 0;
-
-	transfer.cmds = (spi_engine_cmd_queue*)malloc(sizeof(*transfer.cmds));
-
-	if (!transfer.cmds)
-		return FAILURE;
-
-	transfer.tx_buf = msg.commands_data;
-
-	/* Load the commands into the message */
-	transfer.cmds->next = NULL;
-	transfer.cmds->cmd = msg.commands[0];
-	i = 1;
-	while(i < msg.no_commands) {
-		spi_engine_queue_add_cmd(&transfer.cmds, msg.commands[i++]);
+	eng_desc->offload_tx_len = prog->no_words;
+	eng_desc->offload_rx_len = prog->no_sdi_words;
 
-	}
+	spi_engine_load_program(eng_desc, prog,
+				SPI_ENGINE_REG_OFFLOAD_CMD_MEM(0));
 
-	spi_engine_transfer_message(desc, &transfer);
+	/* Write the words of the SDO line */
+	for(i = 0; i < prog->no_sdo_words; i++)
+		spi_engine_write(eng_desc, SPI_ENGINE_REG_OFFLOAD_SDO_MEM(0),
+				 commands_data[i]);
 
 	/* Start transfer */
 	spi_engine_write(eng_desc, SPI_ENGINE_REG_OFFLOAD_CTRL(0), 0x0001);
 
-	word_length = spi_get_word_lenght(eng_desc);
+	size = spi_get_word_lenght(eng_desc) * prog->no_words * no_samples;
 	if(eng_desc->offload_config & OFFLOAD_TX_EN) {
-		axi_dmac_transfer(eng_desc->offload_tx_dma,
-				  msg.tx_addr,
-				  word_length * eng_desc->offload_tx_len *
-				  no_samples);
+		ret = axi_dmac_transfer(eng_desc->offload_tx_dma, tx_addr, size);
+		if (ret != SUCCESS)
+			return ret;
 	}
 
 	if(eng_desc->offload_config & OFFLOAD_RX_EN) {
-		axi_dmac_transfer(eng_desc->offload_rx_dma,
-				  msg.rx_addr,
-				  word_length * eng_desc->offload_tx_len *
-				  no_samples);
-	}
+		ret = axi_dmac_transfer(eng_desc->offload_rx_dma, rx_addr, size);
+		if (ret != SUCCESS)
+			return ret;
 
-	usleep(1000);
+		return spi_engine_offload_wait(eng_desc->offload_rx_dma);
+	}
 
-	spi_engine_queue_free(&transfer.cmds);
+	return spi_engine_offload_wait(eng_desc->offload_tx_dma);
+}
 
-	return SUCCESS;
+/**
+ * @brief Initiate a SPI transfer in offload mode
+ *
+ * The message is compiled on the stack at every call, use
+ * spi_engine_program_init() and spi_engine_offload_program_transfer() to
+ * compile it only once.
+ *
+ * @param desc Decriptor containing SPI interface parameters
+ * @param msg Offload message that get's to be transferred
+ * @param no_samples Number of time the messages will be transferred
+ * @return int32_t - SUCCESS if the transfer finished
+ *		   - -EINVAL if the message is too long or invalid
+ *		   - negative error code if the transfer failed
+ */
+int32_t spi_engine_offload_transfer(struct spi_desc *desc,
+				    struct spi_engine_offload_message msg,
+				    uint32_t no_samples)
+{
+	uint32_t			cmds[SPI_ENGINE_PROGRAM_MAX_LEN];
+	struct spi_engine_program	prog;
+	int32_t				ret;
+
+	if (msg.no_commands + SPI_ENGINE_PROGRAM_HEADER_LEN >
+	    SPI_ENGINE_PROGRAM_MAX_LEN)
+		return -EINVAL;
+
+	prog.cmds = cmds;
+	ret = spi_engine_compile(desc, msg.commands, msg.no_commands, &prog);
+	if (ret != SUCCESS)
+		return ret;
+
+	return spi_engine_offload_program_transfer(desc, &prog,
+			msg.commands_data,
+			msg.tx_addr, msg.rx_addr,
+			no_samples);
 }
 
+
 /**
  * @brief Free the resources allocated by spi_init().
  *
@@ -878,10 +967,11 @@ int32_t spi_engine_remove(struct spi_desc *desc)
 
 	eng_desc = desc->extra;
 
-	if(eng_desc->offload_config & OFFLOAD_TX_EN)
+	if(eng_desc->offload_tx_dma)
 		axi_dmac_remove(eng_desc->offload_tx_dma);
-	if(eng_desc->offload_config & OFFLOAD_RX_EN)
+	if(eng_desc->offload_rx_dma)
 		axi_dmac_remove(eng_desc->offload_rx_dma);
+	free(eng_desc->xfer_buf);
 	free(desc->extra);
 	free(desc);
 
@@ -60,6 +60,13 @@
 
 #define SPI_ENGINE_MSG_QUEUE_END	0xFFFFFFFF
 
+/* Instructions added by the driver in front of each program */
+#define SPI_ENGINE_PROGRAM_HEADER_LEN	3
+/* Maximum length of a program compiled by spi_engine_offload_transfer() */
+#define SPI_ENGINE_PROGRAM_MAX_LEN	32
+/* Size of the words buffer used by spi_engine_write_and_read() */
+#define SPI_ENGINE_MAX_XFER_WORDS	256
+
 /* Spi engine commands */
 #define	WRITE(no_bytes)			((SPI_ENGINE_INST_TRANSFER << 12) |\
 	(SPI_ENGINE_INSTRUCTION_TRANSFER_W << 8) | no_bytes)
@@ -132,6 +139,26 @@ struct spi_engine_desc {
 	uint8_t			data_width;
 	/** The maximum data width supported by the engine */
 	uint8_t 		max_data_width;
+	/** Words buffer used by spi_engine_write_and_read() */
+	uint32_t		*xfer_buf;
+};
+
+/**
+ * @struct spi_engine_program
+ * @brief  Structure representing a list of commands compiled into engine
+ * instructions, ready to be executed any number of times
+ */
+struct spi_engine_program {
+	/** Engine instructions, without the final SYNC instruction */
+	uint32_t	*cmds;
+	/** Number of engine instructions */
+	uint32_t	no_cmds;
+	/** Number of words shifted by all the transfer instructions */
+	uint32_t	no_words;
+	/** Number of words written on the SDO line */
+	uint32_t	no_sdo_words;
+	/** Number of words read from the SDI line */
+	uint32_t	no_sdi_words;
 };
 
 
@@ -209,6 +236,29 @@ int32_t spi_engine_offload_transfer(struct spi_desc *desc,
 				    struct spi_engine_offload_message msg,
 				    uint32_t no_samples);
 
+/* Compile a list of commands into a reusable program */
+int32_t spi_engine_program_init(struct spi_engine_program **prog,
+				struct spi_desc *desc,
+				const uint32_t *commands,
+				uint32_t no_commands);
+
+/* Free the resources used by a compiled program */
+int32_t spi_engine_program_remove(struct spi_engine_program *prog);
+
+/* Execute a compiled program using the command fifo */
+int32_t spi_engine_program_transfer(struct spi_desc *desc,
+				    const struct spi_engine_program *prog,
+				    const uint32_t *tx,
+				    uint32_t *rx);
+
+/* Execute a compiled program using the offload module */
+int32_t spi_engine_offload_program_transfer(struct spi_desc *desc,
+		const struct spi_engine_program *prog,
+		const uint32_t *commands_data,
+		uint32_t tx_addr,
+		uint32_t rx_addr,
+		uint32_t no_samples);
+
 /* Set SPI transfer width */
 int32_t spi_engine_set_transfer_width(struct spi_desc *desc,
 				      uint8_t data_wdith);
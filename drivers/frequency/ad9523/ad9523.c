@@ -44,6 +44,8 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include "ad9523.h"
+#include "error.h"
+#include "util.h"
 
 /* Helpers to avoid excess line breaks */
 #define AD_IFE(_pde, _a, _b) ((dev->pdata->_pde) ? _a : _b)
@@ -718,6 +720,167 @@ int32_t ad9523_setup(struct ad9523_dev **device,
 	return(ad9523_status(dev));
 }
 
+/***************************************************************************//**
+ * @brief Get the channel spec of an output channel.
+ *
+ * @param dev - The device structure.
+ * @param chan - Output channel number.
+ *
+ * @return The channel spec, NULL if the channel is not configured.
+*******************************************************************************/
+static struct ad9523_channel_spec *ad9523_get_channel(struct ad9523_dev *dev,
+		uint32_t chan)
+{
+	uint8_t i;
+
+	for (i = 0; i < dev->pdata->num_channels; i++)
+		if (dev->pdata->channels[i].channel_num == chan)
+			return &dev->pdata->channels[i];
+
+	return NULL;
+}
+
+/***************************************************************************//**
+ * @brief Get the rate feeding the divider of an output channel.
+ *
+ * @param dev - The device structure.
+ * @param chan - Output channel number.
+ *
+ * @return The rate of the VCO divider or VCXO selected for the channel.
+*******************************************************************************/
+static uint32_t ad9523_get_channel_source_rate(struct ad9523_dev *dev,
+		uint32_t chan)
+{
+	return dev->ad9523_st.vco_out_freq[dev->ad9523_st.vco_out_map[chan]];
+}
+
+/***************************************************************************//**
+ * @brief Get the divider closest to the desired rate of an output channel.
+ *
+ * @param dev - The device structure.
+ * @param chan - Output channel number.
+ * @param rate - The desired rate.
+ *
+ * @return The channel divider, 1 to 1024.
+*******************************************************************************/
+static uint32_t ad9523_calc_channel_div(struct ad9523_dev *dev,
+					uint32_t chan,
+					uint64_t rate)
+{
+	uint32_t div;
+
+	if (!rate)
+		return 1024;
+
+	div = DIV_ROUND_CLOSEST_ULL(ad9523_get_channel_source_rate(dev, chan),
+				    rate);
+
+	return clamp_t(uint32_t, div, 1, 1024);
+}
+
+/***************************************************************************//**
+ * @brief Get the current rate of an output channel.
+ *
+ * @param dev - The device structure.
+ * @param chan - Output channel number.
+ * @param rate - The channel rate.
+ *
+ * @return SUCCESS in case of success, negative error code otherwise.
+*******************************************************************************/
+int32_t ad9523_clk_recalc_rate(struct ad9523_dev *dev,
+			       uint32_t chan,
+			       uint64_t *rate)
+{
+	struct ad9523_channel_spec *spec;
+
+	if (chan >= AD9523_NUM_CHAN)
+		return -EINVAL;
+
+	spec = ad9523_get_channel(dev, chan);
+	if (!spec || !spec->channel_divider)
+		return -EINVAL;
+
+	*rate = ad9523_get_channel_source_rate(dev, chan) /
+		spec->channel_divider;
+
+	return SUCCESS;
+}
+
+/***************************************************************************//**
+ * @brief Get the closest rate an output channel can output.
+ *
+ * @param dev - The device structure.
+ * @param chan - Output channel number.
+ * @param rate - The desired rate.
+ * @param rounded_rate - The closest possible rate.
+ *
+ * @return SUCCESS in case of success, negative error code otherwise.
+*******************************************************************************/
+int32_t ad9523_clk_round_rate(struct ad9523_dev *dev,
+			      uint32_t chan,
+			      uint64_t rate,
+			      uint64_t *rounded_rate)
+{
+	if (chan >= AD9523_NUM_CHAN)
+		return -EINVAL;
+
+	*rounded_rate = ad9523_get_channel_source_rate(dev, chan) /
+			ad9523_calc_channel_div(dev, chan, rate);
+
+	return SUCCESS;
+}
+
+/***************************************************************************//**
+ * @brief Change the rate of an output channel.
+ *
+ * Only the channel divider is changed, the VCO keeps running. The outputs are
+ * not synchronized again, call ad9523_sync() if the phase matters.
+ *
+ * @param dev - The device structure.
+ * @param chan - Output channel number.
+ * @param rate - The desired rate.
+ *
+ * @return SUCCESS in case of success, negative error code otherwise.
+*******************************************************************************/
+int32_t ad9523_clk_set_rate(struct ad9523_dev *dev,
+			    uint32_t chan,
+			    uint64_t rate)
+{
+	struct ad9523_channel_spec *spec;
+	uint32_t reg_data;
+	uint32_t div;
+	int32_t ret;
+
+	if (chan >= AD9523_NUM_CHAN)
+		return -EINVAL;
+
+	spec = ad9523_get_channel(dev, chan);
+	if (!spec)
+		return -EINVAL;
+
+	div = ad9523_calc_channel_div(dev, chan, rate);
+
+	ret = ad9523_spi_read(dev, AD9523_CHANNEL_CLOCK_DIST(chan), &reg_data);
+	if (ret < 0)
+		return ret;
+
+	/* DIV(0) sets all the bits of the field, which holds the divider - 1 */
+	reg_data &= ~AD9523_CLK_DIST_DIV(0);
+	reg_data |= AD9523_CLK_DIST_DIV(div);
+
+	ret = ad9523_spi_write(dev, AD9523_CHANNEL_CLOCK_DIST(chan), reg_data);
+	if (ret < 0)
+		return ret;
+
+	ret = ad9523_io_update(dev);
+	if (ret < 0)
+		return ret;
+
+	spec->channel_divider = div;
+
+	return SUCCESS;
+}
+
 /***************************************************************************//**
  * @brief Free the resources allocated by ad9523_setup().
  *
@@ -520,6 +520,22 @@ int32_t ad9523_init(struct ad9523_init_param *init_param);
 int32_t ad9523_setup(struct ad9523_dev **device,
 		     const struct ad9523_init_param *init_param);
 
+/* Get the current rate of an output channel. */
+int32_t ad9523_clk_recalc_rate(struct ad9523_dev *dev,
+			       uint32_t chan,
+			       uint64_t *rate);
+
+/* Get the closest rate an output channel can output. */
+int32_t ad9523_clk_round_rate(struct ad9523_dev *dev,
+			      uint32_t chan,
+			      uint64_t rate,
+			      uint64_t *rounded_rate);
+
+/* Change the rate of an output channel. */
+int32_t ad9523_clk_set_rate(struct ad9523_dev *dev,
+			    uint32_t chan,
+			    uint64_t rate);
+
 /* Free the resources allocated by ad9523_setup(). */
 int32_t ad9523_remove(struct ad9523_dev *dev);
 
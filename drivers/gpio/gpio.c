@@ -182,3 +182,36 @@ int32_t gpio_get_value(struct gpio_desc *desc,
 	else
 		return SUCCESS;
 }
+
+/**
+ * @brief Wait for a transition of the specified input GPIO.
+ * Sleeps until the platform reports the edge instead of polling the value.
+ * Edges that occurred since the GPIO was made an input and were not waited
+ * for yet are reported first, so an edge happening right before the call is
+ * not missed.
+ * @param desc - The GPIO descriptor.
+ * @param edge - The transition to wait for.
+ *               Example: GPIO_EDGE_RISING
+ *                        GPIO_EDGE_FALLING
+ * @param timeout_us - Time left to wait, in microseconds, decreased by the
+ *		      time spent waiting, so that callers waiting for several
+ *		      edges keep a single deadline.
+ * @return SUCCESS when the edge was seen, -ETIMEDOUT if it was not seen in
+ * time or no time is left, -ENOTSUP if the platform can not wait for edges (the caller should
+ * poll the value instead), negative error code otherwise.
+ */
+int32_t gpio_wait_edge(struct gpio_desc *desc, enum gpio_edge edge,
+		       uint32_t *timeout_us)
+{
+	if (!desc || !timeout_us)
+		return -EINVAL;
+
+	if (!desc->platform_ops->gpio_ops_wait_edge)
+		return -ENOTSUP;
+
+	/* Queued edges would be reported forever without this */
+	if (!*timeout_us)
+		return -ETIMEDOUT;
+
+	return desc->platform_ops->gpio_ops_wait_edge(desc, edge, timeout_us);
+}
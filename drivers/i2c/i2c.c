@@ -109,3 +109,42 @@ int32_t i2c_read(struct i2c_desc *desc,
 	return desc->platform_ops->i2c_ops_read(desc, data, bytes_number,
 						stop_bit);
 }
+
+/**
+ * @brief Run several reads and writes as a single transaction.
+ * The messages are separated by repeated starts, so a register address write
+ * followed by a read can not be interleaved with other masters.
+ * Platforms without a combined transfer get one i2c_write()/i2c_read() per
+ * message, with a stop condition after the last one only.
+ * @param desc - The I2C descriptor.
+ * @param msgs - Array of messages.
+ * @param len - Number of messages in the array.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t i2c_transfer(struct i2c_desc *desc, struct i2c_transfer_msg *msgs,
+		     uint32_t len)
+{
+	int32_t ret;
+	uint32_t i;
+
+	if (!desc || !desc->platform_ops || !msgs || !len)
+		return -EINVAL;
+
+	if (desc->platform_ops->i2c_ops_transfer)
+		return desc->platform_ops->i2c_ops_transfer(desc, msgs, len);
+
+	for (i = 0; i < len; i++) {
+		if (msgs[i].bytes_number > UINT8_MAX)
+			return -EINVAL;
+		if (msgs[i].read)
+			ret = i2c_read(desc, msgs[i].buff, msgs[i].bytes_number,
+				       i == len - 1);
+		else
+			ret = i2c_write(desc, msgs[i].buff, msgs[i].bytes_number,
+					i == len - 1);
+		if (ret != SUCCESS)
+			return ret < 0 ? ret : -EIO;
+	}
+
+	return SUCCESS;
+}
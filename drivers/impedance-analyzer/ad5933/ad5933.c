@@ -147,24 +147,63 @@ uint32_t ad5933_get_register_value(struct ad5933_dev *dev,
 {
 	uint32_t register_value = 0;
 	uint8_t byte = 0;
-	uint8_t write_data[2]   = {0, 0};
-	uint8_t read_data[2]    = {0, 0};
+	uint8_t read_data[4] = {0, 0, 0, 0};
 
+	if (bytes_number > sizeof(read_data))
+		return 0;
+
+	ad5933_get_register_values(dev, register_address, read_data,
+				   bytes_number);
 	for(byte = 0; byte < bytes_number; byte ++) {
-		/* Set the register pointer. */
-		write_data[0] = AD5933_ADDR_POINTER;
-		write_data[1] = register_address + byte;
-		i2c_write(dev->i2c_desc, write_data, 2, 1);
-		/* Read Register Data. */
-		read_data[0] = 0xFF;
-		i2c_read(dev->i2c_desc, read_data, 1, 1);
 		register_value = register_value << 8;
-		register_value += read_data[0];
+		register_value += read_data[byte];
 	}
 
 	return register_value;
 }
 
+/***************************************************************************//**
+ * @brief Reads consecutive registers with a block read.
+ *
+ * The address pointer, the block read command and the data are transferred
+ * in a single I2C transaction, instead of a pointer write and a read for
+ * every byte.
+ *
+ * @param dev              - The device structure.
+ * @param register_address - Address of the first register.
+ * @param data             - Where to store the register values.
+ * @param bytes_number     - Number of registers to read.
+ *
+ * @return SUCCESS in case of success, negative error code otherwise.
+*******************************************************************************/
+int32_t ad5933_get_register_values(struct ad5933_dev *dev,
+				   uint8_t register_address,
+				   uint8_t *data,
+				   uint8_t bytes_number)
+{
+	uint8_t pointer[2] = {AD5933_ADDR_POINTER, register_address};
+	uint8_t block_read[2] = {AD5933_BLOCK_READ, bytes_number};
+	struct i2c_transfer_msg msgs[3] = {
+		{
+			.buff = pointer,
+			.bytes_number = 2,
+			.read = false,
+		},
+		{
+			.buff = block_read,
+			.bytes_number = 2,
+			.read = false,
+		},
+		{
+			.buff = data,
+			.bytes_number = bytes_number,
+			.read = true,
+		},
+	};
+
+	return i2c_transfer(dev->i2c_desc, msgs, 3);
+}
+
 /***************************************************************************//**
  * @brief Resets the device.
  *
@@ -380,6 +419,7 @@ void ad5933_get_data(struct ad5933_dev *dev,
 		     short *imag_data,
 		     short *real_data)
 {
+	uint8_t data[4] = {0, 0, 0, 0};
 	uint8_t status = 0;
 
 	if (!dev)
@@ -397,12 +437,10 @@ void ad5933_get_data(struct ad5933_dev *dev,
 						   AD5933_REG_STATUS,
 						   1);
 	}
-	*real_data = ad5933_get_register_value(dev,
-					       AD5933_REG_REAL_DATA,
-					       2);
-	*imag_data = ad5933_get_register_value(dev,
-					       AD5933_REG_IMAG_DATA,
-					       2);
+	/* The real and imaginary data registers are adjacent */
+	ad5933_get_register_values(dev, AD5933_REG_REAL_DATA, data, 4);
+	*real_data = (short)(((uint16_t)data[0] << 8) | data[1]);
+	*imag_data = (short)(((uint16_t)data[2] << 8) | data[3]);
 }
 
 /***************************************************************************//**
@@ -162,6 +162,12 @@ uint32_t ad5933_get_register_value(struct ad5933_dev *dev,
 				   uint8_t register_address,
 				   uint8_t bytes_number);
 
+/*! Reads consecutive registers with a block read. */
+int32_t ad5933_get_register_values(struct ad5933_dev *dev,
+				   uint8_t register_address,
+				   uint8_t *data,
+				   uint8_t bytes_number);
+
 /*! Resets the device. */
 void ad5933_reset(struct ad5933_dev *dev);
 
@@ -279,3 +279,18 @@ int32_t gpio_get_value(struct gpio_desc *desc, uint8_t *value)
 
 	return SUCCESS;
 }
+
+/**
+ * @brief Wait for an edge on the specified GPIO.
+ * @param desc - The GPIO descriptor.
+ * @param edge - The transition to wait for.
+ * @param timeout_us - Time left to wait, in microseconds, decreased by the
+ *		      time spent waiting.
+ * @return -ENOTSUP, edges are not reported by this platform and the caller
+ * should poll the value instead.
+ */
+int32_t gpio_wait_edge(struct gpio_desc *desc, enum gpio_edge edge,
+		       uint32_t *timeout_us)
+{
+	return -ENOTSUP;
+}
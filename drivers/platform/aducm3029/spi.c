@@ -279,3 +279,35 @@ int32_t spi_write_and_read(struct spi_desc *desc,
 	return SUCCESS;
 }
 
+
+/**
+ * @brief Write and read a list of messages. The chip select is deasserted
+ * after every message, keeping it asserted up to the next one is not
+ * supported.
+ * @param desc - The SPI descriptor.
+ * @param msgs - Array of messages.
+ * @param len - Number of messages in the array.
+ * @return SUCCESS in case of success, -ENOTSUP if a message has to keep the
+ * chip select asserted, negative error code otherwise.
+ */
+int32_t spi_transfer(struct spi_desc *desc, struct spi_msg *msgs, uint32_t len)
+{
+	uint32_t i;
+	int32_t ret;
+
+	if (!desc || (len && !msgs))
+		return -EINVAL;
+
+	for (i = 0; i < len; i++) {
+		if (!msgs[i].cs_change)
+			return -ENOTSUP;
+		if (msgs[i].rx_buff != msgs[i].tx_buff || !msgs[i].tx_buff)
+			return -EINVAL;
+		ret = spi_write_and_read(desc, msgs[i].tx_buff,
+					 msgs[i].bytes_number);
+		if (ret != SUCCESS)
+			return ret;
+	}
+
+	return SUCCESS;
+}
@@ -80,3 +80,58 @@ int32_t axi_io_write(uint32_t base, uint32_t offset, uint32_t data)
 
 	return SUCCESS;
 }
+
+/**
+ * @brief AXI IO generic burst read function.
+ * @param base - Base address
+ * @param offset - Address offset of the first register
+ * @param data - variable where returned data is stored
+ * @param count - number of consecutive 32-bit registers to read
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t axi_io_read_burst(uint32_t base, uint32_t offset, uint32_t *data,
+			  uint32_t count)
+{
+	UNUSED_PARAM(base);
+	UNUSED_PARAM(offset);
+	UNUSED_PARAM(data);
+	UNUSED_PARAM(count);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief AXI IO generic burst write function.
+ * @param base - Base address
+ * @param offset - Address offset of the first register
+ * @param data - data to be written.
+ * @param count - number of consecutive 32-bit registers to write
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t axi_io_write_burst(uint32_t base, uint32_t offset,
+			   const uint32_t *data, uint32_t count)
+{
+	UNUSED_PARAM(base);
+	UNUSED_PARAM(offset);
+	UNUSED_PARAM(data);
+	UNUSED_PARAM(count);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Wait for the interrupt of an AXI core.
+ * The interrupts are delivered through the interrupt controller driver on
+ * this platform.
+ * @param base - Base address
+ * @param timeout_us - Time left to wait, in microseconds, decreased by the
+ *		      time spent waiting
+ * @return -ENOTSUP, the caller has to rely on its interrupt handler.
+ */
+int32_t axi_io_wait_irq(uint32_t base, uint32_t *timeout_us)
+{
+	UNUSED_PARAM(base);
+	UNUSED_PARAM(timeout_us);
+
+	return -ENOTSUP;
+}
@@ -40,122 +40,348 @@
 /******************************************************************************/
 /***************************** Include Files **********************************/
 /******************************************************************************/
+#include <errno.h>
 #include <fcntl.h>
 #include <inttypes.h>
+#include <poll.h>
+#include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <time.h>
 #include <unistd.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
 #include "error.h"
 #include "axi_io.h"
 
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+#ifndef UIO_DEV_PATH
+#define UIO_DEV_PATH	"/dev/uio"
+#endif
+
+#ifndef UIO_SYSFS_PATH
+#define UIO_SYSFS_PATH	"/sys/class/uio"
+#endif
+
+#ifndef DEVMEM_PATH
+#define DEVMEM_PATH	"/dev/mem"
+#endif
+
+/* Minimum register window mapped for a /dev/mem base address. */
+#ifndef DEVMEM_MAP_SIZE
+#define DEVMEM_MAP_SIZE	0x10000
+#endif
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @struct axi_io_map
+ * @brief Cached mapping of a register window.
+ */
+struct axi_io_map {
+	/** UIO index (/dev/uioX)/base address */
+	uint32_t base;
+	/** Start of the mmap()-ed area (page aligned) */
+	void *map_addr;
+	/** Size of the mmap()-ed area */
+	size_t map_size;
+	/** Register window corresponding to base */
+	volatile uint8_t *regs;
+	/** Accessible size of the register window */
+	size_t size;
+	/** /dev/uioX file descriptor used for interrupts, -1 until needed */
+	int irq_fd;
+	/** Next cached mapping */
+	struct axi_io_map *next;
+};
+
+/******************************************************************************/
+/************************ Variables Definitions *******************************/
+/******************************************************************************/
+
+/** List of the register windows mapped so far, unmapped at process exit */
+static struct axi_io_map *axi_io_maps;
+
+/**
+ * Held for reading while a register window is accessed, for writing while one
+ * is mapped or remapped and while irq_fd is opened.
+ */
+static pthread_rwlock_t axi_io_maps_lock = PTHREAD_RWLOCK_INITIALIZER;
+
 /******************************************************************************/
 /************************ Functions Definitions *******************************/
 /******************************************************************************/
 
 /**
- * @brief AXI IO through UIO read/write function.
+ * @brief Map the register window of an UIO device.
  * @param base - UIO index (/dev/uioX).
- * @param offset - Address offset.
- * @param read - Location where read data will be stored.
- * @param write - Data to be written.
+ * @param len - Minimum number of bytes that must be accessible, checked
+ *		against the size of map0 in sysfs.
+ * @param map - The mapping to be filled in.
  * @return SUCCESS in case of success, FAILURE otherwise.
  */
-static int32_t uio_read_write(uint32_t base, uint32_t offset, uint32_t *read,
-			      uint32_t *write)
+static int32_t uio_map(uint32_t base, size_t len, struct axi_io_map *map)
 {
-	char buf[32];
-	int ret;
-	int uio_fd;
-	int32_t status = SUCCESS;
-	void *uio_addr;
+	unsigned long long size = 0;
+	struct stat st;
+	char buf[64];
+	void *addr;
+	FILE *f;
+	int fd;
 
-	sprintf(buf, "/dev/uio%"PRIu32"", base);
+	snprintf(buf, sizeof(buf), UIO_SYSFS_PATH"/uio%"PRIu32"/maps/map0/size",
+		 base);
+	f = fopen(buf, "r");
+	if (f) {
+		if (fscanf(f, "%llx", &size) != 1)
+			size = 0;
+		fclose(f);
+	}
 
-	uio_fd = open(buf, O_RDWR);
-	if (uio_fd < 0) {
+	snprintf(buf, sizeof(buf), UIO_DEV_PATH"%"PRIu32"", base);
+	fd = open(buf, O_RDWR | O_SYNC);
+	if (fd < 0) {
 		printf("%s: Can't open %s\n\r", __func__, buf);
 		return FAILURE;
 	}
 
-	uio_addr = mmap(NULL,
-			offset + sizeof(*read),
-			PROT_READ|PROT_WRITE,
-			MAP_SHARED,
-			uio_fd,
-			0);
-	if (uio_addr == MAP_FAILED) {
+	/* No sysfs entry (e.g. file-backed device), use the file size. */
+	if (!size && !fstat(fd, &st) && S_ISREG(st.st_mode))
+		size = st.st_size;
+	if (!size)
+		size = sysconf(_SC_PAGESIZE);
+
+	if (len > size) {
+		close(fd);
+		printf("%s: uio%"PRIu32" maps only 0x%llx bytes\n\r", __func__,
+		       base, size);
+		return FAILURE;
+	}
+
+	addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	close(fd);
+	if (addr == MAP_FAILED) {
 		printf("%s: mmap() failed\n\r", __func__);
-		status = FAILURE;
-		goto close;
+		return FAILURE;
 	}
 
-	if (read)
-		*read = *(uint32_t *)((uintptr_t)uio_addr + offset);
-	if (write)
-		*(uint32_t *)((uintptr_t)uio_addr + offset) = *write;
+	map->map_addr = addr;
+	map->map_size = size;
+	map->regs = addr;
+	map->size = size;
+
+	return SUCCESS;
+}
 
-	ret = munmap(uio_addr, offset + sizeof(*read));
-	if (ret < 0) {
-		printf("%s: munmap() failed\n\r", __func__);
-		status = FAILURE;
+/**
+ * @brief Map a physical register window through /dev/mem.
+ * A window already held by the mapping is unmapped first, so growing it does
+ * not leave the smaller one behind.
+ * @param base - Physical base address.
+ * @param len - Minimum number of bytes that must be accessible from base.
+ * @param map - The mapping to be filled in.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+static int32_t devmem_map(uint32_t base, size_t len, struct axi_io_map *map)
+{
+	size_t page_size = sysconf(_SC_PAGESIZE);
+	off_t page_base = base & ~(page_size - 1);
+	size_t page_offset = base - page_base;
+	size_t size;
+	void *addr;
+	int fd;
+
+	if (len < DEVMEM_MAP_SIZE)
+		len = DEVMEM_MAP_SIZE;
+	size = (page_offset + len + page_size - 1) & ~(page_size - 1);
+
+	if (map->map_addr) {
+		munmap(map->map_addr, map->map_size);
+		map->map_addr = NULL;
+		map->map_size = 0;
+		map->regs = NULL;
+		map->size = 0;
+	}
+
+	fd = open(DEVMEM_PATH, O_RDWR | O_SYNC);
+	if (fd < 0) {
+		printf("%s: Can't open %s\n\r", __func__, DEVMEM_PATH);
+		return FAILURE;
 	}
 
-close:
-	ret = close(uio_fd);
-	if (ret < 0) {
-		printf("%s: Can't close %s\n\r", __func__, buf);
-		status = FAILURE;
+	addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd,
+		    page_base);
+	close(fd);
+	if (addr == MAP_FAILED) {
+		printf("%s: mmap() failed\n\r", __func__);
+		return FAILURE;
 	}
 
-	return status;
+	map->map_addr = addr;
+	map->map_size = size;
+	map->regs = (volatile uint8_t *)addr + page_offset;
+	map->size = size - page_offset;
+
+	return SUCCESS;
 }
 
 /**
- * @brief AXI IO through devmem read/write function.
- * @param base - Base address.
+ * @brief Find the mapping of a base address.
+ * Must be called with axi_io_maps_lock held.
+ * @param base - UIO index (/dev/uioX)/base address.
+ * @return Pointer to the mapping, NULL if base was not mapped yet.
+ */
+static struct axi_io_map *axi_io_find_map(uint32_t base)
+{
+	struct axi_io_map *map;
+
+	for (map = axi_io_maps; map; map = map->next)
+		if (map->base == base)
+			return map;
+
+	return NULL;
+}
+
+/**
+ * @brief Map, or remap larger, the register window of a base address.
+ * Takes axi_io_maps_lock for writing, so no other thread is accessing the
+ * window when a /dev/mem one is unmapped to be grown.
+ * @param base - UIO index (/dev/uioX)/base address.
  * @param offset - Address offset.
+ * @param len - Number of bytes to be accessed.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+static int32_t axi_io_map(uint32_t base, uint32_t offset, size_t len)
+{
+	struct axi_io_map *map;
+	int32_t ret = SUCCESS;
+
+	pthread_rwlock_wrlock(&axi_io_maps_lock);
+
+	/* Another thread may have mapped it meanwhile */
+	map = axi_io_find_map(base);
+	if (map && (size_t)offset + len <= map->size)
+		goto unlock;
+
+	if (!map) {
+		map = calloc(1, sizeof(*map));
+		if (!map) {
+			ret = FAILURE;
+			goto unlock;
+		}
+		map->base = base;
+		map->irq_fd = -1;
+		map->next = axi_io_maps;
+		axi_io_maps = map;
+	}
+
+#ifdef DEVMEM
+	ret = devmem_map(base, (size_t)offset + len, map);
+#else
+	/* The size of an UIO window is fixed */
+	if (map->map_addr) {
+		printf("%s: Offset 0x%"PRIx32" out of range\n\r", __func__, offset);
+		ret = FAILURE;
+	} else {
+		ret = uio_map(base, (size_t)offset + len, map);
+	}
+#endif
+
+unlock:
+	pthread_rwlock_unlock(&axi_io_maps_lock);
+
+	return ret;
+}
+
+/**
+ * @brief Get the cached register window covering [offset, offset + len).
+ * The window is mapped on the first access. On success axi_io_maps_lock is
+ * held for reading, so the window is not remapped while the caller uses it;
+ * the caller releases it with pthread_rwlock_unlock().
+ * @param base - UIO index (/dev/uioX)/base address.
+ * @param offset - Address offset.
+ * @param len - Number of bytes to be accessed.
+ * @return Pointer to the mapping, NULL in case of failure.
+ */
+static struct axi_io_map *axi_io_get_map(uint32_t base, uint32_t offset,
+		size_t len)
+{
+	struct axi_io_map *map;
+
+	pthread_rwlock_rdlock(&axi_io_maps_lock);
+	map = axi_io_find_map(base);
+	if (map && (size_t)offset + len <= map->size)
+		return map;
+	pthread_rwlock_unlock(&axi_io_maps_lock);
+
+	if (axi_io_map(base, offset, len) != SUCCESS)
+		return NULL;
+
+	/* Windows only grow, so it still covers the access */
+	pthread_rwlock_rdlock(&axi_io_maps_lock);
+
+	return axi_io_find_map(base);
+}
+
+/**
+ * @brief Unmap all the cached register windows at process teardown.
+ * @return None.
+ */
+static void __attribute__((destructor)) axi_io_release_maps(void)
+{
+	struct axi_io_map *map;
+
+	while ((map = axi_io_maps)) {
+		axi_io_maps = map->next;
+		if (map->map_addr)
+			munmap(map->map_addr, map->map_size);
+		if (map->irq_fd >= 0)
+			close(map->irq_fd);
+		free(map);
+	}
+}
+
+/**
+ * @brief AXI IO through UIO/devmem read/write function.
+ * @param base - UIO index (/dev/uioX)/base address.
+ * @param offset - Address offset of the first register.
  * @param read - Location where read data will be stored.
  * @param write - Data to be written.
+ * @param count - Number of consecutive 32-bit registers to access.
  * @return SUCCESS in case of success, FAILURE otherwise.
  */
-static int32_t devmem_read_write(uint32_t base, uint32_t offset, uint32_t *read,
-				 uint32_t *write)
+static int32_t axi_io_read_write(uint32_t base, uint32_t offset,
+				 uint32_t *read, const uint32_t *write,
+				 uint32_t count)
 {
-	char command[64];
-	char answer[64];
-	FILE *stream;
-	int32_t ret;
-
-	if (write)
-		ret = snprintf(command, sizeof(command),
-			       "busybox devmem 0x%x w 0x%x", base + offset, *write);
-	else if (read)
-		ret = snprintf(command, sizeof(command),
-			       "busybox devmem 0x%x", base + offset);
-	else
-		return FAILURE;
+	struct axi_io_map *map;
+	volatile uint32_t *reg;
+	uint32_t i;
 
-	if (ret < 0 || ret >= (int32_t) sizeof(command))
-		return FAILURE;
+	if (!count)
+		return SUCCESS;
 
-	stream = popen(command, "r");
-	if (stream == NULL)
+	map = axi_io_get_map(base, offset, (size_t)count * sizeof(*reg));
+	if (!map)
 		return FAILURE;
 
-	if (!(fgets(answer, sizeof(answer), stream))) {
-		ret = FAILURE;
-		goto close;
-	}
+	reg = (volatile uint32_t *)(map->regs + offset);
 
-	if (read)
-		*read = strtol(answer, NULL, 0);
+	for (i = 0; i < count; i++) {
+		if (read)
+			read[i] = reg[i];
+		if (write)
+			reg[i] = write[i];
+	}
 
-	ret = SUCCESS;
-close:
-	pclose(stream);
+	pthread_rwlock_unlock(&axi_io_maps_lock);
 
-	return ret;
+	return SUCCESS;
 }
 
 /**
@@ -167,25 +393,132 @@ close:
  */
 int32_t axi_io_read(uint32_t base, uint32_t offset, uint32_t *data)
 {
-#ifdef DEVMEM
-	return devmem_read_write(base, offset, data, NULL);
-#else
-	return uio_read_write(base, offset, data, NULL);
-#endif
+	return axi_io_read_write(base, offset, data, NULL, 1);
 }
 
 /**
- * @brief AXI IO through UIO specific write function.
- * @param base - UIO index (/dev/uioX).
+ * @brief AXI IO through UIO/devmem write function.
+ * @param base - UIO index (/dev/uioX)/base address.
  * @param offset - Address offset.
  * @param data - Data to be written.
  * @return SUCCESS in case of success, FAILURE otherwise.
  */
 int32_t axi_io_write(uint32_t base, uint32_t offset, uint32_t data)
+{
+	return axi_io_read_write(base, offset, NULL, &data, 1);
+}
+
+/**
+ * @brief AXI IO through UIO/devmem burst read function.
+ * @param base - UIO index (/dev/uioX)/base address.
+ * @param offset - Address offset of the first register.
+ * @param data - Location where read data will be stored.
+ * @param count - Number of consecutive 32-bit registers to read.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t axi_io_read_burst(uint32_t base, uint32_t offset, uint32_t *data,
+			  uint32_t count)
+{
+	return axi_io_read_write(base, offset, data, NULL, count);
+}
+
+/**
+ * @brief AXI IO through UIO/devmem burst write function.
+ * @param base - UIO index (/dev/uioX)/base address.
+ * @param offset - Address offset of the first register.
+ * @param data - Data to be written.
+ * @param count - Number of consecutive 32-bit registers to write.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t axi_io_write_burst(uint32_t base, uint32_t offset,
+			   const uint32_t *data, uint32_t count)
+{
+	return axi_io_read_write(base, offset, NULL, data, count);
+}
+
+/**
+ * @brief Wait for the interrupt of an UIO device.
+ * The interrupt is unmasked, then the calling thread sleeps on /dev/uioX
+ * until it fires. The UIO driver masks it again when it fires, so the
+ * caller handles it in thread context before waiting for the next one.
+ * @param base - UIO index (/dev/uioX).
+ * @param timeout_us - Time left to wait, in microseconds, decreased by the
+ *		      time spent waiting.
+ * @return SUCCESS if the interrupt fired, -ETIMEDOUT if it did not fire in
+ * time, -ENOTSUP when the device has no interrupt or the registers are mapped
+ * through /dev/mem, negative error code otherwise.
+ */
+int32_t axi_io_wait_irq(uint32_t base, uint32_t *timeout_us)
 {
 #ifdef DEVMEM
-	return devmem_read_write(base, offset, NULL, &data);
+	(void)base;
+	(void)timeout_us;
+
+	return -ENOTSUP;
 #else
-	return uio_read_write(base, offset, NULL, &data);
+	struct axi_io_map *map;
+	struct timespec start, now;
+	struct pollfd pfd;
+	uint64_t elapsed_us;
+	uint32_t val = 1;
+	char buf[64];
+	int irq_fd;
+	int ret;
+
+	map = axi_io_get_map(base, 0, sizeof(uint32_t));
+	if (!map)
+		return FAILURE;
+	pthread_rwlock_unlock(&axi_io_maps_lock);
+
+	/* UIO windows are never remapped, so map stays valid */
+	pthread_rwlock_wrlock(&axi_io_maps_lock);
+	if (map->irq_fd < 0) {
+		snprintf(buf, sizeof(buf), UIO_DEV_PATH"%"PRIu32"", base);
+		map->irq_fd = open(buf, O_RDWR);
+		if (map->irq_fd < 0) {
+			ret = -errno;
+			pthread_rwlock_unlock(&axi_io_maps_lock);
+			printf("%s: Can't open %s\n\r", __func__, buf);
+			return ret;
+		}
+	}
+	irq_fd = map->irq_fd;
+	pthread_rwlock_unlock(&axi_io_maps_lock);
+
+	/* Devices without irqcontrol keep the interrupt enabled, the ones
+	 * without interrupt refuse the write with EIO */
+	if (write(irq_fd, &val, sizeof(val)) < 0) {
+		if (errno == EIO)
+			return -ENOTSUP;
+		if (errno != ENOSYS)
+			return -errno;
+	}
+
+	pfd.fd = irq_fd;
+	pfd.events = POLLIN;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	do {
+		ret = poll(&pfd, 1, (*timeout_us + 999) / 1000);
+		if (ret < 0 && errno != EINTR)
+			return -errno;
+
+		/* Charge the caller for the time spent, interrupted or not */
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		elapsed_us = (now.tv_sec - start.tv_sec) * 1000000ull +
+			     now.tv_nsec / 1000 - start.tv_nsec / 1000;
+		start = now;
+		*timeout_us = elapsed_us < *timeout_us ?
+			      *timeout_us - elapsed_us : 0;
+	} while (ret < 0);
+	if (!ret) {
+		*timeout_us = 0;
+		return -ETIMEDOUT;
+	}
+
+	/* Consume the event count */
+	if (read(irq_fd, &val, sizeof(val)) != sizeof(val))
+		return -EIO;
+
+	return SUCCESS;
 #endif
 }
@@ -43,13 +43,26 @@
 
 #include "error.h"
 #include "gpio.h"
+#include "linux_gpio.h"
 
+#include <errno.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <time.h>
 #include <unistd.h>
+#include <linux/gpio.h>
 #include <sys/ioctl.h>
 
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/** Name the requested lines are reported under */
+#define LINUX_GPIO_CONSUMER	"no-OS"
+
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
@@ -65,6 +78,23 @@ struct linux_gpio_desc {
 	int value_fd;
 };
 
+/**
+ * @struct linux_gpio_bulk
+ * @brief Lines of a GPIO chip requested together.
+ */
+struct linux_gpio_bulk {
+	/** /dev/"chip" file descriptor */
+	int chip_fd;
+	/** Line request file descriptor, used for values and edge events */
+	int fd;
+	/** Number of requested lines */
+	uint8_t nb_lines;
+	/** Line offsets, in request order */
+	uint32_t offsets[GPIO_V2_LINES_MAX];
+	/** Current configuration flags of the lines */
+	uint64_t flags;
+};
+
 /******************************************************************************/
 /************************ Functions Definitions *******************************/
 /******************************************************************************/
@@ -365,3 +395,429 @@ const struct gpio_platform_ops linux_gpio_platform_ops = {
 	.gpio_ops_set_value = &linux_gpio_set_value,
 	.gpio_ops_get_value = &linux_gpio_get_value,
 };
+
+/**
+ * @brief Request several lines of a GPIO chip.
+ * The lines of a request share the direction and are read or written in a
+ * single ioctl. Bit n of the value masks stands for offsets[n].
+ * @param bulk - The requested lines.
+ * @param chip - GPIO chip name (/dev/"chip").
+ * @param offsets - Offsets of the lines in the chip.
+ * @param nb_lines - Number of lines, up to 64.
+ * @param output - Make the lines outputs if true, inputs otherwise.
+ * @param values - Initial values of output lines.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t linux_gpio_bulk_get(struct linux_gpio_bulk **bulk, const char *chip,
+			    const uint32_t *offsets, uint8_t nb_lines,
+			    bool output, uint64_t values)
+{
+	struct gpio_v2_line_request req;
+	struct linux_gpio_bulk *b;
+	char path[64];
+	int32_t ret;
+
+	if (!bulk || !chip || !offsets || !nb_lines ||
+	    nb_lines > GPIO_V2_LINES_MAX)
+		return -EINVAL;
+
+	b = calloc(1, sizeof(*b));
+	if (!b)
+		return -ENOMEM;
+
+	ret = snprintf(path, sizeof(path), "/dev/%s", chip);
+	if (ret < 0 || ret >= (int32_t)sizeof(path)) {
+		ret = -EINVAL;
+		goto free_bulk;
+	}
+
+	b->chip_fd = open(path, O_RDWR);
+	if (b->chip_fd < 0) {
+		printf("%s: Can't open %s\n\r", __func__, path);
+		ret = -errno;
+		goto free_bulk;
+	}
+
+	memset(&req, 0, sizeof(req));
+	memcpy(req.offsets, offsets, nb_lines * sizeof(*offsets));
+	strncpy(req.consumer, LINUX_GPIO_CONSUMER, sizeof(req.consumer) - 1);
+	req.num_lines = nb_lines;
+	if (output) {
+		req.config.flags = GPIO_V2_LINE_FLAG_OUTPUT;
+		req.config.num_attrs = 1;
+		req.config.attrs[0].attr.id = GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES;
+		req.config.attrs[0].attr.values = values;
+		req.config.attrs[0].mask = nb_lines == 64 ? ~0ULL :
+					   (1ULL << nb_lines) - 1;
+	}
+
+	ret = ioctl(b->chip_fd, GPIO_V2_GET_LINE_IOCTL, &req);
+	if (ret < 0) {
+		printf("%s: Can't request lines of %s\n\r", __func__, path);
+		ret = -errno;
+		goto close_chip;
+	}
+
+	b->fd = req.fd;
+	b->nb_lines = nb_lines;
+	memcpy(b->offsets, offsets, nb_lines * sizeof(*offsets));
+	b->flags = req.config.flags;
+	*bulk = b;
+
+	return SUCCESS;
+
+close_chip:
+	close(b->chip_fd);
+free_bulk:
+	free(b);
+
+	return ret;
+}
+
+/**
+ * @brief Release the lines requested by linux_gpio_bulk_get().
+ * @param bulk - The requested lines.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t linux_gpio_bulk_remove(struct linux_gpio_bulk *bulk)
+{
+	if (!bulk)
+		return -EINVAL;
+
+	close(bulk->fd);
+	close(bulk->chip_fd);
+	free(bulk);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Set the value of several output lines at once.
+ * @param bulk - The requested lines.
+ * @param mask - Lines to set.
+ * @param values - Values of the lines, bit n for offsets[n].
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t linux_gpio_bulk_set_values(struct linux_gpio_bulk *bulk,
+				   uint64_t mask, uint64_t values)
+{
+	struct gpio_v2_line_values val = {
+		.bits = values,
+		.mask = mask
+	};
+
+	if (ioctl(bulk->fd, GPIO_V2_LINE_SET_VALUES_IOCTL, &val) < 0)
+		return -errno;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Get the value of several lines at once.
+ * @param bulk - The requested lines.
+ * @param mask - Lines to read.
+ * @param values - Values of the lines, bit n for offsets[n].
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t linux_gpio_bulk_get_values(struct linux_gpio_bulk *bulk,
+				   uint64_t mask, uint64_t *values)
+{
+	struct gpio_v2_line_values val = {
+		.mask = mask
+	};
+
+	if (ioctl(bulk->fd, GPIO_V2_LINE_GET_VALUES_IOCTL, &val) < 0)
+		return -errno;
+
+	*values = val.bits;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Change the configuration of all the requested lines.
+ * @param bulk - The requested lines.
+ * @param flags - GPIO_V2_LINE_FLAG_* flags.
+ * @param values - Values of the lines if they are made outputs.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+static int32_t linux_gpio_bulk_set_config(struct linux_gpio_bulk *bulk,
+		uint64_t flags, uint64_t values)
+{
+	struct gpio_v2_line_config config;
+
+	memset(&config, 0, sizeof(config));
+	config.flags = flags;
+	if (flags & GPIO_V2_LINE_FLAG_OUTPUT) {
+		config.num_attrs = 1;
+		config.attrs[0].attr.id = GPIO_V2_LINE_ATTR_ID_OUTPUT_VALUES;
+		config.attrs[0].attr.values = values;
+		config.attrs[0].mask = bulk->nb_lines == 64 ? ~0ULL :
+				       (1ULL << bulk->nb_lines) - 1;
+	}
+
+	if (ioctl(bulk->fd, GPIO_V2_LINE_SET_CONFIG_IOCTL, &config) < 0)
+		return -errno;
+
+	bulk->flags = flags;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Obtain the GPIO decriptor of a GPIO chip line.
+ * @param desc - The GPIO descriptor.
+ * @param param - GPIO initialization parameters. param->number is the line
+ * offset and param->extra a struct linux_gpio_init_param.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t linux_gpiochip_get(struct gpio_desc **desc,
+			   const struct gpio_init_param *param)
+{
+	struct linux_gpio_init_param *linux_init;
+	struct linux_gpio_bulk *bulk;
+	struct gpio_desc *descriptor;
+	uint32_t offset;
+	int32_t ret;
+
+	linux_init = param->extra;
+	if (!linux_init || !linux_init->chip || param->number < 0)
+		return -EINVAL;
+
+	descriptor = calloc(1, sizeof(*descriptor));
+	if (!descriptor)
+		return -ENOMEM;
+
+	/* The direction is left as is until set by the driver */
+	offset = param->number;
+	ret = linux_gpio_bulk_get(&bulk, linux_init->chip, &offset, 1, false, 0);
+	if (ret < 0) {
+		free(descriptor);
+		return ret;
+	}
+
+	descriptor->number = param->number;
+	descriptor->extra = bulk;
+	*desc = descriptor;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Get the descriptor of an optional GPIO chip line.
+ * @param desc - The GPIO descriptor.
+ * @param param - GPIO Initialization parameters.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t linux_gpiochip_get_optional(struct gpio_desc **desc,
+				    const struct gpio_init_param *param)
+{
+	return linux_gpiochip_get(desc, param);
+}
+
+/**
+ * @brief Free the resources allocated by linux_gpiochip_get().
+ * @param desc - The GPIO descriptor.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t linux_gpiochip_remove(struct gpio_desc *desc)
+{
+	int32_t ret;
+
+	ret = linux_gpio_bulk_remove(desc->extra);
+	free(desc);
+
+	return ret;
+}
+
+/**
+ * @brief Enable the input direction of a GPIO chip line.
+ * Edge detection is enabled as well, so linux_gpiochip_wait_edge() can report
+ * edges that happen before it is called.
+ * @param desc - The GPIO descriptor.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t linux_gpiochip_direction_input(struct gpio_desc *desc)
+{
+	return linux_gpio_bulk_set_config(desc->extra,
+					  GPIO_V2_LINE_FLAG_INPUT |
+					  GPIO_V2_LINE_FLAG_EDGE_RISING |
+					  GPIO_V2_LINE_FLAG_EDGE_FALLING, 0);
+}
+
+/**
+ * @brief Enable the output direction of a GPIO chip line.
+ * @param desc - The GPIO descriptor.
+ * @param value - The value.
+ *                Example: GPIO_HIGH
+ *                         GPIO_LOW
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t linux_gpiochip_direction_output(struct gpio_desc *desc,
+					uint8_t value)
+{
+	return linux_gpio_bulk_set_config(desc->extra, GPIO_V2_LINE_FLAG_OUTPUT,
+					  value ? 1 : 0);
+}
+
+/**
+ * @brief Get the direction of a GPIO chip line.
+ * @param desc - The GPIO descriptor.
+ * @param direction - The direction.
+ *                    Example: GPIO_OUT
+ *                             GPIO_IN
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t linux_gpiochip_get_direction(struct gpio_desc *desc,
+				     uint8_t *direction)
+{
+	struct linux_gpio_bulk *bulk = desc->extra;
+	struct gpio_v2_line_info info;
+
+	memset(&info, 0, sizeof(info));
+	info.offset = bulk->offsets[0];
+	if (ioctl(bulk->chip_fd, GPIO_V2_GET_LINEINFO_IOCTL, &info) < 0)
+		return -errno;
+
+	*direction = (info.flags & GPIO_V2_LINE_FLAG_OUTPUT) ? GPIO_OUT : GPIO_IN;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Set the value of a GPIO chip line.
+ * @param desc - The GPIO descriptor.
+ * @param value - The value.
+ *                Example: GPIO_HIGH
+ *                         GPIO_LOW
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t linux_gpiochip_set_value(struct gpio_desc *desc, uint8_t value)
+{
+	return linux_gpio_bulk_set_values(desc->extra, 1, value ? 1 : 0);
+}
+
+/**
+ * @brief Get the value of a GPIO chip line.
+ * @param desc - The GPIO descriptor.
+ * @param value - The value.
+ *                Example: GPIO_HIGH
+ *                         GPIO_LOW
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t linux_gpiochip_get_value(struct gpio_desc *desc, uint8_t *value)
+{
+	uint64_t values;
+	int32_t ret;
+
+	ret = linux_gpio_bulk_get_values(desc->extra, 1, &values);
+	if (ret < 0)
+		return ret;
+
+	*value = (values & 1) ? GPIO_HIGH : GPIO_LOW;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Get the time left until a deadline.
+ * @param deadline - The deadline, on CLOCK_MONOTONIC.
+ * @return Time left in microseconds, 0 if the deadline passed.
+ */
+static uint32_t linux_gpio_time_left(const struct timespec *deadline)
+{
+	struct timespec now;
+	int64_t left_us;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	left_us = (int64_t)(deadline->tv_sec - now.tv_sec) * 1000000 +
+		  (deadline->tv_nsec - now.tv_nsec) / 1000;
+
+	return left_us > 0 ? left_us : 0;
+}
+
+/**
+ * @brief Wait for an edge of a GPIO chip input line.
+ * Sleeps on the line request until the kernel queues an edge event. Events
+ * of the other edge are consumed and ignored.
+ * @param desc - The GPIO descriptor.
+ * @param edge - The transition to wait for.
+ * @param timeout_us - Time left to wait, in microseconds, decreased by the
+ *		      time spent waiting.
+ * @return SUCCESS when the edge was seen, -ETIMEDOUT if it was not seen in
+ * time, negative error code otherwise.
+ */
+int32_t linux_gpiochip_wait_edge(struct gpio_desc *desc, enum gpio_edge edge,
+				 uint32_t *timeout_us)
+{
+	struct linux_gpio_bulk *bulk = desc->extra;
+	struct gpio_v2_line_event event;
+	struct timespec deadline;
+	struct pollfd pfd;
+	ssize_t len;
+	int ret;
+
+	if (!(bulk->flags & GPIO_V2_LINE_FLAG_INPUT))
+		return -EINVAL;
+
+	clock_gettime(CLOCK_MONOTONIC, &deadline);
+	deadline.tv_sec += *timeout_us / 1000000;
+	deadline.tv_nsec += (*timeout_us % 1000000) * 1000;
+	if (deadline.tv_nsec >= 1000000000) {
+		deadline.tv_sec++;
+		deadline.tv_nsec -= 1000000000;
+	}
+
+	pfd.fd = bulk->fd;
+	pfd.events = POLLIN;
+
+	while (true) {
+		*timeout_us = linux_gpio_time_left(&deadline);
+
+		/* A queued event wakes poll() right away, the rounding only
+		 * matters when timing out */
+		ret = poll(&pfd, 1, (int)((*timeout_us + 999ull) / 1000));
+		if (ret < 0) {
+			if (errno == EINTR)
+				continue;
+			return -errno;
+		}
+		if (!ret) {
+			*timeout_us = 0;
+			return -ETIMEDOUT;
+		}
+
+		len = read(bulk->fd, &event, sizeof(event));
+		if (len < 0) {
+			if (errno == EINTR)
+				continue;
+			return -errno;
+		}
+		if (len != sizeof(event))
+			return -EIO;
+
+		if (edge == GPIO_EDGE_BOTH ||
+		    (edge == GPIO_EDGE_RISING &&
+		     event.id == GPIO_V2_LINE_EVENT_RISING_EDGE) ||
+		    (edge == GPIO_EDGE_FALLING &&
+		     event.id == GPIO_V2_LINE_EVENT_FALLING_EDGE)) {
+			*timeout_us = linux_gpio_time_left(&deadline);
+			return SUCCESS;
+		}
+	}
+}
+
+/**
+ * @brief Linux platform specific GPIO character device platform ops structure
+ */
+const struct gpio_platform_ops linux_gpiochip_platform_ops = {
+	.gpio_ops_get = &linux_gpiochip_get,
+	.gpio_ops_get_optional = &linux_gpiochip_get_optional,
+	.gpio_ops_remove = &linux_gpiochip_remove,
+	.gpio_ops_direction_input = &linux_gpiochip_direction_input,
+	.gpio_ops_direction_output = &linux_gpiochip_direction_output,
+	.gpio_ops_get_direction = &linux_gpiochip_get_direction,
+	.gpio_ops_set_value = &linux_gpiochip_set_value,
+	.gpio_ops_get_value = &linux_gpiochip_get_value,
+	.gpio_ops_wait_edge = &linux_gpiochip_wait_edge,
+};
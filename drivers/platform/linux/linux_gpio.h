@@ -39,9 +39,50 @@
 #ifndef LINUX_GPIO_H_
 #define LINUX_GPIO_H_
 
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @struct linux_gpio_init_param
+ * @brief Linux GPIO character device specific initialization parameters.
+ * Used with linux_gpiochip_platform_ops, gpio_init_param.number is then the
+ * offset of the line in the chip.
+ */
+struct linux_gpio_init_param {
+	/** GPIO chip name (/dev/"chip"), for example "gpiochip0" */
+	const char *chip;
+};
+
+/**
+ * @struct linux_gpio_bulk
+ * @brief Lines of a GPIO chip requested together.
+ */
+struct linux_gpio_bulk;
+
 /**
- * @brief Linux specific GPIO platform ops structure
+ * @brief Linux specific GPIO platform ops structure (sysfs interface)
  */
 extern const struct gpio_platform_ops linux_gpio_platform_ops;
 
+/**
+ * @brief Linux specific GPIO platform ops structure (character device)
+ */
+extern const struct gpio_platform_ops linux_gpiochip_platform_ops;
+
+/* Request several lines of a GPIO chip. */
+int32_t linux_gpio_bulk_get(struct linux_gpio_bulk **bulk, const char *chip,
+			    const uint32_t *offsets, uint8_t nb_lines,
+			    bool output, uint64_t values);
+
+/* Release the lines requested by linux_gpio_bulk_get(). */
+int32_t linux_gpio_bulk_remove(struct linux_gpio_bulk *bulk);
+
+/* Set the value of several output lines at once. */
+int32_t linux_gpio_bulk_set_values(struct linux_gpio_bulk *bulk,
+				   uint64_t mask, uint64_t values);
+
+/* Get the value of several lines at once. */
+int32_t linux_gpio_bulk_get_values(struct linux_gpio_bulk *bulk,
+				   uint64_t mask, uint64_t *values);
+
 #endif // LINUX_GPIO_H_
@@ -49,7 +49,9 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <unistd.h>
+#include <errno.h>
 #include <sys/ioctl.h>
+#include <linux/i2c.h>
 #include <linux/i2c-dev.h>
 
 /******************************************************************************/
@@ -218,6 +220,46 @@ int32_t linux_i2c_read(struct i2c_desc *desc,
 	return SUCCESS;
 }
 
+/**
+ * @brief Run several reads and writes as a single transaction.
+ * All the messages are handed to the adapter in one I2C_RDWR ioctl, which
+ * issues a repeated start between them.
+ * @param desc - The I2C descriptor.
+ * @param msgs - Array of messages.
+ * @param len - Number of messages in the array.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t linux_i2c_transfer(struct i2c_desc *desc,
+			   struct i2c_transfer_msg *msgs,
+			   uint32_t len)
+{
+	struct i2c_msg linux_msgs[I2C_RDWR_IOCTL_MAX_MSGS];
+	struct i2c_rdwr_ioctl_data rdwr;
+	struct linux_i2c_desc *linux_desc;
+	uint32_t i;
+
+	if (len > I2C_RDWR_IOCTL_MAX_MSGS)
+		return -EINVAL;
+
+	linux_desc = desc->extra;
+
+	for (i = 0; i < len; i++) {
+		linux_msgs[i].addr = desc->slave_address;
+		linux_msgs[i].flags = msgs[i].read ? I2C_M_RD : 0;
+		linux_msgs[i].len = msgs[i].bytes_number;
+		linux_msgs[i].buf = msgs[i].buff;
+	}
+
+	rdwr.msgs = linux_msgs;
+	rdwr.nmsgs = len;
+	if (ioctl(linux_desc->fd, I2C_RDWR, &rdwr) < 0) {
+		printf("%s: Can't transfer\n\r", __func__);
+		return -errno;
+	}
+
+	return SUCCESS;
+}
+
 /**
  * @brief Linux platform specific I2C platform ops structure
  */
@@ -225,5 +267,6 @@ const struct i2c_platform_ops linux_i2c_platform_ops = {
 	.i2c_ops_init = &linux_i2c_init,
 	.i2c_ops_write = &linux_i2c_write,
 	.i2c_ops_read = &linux_i2c_read,
+	.i2c_ops_transfer = &linux_i2c_transfer,
 	.i2c_ops_remove = &linux_i2c_remove
 };
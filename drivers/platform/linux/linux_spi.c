@@ -49,9 +49,17 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <sys/ioctl.h>
+#include <string.h>
 #include <unistd.h>
 #include <linux/spi/spidev.h>
 
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/* Maximum number of messages packed in a single SPI_IOC_MESSAGE() ioctl. */
+#define LINUX_SPI_MAX_TRANSFERS	64
+
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
@@ -157,7 +165,7 @@ int32_t linux_spi_write_and_read(struct spi_desc *desc,
 	linux_desc = desc->extra;
 
 	ret = ioctl(linux_desc->spidev_fd, SPI_IOC_MESSAGE(1), &tr);
-	if (ret == 1) {
+	if (ret < 0) {
 		printf("%s: Can't send spi message\n\r", __func__);
 		return FAILURE;
 	}
@@ -165,6 +173,57 @@ int32_t linux_spi_write_and_read(struct spi_desc *desc,
 	return SUCCESS;
 }
 
+/**
+ * @brief Send a spi_msg array using as few SPI_IOC_MESSAGE() ioctls as possible.
+ * @param desc - The SPI descriptor.
+ * @param msgs - Array of messages.
+ * @param len - Number of messages in the array.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t linux_spi_transfer(struct spi_desc *desc, struct spi_msg *msgs,
+			   uint32_t len)
+{
+	struct spi_ioc_transfer tr[LINUX_SPI_MAX_TRANSFERS];
+	struct linux_spi_desc *linux_desc;
+	uint32_t i, n;
+	int ret;
+
+	if (!desc || !desc->extra || (len && !msgs))
+		return -EINVAL;
+
+	linux_desc = desc->extra;
+
+	while (len) {
+		n = len < LINUX_SPI_MAX_TRANSFERS ? len : LINUX_SPI_MAX_TRANSFERS;
+		memset(tr, 0, n * sizeof(*tr));
+
+		for (i = 0; i < n; i++) {
+			tr[i].tx_buf = (unsigned long)msgs[i].tx_buff;
+			tr[i].rx_buf = (unsigned long)msgs[i].rx_buff;
+			tr[i].len = msgs[i].bytes_number;
+			tr[i].speed_hz = msgs[i].speed_hz;
+			tr[i].bits_per_word = 8;
+			tr[i].cs_change = msgs[i].cs_change;
+		}
+		/*
+		 * spidev deasserts CS at the end of a message unless cs_change
+		 * is set on its last transfer.
+		 */
+		tr[n - 1].cs_change = !msgs[n - 1].cs_change;
+
+		ret = ioctl(linux_desc->spidev_fd, SPI_IOC_MESSAGE(n), tr);
+		if (ret < 0) {
+			printf("%s: Can't send spi message\n\r", __func__);
+			return FAILURE;
+		}
+
+		msgs += n;
+		len -= n;
+	}
+
+	return SUCCESS;
+}
+
 /**
  * @brief Free the resources allocated by linux_spi_init().
  * @param desc - The SPI descriptor.
@@ -195,5 +254,6 @@ int32_t linux_spi_remove(struct spi_desc *desc)
 const struct spi_platform_ops linux_spi_platform_ops = {
 	.init = &linux_spi_init,
 	.write_and_read = &linux_spi_write_and_read,
+	.transfer = &linux_spi_transfer,
 	.remove = &linux_spi_remove
 };
@@ -43,11 +43,16 @@
 #include "error.h"
 #include "uart.h"
 #include "linux_uart.h"
+#include "util.h"
 
+#include <errno.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <termios.h>
+#include <time.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
 
@@ -64,6 +69,18 @@ struct linux_uart_desc {
 	int fd;
 	/** structure containing the terminal flags/settings */
 	struct termios *terminal;
+	/** Maximum time a read waits for data, 0 waits forever */
+	uint32_t read_timeout_ms;
+	/** Maximum time a write waits for room, 0 waits forever */
+	uint32_t write_timeout_ms;
+	/** Bytes received but not yet returned by uart_read() */
+	uint8_t *rx_buf;
+	/** Size of rx_buf */
+	uint32_t rx_size;
+	/** Offset of the first unread byte in rx_buf */
+	uint32_t rx_off;
+	/** Number of unread bytes in rx_buf */
+	uint32_t rx_len;
 };
 
 /******************************************************************************/
@@ -104,19 +121,34 @@ int32_t uart_init(struct uart_desc **desc, struct uart_init_param *param)
 	descriptor->extra = linux_desc;
 	linux_init = param->extra;
 
+	linux_desc->read_timeout_ms = linux_init->read_timeout_ms;
+	linux_desc->write_timeout_ms = linux_init->write_timeout_ms;
+	linux_desc->rx_size = linux_init->rx_buffer_size ?
+			      linux_init->rx_buffer_size :
+			      LINUX_UART_RX_BUFFER_SIZE;
+	linux_desc->rx_off = 0;
+	linux_desc->rx_len = 0;
+	linux_desc->rx_buf = malloc(linux_desc->rx_size);
+	if (!linux_desc->rx_buf) {
+		ret = -ENOMEM;
+		goto free_terminal;
+	}
+
 	ret = snprintf(path, sizeof(path), "/dev/%s", linux_init->device_id);
 	if (ret < 0 || ret >= sizeof(path)) {
 		ret = -ENOMEM;
-		goto free_linux_desc;
+		goto free_rx_buf;
 	}
 
 	linux_desc->fd = open(path, O_RDWR | O_NOCTTY | O_NONBLOCK);
 	if (linux_desc->fd < 0) {
 		printf("%s: Can't open %s\n\r", __func__, path);
 		ret = -ENOENT;
-		goto free_terminal;
+		goto free_rx_buf;
 	}
 
+	/* The fd stays non-blocking: the waits are done in poll(), with the
+	 * timeouts, and read() and write() only move what is there. */
 	tcgetattr(linux_desc->fd, linux_desc->terminal);
 
 	cfmakeraw(linux_desc->terminal);
@@ -167,6 +199,15 @@ int32_t uart_init(struct uart_desc **desc, struct uart_init_param *param)
 	case 38400:
 		speed = B38400;
 		break;
+	case 57600:
+		speed = B57600;
+		break;
+	case 115200:
+		speed = B115200;
+		break;
+	case 230400:
+		speed = B230400;
+		break;
 	default:
 		ret = -EINVAL;
 		goto free;
@@ -226,6 +267,8 @@ int32_t uart_init(struct uart_desc **desc, struct uart_init_param *param)
 
 free:
 	close(linux_desc->fd);
+free_rx_buf:
+	free(linux_desc->rx_buf);
 free_terminal:
 	free(linux_desc->terminal);
 free_linux_desc:
@@ -252,32 +295,107 @@ int32_t uart_remove(struct uart_desc *desc)
 	if (ret < 0)
 		printf("%s: Can't close device\n\r", __func__);
 
+	free(linux_desc->rx_buf);
+	free(linux_desc->terminal);
 	free(desc->extra);
 	free(desc);
 
 	return SUCCESS;
 };
 
+/**
+ * @brief Compute the deadline of an operation.
+ * @param deadline - Where to store the deadline.
+ * @param timeout_ms - Timeout of the operation, 0 for none.
+ */
+static void linux_uart_deadline(struct timespec *deadline, uint32_t timeout_ms)
+{
+	if (!timeout_ms)
+		return;
+
+	clock_gettime(CLOCK_MONOTONIC, deadline);
+	deadline->tv_sec += timeout_ms / 1000;
+	deadline->tv_nsec += (timeout_ms % 1000) * 1000000;
+	if (deadline->tv_nsec >= 1000000000) {
+		deadline->tv_sec++;
+		deadline->tv_nsec -= 1000000000;
+	}
+}
+
+/**
+ * @brief Sleep until the tty is ready for an operation or the deadline passes.
+ * @param linux_desc - Linux UART descriptor.
+ * @param events - POLLIN or POLLOUT.
+ * @param deadline - Deadline computed by linux_uart_deadline().
+ * @param timeout_ms - Timeout of the operation, 0 for none.
+ * @return SUCCESS if the tty is ready, -ETIMEDOUT if the deadline passed,
+ * negative error code otherwise.
+ */
+static int32_t linux_uart_wait(struct linux_uart_desc *linux_desc,
+			       short events, const struct timespec *deadline,
+			       uint32_t timeout_ms)
+{
+	struct pollfd pfd;
+	struct timespec now;
+	int64_t left_ms = -1;
+	int ret;
+
+	pfd.fd = linux_desc->fd;
+	pfd.events = events;
+
+	do {
+		if (timeout_ms) {
+			clock_gettime(CLOCK_MONOTONIC, &now);
+			left_ms = (int64_t)(deadline->tv_sec - now.tv_sec) * 1000 +
+				  (deadline->tv_nsec - now.tv_nsec) / 1000000;
+			if (left_ms < 0)
+				left_ms = 0;
+		}
+		ret = poll(&pfd, 1, (int)left_ms);
+	} while (ret < 0 && errno == EINTR);
+
+	if (ret < 0)
+		return -errno;
+	if (!ret)
+		return -ETIMEDOUT;
+	if (pfd.revents & events)
+		return SUCCESS;
+
+	return -EIO;
+}
+
 /**
  * @brief Write data to UART device.
  * @param desc - Instance of UART.
  * @param data - Pointer to buffer containing data.
- * @param bytes_number - Number of bytes to read.
- * @return SUCCESS in case of success, FAILURE otherwise.
+ * @param bytes_number - Number of bytes to write.
+ * @return SUCCESS in case of success, -ETIMEDOUT if the data could not be
+ * written in time, negative error code otherwise.
  */
 int32_t uart_write(struct uart_desc *desc, const uint8_t *data,
 		   uint32_t bytes_number)
 {
 	struct linux_uart_desc *linux_desc;
-	ssize_t count = 0;
-	int32_t ret;
+	struct timespec deadline;
+	uint32_t count = 0;
+	ssize_t ret;
 
 	linux_desc = desc->extra;
+	linux_uart_deadline(&deadline, linux_desc->write_timeout_ms);
 
 	while (count < bytes_number) {
-		ret = write(linux_desc->fd, data, bytes_number);
-		if (ret > 0)
-			count += ret;
+		ret = linux_uart_wait(linux_desc, POLLOUT, &deadline,
+				      linux_desc->write_timeout_ms);
+		if (ret < 0)
+			return ret;
+
+		ret = write(linux_desc->fd, &data[count], bytes_number - count);
+		if (ret < 0) {
+			if (errno == EINTR || errno == EAGAIN)
+				continue;
+			return -errno;
+		}
+		count += ret;
 	}
 
 	return SUCCESS;
@@ -285,24 +403,63 @@ int32_t uart_write(struct uart_desc *desc, const uint8_t *data,
 
 /**
  * @brief Read data from UART device.
+ * Bytes are read from the tty in chunks of up to the receive buffer size and
+ * handed out from there, so small reads do not cost a system call each.
  * @param desc - Instance of UART.
  * @param data - Pointer to buffer containing data.
  * @param bytes_number - Number of bytes to read.
- * @return SUCCESS in case of success, FAILURE otherwise.
+ * @return SUCCESS in case of success, -ETIMEDOUT if the data did not arrive
+ * in time, negative error code otherwise.
  */
 int32_t uart_read(struct uart_desc *desc, uint8_t *data,
 		  uint32_t bytes_number)
 {
 	struct linux_uart_desc *linux_desc;
-	ssize_t count = 0;
+	struct timespec deadline;
+	uint32_t count = 0, len;
 	ssize_t ret;
 
 	linux_desc = desc->extra;
+	linux_uart_deadline(&deadline, linux_desc->read_timeout_ms);
 
 	while (count < bytes_number) {
-		ret = read(linux_desc->fd, &data[count], bytes_number - count);
-		if (ret > 0)
+		if (linux_desc->rx_len) {
+			len = min(linux_desc->rx_len, bytes_number - count);
+			memcpy(&data[count],
+			       &linux_desc->rx_buf[linux_desc->rx_off], len);
+			linux_desc->rx_off += len;
+			linux_desc->rx_len -= len;
+			count += len;
+			continue;
+		}
+
+		ret = linux_uart_wait(linux_desc, POLLIN, &deadline,
+				      linux_desc->read_timeout_ms);
+		if (ret < 0)
+			return ret;
+
+		/* Large reads go straight to the caller's buffer */
+		len = bytes_number - count;
+		if (len >= linux_desc->rx_size)
+			ret = read(linux_desc->fd, &data[count], len);
+		else
+			ret = read(linux_desc->fd, linux_desc->rx_buf,
+				   linux_desc->rx_size);
+		if (ret < 0) {
+			if (errno == EINTR || errno == EAGAIN)
+				continue;
+			return -errno;
+		}
+		/* Nothing to read although poll() said so, e.g. on hangup */
+		if (!ret)
+			return -ETIMEDOUT;
+
+		if (len >= linux_desc->rx_size) {
 			count += ret;
+		} else {
+			linux_desc->rx_off = 0;
+			linux_desc->rx_len = ret;
+		}
 	}
 
 	return SUCCESS;
@@ -39,6 +39,11 @@
 #ifndef LINUX_UART_H_
 #define LINUX_UART_H_
 
+#include <stdint.h>
+
+/** Default size of the buffer the received bytes are read into */
+#define LINUX_UART_RX_BUFFER_SIZE	256
+
 /**
  * @struct linux_uart_init_param
  * @brief Structure holding the initialization parameters for Linux platform
@@ -47,6 +52,12 @@
 struct linux_uart_init_param {
 	/** UART device ID (/dev/"device_id") */
 	const char *device_id;
+	/** Maximum time a uart_read() waits for data, 0 waits forever */
+	uint32_t read_timeout_ms;
+	/** Maximum time a uart_write() waits for room, 0 waits forever */
+	uint32_t write_timeout_ms;
+	/** Size of the receive buffer, 0 selects LINUX_UART_RX_BUFFER_SIZE */
+	uint32_t rx_buffer_size;
 };
 
 #endif // LINUX_UART_H_
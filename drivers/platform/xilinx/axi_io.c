@@ -77,3 +77,54 @@ int32_t axi_io_write(uint32_t base, uint32_t offset, uint32_t data)
 	return SUCCESS;
 }
 
+/**
+ * @brief AXI IO Xilinx specific burst read function.
+ * @param base - Base address
+ * @param offset - Address offset of the first register
+ * @param data - variable where returned data is stored
+ * @param count - number of consecutive 32-bit registers to read
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t axi_io_read_burst(uint32_t base, uint32_t offset, uint32_t *data,
+			  uint32_t count)
+{
+	uint32_t i;
+
+	for (i = 0; i < count; i++)
+		data[i] = Xil_In32(base + offset + i * 4);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief AXI IO Xilinx specific burst write function.
+ * @param base - Base address
+ * @param offset - Address offset of the first register
+ * @param data - data to be written
+ * @param count - number of consecutive 32-bit registers to write
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t axi_io_write_burst(uint32_t base, uint32_t offset,
+			   const uint32_t *data, uint32_t count)
+{
+	uint32_t i;
+
+	for (i = 0; i < count; i++)
+		Xil_Out32(base + offset + i * 4, data[i]);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Wait for the interrupt of an AXI core.
+ * The interrupts are delivered through the interrupt controller driver on
+ * this platform.
+ * @param base - Base address
+ * @param timeout_us - Time left to wait, in microseconds, decreased by the
+ *		      time spent waiting
+ * @return -ENOTSUP, the caller has to rely on its interrupt handler.
+ */
+int32_t axi_io_wait_irq(uint32_t base, uint32_t *timeout_us)
+{
+	return -ENOTSUP;
+}
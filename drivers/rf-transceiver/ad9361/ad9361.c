@@ -684,6 +684,125 @@ const char *ad9361_ensm_states[] = {
 	"rx", "rx_flush", "fdd", "fdd_flush"
 };
 
+#define AD9361_REGCACHE_QUEUE_SIZE	64
+
+#define regcache_test(map, reg)		((map)[(reg) >> 3] & (1 << ((reg) & 7)))
+#define regcache_set(map, reg)		((map)[(reg) >> 3] |= (1 << ((reg) & 7)))
+#define regcache_clear(map, reg)	((map)[(reg) >> 3] &= ~(1 << ((reg) & 7)))
+
+/* Registers changed by the device itself (status, readback, calibration
+ * results, self-clearing controls), never served from the cache. */
+static const struct {
+	uint16_t start;
+	uint16_t end;
+} ad9361_volatile_regs[] = {
+	{REG_SPI_CONF, REG_SPI_CONF},
+	{REG_START_TEMP_READING, REG_TEMPERATURE},
+	{REG_CALIBRATION_CTRL, REG_STATE},
+	{REG_AUXADC_WORD_MSB, REG_AUXADC_LSB},
+	{REG_PRODUCT_ID, REG_PRODUCT_ID},
+	{REG_CH_1_OVERFLOW, REG_CH_2_OVERFLOW},
+	{REG_TX_FILTER_COEF_READ_DATA_1, REG_TX_FILTER_COEF_READ_DATA_2},
+	{REG_TX_RSSI1, REG_TX_RSSI_LSB},
+	{REG_TX1_OUT_1_PHASE_CORR, REG_TX2_OUT_2_OFFSET_Q},
+	{REG_QUAD_CAL_STATUS_TX1, REG_QUAD_CAL_STATUS_TX2},
+	{REG_RX_FILTER_COEF_READ_DATA_1, REG_RX_FILTER_COEF_READ_DATA_2},
+	{REG_LMT_OVERLOAD_COUNTERS, REG_DIGITAL_SAT_COUNTER},
+	{REG_GAIN_TABLE_READ_DATA1, REG_GAIN_TABLE_READ_DATA3},
+	{REG_GM_SUB_TABLE_GAIN_READ, REG_GM_SUB_TABLE_CTRL_READ},
+	{REG_GAIN_ERROR_READ, REG_GAIN_ERROR_READ},
+	{REG_LNA_GAIN_DIFF_READ_BACK, REG_LNA_GAIN_DIFF_READ_BACK},
+	{REG_CH1_ADC_POWER, REG_CH2_RX_FILTER_POWER},
+	{REG_RX1_INPUT_A_PHASE_CORR, REG_RX2_INPUT_BC_I_OFFSET},
+	{REG_RX1_BB_DC_WORD_I_MSB, REG_RX_PATH_GAIN_LSB},
+	{REG_INPUT_A_MSBS, REG_INPUTS_BC_MSBS},
+	{REG_RX_CAL_STATUS, REG_RX_CAL_STATUS},
+	{REG_RX_CP_OVERRANGE_VCO_LOCK, REG_RX_CP_OVERRANGE_VCO_LOCK},
+	{REG_RX_FAST_LOCK_PROGRAM_READ, REG_RX_FAST_LOCK_PROGRAM_READ},
+	{REG_TX_CAL_STATUS, REG_TX_CAL_STATUS},
+	{REG_TX_CP_OVERRANGE_VCO_LOCK, REG_TX_CP_OVERRANGE_VCO_LOCK},
+	{REG_DCXO_TEMPCO_READ, REG_DCXO_TEMPCO_READ},
+	{REG_DELTA_T_READ, REG_DELTA_T_READ},
+	{REG_TX_FAST_LOCK_PROGRAM_READ, REG_TX_FAST_LOCK_PROGRAM_READ},
+	{REG_GAIN_RX1, REG_OVRG_SIGS_RX2},
+};
+
+/**
+ * Check if a register is volatile.
+ * @param reg The register address.
+ * @return true if the register can't be cached, false otherwise.
+ */
+static bool ad9361_reg_is_volatile(uint32_t reg)
+{
+	uint32_t i;
+
+	for (i = 0; i < ARRAY_SIZE(ad9361_volatile_regs); i++)
+		if (reg >= ad9361_volatile_regs[i].start &&
+		    reg <= ad9361_volatile_regs[i].end)
+			return true;
+
+	return false;
+}
+
+/**
+ * Get the device using a SPI descriptor.
+ * @param spi
+ * @return The device or NULL if the descriptor wasn't registered.
+ */
+static inline struct ad9361_rf_phy *ad9361_spi_to_phy(struct spi_desc *spi)
+{
+	return spi ? (struct ad9361_rf_phy *)spi->drv_data : NULL;
+}
+
+/**
+ * Header of a multiple bytes register write, used by the write queue.
+ * @param hdr The header buffer.
+ * @param addr The register address.
+ * @param count The number of bytes to write.
+ */
+static void ad9361_spi_write_header(uint8_t *hdr, uint32_t addr,
+				    uint32_t count)
+{
+	uint16_t cmd;
+
+	cmd = AD_WRITE | AD_CNT(count) | AD_ADDR(addr);
+	hdr[0] = cmd >> 8;
+	hdr[1] = cmd & 0xFF;
+}
+
+/**
+ * Write all the dirty registers to the device.
+ * @param phy The AD9361 state structure.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+static int32_t ad9361_regcache_flush(struct ad9361_rf_phy *phy)
+{
+	struct ad9361_regcache *cache = phy->regcache;
+	uint32_t burst = 0;
+	int32_t reg;
+	int32_t ret;
+
+	/* Descending order, so that consecutive registers are streamed. */
+	for (reg = AD9361_NUM_REGS - 1; reg >= 0; reg--) {
+		if (!regcache_test(cache->dirty, reg)) {
+			burst = 0;
+			continue;
+		}
+		ret = spi_wr_queue_push(cache->wr_queue, reg, cache->val[reg]);
+		if (ret < 0)
+			return ret;
+		regcache_clear(cache->dirty, reg);
+
+		if (!burst)
+			phy->spi_stats.bytes += 2;
+		burst = (burst + 1) % MAX_MBYTE_SPI;
+		phy->spi_stats.writes++;
+		phy->spi_stats.bytes++;
+	}
+
+	return spi_wr_queue_flush(cache->wr_queue);
+}
+
 /**
  * SPI multiple bytes register read.
  * @param spi
@@ -695,16 +814,40 @@ const char *ad9361_ensm_states[] = {
 int32_t ad9361_spi_readm(struct spi_desc *spi, uint32_t reg,
 			 uint8_t *rbuf, uint32_t num)
 {
+	struct ad9361_regcache *cache = NULL;
+	struct ad9361_rf_phy *phy;
+	uint8_t rbuffer[MAX_MBYTE_SPI + 2];
 	int32_t ret = 0;
+	uint32_t i, r;
 	uint16_t cmd;
-	uint8_t *rbuffer;
 	if (num > MAX_MBYTE_SPI)
 		return -EINVAL;
 
+	phy = ad9361_spi_to_phy(spi);
+	if (phy)
+		cache = phy->regcache;
+	if (cache) {
+		for (i = 0; i < num; i++) {
+			r = AD_ADDR(reg - i);
+			if (ad9361_reg_is_volatile(r) ||
+			    !regcache_test(cache->valid, r))
+				break;
+			rbuf[i] = cache->val[r];
+		}
+		if (i == num) {
+			phy->spi_stats.cached_reads++;
+			return 0;
+		}
+
+		/* Status may depend on the pending writes. */
+		if (cache->cache_only) {
+			ret = ad9361_regcache_flush(phy);
+			if (ret < 0)
+				return ret;
+		}
+	}
+
 	cmd = AD_READ | AD_CNT(num) | AD_ADDR(reg);
-	rbuffer = malloc(num + 2);
-	if(!rbuffer)
-		return -ENOMEM;
 	rbuffer[0] = cmd >> 8;
 	rbuffer[1] = cmd & 0xFF;
 	ret = spi_write_and_read(spi, &rbuffer[0], 2 + num);
@@ -714,7 +857,20 @@ int32_t ad9361_spi_readm(struct spi_desc *spi, uint32_t reg,
 	else
 		memcpy(rbuf, &rbuffer[2], num);
 
-	free(rbuffer);
+	if (phy) {
+		phy->spi_stats.reads++;
+		phy->spi_stats.bytes += 2 + num;
+	}
+
+	if (cache && ret >= 0) {
+		for (i = 0; i < num; i++) {
+			r = AD_ADDR(reg - i);
+			if (ad9361_reg_is_volatile(r))
+				continue;
+			cache->val[r] = rbuf[i];
+			regcache_set(cache->valid, r);
+		}
+	}
 #ifdef _DEBUG
 	{
 		int32_t i;
@@ -792,9 +948,31 @@ static int32_t __ad9361_spi_readf(struct spi_desc *spi, uint32_t reg,
 int32_t ad9361_spi_write(struct spi_desc *spi,
 			 uint32_t reg, uint32_t val)
 {
+	struct ad9361_regcache *cache = NULL;
+	struct ad9361_rf_phy *phy;
 	uint8_t buf[3];
 	int32_t ret;
 	uint16_t cmd;
+	uint32_t r = AD_ADDR(reg);
+
+	phy = ad9361_spi_to_phy(spi);
+	if (phy)
+		cache = phy->regcache;
+	if (cache) {
+		if (!ad9361_reg_is_volatile(r)) {
+			cache->val[r] = val;
+			regcache_set(cache->valid, r);
+			if (cache->cache_only) {
+				regcache_set(cache->dirty, r);
+				return 0;
+			}
+		} else if (cache->cache_only) {
+			/* Keep the write order around volatile registers. */
+			ret = ad9361_regcache_flush(phy);
+			if (ret < 0)
+				return ret;
+		}
+	}
 
 	cmd = AD_WRITE | AD_CNT(1) | AD_ADDR(reg);
 	buf[0] = cmd >> 8;
@@ -802,8 +980,14 @@ int32_t ad9361_spi_write(struct spi_desc *spi,
 	buf[2] = val;
 
 	ret = spi_write_and_read(spi, buf, 3);
+	if (phy) {
+		phy->spi_stats.writes++;
+		phy->spi_stats.bytes += 3;
+	}
 	if (ret < 0) {
 		dev_err(&spi->dev, "Write Error %"PRId32, ret);
+		if (cache)
+			regcache_clear(cache->valid, r);
 		return ret;
 	}
 
@@ -864,13 +1048,34 @@ static int32_t __ad9361_spi_writef(struct spi_desc *spi, uint32_t reg,
 static int32_t ad9361_spi_writem(struct spi_desc *spi,
 				 uint32_t reg, uint8_t *tbuf, uint32_t num)
 {
-	uint8_t buf[10];
+	struct ad9361_regcache *cache = NULL;
+	struct ad9361_rf_phy *phy;
+	uint8_t buf[MAX_MBYTE_SPI + 2];
 	int32_t ret;
+	uint32_t i, r;
 	uint16_t cmd;
 
 	if (num > MAX_MBYTE_SPI)
 		return -EINVAL;
 
+	phy = ad9361_spi_to_phy(spi);
+	if (phy)
+		cache = phy->regcache;
+	if (cache) {
+		if (cache->cache_only) {
+			ret = ad9361_regcache_flush(phy);
+			if (ret < 0)
+				return ret;
+		}
+		for (i = 0; i < num; i++) {
+			r = AD_ADDR(reg - i);
+			if (ad9361_reg_is_volatile(r))
+				continue;
+			cache->val[r] = tbuf[i];
+			regcache_set(cache->valid, r);
+		}
+	}
+
 	cmd = AD_WRITE | AD_CNT(num) | AD_ADDR(reg);
 	buf[0] = cmd >> 8;
 	buf[1] = cmd & 0xFF;
@@ -878,13 +1083,19 @@ static int32_t ad9361_spi_writem(struct spi_desc *spi,
 #ifndef ALTERA_PLATFORM
 	memcpy(&buf[2], tbuf, num);
 #else
-	int32_t i;
 	for (i = 0; i < num; i++)
 		buf[2 + i] =  tbuf[i];
 #endif
 	ret = spi_write_and_read(spi, buf, num + 2);
+	if (phy) {
+		phy->spi_stats.writes += num;
+		phy->spi_stats.bytes += 2 + num;
+	}
 	if (ret < 0) {
 		dev_err(&spi->dev, "Write Error %"PRId32, ret);
+		if (cache)
+			for (i = 0; i < num; i++)
+				regcache_clear(cache->valid, AD_ADDR(reg - i));
 		return ret;
 	}
 
@@ -1002,6 +1213,144 @@ int32_t ad9361_1rx1tx_channel_map(struct ad9361_rf_phy *phy, bool tx,
 	return channel;
 }
 
+/**
+ * Attach the device to its SPI descriptor, so that the register accessors
+ * can update the SPI statistics and use the register cache.
+ * @param phy The AD9361 state structure.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_spi_register(struct ad9361_rf_phy *phy)
+{
+	if (!phy->spi)
+		return -EINVAL;
+
+	phy->spi->drv_data = phy;
+
+	return 0;
+}
+
+/**
+ * Detach the device from its SPI descriptor.
+ * @param phy The AD9361 state structure.
+ * @return None.
+ */
+void ad9361_spi_unregister(struct ad9361_rf_phy *phy)
+{
+	if (phy->spi && phy->spi->drv_data == phy)
+		phy->spi->drv_data = NULL;
+}
+
+/**
+ * Enable the register cache of the device.
+ *
+ * Reads of non-volatile registers are served from RAM once the registers were
+ * read or written. Register writes are still sent to the device, unless
+ * cache-only mode is enabled with ad9361_regcache_cache_only().
+ * @param phy The AD9361 state structure.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_regcache_init(struct ad9361_rf_phy *phy)
+{
+	struct spi_wr_queue_init_param wr_queue_param;
+	struct ad9361_regcache *cache;
+	int32_t ret;
+
+	if (phy->regcache)
+		return 0;
+
+	cache = (struct ad9361_regcache *)zmalloc(sizeof(*cache));
+	if (!cache)
+		return -ENOMEM;
+
+	wr_queue_param.spi = phy->spi;
+	wr_queue_param.max_entries = AD9361_REGCACHE_QUEUE_SIZE;
+	wr_queue_param.max_burst = MAX_MBYTE_SPI;
+	wr_queue_param.addr_step = -1;
+	wr_queue_param.hdr_len = 2;
+	wr_queue_param.build_header = ad9361_spi_write_header;
+	ret = spi_wr_queue_init(&cache->wr_queue, &wr_queue_param);
+	if (ret < 0) {
+		free(cache);
+		return ret;
+	}
+
+	phy->regcache = cache;
+
+	return ad9361_spi_register(phy);
+}
+
+/**
+ * Write back the dirty registers and disable the register cache.
+ * @param phy The AD9361 state structure.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_regcache_remove(struct ad9361_rf_phy *phy)
+{
+	struct ad9361_regcache *cache = phy->regcache;
+	int32_t ret;
+
+	if (!cache)
+		return 0;
+
+	ret = ad9361_regcache_flush(phy);
+
+	spi_wr_queue_remove(cache->wr_queue);
+	free(cache);
+	phy->regcache = NULL;
+
+	return ret;
+}
+
+/**
+ * Enable/disable the cache-only mode.
+ *
+ * In cache-only mode the writes of non-volatile registers only update the
+ * cache, so that successive bitfield updates of a register are coalesced.
+ * The dirty registers are written by ad9361_regcache_sync(), when leaving
+ * cache-only mode and before any access to a volatile register.
+ * @param phy The AD9361 state structure.
+ * @param enable Enable/disable option.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_regcache_cache_only(struct ad9361_rf_phy *phy, bool enable)
+{
+	if (!phy->regcache)
+		return -EINVAL;
+
+	phy->regcache->cache_only = enable;
+	if (!enable)
+		return ad9361_regcache_flush(phy);
+
+	return 0;
+}
+
+/**
+ * Write the dirty registers to the device.
+ * @param phy The AD9361 state structure.
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad9361_regcache_sync(struct ad9361_rf_phy *phy)
+{
+	if (!phy->regcache)
+		return 0;
+
+	return ad9361_regcache_flush(phy);
+}
+
+/**
+ * Drop all the cached values, e.g. after the device was reset.
+ * @param phy The AD9361 state structure.
+ * @return None.
+ */
+void ad9361_regcache_invalidate(struct ad9361_rf_phy *phy)
+{
+	if (!phy->regcache)
+		return;
+
+	memset(phy->regcache->valid, 0, sizeof(phy->regcache->valid));
+	memset(phy->regcache->dirty, 0, sizeof(phy->regcache->dirty));
+}
+
 /**
  * AD9361 Device Reset
  * @param phy The AD9361 state structure.
@@ -1014,6 +1363,7 @@ int32_t ad9361_reset(struct ad9361_rf_phy *phy)
 		mdelay(1);
 		gpio_set_value(phy->gpio_desc_resetb, 1);
 		mdelay(1);
+		ad9361_regcache_invalidate(phy);
 		dev_dbg(&phy->spi->dev, "%s: by GPIO", __func__);
 		return 0;
 	}
@@ -1025,6 +1375,7 @@ int32_t ad9361_reset(struct ad9361_rf_phy *phy)
 
 	ad9361_spi_write(phy->spi, REG_SPI_CONF, SOFT_RESET | _SOFT_RESET);
 	ad9361_spi_write(phy->spi, REG_SPI_CONF, 0x0);
+	ad9361_regcache_invalidate(phy);
 	dev_err(&phy->spi->dev,
 		"%s: by SPI, this may cause unpredicted behavior!", __func__);
 
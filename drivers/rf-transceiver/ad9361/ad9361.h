@@ -2848,6 +2848,7 @@
 #define MAX_BASEBAND_RATE		61440000UL
 
 #define MAX_MBYTE_SPI			8
+#define AD9361_NUM_REGS			0x400
 
 #define RFPLL_MODULUS			8388593UL
 #define BBPLL_MODULUS			2088960UL
@@ -3337,6 +3338,13 @@ enum dev_id {
 	ID_AD9363A
 };
 
+struct ad9361_spi_stats {
+	uint32_t	reads;		/* SPI read transactions */
+	uint32_t	cached_reads;	/* reads served by the register cache */
+	uint32_t	writes;		/* registers written */
+	uint64_t	bytes;		/* bytes on the bus, instructions included */
+};
+
 struct ad9361_rf_phy {
 	enum dev_id		dev_sel;
 	uint8_t 		id_no;
@@ -3416,6 +3424,8 @@ struct ad9361_rf_phy {
 	uint32_t				bist_tone_level_dB;
 	uint32_t				bist_tone_mask;
 	bool			bbpll_initialized;
+	struct ad9361_regcache	*regcache;
+	struct ad9361_spi_stats	spi_stats;
 };
 
 struct refclk_scale {
@@ -3427,6 +3437,14 @@ struct refclk_scale {
 	enum ad9361_clocks 	parent_source;
 };
 
+struct ad9361_regcache {
+	struct spi_wr_queue	*wr_queue;
+	bool			cache_only;
+	uint8_t			val[AD9361_NUM_REGS];
+	uint8_t			valid[AD9361_NUM_REGS / 8];
+	uint8_t			dirty[AD9361_NUM_REGS / 8];
+};
+
 enum debugfs_cmd {
 	DBGFS_NONE,
 	DBGFS_INIT,
@@ -3446,6 +3464,13 @@ int32_t ad9361_spi_readm(struct spi_desc *spi, uint32_t reg,
 int32_t ad9361_spi_read(struct spi_desc *spi, uint32_t reg);
 int32_t ad9361_spi_write(struct spi_desc *spi,
 			 uint32_t reg, uint32_t val);
+int32_t ad9361_spi_register(struct ad9361_rf_phy *phy);
+void ad9361_spi_unregister(struct ad9361_rf_phy *phy);
+int32_t ad9361_regcache_init(struct ad9361_rf_phy *phy);
+int32_t ad9361_regcache_remove(struct ad9361_rf_phy *phy);
+int32_t ad9361_regcache_cache_only(struct ad9361_rf_phy *phy, bool enable);
+int32_t ad9361_regcache_sync(struct ad9361_rf_phy *phy);
+void ad9361_regcache_invalidate(struct ad9361_rf_phy *phy);
 int32_t ad9361_reset(struct ad9361_rf_phy *phy);
 int32_t ad9361_register_clocks(struct ad9361_rf_phy *phy);
 int32_t ad9361_unregister_clocks(struct ad9361_rf_phy *phy);
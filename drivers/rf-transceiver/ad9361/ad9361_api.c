@@ -493,6 +493,7 @@ int32_t ad9361_init (struct ad9361_rf_phy **ad9361_phy,
 	gpio_direction_output(phy->gpio_desc_resetb, 0);
 
 	spi_init(&phy->spi, &init_param->spi_param);
+	ad9361_spi_register(phy);
 
 	phy->pdata->port_ctrl.digital_io_ctrl = 0;
 	phy->pdata->port_ctrl.lvds_invert[0] = init_param->lvds_invert1_control;
@@ -569,6 +570,7 @@ int32_t ad9361_init (struct ad9361_rf_phy **ad9361_phy,
 out_clk:
 	ad9361_unregister_clocks(phy);
 out:
+	ad9361_spi_unregister(phy);
 #ifndef AXI_ADC_NOT_PRESENT
 	free(phy->adc_conv);
 	free(phy->adc_state);
@@ -588,6 +590,8 @@ out:
  */
 int32_t ad9361_remove(struct ad9361_rf_phy *phy)
 {
+	ad9361_regcache_remove(phy);
+	ad9361_spi_unregister(phy);
 	ad9361_unregister_clocks(phy);
 	spi_remove(phy->spi);
 	gpio_remove(phy->gpio_desc_resetb);
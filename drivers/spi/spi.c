@@ -58,6 +58,7 @@ int32_t spi_init(struct spi_desc **desc,
 		return FAILURE;
 
 	(*desc)->platform_ops = param->platform_ops;
+	(*desc)->drv_data = NULL;
 
 	return SUCCESS;
 }
@@ -115,3 +116,151 @@ int32_t spi_transfer(struct spi_desc *desc, struct spi_msg *msgs, uint32_t len)
 
 	return ret;
 }
+
+/**
+ * @brief Initialize a register write queue.
+ * @param queue - The queue descriptor.
+ * @param param - The structure that contains the queue parameters.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t spi_wr_queue_init(struct spi_wr_queue **queue,
+			  const struct spi_wr_queue_init_param *param)
+{
+	struct spi_wr_queue *q;
+
+	if (!queue || !param || !param->spi || !param->build_header ||
+	    !param->max_entries || !param->max_burst || !param->hdr_len)
+		return -EINVAL;
+
+	/* Bursts of consecutive registers need the streaming address step */
+	if (param->max_burst > 1 && param->addr_step != 1 &&
+	    param->addr_step != -1)
+		return -EINVAL;
+
+	q = (struct spi_wr_queue *)calloc(1, sizeof(*q));
+	if (!q)
+		return -ENOMEM;
+
+	q->spi = param->spi;
+	q->max_entries = param->max_entries;
+	q->max_burst = param->max_burst;
+	q->addr_step = param->addr_step;
+	q->hdr_len = param->hdr_len;
+	q->build_header = param->build_header;
+
+	/* Worst case, every message is a full burst. */
+	q->buff = (uint8_t *)calloc(q->max_entries, q->hdr_len + q->max_burst);
+	if (!q->buff)
+		goto free_queue;
+
+	q->msgs = (struct spi_msg *)calloc(q->max_entries, sizeof(*q->msgs));
+	if (!q->msgs)
+		goto free_buff;
+
+	*queue = q;
+
+	return SUCCESS;
+
+free_buff:
+	free(q->buff);
+free_queue:
+	free(q);
+
+	return -ENOMEM;
+}
+
+/**
+ * @brief Free the resources allocated by spi_wr_queue_init().
+ * @param queue - The queue descriptor.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t spi_wr_queue_remove(struct spi_wr_queue *queue)
+{
+	if (!queue)
+		return -EINVAL;
+
+	free(queue->msgs);
+	free(queue->buff);
+	free(queue);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Send all the queued register writes with a single spi_transfer().
+ * @param queue - The queue descriptor.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t spi_wr_queue_flush(struct spi_wr_queue *queue)
+{
+	int32_t ret;
+
+	if (!queue)
+		return -EINVAL;
+
+	if (!queue->n_msgs)
+		return SUCCESS;
+
+	ret = spi_transfer(queue->spi, queue->msgs, queue->n_msgs);
+
+	queue->n_msgs = 0;
+	queue->buff_len = 0;
+
+	return ret;
+}
+
+/**
+ * @brief Queue a register write.
+ *
+ * Writes to the register following the previous one (as defined by addr_step)
+ * are merged in the previous instruction, up to max_burst bytes. The queue is
+ * flushed when it is full.
+ * @param queue - The queue descriptor.
+ * @param addr - Register address.
+ * @param val - Register value.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t spi_wr_queue_push(struct spi_wr_queue *queue, uint32_t addr,
+			  uint8_t val)
+{
+	struct spi_msg *msg;
+	uint32_t count;
+	int32_t ret;
+
+	if (!queue)
+		return -EINVAL;
+
+	if (queue->n_msgs) {
+		msg = &queue->msgs[queue->n_msgs - 1];
+		count = msg->bytes_number - queue->hdr_len;
+		if (queue->max_burst > 1 && count < queue->max_burst &&
+		    addr == queue->last_addr + queue->addr_step) {
+			msg->tx_buff[msg->bytes_number++] = val;
+			queue->buff_len++;
+			queue->build_header(msg->tx_buff, queue->last_start,
+					    count + 1);
+			queue->last_addr = addr;
+
+			return SUCCESS;
+		}
+	}
+
+	if (queue->n_msgs == queue->max_entries) {
+		ret = spi_wr_queue_flush(queue);
+		if (IS_ERR_VALUE(ret))
+			return ret;
+	}
+
+	msg = &queue->msgs[queue->n_msgs++];
+	msg->tx_buff = &queue->buff[queue->buff_len];
+	msg->rx_buff = msg->tx_buff;
+	msg->bytes_number = queue->hdr_len + 1;
+	msg->cs_change = 1;
+	queue->build_header(msg->tx_buff, addr, 1);
+	msg->tx_buff[queue->hdr_len] = val;
+	queue->buff_len += msg->bytes_number;
+	queue->last_start = addr;
+	queue->last_addr = addr;
+
+	return SUCCESS;
+}
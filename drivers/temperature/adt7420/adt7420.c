@@ -56,18 +56,46 @@ uint8_t adt7420_get_register_value(struct adt7420_dev *dev,
 {
 	uint8_t register_value = 0;
 
-	i2c_write(dev->i2c_desc,
-		  &register_address,
-		  1,
-		  0);
-	i2c_read(dev->i2c_desc,
-		 &register_value,
-		 1,
-		 1);
+	adt7420_get_register_values(dev, register_address, &register_value, 1);
 
 	return register_value;
 }
 
+/***************************************************************************//**
+ * @brief Reads consecutive registers in a single I2C transaction.
+ *
+ * The address pointer write and the data read are separated by a repeated
+ * start and the pointer auto-increments, so multi-byte results such as the
+ * temperature are read coherently.
+ *
+ * @param dev              - The device structure.
+ * @param register_address - Address of the first register.
+ * @param data             - Where to store the register values.
+ * @param bytes_number     - Number of registers to read.
+ *
+ * @return SUCCESS in case of success, negative error code otherwise.
+*******************************************************************************/
+int32_t adt7420_get_register_values(struct adt7420_dev *dev,
+				    uint8_t register_address,
+				    uint8_t *data,
+				    uint8_t bytes_number)
+{
+	struct i2c_transfer_msg msgs[2] = {
+		{
+			.buff = &register_address,
+			.bytes_number = 1,
+			.read = false,
+		},
+		{
+			.buff = data,
+			.bytes_number = bytes_number,
+			.read = true,
+		},
+	};
+
+	return i2c_transfer(dev->i2c_desc, msgs, 2);
+}
+
 /***************************************************************************//**
  * @brief Sets the value of a register.
  *
@@ -223,14 +251,13 @@ void adt7420_set_resolution(struct adt7420_dev *dev,
 *******************************************************************************/
 float adt7420_get_temperature(struct adt7420_dev *dev)
 {
-	uint8_t msb_temp = 0;
-	uint8_t lsb_temp = 0;
+	uint8_t data[2] = {0, 0};
 	uint16_t temp = 0;
 	float temp_c = 0;
 
-	msb_temp = adt7420_get_register_value(dev, ADT7420_REG_TEMP_MSB);
-	lsb_temp = adt7420_get_register_value(dev, ADT7420_REG_TEMP_LSB);
-	temp    = ((uint16_t)msb_temp << 8) + lsb_temp;
+	/* MSB and LSB from the same conversion */
+	adt7420_get_register_values(dev, ADT7420_REG_TEMP_MSB, data, 2);
+	temp    = ((uint16_t)data[0] << 8) + data[1];
 	if(dev->resolution_setting) {
 		if(temp & 0x8000)
 			/*! Negative temperature */
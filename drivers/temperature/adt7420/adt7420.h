@@ -124,6 +124,12 @@ struct adt7420_init_param {
 uint8_t adt7420_get_register_value(struct adt7420_dev *dev,
 				   uint8_t register_address);
 
+/*! Reads consecutive registers in a single I2C transaction. */
+int32_t adt7420_get_register_values(struct adt7420_dev *dev,
+				    uint8_t register_address,
+				    uint8_t *data,
+				    uint8_t bytes_number);
+
 /*! Sets the value of a register. */
 void adt7420_set_register_value(struct adt7420_dev *dev,
 				uint8_t register_address,
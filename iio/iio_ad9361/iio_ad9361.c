@@ -1917,6 +1917,7 @@ struct iio_attribute voltage_output_attributes[] = {
 		.name = "rf_port_select",
 		.show = get_rf_port_select,
 		.store = set_rf_port_select,
+		.cache = IIO_ATTR_CACHED,
 	},
 	{
 		.name = "hardwaregain",
@@ -1932,36 +1933,43 @@ struct iio_attribute voltage_output_attributes[] = {
 		.name = "hardwaregain_available",
 		.show = get_hardwaregain_available,
 		.store = set_hardwaregain_available,
+		.cache = IIO_ATTR_CACHED,
 	},
 	{
 		.name = "sampling_frequency_available",
 		.show = get_sampling_frequency_available,
 		.store = set_sampling_frequency_available,
+		.cache = IIO_ATTR_CACHED,
 	},
 	{
 		.name = "rf_port_select_available",
 		.show = get_rf_port_select_available,
 		.store = set_rf_port_select_available,
+		.cache = IIO_ATTR_STATIC,
 	},
 	{
 		.name = "filter_fir_en",
 		.show = get_filter_fir_en,
 		.store = set_filter_fir_en,
+		.cache = IIO_ATTR_CACHED,
 	},
 	{
 		.name = "sampling_frequency",
 		.show = get_sampling_frequency,
 		.store = set_sampling_frequency,
+		.cache = IIO_ATTR_CACHED,
 	},
 	{
 		.name = "rf_bandwidth_available",
 		.show = get_rf_bandwidth_available,
 		.store = set_rf_bandwidth_available,
+		.cache = IIO_ATTR_STATIC,
 	},
 	{
 		.name = "rf_bandwidth",
 		.show = get_rf_bandwidth,
 		.store = set_rf_bandwidth,
+		.cache = IIO_ATTR_CACHED,
 	},
 	END_ATTRIBUTES_ARRAY
 };
@@ -1971,6 +1979,7 @@ struct iio_attribute voltage_input_attributes[] = {
 		.name = "hardwaregain_available",
 		.show = get_hardwaregain_available,
 		.store = set_hardwaregain_available,
+		.cache = IIO_ATTR_CACHED,
 	},
 	{
 		.name = "hardwaregain",
@@ -1986,61 +1995,73 @@ struct iio_attribute voltage_input_attributes[] = {
 		.name = "rf_port_select",
 		.show = get_rf_port_select,
 		.store = set_rf_port_select,
+		.cache = IIO_ATTR_CACHED,
 	},
 	{
 		.name = "gain_control_mode",
 		.show = get_gain_control_mode,
 		.store = set_gain_control_mode,
+		.cache = IIO_ATTR_CACHED,
 	},
 	{
 		.name = "rf_port_select_available",
 		.show = get_rf_port_select_available,
 		.store = set_rf_port_select_available,
+		.cache = IIO_ATTR_STATIC,
 	},
 	{
 		.name = "rf_bandwidth",
 		.show = get_rf_bandwidth,
 		.store = set_rf_bandwidth,
+		.cache = IIO_ATTR_CACHED,
 	},
 	{
 		.name = "rf_dc_offset_tracking_en",
 		.show = get_rf_dc_offset_tracking_en,
 		.store = set_rf_dc_offset_tracking_en,
+		.cache = IIO_ATTR_CACHED,
 	},
 	{
 		.name = "sampling_frequency_available",
 		.show = get_sampling_frequency_available,
 		.store = set_sampling_frequency_available,
+		.cache = IIO_ATTR_CACHED,
 	},
 	{
 		.name = "quadrature_tracking_en",
 		.show = get_quadrature_tracking_en,
 		.store = set_quadrature_tracking_en,
+		.cache = IIO_ATTR_CACHED,
 	},
 	{
 		.name = "sampling_frequency",
 		.show = get_sampling_frequency,
 		.store = set_sampling_frequency,
+		.cache = IIO_ATTR_CACHED,
 	},
 	{
 		.name = "gain_control_mode_available",
 		.show = get_gain_control_mode_available,
 		.store = set_gain_control_mode_available,
+		.cache = IIO_ATTR_STATIC,
 	},
 	{
 		.name = "filter_fir_en",
 		.show = get_filter_fir_en,
 		.store = set_filter_fir_en,
+		.cache = IIO_ATTR_CACHED,
 	},
 	{
 		.name = "rf_bandwidth_available",
 		.show = get_rf_bandwidth_available,
 		.store = set_rf_bandwidth_available,
+		.cache = IIO_ATTR_STATIC,
 	},
 	{
 		.name = "bb_dc_offset_tracking_en",
 		.show = get_bb_dc_offset_tracking_en,
 		.store = set_bb_dc_offset_tracking_en,
+		.cache = IIO_ATTR_CACHED,
 	},
 	END_ATTRIBUTES_ARRAY
 };
@@ -2050,6 +2071,7 @@ struct iio_attribute altvoltage_attributes[] = {
 		.name = "frequency_available",
 		.show = get_frequency_available,
 		.store = set_frequency_available,
+		.cache = IIO_ATTR_STATIC,
 	},
 	{
 		.name = "fastlock_save",
@@ -2060,6 +2082,7 @@ struct iio_attribute altvoltage_attributes[] = {
 		.name = "powerdown",
 		.show = get_powerdown,
 		.store = set_powerdown,
+		.cache = IIO_ATTR_CACHED,
 	},
 	{
 		.name = "fastlock_load",
@@ -2075,11 +2098,13 @@ struct iio_attribute altvoltage_attributes[] = {
 		.name = "frequency",
 		.show = get_frequency,
 		.store = set_frequency,
+		.cache = IIO_ATTR_CACHED,
 	},
 	{
 		.name = "external",
 		.show = get_external,
 		.store = set_external,
+		.cache = IIO_ATTR_CACHED,
 	},
 	{
 		.name = "fastlock_recall",
@@ -2094,6 +2119,7 @@ struct iio_attribute out_attributes[] = {
 		.name = "voltage_filter_fir_en",
 		.show = get_voltage_filter_fir_en,
 		.store = set_voltage_filter_fir_en,
+		.cache = IIO_ATTR_CACHED,
 	},
 	END_ATTRIBUTES_ARRAY,
 };
@@ -2112,46 +2138,55 @@ static struct iio_attribute global_attributes[] = {
 		.name = "dcxo_tune_coarse",
 		.show = get_dcxo_tune_coarse,
 		.store = set_dcxo_tune_coarse,
+		.cache = IIO_ATTR_CACHED,
 	},
 	{
 		.name = "rx_path_rates",
 		.show = get_rx_path_rates,
 		.store = NULL,
+		.cache = IIO_ATTR_CACHED,
 	},
 	{
 		.name = "trx_rate_governor",
 		.show = get_trx_rate_governor,
 		.store = set_trx_rate_governor,
+		.cache = IIO_ATTR_CACHED,
 	},
 	{
 		.name = "calib_mode_available",
 		.show = get_calib_mode_available,
 		.store = NULL,
+		.cache = IIO_ATTR_STATIC,
 	},
 	{
 		.name = "xo_correction_available",
 		.show = get_xo_correction_available,
 		.store = NULL,
+		.cache = IIO_ATTR_STATIC,
 	},
 	{
 		.name = "gain_table_config",
 		.show = get_gain_table_config,
 		.store = NULL,
+		.cache = IIO_ATTR_CACHED,
 	},
 	{
 		.name = "dcxo_tune_fine",
 		.show = get_dcxo_tune_fine,
 		.store = set_dcxo_tune_fine,
+		.cache = IIO_ATTR_CACHED,
 	},
 	{
 		.name = "dcxo_tune_fine_available",
 		.show = get_dcxo_tune_fine_available,
 		.store = NULL,
+		.cache = IIO_ATTR_STATIC,
 	},
 	{
 		.name = "ensm_mode_available",
 		.show = get_ensm_mode_available,
 		.store = NULL,
+		.cache = IIO_ATTR_STATIC,
 	},
 	{
 		.name = "multichip_sync",
@@ -2167,21 +2202,25 @@ static struct iio_attribute global_attributes[] = {
 		.name = "dcxo_tune_coarse_available",
 		.show = get_dcxo_tune_coarse_available,
 		.store = NULL,
+		.cache = IIO_ATTR_STATIC,
 	},
 	{
 		.name = "tx_path_rates",
 		.show = get_tx_path_rates,
 		.store = NULL,
+		.cache = IIO_ATTR_CACHED,
 	},
 	{
 		.name = "trx_rate_governor_available",
 		.show = get_trx_rate_governor_available,
 		.store = NULL,
+		.cache = IIO_ATTR_STATIC,
 	},
 	{
 		.name = "xo_correction",
 		.show = get_xo_correction,
 		.store = NULL,
+		.cache = IIO_ATTR_CACHED,
 	},
 	{
 		.name = "ensm_mode",
@@ -2192,11 +2231,13 @@ static struct iio_attribute global_attributes[] = {
 		.name = "filter_fir_config",
 		.show = get_filter_fir_config,
 		.store = set_filter_fir_config,
+		.cache = IIO_ATTR_CACHED,
 	},
 	{
 		.name = "calib_mode",
 		.show = get_calib_mode,
 		.store = set_calib_mode,
+		.cache = IIO_ATTR_CACHED,
 	},
 	END_ATTRIBUTES_ARRAY,
 };
@@ -65,6 +65,12 @@
 #include "tcp_socket.h"
 #endif
 
+#ifdef IIO_CONTEXT_XML
+/* Generated with tools/scripts/iio_xml2c.py */
+extern const char iio_context_xml[];
+extern const uint32_t iio_context_xml_size;
+#endif
+
 // The default baudrate iio_app will use to print messages to console.
 #define UART_BAUDRATE_DEFAULT	115200
 
@@ -101,7 +107,7 @@ int32_t iio_app_run(struct iio_app_device *devices, int32_t len)
 	int32_t			status;
 	char message[512];
 	struct iio_desc		*iio_desc;
-	struct iio_init_param	iio_init_param;
+	struct iio_init_param	iio_init_param = { 0 };
 	struct uart_init_param	uart_init_par;
 #if defined(ADUCM_PLATFORM) || defined(XILINX_PLATFORM)
 	struct irq_init_param	irq_init_param;
@@ -269,6 +275,11 @@ int32_t iio_app_run(struct iio_app_device *devices, int32_t len)
 	iio_init_param.uart_desc = uart_desc;
 #endif//USE_TCP_SOCKET
 
+#ifdef IIO_CONTEXT_XML
+	iio_init_param.xml = iio_context_xml;
+	iio_init_param.xml_size = iio_context_xml_size;
+#endif
+
 	status = iio_init(&iio_desc, &iio_init_param);
 	if(status < 0)
 		goto error;
@@ -45,6 +45,7 @@
 
 #include <inttypes.h>
 #include <stdlib.h>
+#include <string.h>
 #include "error.h"
 #include "iio.h"
 #include "iio_axi_adc.h"
@@ -54,6 +55,8 @@
 /******************************************************************************/
 
 #define STORAGE_BITS 16
+/* The DMAC tracks at most 4 transfer IDs at a time */
+#define STREAM_MAX_QUEUED 4
 
 /**
  * @brief get_cf_calibphase().
@@ -299,6 +302,60 @@ static ssize_t set_sampling_frequency(void *device, char *buf, size_t len,
 }
 
 
+/**
+ * @brief Get the number of streaming overruns.
+ * @param device - Physical instance of a iio_axi_adc_desc device.
+ * @param buf - Where value is stored.
+ * @param len - Maximum length of value to be stored in buf.
+ * @param channel - Channel properties.
+ * @return Length of chars written in buf, or negative value on failure.
+ */
+static ssize_t get_stream_overruns(void *device, char *buf, size_t len,
+				   const struct iio_ch_info *channel,
+				   intptr_t priv)
+{
+	struct iio_axi_adc_desc *iio_adc = (struct iio_axi_adc_desc *)device;
+
+	return snprintf(buf, len, "%"PRIu32"", iio_adc->stream.overruns);
+}
+
+/**
+ * @brief Get the number of blocks captured in streaming mode.
+ * @param device - Physical instance of a iio_axi_adc_desc device.
+ * @param buf - Where value is stored.
+ * @param len - Maximum length of value to be stored in buf.
+ * @param channel - Channel properties.
+ * @return Length of chars written in buf, or negative value on failure.
+ */
+static ssize_t get_stream_blocks(void *device, char *buf, size_t len,
+				 const struct iio_ch_info *channel,
+				 intptr_t priv)
+{
+	struct iio_axi_adc_desc *iio_adc = (struct iio_axi_adc_desc *)device;
+
+	return snprintf(buf, len, "%"PRIu32"", iio_adc->stream.blocks);
+}
+
+/**
+ * @brief Reset the streaming counters, the written value is ignored.
+ * @param device - Physical instance of a iio_axi_adc_desc device.
+ * @param buf - Value to be written to attribute.
+ * @param len - Length of the data in "buf".
+ * @param channel - Channel properties.
+ * @return Number of bytes written to device, or negative value on failure.
+ */
+static ssize_t set_stream_counters(void *device, char *buf, size_t len,
+				   const struct iio_ch_info *channel,
+				   intptr_t priv)
+{
+	struct iio_axi_adc_desc *iio_adc = (struct iio_axi_adc_desc *)device;
+
+	iio_adc->stream.overruns = 0;
+	iio_adc->stream.blocks = 0;
+
+	return len;
+}
+
 /**
  * List containing attributes, corresponding to "voltage" channels.
  */
@@ -331,6 +388,180 @@ static struct iio_attribute iio_voltage_attributes[] = {
 	END_ATTRIBUTES_ARRAY
 };
 
+/**
+ * List containing buffer attributes, used in streaming mode.
+ */
+static struct iio_attribute iio_stream_attributes[] = {
+	{
+		.name = "overruns",
+		.show = get_stream_overruns,
+		.store = set_stream_counters,
+	},
+	{
+		.name = "blocks",
+		.show = get_stream_blocks,
+		.store = set_stream_counters,
+	},
+	END_ATTRIBUTES_ARRAY
+};
+
+/**
+ * @brief Get the address of a streaming buffer.
+ * @param stream - Streaming state.
+ * @param idx - Buffer index.
+ * @return Address of the buffer.
+ */
+static inline uint32_t iio_axi_adc_stream_addr(struct iio_axi_adc_stream
+		*stream, uint32_t idx)
+{
+	return stream->buffer_addr + idx * stream->buffer_stride;
+}
+
+/**
+ * @brief Check whether the DMA transfer of a streaming buffer is done.
+ * @param iio_adc - Instance of the iio_axi_adc.
+ * @param idx - Buffer index.
+ * @return true if the buffer was filled, false otherwise.
+ */
+static bool iio_axi_adc_stream_done(struct iio_axi_adc_desc *iio_adc,
+				    uint32_t idx)
+{
+	uint32_t reg_val;
+
+	axi_dmac_read(iio_adc->dmac, AXI_DMAC_REG_TRANSFER_DONE, &reg_val);
+
+	return reg_val & BIT(iio_adc->stream.transfer_id[idx]);
+}
+
+/**
+ * @brief Stop the DMA and drop the buffers in flight.
+ * @param iio_adc - Instance of the iio_axi_adc.
+ * @return None.
+ */
+static void iio_axi_adc_stream_stop(struct iio_axi_adc_desc *iio_adc)
+{
+	if (iio_adc->stream.block_size)
+		axi_dmac_write(iio_adc->dmac, AXI_DMAC_REG_CTRL, 0x0);
+
+	iio_adc->stream.block_size = 0;
+	iio_adc->stream.tail = 0;
+	iio_adc->stream.pending = 0;
+	iio_adc->stream.held = false;
+}
+
+/**
+ * @brief Queue free streaming buffers to the DMA, as many as it accepts.
+ * @param iio_adc - Instance of the iio_axi_adc.
+ * @return SUCCESS if at least a buffer is in flight, FAILURE otherwise.
+ */
+static int32_t iio_axi_adc_stream_fill(struct iio_axi_adc_desc *iio_adc)
+{
+	struct iio_axi_adc_stream *stream = &iio_adc->stream;
+	uint32_t idx, id;
+	int32_t ret;
+
+	while (stream->pending < stream->nb_buffers &&
+	       stream->pending < STREAM_MAX_QUEUED) {
+		idx = (stream->tail + stream->pending) % stream->nb_buffers;
+		axi_dmac_read(iio_adc->dmac, AXI_DMAC_REG_TRANSFER_ID, &id);
+		ret = axi_dmac_transfer_nonblocking(iio_adc->dmac,
+						    iio_axi_adc_stream_addr(stream, idx),
+						    stream->block_size);
+		/* The previous submission was not taken by the DMA yet */
+		if (ret < 0)
+			break;
+		stream->transfer_id[idx] = id;
+		stream->pending++;
+	}
+
+	return stream->pending ? SUCCESS : FAILURE;
+}
+
+/**
+ * @brief Give the buffer lent by iio_axi_adc_stream_get() back to the DMA.
+ * @param iio_adc - Instance of the iio_axi_adc.
+ * @return None.
+ */
+static void iio_axi_adc_stream_release(struct iio_axi_adc_desc *iio_adc)
+{
+	struct iio_axi_adc_stream *stream = &iio_adc->stream;
+
+	if (!stream->held)
+		return;
+
+	stream->held = false;
+	stream->tail = (stream->tail + 1) % stream->nb_buffers;
+	stream->pending--;
+}
+
+/**
+ * @brief Wait for the oldest streaming buffer and lend it to the caller.
+ * The following buffers stay queued to the DMA, so the converter keeps being
+ * captured while this block is sent. The buffer is given back to the DMA by
+ * the next call or by iio_axi_adc_stream_release().
+ * @param iio_adc - Instance of the iio_axi_adc.
+ * @param bytes - Size of the block.
+ * @param addr - Address of the filled buffer.
+ * @return SUCCESS in case of success or negative value otherwise.
+ */
+static int32_t iio_axi_adc_stream_get(struct iio_axi_adc_desc *iio_adc,
+				      uint32_t bytes, uint32_t *addr)
+{
+	struct iio_axi_adc_stream *stream = &iio_adc->stream;
+	uint32_t last, timeout = AXI_DMAC_TIMEOUT_US;
+	int32_t ret;
+
+	if (bytes != stream->block_size) {
+		iio_axi_adc_stream_stop(iio_adc);
+		if (bytes > stream->buffer_stride)
+			return -ENOMEM;
+		stream->block_size = bytes;
+		iio_adc->dmac->flags = 0;
+	} else {
+		iio_axi_adc_stream_release(iio_adc);
+		/* All the queued buffers got filled, the DMA stalled */
+		last = (stream->tail + stream->pending - 1) % stream->nb_buffers;
+		if (stream->pending && iio_axi_adc_stream_done(iio_adc, last))
+			stream->overruns++;
+	}
+
+	ret = iio_axi_adc_stream_fill(iio_adc);
+	if (ret < 0)
+		return ret;
+
+	while (!iio_axi_adc_stream_done(iio_adc, stream->tail)) {
+		ret = axi_dmac_wait_event(iio_adc->dmac, &timeout);
+		if (ret < 0)
+			return ret;
+		/* Keep topping up the DMA queue while waiting */
+		iio_axi_adc_stream_fill(iio_adc);
+	}
+
+	*addr = iio_axi_adc_stream_addr(stream, stream->tail);
+	if (iio_adc->dcache_invalidate_range)
+		iio_adc->dcache_invalidate_range(*addr, bytes);
+
+	stream->held = true;
+	stream->blocks++;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Check whether a read of the given size is served by the stream.
+ * Blocks bigger than a DMA transfer are split by the DMA interrupt, which
+ * handles one transfer at a time.
+ * @param iio_adc - Instance of the iio_axi_adc.
+ * @param bytes - Size of the block.
+ * @return true if the block is read from the streaming buffers.
+ */
+static bool iio_axi_adc_stream_fits(struct iio_axi_adc_desc *iio_adc,
+				    uint32_t bytes)
+{
+	return iio_adc->stream.nb_buffers &&
+	       bytes - 1 <= iio_adc->dmac->transfer_max_size;
+}
+
 /**
  * @brief Update active channels
  * @param dev - Instance of the iio_axi_adc
@@ -341,6 +572,7 @@ int32_t iio_axi_adc_prepare_transfer(void *dev, uint32_t mask)
 {
 	struct iio_axi_adc_desc *iio_adc = dev;
 
+	iio_axi_adc_stream_stop(iio_adc);
 	iio_adc->mask = mask;
 
 	return axi_adc_update_active_channels(iio_adc->adc, mask);
@@ -357,6 +589,7 @@ int32_t	iio_axi_adc_read_dev(void *dev, void *buff, uint32_t nb_samples)
 {
 	struct iio_axi_adc_desc *iio_adc;
 	ssize_t ret, bytes;
+	uint32_t addr;
 
 	if (!dev)
 		return FAILURE;
@@ -364,6 +597,18 @@ int32_t	iio_axi_adc_read_dev(void *dev, void *buff, uint32_t nb_samples)
 	iio_adc = (struct iio_axi_adc_desc *)dev;
 	bytes = nb_samples * hweight8(iio_adc->mask) * (STORAGE_BITS / 8);
 
+	if (iio_axi_adc_stream_fits(iio_adc, bytes)) {
+		ret = iio_axi_adc_stream_get(iio_adc, bytes, &addr);
+		if (ret < 0)
+			return ret;
+		memcpy(buff, (void *)(uintptr_t)addr, bytes);
+		iio_axi_adc_stream_release(iio_adc);
+
+		/* Give the buffer back to the DMA */
+		return iio_axi_adc_stream_fill(iio_adc);
+	}
+
+	iio_axi_adc_stream_stop(iio_adc);
 	iio_adc->dmac->flags = 0;
 	ret = axi_dmac_transfer(iio_adc->dmac, (uint32_t)buff, bytes);
 	if (ret < 0)
@@ -375,6 +620,55 @@ int32_t	iio_axi_adc_read_dev(void *dev, void *buff, uint32_t nb_samples)
 	return SUCCESS;
 }
 
+/**
+ * @brief Read samples without copying them out of the DMA buffer.
+ * The block is left in the streaming buffer the DMA wrote it to, which is
+ * lent to the caller until the next read or the end of the transfer.
+ * @param dev - Instance of the iio_axi_adc
+ * @param buff - Set to the address of the samples.
+ * @param nb_samples - Number of samples
+ * @return SUCCESS in case of success, -ENOTSUP if the block does not fit in
+ * a streaming buffer and must be read with iio_axi_adc_read_dev(), negative
+ * value otherwise.
+ */
+int32_t iio_axi_adc_read_dev_zc(void *dev, void **buff, uint32_t nb_samples)
+{
+	struct iio_axi_adc_desc *iio_adc;
+	uint32_t bytes, addr;
+	int32_t ret;
+
+	if (!dev)
+		return FAILURE;
+
+	iio_adc = (struct iio_axi_adc_desc *)dev;
+	bytes = nb_samples * hweight8(iio_adc->mask) * (STORAGE_BITS / 8);
+	if (!iio_axi_adc_stream_fits(iio_adc, bytes))
+		return -ENOTSUP;
+
+	ret = iio_axi_adc_stream_get(iio_adc, bytes, &addr);
+	if (ret < 0)
+		return ret;
+
+	*buff = (void *)(uintptr_t)addr;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Stop the streaming capture.
+ * @param dev - Instance of the iio_axi_adc
+ * @return SUCCESS in case of success or negative value otherwise.
+ */
+int32_t iio_axi_adc_end_transfer(void *dev)
+{
+	if (!dev)
+		return FAILURE;
+
+	iio_axi_adc_stream_stop(dev);
+
+	return SUCCESS;
+}
+
 /**
  * @brief Delete iio_device.
  * @param iio_device - Structure describing a device, channels and attributes.
@@ -425,6 +719,8 @@ static int32_t iio_axi_adc_create_device_descriptor(
 
 	iio_device->num_ch = desc->adc->num_channels;
 	iio_device->attributes = NULL; /* no device attribute */
+	if (desc->stream.nb_buffers)
+		iio_device->buffer_attributes = iio_stream_attributes;
 	iio_device->channels = calloc(iio_device->num_ch,
 				      sizeof(struct iio_channel));
 	if (!iio_device->channels)
@@ -446,6 +742,9 @@ static int32_t iio_axi_adc_create_device_descriptor(
 
 	iio_device->prepare_transfer = iio_axi_adc_prepare_transfer;
 	iio_device->read_dev = iio_axi_adc_read_dev;
+	if (desc->stream.nb_buffers)
+		iio_device->read_dev_zc = iio_axi_adc_read_dev_zc;
+	iio_device->end_transfer = iio_axi_adc_end_transfer;
 
 	return SUCCESS;
 error:
@@ -477,7 +776,7 @@ int32_t iio_axi_adc_init(struct iio_axi_adc_desc **desc,
 			 struct iio_axi_adc_init_param *init)
 {
 	struct iio_axi_adc_desc *iio_axi_adc_inst;
-
+	uint32_t stride;
 	int32_t status;
 
 	if (!init)
@@ -496,9 +795,29 @@ int32_t iio_axi_adc_init(struct iio_axi_adc_desc **desc,
 	iio_axi_adc_inst->dcache_invalidate_range = init->dcache_invalidate_range;
 	iio_axi_adc_inst->get_sampling_frequency = init->get_sampling_frequency;
 
+	if (init->stream_nb_buffers > 1) {
+		/* Every buffer starts on a DMA beat and holds at least one */
+		stride = ALIGN_DOWN(init->stream_buffer_size /
+				    init->stream_nb_buffers, init->rx_dmac->width);
+		if (!stride || init->stream_buffer_addr % init->rx_dmac->width) {
+			free(iio_axi_adc_inst);
+			return FAILURE;
+		}
+		iio_axi_adc_inst->stream.transfer_id = calloc(init->stream_nb_buffers,
+						       sizeof(uint32_t));
+		if (!iio_axi_adc_inst->stream.transfer_id) {
+			free(iio_axi_adc_inst);
+			return FAILURE;
+		}
+		iio_axi_adc_inst->stream.nb_buffers = init->stream_nb_buffers;
+		iio_axi_adc_inst->stream.buffer_addr = init->stream_buffer_addr;
+		iio_axi_adc_inst->stream.buffer_stride = stride;
+	}
+
 	status = iio_axi_adc_create_device_descriptor(iio_axi_adc_inst,
 			&iio_axi_adc_inst->dev_descriptor);
 	if (IS_ERR_VALUE(status)) {
+		free(iio_axi_adc_inst->stream.transfer_id);
 		free(iio_axi_adc_inst);
 		return status;
 	}
@@ -520,10 +839,13 @@ int32_t iio_axi_adc_remove(struct iio_axi_adc_desc *desc)
 	if (!desc)
 		return FAILURE;
 
+	iio_axi_adc_stream_stop(desc);
+
 	status = iio_axi_adc_delete_device_descriptor(desc);
 	if (status < 0)
 		return status;
 
+	free(desc->stream.transfer_id);
 	free(desc);
 
 	return SUCCESS;
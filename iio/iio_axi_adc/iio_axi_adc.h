@@ -52,6 +52,35 @@
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
 
+/**
+ * @struct iio_axi_adc_stream
+ * @brief State of the streaming capture, the DMA keeps filling the next
+ * buffers while the oldest one is handed to the client.
+ */
+struct iio_axi_adc_stream {
+	/** Number of DMA buffers, 0 if streaming is disabled */
+	uint32_t nb_buffers;
+	/** Start address of the memory split between the DMA buffers */
+	uint32_t buffer_addr;
+	/** Distance in bytes between two DMA buffers */
+	uint32_t buffer_stride;
+	/** Size of a block, 0 while the stream is stopped */
+	uint32_t block_size;
+	/** Oldest submitted buffer */
+	uint32_t tail;
+	/** Number of submitted buffers not yet handed to the client */
+	uint32_t pending;
+	/** Set while the tail buffer is lent to the IIO layer, it is given back
+	 * to the DMA on the next read */
+	bool held;
+	/** DMAC transfer ID of each buffer */
+	uint32_t *transfer_id;
+	/** Number of times the DMA ran out of buffers and samples were lost */
+	uint32_t overruns;
+	/** Number of blocks handed to the client */
+	uint32_t blocks;
+};
+
 /**
  * @struct iio_axi_adc_desc
  * @brief iio_axi_adc_descriptor
@@ -72,6 +101,8 @@ struct iio_axi_adc_desc {
 	struct iio_device dev_descriptor;
 	/** Channel names */
 	char (*ch_names)[20];
+	/** Streaming capture state */
+	struct iio_axi_adc_stream stream;
 };
 
 /**
@@ -88,6 +119,15 @@ struct iio_axi_adc_init_param {
 	/** Custom sampling frequency getter */
 	int (*get_sampling_frequency)(struct axi_adc *dev, uint32_t chan,
 				      uint64_t *sampling_freq_hz);
+	/** Number of DMA buffers used for streaming capture. With less than
+	 * two buffers every read is a single blocking DMA transfer. */
+	uint32_t stream_nb_buffers;
+	/** Start address of the memory split between the streaming buffers */
+	uint32_t stream_buffer_addr;
+	/** Size in bytes of the memory split between the streaming buffers.
+	 * Each buffer gets an equal share, rounded down to the DMA width; the
+	 * address must be aligned to it. */
+	uint32_t stream_buffer_size;
 };
 
 /******************************************************************************/
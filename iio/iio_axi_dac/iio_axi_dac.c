@@ -54,6 +54,8 @@
 /******************************************************************************/
 
 #define STORAGE_BITS 16
+/* The DMAC tracks at most 4 transfer IDs at a time */
+#define STREAM_MAX_QUEUED 4
 
 /**
  * @brief get_dds_calibscale().
@@ -404,6 +406,60 @@ static ssize_t set_altvoltage_sampling_frequency(void *device, char *buf,
 	return -ENOENT;
 }
 
+/**
+ * @brief Get the number of streaming underruns.
+ * @param device - Physical instance of a iio_axi_dac_desc device.
+ * @param buf - Where value is stored.
+ * @param len - Maximum length of value to be stored in buf.
+ * @param channel - Channel properties.
+ * @return Length of chars written in buf, or negative value on failure.
+ */
+static ssize_t get_stream_underruns(void *device, char *buf, size_t len,
+				    const struct iio_ch_info *channel,
+				    intptr_t priv)
+{
+	struct iio_axi_dac_desc *iio_dac = (struct iio_axi_dac_desc *)device;
+
+	return snprintf(buf, len, "%"PRIu32"", iio_dac->stream.underruns);
+}
+
+/**
+ * @brief Get the number of blocks played in streaming mode.
+ * @param device - Physical instance of a iio_axi_dac_desc device.
+ * @param buf - Where value is stored.
+ * @param len - Maximum length of value to be stored in buf.
+ * @param channel - Channel properties.
+ * @return Length of chars written in buf, or negative value on failure.
+ */
+static ssize_t get_stream_blocks(void *device, char *buf, size_t len,
+				 const struct iio_ch_info *channel,
+				 intptr_t priv)
+{
+	struct iio_axi_dac_desc *iio_dac = (struct iio_axi_dac_desc *)device;
+
+	return snprintf(buf, len, "%"PRIu32"", iio_dac->stream.blocks);
+}
+
+/**
+ * @brief Reset the streaming counters, the written value is ignored.
+ * @param device - Physical instance of a iio_axi_dac_desc device.
+ * @param buf - Value to be written to attribute.
+ * @param len - Length of the data in "buf".
+ * @param channel - Channel properties.
+ * @return Number of bytes written to device, or negative value on failure.
+ */
+static ssize_t set_stream_counters(void *device, char *buf, size_t len,
+				   const struct iio_ch_info *channel,
+				   intptr_t priv)
+{
+	struct iio_axi_dac_desc *iio_dac = (struct iio_axi_dac_desc *)device;
+
+	iio_dac->stream.underruns = 0;
+	iio_dac->stream.blocks = 0;
+
+	return len;
+}
+
 /**
  * List containing attributes, corresponding to "voltage" channels.
  */
@@ -458,6 +514,157 @@ static struct iio_attribute iio_altvoltage_attributes[] = {
 	END_ATTRIBUTES_ARRAY,
 };
 
+/**
+ * List containing buffer attributes, used in streaming mode.
+ */
+static struct iio_attribute iio_stream_attributes[] = {
+	{
+		.name = "underruns",
+		.show = get_stream_underruns,
+		.store = set_stream_counters,
+	},
+	{
+		.name = "blocks",
+		.show = get_stream_blocks,
+		.store = set_stream_counters,
+	},
+	END_ATTRIBUTES_ARRAY
+};
+
+/**
+ * @brief Get the address of a streaming buffer.
+ * @param stream - Streaming state.
+ * @param idx - Buffer index.
+ * @return Address of the buffer.
+ */
+static inline uint32_t iio_axi_dac_stream_addr(struct iio_axi_dac_stream
+		*stream, uint32_t idx)
+{
+	return stream->buffer_addr + idx * stream->buffer_stride;
+}
+
+/**
+ * @brief Check whether the DMA transfer of a streaming buffer is done.
+ * @param iio_dac - Instance of the iio_axi_dac.
+ * @param idx - Buffer index.
+ * @return true if the buffer was played out, false otherwise.
+ */
+static bool iio_axi_dac_stream_done(struct iio_axi_dac_desc *iio_dac,
+				    uint32_t idx)
+{
+	uint32_t reg_val;
+
+	axi_dmac_read(iio_dac->dmac, AXI_DMAC_REG_TRANSFER_DONE, &reg_val);
+
+	return reg_val & BIT(iio_dac->stream.transfer_id[idx]);
+}
+
+/**
+ * @brief Stop the DMA and drop the buffers in flight.
+ * The DMA is stopped even when no streaming block is pending, so a cyclic
+ * transfer left running does not hold back the next opened buffer.
+ * @param iio_dac - Instance of the iio_axi_dac.
+ * @return None.
+ */
+static void iio_axi_dac_stream_stop(struct iio_axi_dac_desc *iio_dac)
+{
+	axi_dmac_write(iio_dac->dmac, AXI_DMAC_REG_CTRL, 0x0);
+
+	iio_dac->stream.tail = 0;
+	iio_dac->stream.pending = 0;
+	iio_dac->stream.blocks = 0;
+}
+
+/**
+ * @brief Take back the streaming buffers that were played out.
+ * @param iio_dac - Instance of the iio_axi_dac.
+ * @return None.
+ */
+static void iio_axi_dac_stream_reclaim(struct iio_axi_dac_desc *iio_dac)
+{
+	struct iio_axi_dac_stream *stream = &iio_dac->stream;
+
+	while (stream->pending && iio_axi_dac_stream_done(iio_dac, stream->tail)) {
+		stream->tail = (stream->tail + 1) % stream->nb_buffers;
+		stream->pending--;
+	}
+}
+
+/**
+ * @brief Queue a block to the DMA behind the blocks still being played.
+ * The call only waits when all the streaming buffers are in flight, so the
+ * client can send the next block while the previous ones are played out.
+ * @param iio_dac - Instance of the iio_axi_dac.
+ * @param buff - Block to be played.
+ * @param bytes - Size of the block.
+ * @return SUCCESS in case of success or negative value otherwise.
+ */
+static int32_t iio_axi_dac_stream_write(struct iio_axi_dac_desc *iio_dac,
+					void *buff, uint32_t bytes)
+{
+	struct iio_axi_dac_stream *stream = &iio_dac->stream;
+	uint32_t addr, idx, id, timeout = AXI_DMAC_TIMEOUT_US;
+	int32_t ret;
+
+	if (bytes > stream->buffer_stride)
+		return -ENOMEM;
+
+	iio_axi_dac_stream_reclaim(iio_dac);
+	/* Everything queued was played before this block arrived */
+	if (stream->blocks && !stream->pending)
+		stream->underruns++;
+
+	while (stream->pending == stream->nb_buffers ||
+	       stream->pending == STREAM_MAX_QUEUED) {
+		ret = axi_dmac_wait_event(iio_dac->dmac, &timeout);
+		if (ret < 0)
+			return ret;
+		iio_axi_dac_stream_reclaim(iio_dac);
+	}
+
+	idx = (stream->tail + stream->pending) % stream->nb_buffers;
+	addr = iio_axi_dac_stream_addr(stream, idx);
+	memcpy((void *)(uintptr_t)addr, buff, bytes);
+	if (iio_dac->dcache_flush_range)
+		iio_dac->dcache_flush_range(addr, bytes);
+
+	iio_dac->dmac->flags = 0;
+	while (true) {
+		axi_dmac_read(iio_dac->dmac, AXI_DMAC_REG_TRANSFER_ID, &id);
+		ret = axi_dmac_transfer_nonblocking(iio_dac->dmac, addr, bytes);
+		if (ret == SUCCESS)
+			break;
+		/* The previous submission was not taken by the DMA yet */
+		ret = axi_dmac_wait_event(iio_dac->dmac, &timeout);
+		if (ret < 0)
+			return ret;
+	}
+
+	stream->transfer_id[idx] = id;
+	stream->pending++;
+	stream->blocks++;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Select between cyclic replay and streaming of the opened buffer.
+ * @param dev - Instance of the iio_axi_dac
+ * @param cyclic - The buffer is replayed until the device is closed.
+ * @return SUCCESS in case of success or negative value otherwise.
+ */
+int32_t iio_axi_dac_set_cyclic(void *dev, bool cyclic)
+{
+	struct iio_axi_dac_desc *iio_dac = dev;
+
+	if (!dev)
+		return FAILURE;
+
+	iio_dac->cyclic = cyclic;
+
+	return SUCCESS;
+}
+
 /**
  * @brief Update active channels
  * @param dev - Instance of the iio_axi_dac
@@ -470,6 +677,7 @@ int32_t iio_axi_dac_prepare_transfer(void *dev, uint32_t mask)
 	uint16_t i;
 	int32_t	ret;
 
+	iio_axi_dac_stream_stop(iio_dac);
 	iio_dac->mask = mask;
 
 	for (i = 0; i < iio_dac->dev_descriptor.num_ch; i++) {
@@ -504,6 +712,13 @@ int32_t iio_axi_dac_write_data(void *dev, void *buff, uint32_t nb_samples)
 	iio_dac = (struct iio_axi_dac_desc *)dev;
 	bytes = nb_samples * hweight8(iio_dac->mask) * (STORAGE_BITS / 8);
 
+	/* Blocks bigger than a DMA transfer are split by the DMA interrupt,
+	 * which handles one transfer at a time. */
+	if (iio_dac->stream.nb_buffers && !iio_dac->cyclic &&
+	    (uint32_t)(bytes - 1) <= iio_dac->dmac->transfer_max_size)
+		return iio_axi_dac_stream_write(iio_dac, buff, bytes);
+
+	iio_axi_dac_stream_stop(iio_dac);
 	if(iio_dac->dcache_flush_range)
 		iio_dac->dcache_flush_range((uint32_t)buff, bytes);
 
@@ -512,6 +727,21 @@ int32_t iio_axi_dac_write_data(void *dev, void *buff, uint32_t nb_samples)
 	return axi_dmac_transfer(iio_dac->dmac, (uint32_t)buff, bytes);
 }
 
+/**
+ * @brief Stop the streaming playback.
+ * @param dev - Instance of the iio_axi_dac
+ * @return SUCCESS in case of success or negative value otherwise.
+ */
+int32_t iio_axi_dac_end_transfer(void *dev)
+{
+	if (!dev)
+		return FAILURE;
+
+	iio_axi_dac_stream_stop(dev);
+
+	return SUCCESS;
+}
+
 enum ch_type {
 	CH_VOLTGE,
 	CH_ALTVOLTGE,
@@ -578,6 +808,8 @@ static int32_t iio_axi_dac_create_device_descriptor(
 	altvoltage_ch_no = desc->dac->num_channels * 2;
 	iio_device->num_ch = voltage_ch_no + altvoltage_ch_no;
 	iio_device->attributes = NULL; /* no device attribute */
+	if (desc->stream.nb_buffers)
+		iio_device->buffer_attributes = iio_stream_attributes;
 	iio_device->channels = calloc(iio_device->num_ch,
 				      sizeof(struct iio_channel));
 	if (!iio_device->channels)
@@ -610,6 +842,8 @@ static int32_t iio_axi_dac_create_device_descriptor(
 	}
 	iio_device->prepare_transfer = iio_axi_dac_prepare_transfer;
 	iio_device->write_dev = iio_axi_dac_write_data;
+	iio_device->set_cyclic = iio_axi_dac_set_cyclic;
+	iio_device->end_transfer = iio_axi_dac_end_transfer;
 
 	return SUCCESS;
 
@@ -643,6 +877,7 @@ int32_t iio_axi_dac_init(struct iio_axi_dac_desc **desc,
 			 struct iio_axi_dac_init_param *init)
 {
 	struct iio_axi_dac_desc *iio_axi_dac_inst;
+	uint32_t stride;
 	int32_t status;
 
 	if (!init)
@@ -659,10 +894,31 @@ int32_t iio_axi_dac_init(struct iio_axi_dac_desc **desc,
 	iio_axi_dac_inst->dac = init->tx_dac;
 	iio_axi_dac_inst->dmac = init->tx_dmac;
 	iio_axi_dac_inst->dcache_flush_range = init->dcache_flush_range;
+	iio_axi_dac_inst->cyclic = true;
+
+	if (init->stream_nb_buffers > 1) {
+		/* Every buffer starts on a DMA beat and holds at least one */
+		stride = ALIGN_DOWN(init->stream_buffer_size /
+				    init->stream_nb_buffers, init->tx_dmac->width);
+		if (!stride || init->stream_buffer_addr % init->tx_dmac->width) {
+			free(iio_axi_dac_inst);
+			return FAILURE;
+		}
+		iio_axi_dac_inst->stream.transfer_id = calloc(init->stream_nb_buffers,
+						       sizeof(uint32_t));
+		if (!iio_axi_dac_inst->stream.transfer_id) {
+			free(iio_axi_dac_inst);
+			return FAILURE;
+		}
+		iio_axi_dac_inst->stream.nb_buffers = init->stream_nb_buffers;
+		iio_axi_dac_inst->stream.buffer_addr = init->stream_buffer_addr;
+		iio_axi_dac_inst->stream.buffer_stride = stride;
+	}
 
 	status = iio_axi_dac_create_device_descriptor(iio_axi_dac_inst,
 			&iio_axi_dac_inst->dev_descriptor);
 	if (IS_ERR_VALUE(status)) {
+		free(iio_axi_dac_inst->stream.transfer_id);
 		free(iio_axi_dac_inst);
 		return status;
 	}
@@ -684,10 +940,13 @@ int32_t iio_axi_dac_remove(struct iio_axi_dac_desc *desc)
 	if (!desc)
 		return FAILURE;
 
+	iio_axi_dac_stream_stop(desc);
+
 	status = iio_axi_dac_delete_device_descriptor(desc);
 	if (status < 0)
 		return status;
 
+	free(desc->stream.transfer_id);
 	free(desc);
 
 	return SUCCESS;
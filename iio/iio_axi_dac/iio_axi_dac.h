@@ -52,6 +52,30 @@
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
 
+/**
+ * @struct iio_axi_dac_stream
+ * @brief State of the streaming playback, the client fills the next buffers
+ * while the DMA plays out the oldest ones.
+ */
+struct iio_axi_dac_stream {
+	/** Number of DMA buffers, 0 if streaming is disabled */
+	uint32_t nb_buffers;
+	/** Start address of the memory split between the DMA buffers */
+	uint32_t buffer_addr;
+	/** Distance in bytes between two DMA buffers */
+	uint32_t buffer_stride;
+	/** Oldest submitted buffer */
+	uint32_t tail;
+	/** Number of submitted buffers not yet played out */
+	uint32_t pending;
+	/** DMAC transfer ID of each buffer */
+	uint32_t *transfer_id;
+	/** Number of times the DMA ran out of buffers and the output stalled */
+	uint32_t underruns;
+	/** Number of blocks submitted to the DMA since the buffer was opened */
+	uint32_t blocks;
+};
+
 /**
  * @struct iio_basic_desc
  * @brief Application desciptor.
@@ -68,6 +92,10 @@ struct iio_axi_dac_desc {
 	struct iio_device dev_descriptor;
 	/** Channel names */
 	char (*ch_names)[20];
+	/** The opened buffer is replayed until the device is closed */
+	bool cyclic;
+	/** Streaming playback state */
+	struct iio_axi_dac_stream stream;
 };
 
 /**
@@ -81,6 +109,15 @@ struct iio_axi_dac_init_param {
 	struct axi_dmac *tx_dmac;
 	/** Function pointer to flush the data cache for the given address range */
 	void (*dcache_flush_range)(uint32_t address, uint32_t bytes_count);
+	/** Number of DMA buffers used for streaming non-cyclic buffers. With
+	 * less than two buffers every buffer is replayed cyclically. */
+	uint32_t stream_nb_buffers;
+	/** Start address of the memory split between the streaming buffers */
+	uint32_t stream_buffer_addr;
+	/** Size in bytes of the memory split between the streaming buffers.
+	 * Each buffer gets an equal share, rounded down to the DMA width; the
+	 * address must be aligned to it. */
+	uint32_t stream_buffer_size;
 };
 
 /******************************************************************************/
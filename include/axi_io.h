@@ -56,4 +56,15 @@ int32_t axi_io_read(uint32_t base, uint32_t offset, uint32_t *data);
 /* AXI IO Write data */
 int32_t axi_io_write(uint32_t base, uint32_t offset, uint32_t data);
 
+/* AXI IO Read a block of consecutive registers */
+int32_t axi_io_read_burst(uint32_t base, uint32_t offset, uint32_t *data,
+			  uint32_t count);
+
+/* AXI IO Write a block of consecutive registers */
+int32_t axi_io_write_burst(uint32_t base, uint32_t offset,
+			   const uint32_t *data, uint32_t count);
+
+/* AXI IO Wait for the interrupt of a core */
+int32_t axi_io_wait_irq(uint32_t base, uint32_t *timeout_us);
+
 #endif // AXI_IO_H_
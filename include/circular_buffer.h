@@ -58,6 +58,17 @@
  */
 struct circular_buffer;
 
+/**
+ * @struct cb_span
+ * @brief Region of the circular buffer, in two segments when it wraps around
+ */
+struct cb_span {
+	/** Start of each segment, the second one is the start of the buffer */
+	void		*buff[2];
+	/** Size in bytes of each segment, the second one is 0 if not wrapping */
+	uint32_t	size[2];
+};
+
 /******************************************************************************/
 /************************ Functions Declarations ******************************/
 /******************************************************************************/
@@ -82,4 +93,12 @@ int32_t cb_prepare_async_read(struct circular_buffer *desc,
 			      uint32_t *raw_size_avilable);
 int32_t cb_end_async_read(struct circular_buffer *desc);
 
+int32_t cb_peek_write(struct circular_buffer *desc, uint32_t size,
+		      struct cb_span *span);
+int32_t cb_commit_write(struct circular_buffer *desc, uint32_t size);
+
+int32_t cb_peek_read(struct circular_buffer *desc, uint32_t size,
+		     struct cb_span *span);
+int32_t cb_commit_read(struct circular_buffer *desc, uint32_t size);
+
 #endif
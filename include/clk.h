@@ -43,6 +43,19 @@
 /***************************** Include Files **********************************/
 /******************************************************************************/
 #include <stdint.h>
+#include <stdbool.h>
+#include "util.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+/* Rate changes the clock cannot do itself are forwarded to its parent. */
+#define CLK_SET_RATE_PARENT	BIT(0)
+/*
+ * The rate only changes through this framework, so clk_recalc_rate() may
+ * return the cached value. Without it the hardware is read on every call.
+ */
+#define CLK_CACHE_RATE		BIT(1)
 
 /******************************************************************************/
 /************************* Structure Declarations *****************************/
@@ -54,18 +67,57 @@ struct clk_hw {
 	int32_t (*dev_clk_recalc_rate)();
 	int32_t (*dev_clk_set_rate)();
 	int32_t (*dev_clk_round_rate)();
+	int32_t (*dev_clk_set_parent)();
 };
 
+/**
+ * @struct clk
+ * @brief Clock of the clock tree.
+ *
+ * The hardware and configuration fields are filled in by the user before the
+ * clock is registered with clk_register(). The tree links, the cached rate
+ * and the enable count are managed by the framework.
+ */
 struct clk {
+	/** Hardware operations of the clock */
 	struct clk_hw	*hw;
+	/** Channel of the hardware device */
 	uint32_t	hw_ch_num;
+	/** Clock name */
 	const char	*name;
+	/** CLK_SET_RATE_PARENT, CLK_CACHE_RATE */
+	uint32_t	flags;
+	/** Parents the clock can be switched to, NULL if it has a fixed one */
+	struct clk	**parents;
+	/** Number of parents */
+	uint8_t		num_parents;
+	/** Current parent, NULL for a root clock */
+	struct clk	*parent;
+	/** First child */
+	struct clk	*children;
+	/** Next clock with the same parent */
+	struct clk	*sibling;
+	/** Cached rate, used with CLK_CACHE_RATE */
+	uint64_t	rate;
+	/** Rate last given to clk_set_rate(), 0 if none */
+	uint64_t	req_rate;
+	/** True if the cached rate is up to date */
+	bool		rate_valid;
+	/** Number of clk_enable() calls not balanced by clk_disable() */
+	uint32_t	enable_count;
 };
 
 /******************************************************************************/
 /************************ Functions Declarations ******************************/
 /******************************************************************************/
 
+/* Add the clock to the clock tree. */
+int32_t clk_register(struct clk *clk,
+		     struct clk *parent);
+
+/* Remove the clock from the clock tree. */
+int32_t clk_unregister(struct clk *clk);
+
 /* Start the clock. */
 int32_t clk_enable(struct clk * clk);
 
@@ -85,4 +137,11 @@ int32_t clk_round_rate(struct clk *clk,
 int32_t clk_set_rate(struct clk *clk,
 		     uint64_t rate);
 
+/* Get the parent of the clock. */
+struct clk *clk_get_parent(struct clk *clk);
+
+/* Change the parent of the clock. */
+int32_t clk_set_parent(struct clk *clk,
+		       struct clk *parent);
+
 #endif // CLK_H_
@@ -0,0 +1,133 @@
+/***************************************************************************//**
+ *   @file   crc_table.h
+ *   @brief  Compile time generation of CRC lookup tables.
+********************************************************************************
+ * Copyright 2021(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+#ifndef __CRC_TABLE_H
+#define __CRC_TABLE_H
+
+/*
+ * The msb-first CRC lookup tables are linear: the entry of a byte is the
+ * exclusive or of the entries of its set bits. The entry of bit k is the
+ * polynomial shifted through the CRC register k times, so only 8 values are
+ * computed for each table, as enumeration constants, and all the entries are
+ * built from them by the compiler.
+ *
+ * The slicing-by-4 tables hold, for table k, the entry of a byte followed by
+ * k zero bytes. Their basis is the one of table k - 1 shifted 8 more times.
+ * They are four times larger and only pay off past a few tens of bytes; on
+ * frames of a few bytes the single table is faster (see tests/test_crc.c).
+ */
+
+/* Shift a CRC register of the given width once, msb-first */
+#define CRC_TABLE_STEP(crc, poly, width)				\
+	((((crc) << 1) ^ (((crc) >> ((width) - 1)) & 1 ? (poly) : 0)) &	\
+	 ((1ul << (width)) - 1))
+
+/* Shift a CRC register of the given width through a zero byte */
+#define CRC_TABLE_STEP2(crc, poly, width)				\
+	CRC_TABLE_STEP(CRC_TABLE_STEP(crc, poly, width), poly, width)
+#define CRC_TABLE_STEP4(crc, poly, width)				\
+	CRC_TABLE_STEP2(CRC_TABLE_STEP2(crc, poly, width), poly, width)
+#define CRC_TABLE_STEP8(crc, poly, width)				\
+	CRC_TABLE_STEP4(CRC_TABLE_STEP4(crc, poly, width), poly, width)
+
+/* Enumeration constants holding the table entries of the single bit bytes */
+#define CRC_TABLE_BASIS(_b, poly, width)				\
+	_b##_0 = (poly) & ((1ul << (width)) - 1),			\
+	_b##_1 = CRC_TABLE_STEP(_b##_0, poly, width),			\
+	_b##_2 = CRC_TABLE_STEP(_b##_1, poly, width),			\
+	_b##_3 = CRC_TABLE_STEP(_b##_2, poly, width),			\
+	_b##_4 = CRC_TABLE_STEP(_b##_3, poly, width),			\
+	_b##_5 = CRC_TABLE_STEP(_b##_4, poly, width),			\
+	_b##_6 = CRC_TABLE_STEP(_b##_5, poly, width),			\
+	_b##_7 = CRC_TABLE_STEP(_b##_6, poly, width)
+
+#define CRC_TABLE_ENTRY(_b, n)						\
+	(((n) & 0x01 ? _b##_0 : 0) ^ ((n) & 0x02 ? _b##_1 : 0) ^	\
+	 ((n) & 0x04 ? _b##_2 : 0) ^ ((n) & 0x08 ? _b##_3 : 0) ^	\
+	 ((n) & 0x10 ? _b##_4 : 0) ^ ((n) & 0x20 ? _b##_5 : 0) ^	\
+	 ((n) & 0x40 ? _b##_6 : 0) ^ ((n) & 0x80 ? _b##_7 : 0))
+
+#define CRC_TABLE_ENTRIES_4(_b, n)					\
+	CRC_TABLE_ENTRY(_b, (n)), CRC_TABLE_ENTRY(_b, (n) + 1),		\
+	CRC_TABLE_ENTRY(_b, (n) + 2), CRC_TABLE_ENTRY(_b, (n) + 3)
+#define CRC_TABLE_ENTRIES_16(_b, n)					\
+	CRC_TABLE_ENTRIES_4(_b, (n)), CRC_TABLE_ENTRIES_4(_b, (n) + 4),	\
+	CRC_TABLE_ENTRIES_4(_b, (n) + 8), CRC_TABLE_ENTRIES_4(_b, (n) + 12)
+#define CRC_TABLE_ENTRIES_64(_b, n)					\
+	CRC_TABLE_ENTRIES_16(_b, (n)), CRC_TABLE_ENTRIES_16(_b, (n) + 16), \
+	CRC_TABLE_ENTRIES_16(_b, (n) + 32), CRC_TABLE_ENTRIES_16(_b, (n) + 48)
+
+/* Initializer of a 256 entries lookup table */
+#define CRC_TABLE_INIT(_b)						\
+	CRC_TABLE_ENTRIES_64(_b, 0), CRC_TABLE_ENTRIES_64(_b, 64),	\
+	CRC_TABLE_ENTRIES_64(_b, 128), CRC_TABLE_ENTRIES_64(_b, 192)
+
+/* Basis of the table of the bytes followed by one more zero byte than _prev */
+#define CRC_TABLE_NEXT_BASIS(_b, _prev, poly, width)			\
+	_b##_0 = CRC_TABLE_STEP8(_prev##_0, poly, width),		\
+	_b##_1 = CRC_TABLE_STEP8(_prev##_1, poly, width),		\
+	_b##_2 = CRC_TABLE_STEP8(_prev##_2, poly, width),		\
+	_b##_3 = CRC_TABLE_STEP8(_prev##_3, poly, width),		\
+	_b##_4 = CRC_TABLE_STEP8(_prev##_4, poly, width),		\
+	_b##_5 = CRC_TABLE_STEP8(_prev##_5, poly, width),		\
+	_b##_6 = CRC_TABLE_STEP8(_prev##_6, poly, width),		\
+	_b##_7 = CRC_TABLE_STEP8(_prev##_7, poly, width)
+
+/* Define a constant lookup table, generated at compile time */
+#define DECLARE_CRC_CONST_TABLE(_type, _table, poly, width)		\
+	enum { CRC_TABLE_BASIS(_table##_basis, poly, width) };		\
+	static const _type _table[256] = { CRC_TABLE_INIT(_table##_basis) }
+
+/* Define the 4 constant lookup tables of the slicing-by-4 kernels */
+#define DECLARE_CRC_CONST_SLICE4_TABLE(_type, _table, poly, width)	\
+	enum {								\
+		CRC_TABLE_BASIS(_table##_basis0, poly, width),		\
+		CRC_TABLE_NEXT_BASIS(_table##_basis1, _table##_basis0,	\
+				     poly, width),			\
+		CRC_TABLE_NEXT_BASIS(_table##_basis2, _table##_basis1,	\
+				     poly, width),			\
+		CRC_TABLE_NEXT_BASIS(_table##_basis3, _table##_basis2,	\
+				     poly, width)			\
+	};								\
+	static const _type _table[4][256] = {				\
+		{ CRC_TABLE_INIT(_table##_basis0) },			\
+		{ CRC_TABLE_INIT(_table##_basis1) },			\
+		{ CRC_TABLE_INIT(_table##_basis2) },			\
+		{ CRC_TABLE_INIT(_table##_basis3) }			\
+	}
+
+#endif // __CRC_TABLE_H
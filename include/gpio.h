@@ -103,6 +103,19 @@ enum gpio_values {
 	GPIO_HIGH_Z
 };
 
+/**
+ * @enum gpio_edge
+ * @brief Signal transitions gpio_wait_edge() can wait for.
+ */
+enum gpio_edge {
+	/** Low to high transition */
+	GPIO_EDGE_RISING,
+	/** High to low transition */
+	GPIO_EDGE_FALLING,
+	/** Any transition */
+	GPIO_EDGE_BOTH
+};
+
 /**
  * @struct gpio_platform_ops
  * @brief Structure holding gpio function pointers that point to the platform
@@ -126,6 +139,9 @@ struct gpio_platform_ops {
 	int32_t (*gpio_ops_set_value)(struct gpio_desc *, uint8_t);
 	/** gpio get value function pointer */
 	int32_t (*gpio_ops_get_value)(struct gpio_desc *, uint8_t *);
+	/** gpio wait edge function pointer (optional) */
+	int32_t (*gpio_ops_wait_edge)(struct gpio_desc *, enum gpio_edge,
+				      uint32_t *);
 };
 
 /******************************************************************************/
@@ -162,4 +178,8 @@ int32_t gpio_set_value(struct gpio_desc *desc,
 int32_t gpio_get_value(struct gpio_desc *desc,
 		       uint8_t *value);
 
+/* Wait for a transition of the specified input GPIO. */
+int32_t gpio_wait_edge(struct gpio_desc *desc, enum gpio_edge edge,
+		       uint32_t *timeout_us);
+
 #endif // GPIO_H_
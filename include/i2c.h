@@ -44,6 +44,7 @@
 /***************************** Include Files **********************************/
 /******************************************************************************/
 
+#include <stdbool.h>
 #include <stdint.h>
 
 /******************************************************************************/
@@ -87,6 +88,20 @@ typedef struct i2c_desc {
 	void		*extra;
 } i2c_desc;
 
+/**
+ * @struct i2c_transfer_msg
+ * @brief One segment of a combined I2C transaction. Segments after the first
+ * one are preceded by a repeated start, the last one is followed by a stop.
+ */
+struct i2c_transfer_msg {
+	/** Data to write or where to store the data read */
+	uint8_t		*buff;
+	/** Number of bytes to transfer */
+	uint16_t	bytes_number;
+	/** Read from the slave if set, write to it otherwise */
+	bool		read;
+};
+
 /**
  * @struct i2c_platform_ops
  * @brief Structure holding i2c function pointers that point to the platform
@@ -99,6 +114,9 @@ struct i2c_platform_ops {
 	int32_t (*i2c_ops_write)(struct i2c_desc *, uint8_t *, uint8_t, uint8_t);
 	/** i2c write function pointer */
 	int32_t (*i2c_ops_read)(struct i2c_desc *, uint8_t *, uint8_t, uint8_t);
+	/** i2c combined transaction function pointer (optional) */
+	int32_t (*i2c_ops_transfer)(struct i2c_desc *, struct i2c_transfer_msg *,
+				    uint32_t);
 	/** i2c remove function pointer */
 	int32_t (*i2c_ops_remove)(struct i2c_desc *);
 };
@@ -126,4 +144,8 @@ int32_t i2c_read(struct i2c_desc *desc,
 		 uint8_t bytes_number,
 		 uint8_t stop_bit);
 
+/* Run several reads and writes as a single transaction. */
+int32_t i2c_transfer(struct i2c_desc *desc, struct i2c_transfer_msg *msgs,
+		     uint32_t len);
+
 #endif // I2C_H_
@@ -0,0 +1,87 @@
+/***************************************************************************//**
+ *   @file   sample_unpack.h
+ *   @brief  Header file of the sample unpacking and deinterleaving helpers.
+********************************************************************************
+ * Copyright 2021(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+#ifndef SAMPLE_UNPACK_H_
+#define SAMPLE_UNPACK_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @struct sample_format
+ * @brief Layout of a sample in memory, same fields as the IIO scan_type.
+ */
+struct sample_format {
+	/** Size of a sample in memory: 8, 16, 24 or 32 bits */
+	uint8_t storagebits;
+	/** Number of valid bits of a sample */
+	uint8_t realbits;
+	/** Shift right by this before masking out realbits */
+	uint8_t shift;
+	/** Sign extend the valid bits */
+	bool is_signed;
+	/** True if big endian, false if little endian */
+	bool is_big_endian;
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+/* Unpack big endian, bit-packed samples of any width into 32-bit words.
+ * Vectorized for 12, 16, 18, 24 and 26 bits on NEON and SSSE3, only for
+ * 16 bits on plain SSE2. */
+int32_t sample_unpack_be(const uint8_t *src, uint32_t nb_samples,
+			 uint8_t bits, uint32_t *dst);
+/* Convert samples stored in a given format to 32-bit values. */
+int32_t sample_extract(const void *src, uint32_t nb_samples,
+		       const struct sample_format *fmt, int32_t *dst);
+/* Split interleaved samples into one buffer per channel. */
+int32_t sample_deinterleave(const void *src, uint32_t nb_samples,
+			    uint8_t sample_bytes, uint32_t mask,
+			    void * const *dst);
+
+#endif /* SAMPLE_UNPACK_H_ */
@@ -96,6 +96,11 @@ struct spi_msg {
 	uint32_t		bytes_number;
 	/** If set, CS will be deasserted after the transfer */
 	uint8_t			cs_change;
+	/**
+	 * Transfer speed for this message. If 0, max_speed_hz is used.
+	 * Only honored by platforms that support per-message speed.
+	 */
+	uint32_t		speed_hz;
 };
 
 /**
@@ -143,6 +148,8 @@ typedef struct spi_desc {
 	const struct spi_platform_ops *platform_ops;
 	/**  SPI extra parameters (device specific) */
 	void		*extra;
+	/** Data of the device driver using the descriptor, NULL by default */
+	void		*drv_data;
 } spi_desc;
 
 /**
@@ -161,6 +168,60 @@ struct spi_platform_ops {
 	int32_t (*remove)(struct spi_desc *);
 };
 
+/**
+ * @struct spi_wr_queue_init_param
+ * @brief Structure holding the parameters for register write queue
+ * initialization.
+ */
+struct spi_wr_queue_init_param {
+	/** SPI descriptor used to flush the queue */
+	struct spi_desc	*spi;
+	/** Maximum number of register writes held before an automatic flush */
+	uint32_t	max_entries;
+	/** Maximum number of data bytes per instruction. 1 disables streaming */
+	uint32_t	max_burst;
+	/** Address step of streaming mode: 1 auto-increment, -1 auto-decrement.
+	 *  Required when max_burst is above 1 */
+	int8_t		addr_step;
+	/** Length of the instruction header in bytes */
+	uint8_t		hdr_len;
+	/** Build the header of a write of count bytes starting at addr */
+	void		(*build_header)(uint8_t *hdr, uint32_t addr,
+					uint32_t count);
+};
+
+/**
+ * @struct spi_wr_queue
+ * @brief Register write queue flushed as a single spi_transfer().
+ */
+struct spi_wr_queue {
+	/** SPI descriptor used to flush the queue */
+	struct spi_desc	*spi;
+	/** Maximum number of register writes held before an automatic flush */
+	uint32_t	max_entries;
+	/** Maximum number of data bytes per instruction */
+	uint32_t	max_burst;
+	/** Address step of streaming mode */
+	int8_t		addr_step;
+	/** Length of the instruction header in bytes */
+	uint8_t		hdr_len;
+	/** Header builder */
+	void		(*build_header)(uint8_t *hdr, uint32_t addr,
+					uint32_t count);
+	/** Frame buffer */
+	uint8_t		*buff;
+	/** Messages, one per instruction */
+	struct spi_msg	*msgs;
+	/** Number of messages in use */
+	uint32_t	n_msgs;
+	/** Number of bytes of buff in use */
+	uint32_t	buff_len;
+	/** Start address of the last message */
+	uint32_t	last_start;
+	/** Address of the last queued register */
+	uint32_t	last_addr;
+};
+
 /******************************************************************************/
 /************************ Functions Declarations ******************************/
 /******************************************************************************/
@@ -180,5 +241,19 @@ int32_t spi_write_and_read(struct spi_desc *desc,
 /* Iterate over the spi_msg array and send all messages at once */
 int32_t spi_transfer(struct spi_desc *desc, struct spi_msg *msgs, uint32_t len);
 
+/* Initialize a register write queue. */
+int32_t spi_wr_queue_init(struct spi_wr_queue **queue,
+			  const struct spi_wr_queue_init_param *param);
+
+/* Free the resources allocated by spi_wr_queue_init(). */
+int32_t spi_wr_queue_remove(struct spi_wr_queue *queue);
+
+/* Queue a register write, flushing the queue if it is full. */
+int32_t spi_wr_queue_push(struct spi_wr_queue *queue, uint32_t addr,
+			  uint8_t val);
+
+/* Send all the queued register writes. */
+int32_t spi_wr_queue_flush(struct spi_wr_queue *queue);
+
 
 #endif // SPI_H_
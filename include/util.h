@@ -81,6 +81,10 @@
 #define round_up(x,y) \
 		(((x)+(y)-1)/(y))
 
+/* Round down to a multiple of a, which must be a power of 2 */
+#define ALIGN_DOWN(x, a) \
+	((x) & ~((a) - 1))
+
 #define BITS_PER_LONG 32
 
 #define GENMASK(h, l) ({ 					\
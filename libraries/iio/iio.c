@@ -59,6 +59,12 @@
 #include "tcp_socket.h"
 #include "circular_buffer.h"
 #endif
+#ifdef ENABLE_IIO_THREADS
+#ifndef ENABLE_IIO_NETWORK
+#error "ENABLE_IIO_THREADS needs ENABLE_IIO_NETWORK"
+#endif
+#include <pthread.h>
+#endif
 
 /******************************************************************************/
 /********************** Macros and Constants Definitions **********************/
@@ -66,7 +72,36 @@
 
 #define IIOD_PORT		30431
 #define MAX_SOCKET_TO_HANDLE	4
+#if defined(ENABLE_IIO_NETWORK) && MAX_SOCKET_TO_HANDLE + 1 > SOCKET_POLL_MAX
+#error "The clients and the server socket must fit in one socket_poll()"
+#endif
+/* Start of a command kept for each client until the rest of it arrives */
+#define IIOD_CMD_BUF_SIZE	128
+#ifdef ENABLE_IIO_THREADS
+/* Each client has its own thread, which can wait for as long as needed */
+#define IIOD_RECV_TIMEOUT_MS	-1
+#else
+/* Time a client gets to send the rest of a command it started */
+#define IIOD_RECV_TIMEOUT_MS	1000
+#endif
 #define REG_ACCESS_ATTRIBUTE	"direct_reg_access"
+/* Enough for "altvoltage<n>-altvoltage<m>" */
+#define IIO_CH_ID_SIZE		50
+
+#ifdef ENABLE_IIO_THREADS
+#define IIO_LOCK(mutex)		pthread_mutex_lock(mutex)
+#define IIO_UNLOCK(mutex)	pthread_mutex_unlock(mutex)
+#else
+#define IIO_LOCK(mutex)
+#define IIO_UNLOCK(mutex)
+#endif
+
+/* Several IIO servers may run in separate threads of a Linux process */
+#if defined(ENABLE_IIO_THREADS) || defined(LINUX_PLATFORM)
+#define IIO_THREAD_LOCAL	__thread
+#else
+#define IIO_THREAD_LOCAL
+#endif
 
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
@@ -107,6 +142,46 @@ struct attr_fun_params {
 	char			*buf;
 	size_t			len;
 	struct iio_ch_info	*ch_info;
+	/* Channel or attribute array the cached values are looked up by */
+	uintptr_t		cache_tag;
+};
+
+/**
+ * @struct iio_lookup_entry
+ * @brief Entry of a channel or attribute lookup table.
+ */
+struct iio_lookup_entry {
+	/** Attribute array of an attribute, direction of a channel */
+	uintptr_t	tag;
+	/** Name used to look the item up */
+	const char	*name;
+	/** Channel or attribute, NULL for free entries */
+	void		*item;
+};
+
+/**
+ * @struct iio_lookup
+ * @brief Open addressing hash table, built once at iio_register().
+ */
+struct iio_lookup {
+	struct iio_lookup_entry	*entries;
+	/** Number of entries, power of 2 */
+	uint32_t		size;
+};
+
+/**
+ * @struct iio_attr_cache_slot
+ * @brief Cached value of an attribute of a channel or of a device.
+ */
+struct iio_attr_cache_slot {
+	/** Attribute the value belongs to */
+	struct iio_attribute	*attr;
+	/** Value returned by show, NULL until the first read */
+	char			*value;
+	/** Length returned by show */
+	ssize_t			len;
+	/** Value is up to date */
+	bool			valid;
 };
 
 /**
@@ -129,7 +204,76 @@ struct iio_interface {
 	struct iio_device	*dev_descriptor;
 	struct iio_data_buffer	*write_buffer;
 	struct iio_data_buffer	*read_buffer;
+	/** Samples of the last iio_transfer_dev_to_mem() */
+	void			*rd_data;
+	/** Number of bytes at rd_data */
+	size_t			rd_size;
+	/** Channel ids, as seen by the client */
+	char			(*ch_ids)[IIO_CH_ID_SIZE];
+	/** Channels by id and direction */
+	struct iio_lookup	ch_lookup;
+	/** Attributes by attribute array and name */
+	struct iio_lookup	attr_lookup;
+	/** Values of the cacheable attributes */
+	struct iio_attr_cache_slot	*cache;
+	/** Number of used cache slots */
+	uint32_t		nb_cache;
+	/** Cache slots by channel or attribute array and name */
+	struct iio_lookup	cache_lookup;
+#ifdef ENABLE_IIO_THREADS
+	/** Serializes the calls into the device driver */
+	pthread_mutex_t		lock;
+	/** Held by the client that owns the read buffer */
+	pthread_mutex_t		rd_lock;
+	/** Held by the client that owns the write buffer */
+	pthread_mutex_t		wr_lock;
+#endif
+};
+
+/**
+ * @struct iio_conn
+ * @brief State of a client connection.
+ */
+struct iio_conn {
+	/** IIO server the client is connected to */
+	struct iio_desc		*desc;
+#ifdef ENABLE_IIO_NETWORK
+	/** Client socket, active during an iio_step when not threaded */
+	struct tcp_socket_desc	*sock;
+#endif
+	/** Next unsent byte of the buffer handed to libtinyiiod by the last
+	 *  iio_read_dev() call */
+	const char		*zc_dst;
+	/** Device buffer data that zc_dst stands for */
+	const char		*zc_src;
+	/** Number of bytes at zc_dst not yet sent */
+	size_t			zc_len;
+#ifdef ENABLE_IIO_THREADS
+	/** tinyiiod instance parsing the commands of this client */
+	struct tinyiiod		*iiod;
+	/** Interface whose read buffer is being sent to this client */
+	struct iio_interface	*rd_owner;
+	/** Interface whose write buffer is being filled by this client */
+	struct iio_interface	*wr_owner;
+#endif
+};
+
+#ifdef ENABLE_IIO_NETWORK
+/**
+ * @struct iio_client
+ * @brief Bytes received from a client while the other clients were served.
+ */
+struct iio_client {
+	/** Client socket, NULL for a free slot */
+	struct tcp_socket_desc	*sock;
+	/** Received bytes, a client is only served once a whole command is in */
+	char			buf[IIOD_CMD_BUF_SIZE];
+	/** Number of bytes in buf */
+	uint32_t		len;
+	/** First byte of buf not handed to libtinyiiod yet */
+	uint32_t		pos;
 };
+#endif
 
 struct iio_desc {
 	struct tinyiiod		*iiod;
@@ -137,22 +281,36 @@ struct iio_desc {
 	enum pysical_link_type	phy_type;
 	void			*phy_desc;
 	struct list_desc	*interfaces_list;
+	/* Registered interfaces, indexed by the number in their dev_id */
+	struct iio_interface	**dev_table;
+	/* Context xml, chosen or generated on the first request */
 	char			*xml_desc;
 	uint32_t		xml_size;
-	uint32_t		xml_size_to_last_dev;
+	/* Prebuilt context from iio_init_param, NULL if there is none */
+	const char		*xml_prebuilt;
+	uint32_t		xml_prebuilt_size;
+#ifdef ENABLE_IIO_THREADS
+	/* Serializes the generation of the context xml */
+	pthread_mutex_t		xml_lock;
+#endif
 	uint32_t		dev_count;
 	struct uart_desc	*uart_desc;
 #ifdef ENABLE_IIO_NETWORK
 	/* FIFO for socket descriptors */
 	struct circular_buffer	*sockets;
-	/* Client socket active during an iio_step */
-	struct tcp_socket_desc	*current_sock;
 	/* Instance of server socket */
 	struct tcp_socket_desc	*server;
+	/* State of the clients in sockets, unless threaded */
+	struct iio_client	clients[MAX_SOCKET_TO_HANDLE];
 #endif
+	/* Connection served by iio_step, unless threaded */
+	struct iio_conn		conn;
 };
 
-static struct iio_desc			*g_desc;
+/* Connection served by the calling thread. libtinyiiod callbacks carry no
+ * context, so iio_step() and the client threads set it before handing control
+ * to libtinyiiod and every callback starts from it. */
+static IIO_THREAD_LOCAL struct iio_conn	*g_conn;
 
 /******************************************************************************/
 /************************ Functions Definitions *******************************/
@@ -181,76 +339,229 @@ static inline int32_t _nb_active_sockets(struct iio_desc *desc)
 	return size / sizeof(struct tcp_socket_desc *);
 }
 
-/* Blocking until new socket available.
- * Will iterate through a list of sockets */
+/* Wait until a connection is pending or a client sent data.
+ * ready is 0 for the server socket, n for the n-th socket of the queue */
+static int32_t _wait_sockets(struct iio_desc *desc, uint32_t *ready)
+{
+	struct tcp_socket_desc	*socks[MAX_SOCKET_TO_HANDLE + 1];
+	uint32_t		nb_active_sockets;
+	uint32_t		i;
+
+	socks[0] = desc->server;
+	nb_active_sockets = _nb_active_sockets(desc);
+	/* Rotate through the whole queue to collect the sockets in order */
+	for (i = 1; i <= nb_active_sockets; i++) {
+		_pop_sock(desc, &socks[i]);
+		_push_sock(desc, socks[i]);
+	}
+
+	return socket_poll(socks, nb_active_sockets + 1, ready, -1);
+}
+
+/* Get the buffered state of a client, NULL if it has none (threaded) */
+static struct iio_client *_get_client(struct iio_desc *desc,
+				      struct tcp_socket_desc *sock)
+{
+	uint32_t i;
+
+	for (i = 0; i < MAX_SOCKET_TO_HANDLE; i++)
+		if (desc->clients[i].sock == sock)
+			return &desc->clients[i];
+
+	return NULL;
+}
+
+/* Queue a new client */
+static int32_t _add_client(struct iio_desc *desc, struct tcp_socket_desc *sock)
+{
+	struct iio_client	*client;
+	int32_t			ret;
+
+	client = _get_client(desc, NULL);
+	if (!client)
+		return -ENOMEM;
+
+	ret = _push_sock(desc, sock);
+	if (IS_ERR_VALUE(ret))
+		return ret;
+
+	client->sock = sock;
+	client->len = 0;
+	client->pos = 0;
+
+	return SUCCESS;
+}
+
+/* A whole command, ended by '\n', is buffered */
+static inline bool _client_has_command(struct iio_client *client)
+{
+	return memchr(client->buf + client->pos, '\n',
+		      client->len - client->pos) != NULL;
+}
+
+/* Receive what the client sent so far, without waiting for more.
+ * Return true once the client can be served without blocking the others:
+ * a whole command arrived, the buffer is full or the connection failed */
+static bool _client_recv_command(struct iio_desc *desc,
+				 struct tcp_socket_desc *sock)
+{
+	struct iio_client	*client;
+	int32_t			ret;
+
+	client = _get_client(desc, sock);
+	if (!client)
+		return true;
+
+	if (client->pos) {
+		client->len -= client->pos;
+		memmove(client->buf, client->buf + client->pos, client->len);
+		client->pos = 0;
+	}
+
+	while (client->len < IIOD_CMD_BUF_SIZE) {
+		ret = socket_recv(sock, client->buf + client->len,
+				  IIOD_CMD_BUF_SIZE - client->len);
+		if (ret == -EAGAIN)
+			return _client_has_command(client);
+		/* Let network_read() report the error */
+		if (IS_ERR_VALUE(ret))
+			return true;
+
+		client->len += ret;
+	}
+
+	return true;
+}
+
+/* Take out of the queue a client that has a whole command buffered */
+static bool _pop_buffered_command(struct iio_desc *desc,
+				  struct tcp_socket_desc **sock)
+{
+	struct iio_client	*client;
+	uint32_t		nb_active_sockets;
+	uint32_t		i;
+
+	nb_active_sockets = _nb_active_sockets(desc);
+	for (i = 0; i < nb_active_sockets; i++) {
+		_pop_sock(desc, sock);
+		client = _get_client(desc, *sock);
+		if (client && _client_has_command(client))
+			return true;
+		_push_sock(desc, *sock);
+	}
+
+	return false;
+}
+
+/* Blocking until a client sent a whole command.
+ * Clients are kept in the queue while their command is incomplete, so a
+ * client sending a command slowly doesn't hold back the others */
 static int32_t _get_next_socket(struct iio_desc *desc)
 {
 	struct tcp_socket_desc	*sock;
 	int32_t			ret;
-	uint32_t		nb_active_sockets;
+	uint32_t		ready;
 
-	/* Get all new waiting sockets.
-	 * If none is available, wait until first connection */
-	do {
+	while (true) {
+		/* Get all new waiting sockets */
 		ret = socket_accept(desc->server, &sock);
-		if (ret == -EAGAIN) {
-			nb_active_sockets = _nb_active_sockets(desc);
-			if (nb_active_sockets == 0) {
-				/* Wait until a connection exists */
+		if (ret == SUCCESS) {
+			ret = _add_client(desc, sock);
+			if (IS_ERR_VALUE(ret))
+				return ret;
+			continue;
+		} else if (ret != -EAGAIN) {
+			return ret;
+		}
+
+		/* Commands received along with the previous one */
+		if (_pop_buffered_command(desc, &sock))
+			break;
+
+		ret = _wait_sockets(desc, &ready);
+		if (ret == -ENOSYS) {
+			/* The network interface can't wait for sockets,
+			 * poll them */
+			if (_nb_active_sockets(desc) == 0) {
 				mdelay(1);
 				continue;
-			} else {
-				break;
 			}
+			ret = _pop_sock(desc, &sock);
+			if (IS_ERR_VALUE(ret))
+				return ret;
+			break;
 		} else if (IS_ERR_VALUE(ret)) {
 			return ret;
 		}
-		/* Add socket to queue */
-		ret = _push_sock(desc, sock);
-		if (IS_ERR_VALUE(ret))
-			return ret;
-	} while (true);
-
-	ret = _pop_sock(desc, &desc->current_sock);
-	if (IS_ERR_VALUE(ret)) {
-		desc->current_sock = NULL;
-		return ret;
+		/* A new connection is pending */
+		if (ready == 0)
+			continue;
+		/* Bring the client that sent data in front */
+		while (--ready) {
+			_pop_sock(desc, &sock);
+			_push_sock(desc, sock);
+		}
+		_pop_sock(desc, &sock);
+		if (_client_recv_command(desc, sock))
+			break;
+		_push_sock(desc, sock);
 	}
 
+	desc->conn.sock = sock;
+
 	return SUCCESS;
 }
 
-static int32_t network_read(const void *data, uint32_t len)
+static int32_t network_read(struct iio_conn *conn, const void *data,
+			    uint32_t len)
 {
-	uint32_t	i;
-	int32_t		ret;
+	struct iio_client	*client;
+	uint32_t		i;
+	uint32_t		ready;
+	int32_t			ret;
 
-	if ((int32_t)g_desc->current_sock == -1)
+	if ((int32_t)conn->sock == -1)
 		return -1;
 
-	if (g_desc->current_sock == NULL) {
-		ret = _get_next_socket(g_desc);
+	if (conn->sock == NULL) {
+		ret = _get_next_socket(conn->desc);
 		if (IS_ERR_VALUE(ret))
 			return ret;
 	}
 
+	/* Bytes received while waiting for a whole command come first */
 	i = 0;
-	do {
-		ret = socket_recv(g_desc->current_sock,
+	client = _get_client(conn->desc, conn->sock);
+	if (client && client->pos < client->len) {
+		i = min(len, client->len - client->pos);
+		memcpy((void *)data, client->buf + client->pos, i);
+		client->pos += i;
+	}
+
+	ret = SUCCESS;
+	while (i < len) {
+		ret = socket_recv(conn->sock,
 				  (void *)((uint8_t *)data + i), len - i);
+		/* Wait for the rest of the data of a command being served */
+		if (ret == -EAGAIN &&
+		    socket_poll(&conn->sock, 1, &ready,
+				IIOD_RECV_TIMEOUT_MS) == SUCCESS)
+			continue;
 		if (IS_ERR_VALUE(ret)) {
 			*(int8_t *)data = '*';
 			break;
 		}
 
 		i += ret;
-	} while (i < len);
+	}
 
 	if (ret == -ENOTCONN) {
 		/* A socket connection is disconnected, so we release
 		 * the resources and don't add it again in the list */
-		socket_remove(g_desc->current_sock);
-		g_desc->current_sock = (void *)-1;
+		if (client)
+			client->sock = NULL;
+		socket_remove(conn->sock);
+		conn->sock = (void *)-1;
 	}
 
 	return i;
@@ -259,29 +570,83 @@ static int32_t network_read(const void *data, uint32_t len)
 
 static ssize_t iio_phy_read(char *buf, size_t len)
 {
-	if (g_desc->phy_type == USE_UART)
-		return (ssize_t)uart_read(g_desc->uart_desc, (uint8_t *)buf,
+	struct iio_conn *conn = g_conn;
+	struct iio_desc *desc = conn->desc;
+
+	/* A new request starts, drop any zero-copy chunk left behind */
+	conn->zc_len = 0;
+#ifdef ENABLE_IIO_THREADS
+	/* and let other clients use the read buffer that was sent */
+	if (conn->rd_owner) {
+		IIO_UNLOCK(&conn->rd_owner->rd_lock);
+		conn->rd_owner = NULL;
+	}
+#endif
+
+	if (desc->phy_type == USE_UART)
+		return (ssize_t)uart_read(desc->uart_desc, (uint8_t *)buf,
 					  (size_t)len);
 #ifdef ENABLE_IIO_NETWORK
 	else
-		return network_read((void *)buf, (uint32_t)len);
+		return network_read(conn, (void *)buf, (uint32_t)len);
 #endif
 
 	return -EINVAL;
 }
 
+/**
+ * @brief Account for the bytes of the zero-copy chunk that were sent.
+ * @param conn - Client connection.
+ * @param sent - Number of bytes sent.
+ * @return None.
+ */
+static void iio_zc_advance(struct iio_conn *conn, size_t sent)
+{
+	conn->zc_dst += sent;
+	conn->zc_src += sent;
+	conn->zc_len -= sent;
+}
+
 /** Write to a peripheral device (UART, USB, NETWORK) */
 static ssize_t iio_phy_write(const char *buf, size_t len)
 {
-	if (g_desc->phy_type == USE_UART)
-		return (ssize_t)uart_write(g_desc->uart_desc,
-					   (uint8_t *)buf, (size_t)len);
+	struct iio_conn *conn = g_conn;
+	bool zc = conn->zc_len != 0;
+	ssize_t ret;
+	size_t sent;
+
+	if (zc) {
+		/*
+		 * libtinyiiod sends the chunk it got from iio_read_dev() with
+		 * the writes that directly follow, in order from the start of
+		 * pbuf. pbuf was never filled, so refuse any other write instead
+		 * of sending what it holds.
+		 */
+		if (buf != conn->zc_dst || len > conn->zc_len)
+			return -EINVAL;
+		buf = conn->zc_src;
+	}
+
+	if (conn->desc->phy_type == USE_UART) {
+		ret = uart_write(conn->desc->uart_desc, (uint8_t *)buf,
+				 (size_t)len);
+		sent = IS_ERR_VALUE(ret) ? 0 : len;
+	}
 #ifdef ENABLE_IIO_NETWORK
-	else
-		return socket_send(g_desc->current_sock, buf, len);
+	else {
+		ret = socket_send(conn->sock, buf, len);
+		sent = IS_ERR_VALUE(ret) ? 0 : (size_t)ret;
+	}
+#else
+	else {
+		return -EINVAL;
+	}
 #endif
 
-	return -EINVAL;
+	if (zc)
+		iio_zc_advance(conn, sent);
+
+	return ret;
 }
 
 /* Get string for channel id from channel type */
@@ -325,50 +690,340 @@ static inline void _print_ch_id(char *buff, struct iio_channel *ch)
 	}
 }
 
+/* FNV-1a hash of name, mixed with tag */
+static uint32_t iio_lookup_hash(uintptr_t tag, const char *name)
+{
+	uint32_t hash = 2166136261u;
+
+	while (*name) {
+		hash ^= (uint8_t)*name++;
+		hash *= 16777619u;
+	}
+
+	return hash ^ ((uint32_t)tag * 2654435761u);
+}
+
+/**
+ * @brief Allocate a lookup table for nb_items items.
+ * @param lookup - Lookup table.
+ * @param nb_items - Maximum number of items that will be added.
+ * @return SUCCESS in case of success or negative value otherwise.
+ */
+static int32_t iio_lookup_init(struct iio_lookup *lookup, uint32_t nb_items)
+{
+	lookup->size = 0;
+	lookup->entries = NULL;
+	if (!nb_items)
+		return SUCCESS;
+
+	/* Keep the load factor under 1/2 */
+	lookup->size = 4;
+	while (lookup->size < 2 * nb_items)
+		lookup->size <<= 1;
+
+	lookup->entries = calloc(lookup->size, sizeof(*lookup->entries));
+	if (!lookup->entries)
+		return -ENOMEM;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Find an item in a lookup table.
+ * @param lookup - Lookup table.
+ * @param tag - Attribute array or channel direction.
+ * @param name - Name of the item.
+ * @return The item or NULL if it is not found.
+ */
+static void *iio_lookup_find(struct iio_lookup *lookup, uintptr_t tag,
+			     const char *name)
+{
+	struct iio_lookup_entry	*entry;
+	uint32_t		i;
+
+	if (!lookup->size)
+		return NULL;
+
+	i = iio_lookup_hash(tag, name);
+	while (true) {
+		entry = &lookup->entries[i & (lookup->size - 1)];
+		if (!entry->item)
+			return NULL;
+		if (entry->tag == tag && !strcmp(entry->name, name))
+			return entry->item;
+		i++;
+	}
+}
+
+/**
+ * @brief Add an item to a lookup table. The first item added for a name
+ * wins, as it would with a linear search.
+ * @param lookup - Lookup table.
+ * @param tag - Attribute array or channel direction.
+ * @param name - Name of the item.
+ * @param item - Item.
+ * @return None.
+ */
+static void iio_lookup_add(struct iio_lookup *lookup, uintptr_t tag,
+			   const char *name, void *item)
+{
+	struct iio_lookup_entry	*entry;
+	uint32_t		i;
+
+	i = iio_lookup_hash(tag, name);
+	while (true) {
+		entry = &lookup->entries[i & (lookup->size - 1)];
+		if (!entry->item)
+			break;
+		if (entry->tag == tag && !strcmp(entry->name, name))
+			return;
+		i++;
+	}
+
+	entry->tag = tag;
+	entry->name = name;
+	entry->item = item;
+}
+
+/* Number of attributes in an attribute array */
+static uint32_t iio_attr_count(struct iio_attribute *attributes)
+{
+	uint32_t n = 0;
+
+	if (attributes)
+		while (attributes[n].name)
+			n++;
+
+	return n;
+}
+
+/* Number of cacheable attributes in an attribute array */
+static uint32_t iio_attr_count_cached(struct iio_attribute *attributes)
+{
+	uint32_t i, n = 0;
+
+	if (attributes)
+		for (i = 0; attributes[i].name; i++)
+			if (attributes[i].cache != IIO_ATTR_NO_CACHE)
+				n++;
+
+	return n;
+}
+
+/* Add all the attributes of an attribute array to a lookup table */
+static void iio_lookup_add_attrs(struct iio_lookup *lookup,
+				 struct iio_attribute *attributes)
+{
+	uint32_t i;
+
+	if (!attributes)
+		return;
+
+	for (i = 0; attributes[i].name; i++)
+		iio_lookup_add(lookup, (uintptr_t)attributes,
+			       attributes[i].name, &attributes[i]);
+}
+
+/* Give a cache slot to each cacheable attribute of an attribute array.
+ * Channels may share an attribute array, so channel attributes are keyed by
+ * the channel and device attributes by their array. */
+static void iio_cache_add_attrs(struct iio_interface *intf, uintptr_t tag,
+				struct iio_attribute *attributes)
+{
+	struct iio_attr_cache_slot	*slot;
+	uint32_t			i;
+
+	if (!attributes)
+		return;
+
+	for (i = 0; attributes[i].name; i++) {
+		if (attributes[i].cache == IIO_ATTR_NO_CACHE)
+			continue;
+		slot = &intf->cache[intf->nb_cache++];
+		slot->attr = &attributes[i];
+		iio_lookup_add(&intf->cache_lookup, tag, attributes[i].name, slot);
+	}
+}
+
+/**
+ * @brief Build the channel and attribute lookup tables of an interface.
+ * @param intf - Interface.
+ * @return SUCCESS in case of success or negative value otherwise.
+ */
+static int32_t iio_interface_build_lookup(struct iio_interface *intf)
+{
+	struct iio_device	*dev = intf->dev_descriptor;
+	uint32_t		nb_attrs;
+	uint32_t		nb_cached;
+	int32_t			ret;
+	int16_t			i;
+
+	if (dev->num_ch) {
+		intf->ch_ids = calloc(dev->num_ch, sizeof(*intf->ch_ids));
+		if (!intf->ch_ids)
+			return -ENOMEM;
+	}
+
+	nb_attrs = iio_attr_count(dev->attributes) +
+		   iio_attr_count(dev->debug_attributes) +
+		   iio_attr_count(dev->buffer_attributes);
+	nb_cached = iio_attr_count_cached(dev->attributes) +
+		    iio_attr_count_cached(dev->debug_attributes) +
+		    iio_attr_count_cached(dev->buffer_attributes);
+	for (i = 0; i < dev->num_ch; i++) {
+		nb_attrs += iio_attr_count(dev->channels[i].attributes);
+		nb_cached += iio_attr_count_cached(dev->channels[i].attributes);
+	}
+
+	ret = iio_lookup_init(&intf->ch_lookup, dev->num_ch);
+	if (IS_ERR_VALUE(ret))
+		return ret;
+	ret = iio_lookup_init(&intf->attr_lookup, nb_attrs);
+	if (IS_ERR_VALUE(ret))
+		return ret;
+	ret = iio_lookup_init(&intf->cache_lookup, nb_cached);
+	if (IS_ERR_VALUE(ret))
+		return ret;
+	if (nb_cached) {
+		intf->cache = calloc(nb_cached, sizeof(*intf->cache));
+		if (!intf->cache)
+			return -ENOMEM;
+	}
+
+	for (i = 0; i < dev->num_ch; i++) {
+		_print_ch_id(intf->ch_ids[i], &dev->channels[i]);
+		iio_lookup_add(&intf->ch_lookup, dev->channels[i].ch_out,
+			       intf->ch_ids[i], &dev->channels[i]);
+		iio_lookup_add_attrs(&intf->attr_lookup,
+				     dev->channels[i].attributes);
+		iio_cache_add_attrs(intf, (uintptr_t)&dev->channels[i],
+				    dev->channels[i].attributes);
+	}
+	iio_lookup_add_attrs(&intf->attr_lookup, dev->attributes);
+	iio_lookup_add_attrs(&intf->attr_lookup, dev->debug_attributes);
+	iio_lookup_add_attrs(&intf->attr_lookup, dev->buffer_attributes);
+	iio_cache_add_attrs(intf, (uintptr_t)dev->attributes, dev->attributes);
+	iio_cache_add_attrs(intf, (uintptr_t)dev->debug_attributes,
+			    dev->debug_attributes);
+	iio_cache_add_attrs(intf, (uintptr_t)dev->buffer_attributes,
+			    dev->buffer_attributes);
+
+	return SUCCESS;
+}
+
+/* Free an interface, its lookup tables and its cached values */
+static void iio_interface_free(struct iio_interface *intf)
+{
+	uint32_t i;
+
+#ifdef ENABLE_IIO_THREADS
+	pthread_mutex_destroy(&intf->lock);
+	pthread_mutex_destroy(&intf->rd_lock);
+	pthread_mutex_destroy(&intf->wr_lock);
+#endif
+	free(intf->ch_lookup.entries);
+	free(intf->attr_lookup.entries);
+	free(intf->cache_lookup.entries);
+	for (i = 0; i < intf->nb_cache; i++)
+		free(intf->cache[i].value);
+	free(intf->cache);
+	free(intf->ch_ids);
+	free(intf);
+}
+
 /**
  * @brief Get channel ID from a list of channels.
  * @param channel - Channel name.
- * @param desc - Device descriptor
+ * @param intf - Interface of the device.
  * @param ch_out - If "true" is output channel, if "false" is input channel.
  * @return Channel ID, or negative value if attribute is not found.
  */
 static inline struct iio_channel *iio_get_channel(const char *channel,
-		struct iio_device *desc, bool ch_out)
+		struct iio_interface *intf, bool ch_out)
 {
-	int16_t i = 0;
-	char	ch_id[20];
-
-	while (i < desc->num_ch) {
-		_print_ch_id(ch_id, &desc->channels[i]);
-		if (!strcmp(channel, ch_id) &&
-		    (desc->channels[i].ch_out == ch_out))
-			return &desc->channels[i];
-		i++;
-	}
-
-	return NULL;
+	return iio_lookup_find(&intf->ch_lookup, ch_out, channel);
 }
 
 /**
  * @brief Find interface with "device_name".
+ * Device names are "device<n>", n being the index in the device table.
+ * @param desc - IIO descriptor.
  * @param device_name - Device name.
- * @param iio_interfaces - List of interfaces.
  * @return Interface pointer if interface is found, NULL otherwise.
  */
-static struct iio_interface *iio_get_interface(const char *device_name)
+static struct iio_interface *iio_get_interface(struct iio_desc *desc,
+		const char *device_name)
 {
-	struct iio_interface	*interface;
-	struct iio_interface	cmp_val;
-	int32_t					ret;
+	uint32_t	idx = 0;
+	const char	*p;
 
-	strcpy(cmp_val.dev_id, device_name);
+	if (strncmp(device_name, "device", 6))
+		return NULL;
 
-	ret = list_read_find(g_desc->interfaces_list,
-			     (void **)&interface, &cmp_val);
-	if (IS_ERR_VALUE(ret))
+	p = device_name + 6;
+	if (!*p)
 		return NULL;
+	while (*p) {
+		if (*p < '0' || *p > '9')
+			return NULL;
+		idx = idx * 10 + (*p++ - '0');
+		if (idx >= desc->dev_count)
+			return NULL;
+	}
+
+	return desc->dev_table[idx];
+}
+
+/* Drop the cached values that a store may have changed */
+static void iio_cache_invalidate(struct iio_interface *intf)
+{
+	uint32_t i;
 
-	return interface;
+	for (i = 0; i < intf->nb_cache; i++)
+		if (intf->cache[i].attr->cache == IIO_ATTR_CACHED)
+			intf->cache[i].valid = false;
+}
+
+/**
+ * @brief Read an attribute, from the cache when it holds its value.
+ * @param params - Structure describing parameters for the show function.
+ * @param intf - Interface of the device.
+ * @param attr - Attribute to be read.
+ * @return Length of chars read or negative value in case of error.
+ */
+static ssize_t iio_attr_show(struct attr_fun_params *params,
+			     struct iio_interface *intf,
+			     struct iio_attribute *attr)
+{
+	struct iio_attr_cache_slot	*slot = NULL;
+	char				*value;
+	ssize_t				ret;
+
+	if (attr->cache != IIO_ATTR_NO_CACHE) {
+		slot = iio_lookup_find(&intf->cache_lookup, params->cache_tag,
+				       attr->name);
+		if (slot && slot->valid && (size_t)slot->len < params->len) {
+			memcpy(params->buf, slot->value, slot->len + 1);
+			return slot->len;
+		}
+	}
+
+	ret = attr->show(params->dev_instance, params->buf, params->len,
+			 params->ch_info, attr->priv);
+	/* Truncated values are not cached */
+	if (!slot || ret < 0 || (size_t)ret >= params->len)
+		return ret;
+
+	value = realloc(slot->value, ret + 1);
+	if (value) {
+		memcpy(value, params->buf, ret);
+		value[ret] = '\0';
+		slot->value = value;
+		slot->len = ret;
+		slot->valid = true;
+	}
+
+	return ret;
 }
 
 /**
@@ -377,22 +1032,24 @@ static struct iio_interface *iio_get_interface(const char *device_name)
  * @param buf - Buffer where values are read.
  * @param len - Maximum length of value to be stored in buf.
  * @param channel - Channel properties.
+ * @param intf - Interface of the device.
  * @param attributes - List of attributes to be read.
  * @return Number of bytes read or negative value in case of error.
  */
 static ssize_t iio_read_all_attr(struct attr_fun_params *params,
+				 struct iio_interface *intf,
 				 struct iio_attribute *attributes)
 {
+	struct attr_fun_params local_params = *params;
 	int16_t i = 0, j = 0;
 	char local_buf[256];
 	ssize_t attr_length;
 	uint32_t *pattr_length;
 
+	local_params.buf = local_buf;
+	local_params.len = sizeof(local_buf);
 	while (attributes[i].name) {
-		attr_length = attributes[i].show(params->dev_instance,
-						 local_buf, params->len,
-						 params->ch_info,
-						 attributes[i].priv);
+		attr_length = iio_attr_show(&local_params, intf, &attributes[i]);
 		pattr_length = (uint32_t *)(params->buf + j);
 		*pattr_length = bswap_constant_32(attr_length);
 		j += 4;
@@ -414,10 +1071,12 @@ static ssize_t iio_read_all_attr(struct attr_fun_params *params,
  * @param buf - Values to be written.
  * @param len - Length of buf.
  * @param channel - Channel properties.
+ * @param intf - Interface of the device.
  * @param attributes - List of attributes to be written.
  * @return Number of written bytes or negative value in case of error.
  */
 static ssize_t iio_write_all_attr(struct attr_fun_params *params,
+				  struct iio_interface *intf,
 				  struct iio_attribute *attributes)
 {
 	int16_t i = 0, j = 0;
@@ -434,6 +1093,7 @@ static ssize_t iio_write_all_attr(struct attr_fun_params *params,
 			j = ((j >> 2) + 1) << 2;
 		i++;
 	}
+	iio_cache_invalidate(intf);
 
 	return params->len;
 }
@@ -441,6 +1101,7 @@ static ssize_t iio_write_all_attr(struct attr_fun_params *params,
 /**
  * @brief Read/write attribute.
  * @param params - Structure describing parameters for store and show functions
+ * @param intf - Interface of the device.
  * @param attributes - Array of attributes.
  * @param attr_name - Attribute name to be modified
  * @param is_write -If it has value "1", writes attribute, otherwise reads
@@ -448,35 +1109,33 @@ static ssize_t iio_write_all_attr(struct attr_fun_params *params,
  * @return Length of chars written/read or negative value in case of error.
  */
 static ssize_t iio_rd_wr_attribute(struct attr_fun_params *params,
+				   struct iio_interface *intf,
 				   struct iio_attribute *attributes,
 				   char *attr_name,
 				   bool is_write)
 {
-	int16_t i = 0;
-
-	/* Search attribute */
-	while (attributes[i].name) {
-		if (!strcmp(attr_name, attributes[i].name))
-			break;
-		i++;
-	}
+	struct iio_attribute *attr;
+	ssize_t ret;
 
-	if (!attributes[i].name)
+	attr = iio_lookup_find(&intf->attr_lookup, (uintptr_t)attributes,
+			       attr_name);
+	if (!attr)
 		return -ENOENT;
 
 	if (is_write) {
-		if (!attributes[i].store)
+		if (!attr->store)
 			return -ENOENT;
 
-		return attributes[i].store(params->dev_instance, params->buf,
-					   params->len, params->ch_info,
-					   attributes[i].priv);
+		ret = attr->store(params->dev_instance, params->buf,
+				  params->len, params->ch_info, attr->priv);
+		/* Even a failed store may have changed some values */
+		iio_cache_invalidate(intf);
+
+		return ret;
 	} else {
-		if (!attributes[i].show)
+		if (!attr->show)
 			return -ENOENT;
-		return attributes[i].show(params->dev_instance, params->buf,
-					  params->len, params->ch_info,
-					  attributes[i].priv);
+		return iio_attr_show(params, intf, attr);
 	}
 }
 
@@ -522,6 +1181,7 @@ static int32_t debug_reg_write(struct iio_interface *dev, const char *buf,
 		/* Write register */
 		ret = dev->dev_descriptor->debug_reg_write(dev->dev_instance,
 				addr, value);
+		iio_cache_invalidate(dev);
 		if (IS_ERR_VALUE(ret))
 			return ret;
 	} else {
@@ -552,8 +1212,9 @@ static ssize_t iio_read_attr(const char *device_id, const char *attr, char *buf,
 	struct iio_interface	*dev;
 	struct attr_fun_params	params;
 	struct iio_attribute	*attributes;
+	ssize_t			ret;
 
-	dev = iio_get_interface(device_id);
+	dev = iio_get_interface(g_conn->desc, device_id);
 	if (!dev)
 		return FAILURE;
 
@@ -565,10 +1226,12 @@ static ssize_t iio_read_attr(const char *device_id, const char *attr, char *buf,
 	switch (type) {
 	case IIO_ATTR_TYPE_DEBUG:
 		if (strcmp(attr, REG_ACCESS_ATTRIBUTE) == 0) {
-			if (dev->dev_descriptor->debug_reg_read)
-				return debug_reg_read(dev, buf, len);
-			else
+			if (!dev->dev_descriptor->debug_reg_read)
 				return -ENOENT;
+			IIO_LOCK(&dev->lock);
+			ret = debug_reg_read(dev, buf, len);
+			IIO_UNLOCK(&dev->lock);
+			return ret;
 		}
 		attributes = dev->dev_descriptor->debug_attributes;
 		break;
@@ -580,10 +1243,16 @@ static ssize_t iio_read_attr(const char *device_id, const char *attr, char *buf,
 		break;
 	}
 
+	params.cache_tag = (uintptr_t)attributes;
+	IIO_LOCK(&dev->lock);
 	if (!strcmp(attr, ""))
-		return iio_read_all_attr(&params, attributes);
+		ret = iio_read_all_attr(&params, dev, attributes);
 	else
-		return iio_rd_wr_attribute(&params,attributes, (char *)attr, 0);
+		ret = iio_rd_wr_attribute(&params, dev, attributes,
+					  (char *)attr, 0);
+	IIO_UNLOCK(&dev->lock);
+
+	return ret;
 }
 
 /**
@@ -602,8 +1271,9 @@ static ssize_t iio_write_attr(const char *device_id, const char *attr,
 	struct iio_interface	*dev;
 	struct attr_fun_params	params;
 	struct iio_attribute	*attributes;
+	ssize_t			ret;
 
-	dev = iio_get_interface(device_id);
+	dev = iio_get_interface(g_conn->desc, device_id);
 	if (!dev)
 		return -ENODEV;
 
@@ -615,10 +1285,12 @@ static ssize_t iio_write_attr(const char *device_id, const char *attr,
 	switch (type) {
 	case IIO_ATTR_TYPE_DEBUG:
 		if (strcmp(attr, REG_ACCESS_ATTRIBUTE) == 0) {
-			if (dev->dev_descriptor->debug_reg_write)
-				return debug_reg_write(dev, buf, len);
-			else
+			if (!dev->dev_descriptor->debug_reg_write)
 				return -ENOENT;
+			IIO_LOCK(&dev->lock);
+			ret = debug_reg_write(dev, buf, len);
+			IIO_UNLOCK(&dev->lock);
+			return ret;
 		}
 		attributes = dev->dev_descriptor->debug_attributes;
 		break;
@@ -630,10 +1302,16 @@ static ssize_t iio_write_attr(const char *device_id, const char *attr,
 		break;
 	}
 
+	params.cache_tag = (uintptr_t)attributes;
+	IIO_LOCK(&dev->lock);
 	if (!strcmp(attr, ""))
-		return iio_write_all_attr(&params, attributes);
+		ret = iio_write_all_attr(&params, dev, attributes);
 	else
-		return iio_rd_wr_attribute(&params, attributes, (char *)attr, 1);
+		ret = iio_rd_wr_attribute(&params, dev, attributes,
+					  (char *)attr, 1);
+	IIO_UNLOCK(&dev->lock);
+
+	return ret;
 }
 
 /**
@@ -653,12 +1331,13 @@ static ssize_t iio_ch_read_attr(const char *device_id, const char *channel,
 	struct iio_ch_info	ch_info;
 	struct iio_channel	*ch;
 	struct attr_fun_params	params;
+	ssize_t			ret;
 
-	dev = iio_get_interface(device_id);
+	dev = iio_get_interface(g_conn->desc, device_id);
 	if (!dev)
 		return FAILURE;
 
-	ch = iio_get_channel(channel, dev->dev_descriptor, ch_out);
+	ch = iio_get_channel(channel, dev, ch_out);
 	if (!ch)
 		return -ENOENT;
 
@@ -668,10 +1347,16 @@ static ssize_t iio_ch_read_attr(const char *device_id, const char *channel,
 	params.len = len;
 	params.dev_instance = dev->dev_instance;
 	params.ch_info = &ch_info;
+	params.cache_tag = (uintptr_t)ch;
+	IIO_LOCK(&dev->lock);
 	if (!strcmp(attr, ""))
-		return iio_read_all_attr(&params, ch->attributes);
+		ret = iio_read_all_attr(&params, dev, ch->attributes);
 	else
-		return iio_rd_wr_attribute(&params, ch->attributes, (char *)attr, 0);
+		ret = iio_rd_wr_attribute(&params, dev, ch->attributes,
+					  (char *)attr, 0);
+	IIO_UNLOCK(&dev->lock);
+
+	return ret;
 }
 
 /**
@@ -691,12 +1376,13 @@ static ssize_t iio_ch_write_attr(const char *device_id, const char *channel,
 	struct iio_ch_info	ch_info;
 	struct iio_channel	*ch;
 	struct attr_fun_params	params;
+	ssize_t			ret;
 
-	dev = iio_get_interface(device_id);
+	dev = iio_get_interface(g_conn->desc, device_id);
 	if (!dev)
 		return -ENOENT;
 
-	ch = iio_get_channel(channel, dev->dev_descriptor, ch_out);
+	ch = iio_get_channel(channel, dev, ch_out);
 	if (!ch)
 		return -ENOENT;
 
@@ -706,10 +1392,16 @@ static ssize_t iio_ch_write_attr(const char *device_id, const char *channel,
 	params.len = len;
 	params.dev_instance = dev->dev_instance;
 	params.ch_info = &ch_info;
+	params.cache_tag = (uintptr_t)ch;
+	IIO_LOCK(&dev->lock);
 	if (!strcmp(attr, ""))
-		return iio_write_all_attr(&params, ch->attributes);
+		ret = iio_write_all_attr(&params, dev, ch->attributes);
 	else
-		return iio_rd_wr_attribute(&params, ch->attributes, (char *)attr, 1);
+		ret = iio_rd_wr_attribute(&params, dev, ch->attributes,
+					  (char *)attr, 1);
+	IIO_UNLOCK(&dev->lock);
+
+	return ret;
 }
 
 /**
@@ -717,6 +1409,7 @@ static ssize_t iio_ch_write_attr(const char *device_id, const char *channel,
  * @param device - String containing device name.
  * @param sample_size - Sample size.
  * @param mask - Channels to be opened.
+ * @param cyclic - The buffer is replayed until the device is closed.
  * @return SUCCESS, negative value in case of failure.
  */
 static int32_t iio_open_dev(const char *device, size_t sample_size,
@@ -724,8 +1417,9 @@ static int32_t iio_open_dev(const char *device, size_t sample_size,
 {
 	struct iio_interface *iface;
 	uint32_t ch_mask;
+	int32_t ret;
 
-	iface = iio_get_interface(device);
+	iface = iio_get_interface(g_conn->desc, device);
 	if (!iface)
 		return -ENODEV;
 
@@ -734,13 +1428,18 @@ static int32_t iio_open_dev(const char *device, size_t sample_size,
 	if (mask & ~ch_mask)
 		return -ENOENT;
 
+	IIO_LOCK(&iface->lock);
 	iface->ch_mask = mask;
-
-	if (iface->dev_descriptor->prepare_transfer)
-		return iface->dev_descriptor->prepare_transfer(
-			       iface->dev_instance, mask);
-
-	return SUCCESS;
+	ret = SUCCESS;
+	if (iface->dev_descriptor->set_cyclic)
+		ret = iface->dev_descriptor->set_cyclic(iface->dev_instance,
+							cyclic);
+	if (!IS_ERR_VALUE(ret) && iface->dev_descriptor->prepare_transfer)
+		ret = iface->dev_descriptor->prepare_transfer(
+			      iface->dev_instance, mask);
+	IIO_UNLOCK(&iface->lock);
+
+	return ret;
 }
 
 /**
@@ -751,16 +1450,22 @@ static int32_t iio_open_dev(const char *device, size_t sample_size,
 static int32_t iio_close_dev(const char *device)
 {
 	struct iio_interface *iface;
+	int32_t ret;
 
-	iface = iio_get_interface(device);
+	iface = iio_get_interface(g_conn->desc, device);
 	if (!iface)
 		return FAILURE;
 
+	IIO_LOCK(&iface->lock);
 	iface->ch_mask = 0;
+	/* A zero-copy buffer is given back to the device by end_transfer */
+	iface->rd_size = 0;
+	ret = SUCCESS;
 	if (iface->dev_descriptor->end_transfer)
-		return iface->dev_descriptor->end_transfer(iface->dev_instance);
+		ret = iface->dev_descriptor->end_transfer(iface->dev_instance);
+	IIO_UNLOCK(&iface->lock);
 
-	return SUCCESS;
+	return ret;
 }
 
 /**
@@ -773,7 +1478,7 @@ static int32_t iio_get_mask(const char *device, uint32_t *mask)
 {
 	struct iio_interface *iface;
 
-	iface = iio_get_interface(device);
+	iface = iio_get_interface(g_conn->desc, device);
 	if (!iface)
 		return -ENODEV;
 
@@ -818,30 +1523,65 @@ static uint32_t bytes_to_samples(struct iio_interface *intf, uint32_t bytes)
  */
 static ssize_t iio_transfer_dev_to_mem(const char *device, size_t bytes_count)
 {
-	struct iio_interface *iio_interface = iio_get_interface(device);
+	struct iio_interface *iio_interface = iio_get_interface(g_conn->desc,
+					      device);
+	struct iio_device	*dev_desc = iio_interface->dev_descriptor;
 	struct iio_data_buffer	*r_buff;
 	uint32_t		samples;
 	ssize_t			ret;
+	void			*data;
 
 	r_buff = iio_interface->read_buffer;
-	if (r_buff && iio_interface->dev_descriptor->read_dev) {
-		if (bytes_count > r_buff->size)
-			return -ENOMEM;
-		samples = bytes_to_samples(iio_interface, bytes_count);
-		ret = iio_interface->dev_descriptor->read_dev(
-			      iio_interface->dev_instance,
-			      r_buff->buff, samples);
-		return ret < 0 ? ret : (ssize_t)bytes_count;
+	if (!dev_desc->read_dev_zc && !(r_buff && dev_desc->read_dev))
+		return -ENOENT;
+
+#ifdef ENABLE_IIO_THREADS
+	/* Keep the buffer until it is sent, see iio_phy_read() */
+	if (g_conn->rd_owner != iio_interface) {
+		if (g_conn->rd_owner)
+			IIO_UNLOCK(&g_conn->rd_owner->rd_lock);
+		IIO_LOCK(&iio_interface->rd_lock);
+		g_conn->rd_owner = iio_interface;
 	}
+#endif
+	iio_interface->rd_size = 0;
+	samples = bytes_to_samples(iio_interface, bytes_count);
+	ret = -ENOTSUP;
+	IIO_LOCK(&iio_interface->lock);
+	/* Send the samples straight from the device buffer when it allows */
+	if (dev_desc->read_dev_zc)
+		ret = dev_desc->read_dev_zc(iio_interface->dev_instance,
+					    &data, samples);
+	if (ret == -ENOTSUP) {
+		if (!r_buff || !dev_desc->read_dev)
+			ret = -ENOENT;
+		else if (bytes_count > r_buff->size)
+			ret = -ENOMEM;
+		else
+			ret = dev_desc->read_dev(iio_interface->dev_instance,
+						 r_buff->buff, samples);
+		data = r_buff ? r_buff->buff : NULL;
+	}
+	IIO_UNLOCK(&iio_interface->lock);
+	if (ret < 0)
+		return ret;
 
-	return -ENOENT;
+	iio_interface->rd_data = data;
+	iio_interface->rd_size = bytes_count;
+
+	return bytes_count;
 }
 
 /**
- * @brief Read chunk of data from RAM to pbuf. Call
- * "iio_transfer_dev_to_mem()" first.
+ * @brief Read chunk of data from the buffer filled by
+ * "iio_transfer_dev_to_mem()", call it first. That is the read buffer of the
+ * interface or, for devices implementing read_dev_zc, a buffer of the device.
  * This function is probably called multiple times by libtinyiiod after a
  * "iio_transfer_dev_to_mem" call, since we can only read "bytes_count" bytes.
+ * The data is not copied: libtinyiiod writes pbuf back to the client right
+ * after this call, so pbuf is only remembered as an alias of the device buffer
+ * and "iio_phy_write()" sends straight from the device buffer instead. Both
+ * ends check that libtinyiiod keeps to this order.
  * @param device - String containing device name.
  * @param pbuf - Buffer where value is stored.
  * @param offset - Offset to the remaining data after reading n chunks.
@@ -851,20 +1591,22 @@ static ssize_t iio_transfer_dev_to_mem(const char *device, size_t bytes_count)
 static ssize_t iio_read_dev(const char *device, char *pbuf, size_t offset,
 			    size_t bytes_count)
 {
-	struct iio_interface *iio_interface = iio_get_interface(device);
-	struct iio_data_buffer *r_buff;
-
-	r_buff = iio_interface->read_buffer;
-	if (r_buff) {
-		if (offset + bytes_count > r_buff->size)
-			return -ENOMEM;
+	struct iio_interface *iio_interface = iio_get_interface(g_conn->desc,
+					      device);
 
-		memcpy(pbuf, r_buff->buff + offset, bytes_count);
+	if (!iio_interface->rd_size)
+		return -ENOENT;
+	if (offset + bytes_count > iio_interface->rd_size)
+		return -ENOMEM;
+	/* The previous chunk is sent before the next one is asked for */
+	if (g_conn->zc_len)
+		return -EINVAL;
 
-		return bytes_count;
-	}
+	g_conn->zc_dst = pbuf;
+	g_conn->zc_src = (char *)iio_interface->rd_data + offset;
+	g_conn->zc_len = bytes_count;
 
-	return -ENOENT;
+	return bytes_count;
 }
 
 /**
@@ -875,7 +1617,8 @@ static ssize_t iio_read_dev(const char *device, char *pbuf, size_t offset,
  */
 static ssize_t iio_transfer_mem_to_dev(const char *device, size_t bytes_count)
 {
-	struct iio_interface *iio_interface = iio_get_interface(device);
+	struct iio_interface *iio_interface = iio_get_interface(g_conn->desc,
+					      device);
 	struct iio_data_buffer	*w_buff;
 	ssize_t			ret;
 	uint32_t		samples;
@@ -885,9 +1628,18 @@ static ssize_t iio_transfer_mem_to_dev(const char *device, size_t bytes_count)
 		if (bytes_count > w_buff->size)
 			return -ENOMEM;
 		samples = bytes_to_samples(iio_interface, bytes_count);
+		IIO_LOCK(&iio_interface->lock);
 		ret = iio_interface->dev_descriptor->write_dev(
 			      iio_interface->dev_instance,
 			      w_buff->buff, samples);
+		IIO_UNLOCK(&iio_interface->lock);
+#ifdef ENABLE_IIO_THREADS
+		/* Taken by the first iio_write_dev() of the buffer */
+		if (g_conn->wr_owner == iio_interface) {
+			IIO_UNLOCK(&iio_interface->wr_lock);
+			g_conn->wr_owner = NULL;
+		}
+#endif
 		return ret < 0 ? ret : (ssize_t)bytes_count;
 	}
 
@@ -908,13 +1660,23 @@ static ssize_t iio_transfer_mem_to_dev(const char *device, size_t bytes_count)
 static ssize_t iio_write_dev(const char *device, const char *buf,
 			     size_t offset, size_t bytes_count)
 {
-	struct iio_interface *iio_interface = iio_get_interface(device);
+	struct iio_interface *iio_interface = iio_get_interface(g_conn->desc,
+					      device);
 	struct iio_data_buffer	*w_buff;
 
 	w_buff = iio_interface->write_buffer;
 	if (w_buff) {
 		if (offset + bytes_count > w_buff->size)
 			return -ENOMEM;
+#ifdef ENABLE_IIO_THREADS
+		/* Keep the buffer until it is handed to the device */
+		if (g_conn->wr_owner != iio_interface) {
+			if (g_conn->wr_owner)
+				IIO_UNLOCK(&g_conn->wr_owner->wr_lock);
+			IIO_LOCK(&iio_interface->wr_lock);
+			g_conn->wr_owner = iio_interface;
+		}
+#endif
 		memcpy(w_buff->buff + offset, buf, bytes_count);
 		return bytes_count;
 	}
@@ -922,44 +1684,6 @@ static ssize_t iio_write_dev(const char *device, const char *buf,
 	return -ENOENT;
 }
 
-/**
- * @brief Get a merged xml containing all devices.
- * @param outxml - Generated xml.
- * @return SUCCESS in case of success or negative value otherwise.
- */
-static ssize_t iio_get_xml(char **outxml)
-{
-	if (!outxml)
-		return FAILURE;
-
-	*outxml = g_desc->xml_desc;
-
-	return g_desc->xml_size;
-}
-
-/**
- * @brief Execute an iio step
- * @param desc - IIo descriptor
- * @return SUCCESS in case of success or negative value otherwise.
- */
-ssize_t iio_step(struct iio_desc *desc)
-{
-#ifdef ENABLE_IIO_NETWORK
-	int32_t ret;
-
-	if (desc->phy_type == USE_NETWORK) {
-		if (desc->current_sock != NULL &&
-		    (int32_t)desc->current_sock != -1) {
-			ret = _push_sock(desc, desc->current_sock);
-			if (IS_ERR_VALUE(ret))
-				return ret;
-		}
-		desc->current_sock = NULL;
-	}
-#endif
-	return tinyiiod_read_command(desc->iiod);
-}
-
 /*
  * Generate an xml describing a device and write it to buff.
  * Will return the size of the xml.
@@ -1062,6 +1786,246 @@ static uint32_t iio_generate_device_xml(struct iio_device *device, char *name,
 	return i;
 }
 
+/**
+ * @brief Generate the context xml from the registered devices.
+ * @param desc - IIO descriptor.
+ * @return SUCCESS in case of success or negative value otherwise.
+ */
+static int32_t iio_generate_xml(struct iio_desc *desc)
+{
+	struct iio_interface	*intf;
+	uint32_t		size;
+	uint32_t		i;
+	uint32_t		n;
+	char			*xml;
+
+	/* Get number of bytes needed for the xml of all devices */
+	size = sizeof(header) + sizeof(header_end);
+	for (i = 0; i < desc->dev_count; i++) {
+		intf = desc->dev_table[i];
+		size += iio_generate_device_xml(intf->dev_descriptor,
+						(char *)intf->name, i, NULL, -1);
+	}
+
+	xml = calloc(1, size);
+	if (!xml)
+		return -ENOMEM;
+
+	strcpy(xml, header);
+	n = sizeof(header) - 1;
+	for (i = 0; i < desc->dev_count; i++) {
+		intf = desc->dev_table[i];
+		n += iio_generate_device_xml(intf->dev_descriptor,
+					     (char *)intf->name, i,
+					     xml + n, size - n);
+	}
+	strcpy(xml + n, header_end);
+
+	desc->xml_desc = xml;
+	desc->xml_size = size;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Check that the prebuilt context xml describes the registered devices:
+ * the same ids and names, and no other device.
+ * @param desc - IIO descriptor.
+ * @return true if the prebuilt xml can be served.
+ */
+static bool iio_prebuilt_xml_matches(struct iio_desc *desc)
+{
+	const char		*xml = desc->xml_prebuilt;
+	struct iio_interface	*intf;
+	char			prefix[32];
+	const char		*p;
+	uint32_t		nb_devices;
+	uint32_t		nb_found;
+	uint32_t		len;
+	uint32_t		i;
+
+	/* Generated by iio_xml2c.py, with the terminating null character */
+	if (!desc->xml_prebuilt_size ||
+	    xml[desc->xml_prebuilt_size - 1] != '\0')
+		return false;
+
+	nb_devices = 0;
+	for (p = strstr(xml, "<device "); p; p = strstr(p + 1, "<device "))
+		nb_devices++;
+
+	nb_found = 0;
+	for (i = 0; i < desc->dev_count; i++) {
+		intf = desc->dev_table[i];
+		sprintf(prefix, "<device id=\"%s\" name=\"", intf->dev_id);
+		p = strstr(xml, prefix);
+		if (!p)
+			return false;
+
+		p += strlen(prefix);
+		len = strlen(intf->name);
+		if (strncmp(p, intf->name, len) || p[len] != '"')
+			return false;
+
+		nb_found++;
+	}
+
+	return nb_found == nb_devices;
+}
+
+/* Drop the context xml after the registered devices changed */
+static void iio_invalidate_xml(struct iio_desc *desc)
+{
+	if (desc->xml_desc != desc->xml_prebuilt)
+		free(desc->xml_desc);
+	desc->xml_desc = NULL;
+}
+
+/**
+ * @brief Get a merged xml containing all devices. The xml is chosen on the
+ * first request after a device was registered or unregistered: the prebuilt
+ * one if it still describes the registered devices, a generated one otherwise.
+ * @param outxml - Generated xml.
+ * @return Size of the xml or negative value in case of error.
+ */
+static ssize_t iio_get_xml(char **outxml)
+{
+	struct iio_desc	*desc = g_conn->desc;
+	int32_t		ret = SUCCESS;
+
+	if (!outxml)
+		return FAILURE;
+
+	IIO_LOCK(&desc->xml_lock);
+	if (!desc->xml_desc) {
+		if (desc->xml_prebuilt && iio_prebuilt_xml_matches(desc)) {
+			desc->xml_desc = (char *)desc->xml_prebuilt;
+			desc->xml_size = desc->xml_prebuilt_size;
+		} else {
+			ret = iio_generate_xml(desc);
+		}
+	}
+	IIO_UNLOCK(&desc->xml_lock);
+	if (IS_ERR_VALUE(ret))
+		return ret;
+
+	*outxml = desc->xml_desc;
+
+	return desc->xml_size;
+}
+
+#ifdef ENABLE_IIO_THREADS
+/**
+ * @brief Serve a client until it disconnects.
+ * @param arg - Connection of the client.
+ * @return NULL
+ */
+static void *iio_client_thread(void *arg)
+{
+	struct iio_conn *conn = arg;
+
+	g_conn = conn;
+	while ((int32_t)conn->sock != -1)
+		tinyiiod_read_command(conn->iiod);
+
+	/* Give back the buffers of a client gone mid transfer */
+	if (conn->rd_owner)
+		IIO_UNLOCK(&conn->rd_owner->rd_lock);
+	if (conn->wr_owner)
+		IIO_UNLOCK(&conn->wr_owner->wr_lock);
+	tinyiiod_destroy(conn->iiod);
+	free(conn);
+
+	return NULL;
+}
+
+/**
+ * @brief Wait for a new client and start a thread serving it.
+ * @param desc - IIO descriptor
+ * @return SUCCESS in case of success or negative value otherwise.
+ */
+static int32_t iio_accept_client(struct iio_desc *desc)
+{
+	struct iio_conn	*conn;
+	pthread_t	thread;
+	uint32_t	ready;
+	int32_t		ret;
+
+	ret = socket_poll(&desc->server, 1, &ready, -1);
+	if (ret == -ENOSYS)
+		mdelay(1);
+	else if (IS_ERR_VALUE(ret))
+		return ret;
+
+	conn = (struct iio_conn *)calloc(1, sizeof(*conn));
+	if (!conn)
+		return -ENOMEM;
+	conn->desc = desc;
+
+	ret = socket_accept(desc->server, &conn->sock);
+	if (ret == -EAGAIN) {
+		free(conn);
+		return SUCCESS;
+	} else if (IS_ERR_VALUE(ret)) {
+		goto free_conn;
+	}
+
+	conn->iiod = tinyiiod_create(desc->iiod_ops);
+	if (!conn->iiod) {
+		ret = -ENOMEM;
+		goto free_sock;
+	}
+
+	ret = pthread_create(&thread, NULL, iio_client_thread, conn);
+	if (ret) {
+		ret = -ret;
+		goto free_iiod;
+	}
+	pthread_detach(thread);
+
+	return SUCCESS;
+
+free_iiod:
+	tinyiiod_destroy(conn->iiod);
+free_sock:
+	socket_remove(conn->sock);
+free_conn:
+	free(conn);
+
+	return ret;
+}
+#endif
+
+/**
+ * @brief Execute an iio step
+ * With ENABLE_IIO_THREADS, a network step accepts a client and serves it
+ * in its own thread.
+ * @param desc - IIo descriptor
+ * @return SUCCESS in case of success or negative value otherwise.
+ */
+ssize_t iio_step(struct iio_desc *desc)
+{
+#ifdef ENABLE_IIO_THREADS
+	if (desc->phy_type == USE_NETWORK)
+		return iio_accept_client(desc);
+#endif
+#ifdef ENABLE_IIO_NETWORK
+	int32_t ret;
+
+	if (desc->phy_type == USE_NETWORK) {
+		if (desc->conn.sock != NULL &&
+		    (int32_t)desc->conn.sock != -1) {
+			ret = _push_sock(desc, desc->conn.sock);
+			if (IS_ERR_VALUE(ret))
+				return ret;
+		}
+		desc->conn.sock = NULL;
+	}
+#endif
+	g_conn = &desc->conn;
+
+	return tinyiiod_read_command(desc->iiod);
+}
+
 /**
  * @brief Register interface.
  * @param desc - iio descriptor
@@ -1076,10 +2040,8 @@ ssize_t iio_register(struct iio_desc *desc, struct iio_device *dev_descriptor,
 		     struct iio_data_buffer *write_buff)
 {
 	struct iio_interface	*iio_interface;
+	struct iio_interface	**table;
 	int32_t ret;
-	int32_t	n;
-	int32_t	new_size;
-	char	*aux;
 
 	iio_interface = (struct iio_interface *)calloc(1,
 			sizeof(*iio_interface));
@@ -1090,40 +2052,36 @@ ssize_t iio_register(struct iio_desc *desc, struct iio_device *dev_descriptor,
 	iio_interface->dev_descriptor = dev_descriptor;
 	iio_interface->read_buffer = read_buff;
 	iio_interface->write_buffer = write_buff;
+#ifdef ENABLE_IIO_THREADS
+	pthread_mutex_init(&iio_interface->lock, NULL);
+	pthread_mutex_init(&iio_interface->rd_lock, NULL);
+	pthread_mutex_init(&iio_interface->wr_lock, NULL);
+#endif
 
-	/* Get number of bytes needed for the xml of the new device */
-	n = iio_generate_device_xml(iio_interface->dev_descriptor,
-				    (char *)iio_interface->name,
-				    desc->dev_count, NULL, -1);
+	ret = iio_interface_build_lookup(iio_interface);
+	if (IS_ERR_VALUE(ret)) {
+		iio_interface_free(iio_interface);
+		return ret;
+	}
 
-	new_size = desc->xml_size + n;
-	aux = realloc(desc->xml_desc, new_size);
-	if (!aux) {
-		free(iio_interface);
+	table = realloc(desc->dev_table,
+			(desc->dev_count + 1) * sizeof(*desc->dev_table));
+	if (!table) {
+		iio_interface_free(iio_interface);
 		return -ENOMEM;
 	}
+	desc->dev_table = table;
 
+	sprintf((char *)iio_interface->dev_id, "device%d", (int)desc->dev_count);
 	ret = desc->interfaces_list->push(desc->interfaces_list, iio_interface);
 	if (IS_ERR_VALUE(ret)) {
-		free(iio_interface);
-		free(aux);
+		iio_interface_free(iio_interface);
 		return ret;
 	}
 
-	desc->xml_desc = aux;
-	/* Print the new device xml at the end of the xml */
-	iio_generate_device_xml(iio_interface->dev_descriptor,
-				(char *)iio_interface->name,
-				desc->dev_count,
-				desc->xml_desc + desc->xml_size_to_last_dev,
-				new_size - desc->xml_size_to_last_dev);
-	sprintf((char *)iio_interface->dev_id, "device%d", (int)desc->dev_count);
-	desc->xml_size_to_last_dev += n;
-	desc->xml_size += n;
-	/* Copy end header at the end */
-	strcat(desc->xml_desc, header_end);
-
+	desc->dev_table[desc->dev_count] = iio_interface;
 	desc->dev_count++;
+	iio_invalidate_xml(desc);
 
 	return SUCCESS;
 }
@@ -1136,31 +2094,29 @@ ssize_t iio_register(struct iio_desc *desc, struct iio_device *dev_descriptor,
 ssize_t iio_unregister(struct iio_desc *desc, char *name)
 {
 	struct iio_interface	*to_remove_interface;
-	struct iio_interface	search_interface;
+	uint32_t		i;
 	int32_t			ret;
-	int32_t			n;
-	char			*aux;
 
-	/* Get if the item is found, get will remove it from the list */
-	search_interface.name = name;
+	for (i = 0; i < desc->dev_count; i++)
+		if (!strcmp(desc->dev_table[i]->name, name))
+			break;
+	if (i == desc->dev_count)
+		return -ENOENT;
+
+	/* Get will remove it from the list */
 	ret = list_get_find(desc->interfaces_list,
-			    (void **)&to_remove_interface, &search_interface);
+			    (void **)&to_remove_interface, desc->dev_table[i]);
 	if (IS_ERR_VALUE(ret))
 		return ret;
-	free(to_remove_interface);
-
-	/* Get number of bytes needed for the xml of the device */
-	n = iio_generate_device_xml(to_remove_interface->dev_descriptor,
-				    (char *)to_remove_interface->name,
-				    desc->dev_count, NULL, -1);
+	iio_interface_free(to_remove_interface);
 
-	/* Overwritte the deleted device */
-	aux = desc->xml_desc + desc->xml_size_to_last_dev - n;
-	memmove(aux, aux + n, strlen(aux + n));
-
-	/* Decrease the xml size */
-	desc->xml_size -= n;
-	desc->xml_size_to_last_dev -= n;
+	/* Keep the table dense, the next devices move down one id */
+	desc->dev_count--;
+	for (; i < desc->dev_count; i++) {
+		desc->dev_table[i] = desc->dev_table[i + 1];
+		sprintf((char *)desc->dev_table[i]->dev_id, "device%d", (int)i);
+	}
+	iio_invalidate_xml(desc);
 
 	return SUCCESS;
 }
@@ -1214,14 +2170,9 @@ ssize_t iio_init(struct iio_desc **desc, struct iio_init_param *init_param)
 	ops->read = iio_phy_read;
 	ops->write = iio_phy_write;
 
-	ldesc->xml_size = sizeof(header) + sizeof(header_end);
-	ldesc->xml_desc = (char *)malloc(ldesc->xml_size);
-	if (!ldesc->xml_desc)
-		goto free_desc;
-
-	strcpy(ldesc->xml_desc, header);
-	strcat(ldesc->xml_desc, header_end);
-	ldesc->xml_size_to_last_dev = sizeof(header) - 1;
+	/* Checked against the registered devices when first requested */
+	ldesc->xml_prebuilt = init_param->xml;
+	ldesc->xml_prebuilt_size = init_param->xml_size;
 
 	ldesc->phy_type = init_param->phy_type;
 	if (init_param->phy_type == USE_UART) {
@@ -1233,7 +2184,8 @@ ssize_t iio_init(struct iio_desc **desc, struct iio_init_param *init_param)
 				  init_param->tcp_socket_init_param);
 		if (IS_ERR_VALUE(ret))
 			goto free_desc;
-		ret = socket_bind(ldesc->server, IIOD_PORT);
+		ret = socket_bind(ldesc->server, init_param->port ?
+				  init_param->port : IIOD_PORT);
 		if (IS_ERR_VALUE(ret))
 			goto free_pylink;
 		ret = socket_listen(ldesc->server, 0);
@@ -1263,8 +2215,11 @@ ssize_t iio_init(struct iio_desc **desc, struct iio_init_param *init_param)
 	if (!(ldesc->iiod))
 		goto free_list;
 
+#ifdef ENABLE_IIO_THREADS
+	pthread_mutex_init(&ldesc->xml_lock, NULL);
+#endif
+	ldesc->conn.desc = ldesc;
 	*desc = ldesc;
-	g_desc = ldesc;
 
 	return SUCCESS;
 
@@ -1297,13 +2252,17 @@ ssize_t iio_remove(struct iio_desc *desc)
 
 	while (SUCCESS == list_get_first(desc->interfaces_list,
 					 (void **)&iio_interface))
-		free(iio_interface);
+		iio_interface_free(iio_interface);
 	list_remove(desc->interfaces_list);
+	free(desc->dev_table);
 
 	free(desc->iiod_ops);
 	tinyiiod_destroy(desc->iiod);
 
-	free(desc->xml_desc);
+	iio_invalidate_xml(desc);
+#ifdef ENABLE_IIO_THREADS
+	pthread_mutex_destroy(&desc->xml_lock);
+#endif
 
 	if (desc->phy_type == USE_UART) {
 		uart_remove(desc->phy_desc);
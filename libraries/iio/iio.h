@@ -72,6 +72,16 @@ struct iio_init_param {
 		struct tcp_socket_init_param *tcp_socket_init_param;
 #endif
 	};
+#ifdef ENABLE_IIO_NETWORK
+	/* TCP port to listen on, 0 for the default IIOD port */
+	uint16_t	port;
+#endif
+	/* Prebuilt context xml (see tools/scripts/iio_xml2c.py), served as is
+	 * instead of the xml generated from the registered devices, as long
+	 * as it lists the same device ids and names. NULL to generate it. */
+	const char	*xml;
+	/* Size of the prebuilt context xml */
+	uint32_t	xml_size;
 };
 
 /******************************************************************************/
@@ -89,6 +89,19 @@ struct iio_ch_info {
 
 #define END_ATTRIBUTES_ARRAY {.name = NULL}
 
+/**
+ * @enum iio_attr_cache
+ * @brief How the IIO layer may cache the value returned by a show function.
+ */
+enum iio_attr_cache {
+	/** Call the show function on every read */
+	IIO_ATTR_NO_CACHE,
+	/** Value never changes once the device is registered */
+	IIO_ATTR_STATIC,
+	/** Value only changes when an attribute of the device is stored */
+	IIO_ATTR_CACHED,
+};
+
 /**
  * @struct iio_attribute
  * @brief Structure holding pointers to show and store functions.
@@ -104,6 +117,8 @@ struct iio_attribute {
 	/** Store function pointer */
 	ssize_t (*store)(void *device, char *buf, size_t len,
 			 const struct iio_ch_info *channel, intptr_t priv);
+	/** Caching of the value returned by show, IIO_ATTR_NO_CACHE if unset */
+	enum iio_attr_cache cache;
 };
 
 /**
@@ -181,10 +196,19 @@ struct iio_device {
 	int32_t (*prepare_transfer)(void *dev, uint32_t mask);
 	/** Called after a tranfer ends */
 	int32_t (*end_transfer)(void *dev);
+	/** Optional. Called before prepare_transfer with the cyclic flag of the
+	 * buffer opened by the client */
+	int32_t (*set_cyclic)(void *dev, bool cyclic);
 	/* Numbers of bytes will be:
 	 * samples * (storage_size_of_first_active_ch / 8) * nb_active_channels
 	 */
 	int32_t	(*read_dev)(void *dev, void *buff, uint32_t nb_samples);
+	/* Optional. Same as read_dev, but the samples are left in a buffer of
+	 * the device and buff is set to point to them. The buffer must stay
+	 * valid until the next call or end_transfer. Return -ENOTSUP to have
+	 * the samples read with read_dev instead.
+	 */
+	int32_t	(*read_dev_zc)(void *dev, void **buff, uint32_t nb_samples);
 	/* Numbers of bytes will be:
 	 * samples * (storage_size_of_first_active_ch / 8) * nb_active_channels
 	 */
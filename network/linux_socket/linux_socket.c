@@ -58,6 +58,8 @@
 #include <netdb.h>
 #include <string.h>
 #include <fcntl.h>
+#include <poll.h>
+#include <errno.h>
 
 /******************************************************************************/
 /*************************** FUnctions Declarations *******************************/
@@ -153,7 +155,11 @@ static int32_t linux_socket_recv(struct linux_desc *desc, uint32_t sock_id,
 	if(ret < 0)
 		return -errno;
 
-	return size;
+	/* Orderly shutdown of the peer */
+	if(ret == 0 && size)
+		return -ENOTCONN;
+
+	return ret;
 }
 
 /** @brief See \ref network_interface.socket_sendto */
@@ -260,6 +266,41 @@ static int32_t linux_socket_accept(struct linux_desc *desc, uint32_t sock_id,
 	return SUCCESS;
 }
 
+/** @brief See \ref network_interface.socket_poll */
+static int32_t linux_socket_poll(struct linux_desc *desc, uint32_t *sock_ids,
+				 uint32_t nb_socks, uint32_t *ready,
+				 int32_t timeout_ms)
+{
+	struct pollfd	fds[SOCKET_POLL_MAX];
+	uint32_t	i;
+	int32_t		ret;
+
+	if(nb_socks > SOCKET_POLL_MAX)
+		return -EINVAL;
+
+	for(i = 0; i < nb_socks; i++) {
+		fds[i].fd = sock_ids[i];
+		fds[i].events = POLLIN;
+	}
+
+	do {
+		ret = poll(fds, nb_socks, timeout_ms);
+	} while(ret < 0 && errno == EINTR);
+
+	if(ret < 0)
+		return -errno;
+	if(ret == 0)
+		return -ETIMEDOUT;
+
+	/* A closed or failed socket is reported as ready, recv will tell why */
+	for(i = 0; i < nb_socks; i++)
+		if(fds[i].revents)
+			break;
+	*ready = i;
+
+	return SUCCESS;
+}
+
 struct network_interface linux_net = {
 	.socket_open = (int32_t (*)(void *, uint32_t *, enum socket_protocol,
 				    uint32_t)) linux_socket_open,
@@ -272,7 +313,8 @@ struct network_interface linux_net = {
 	.socket_recvfrom = (int32_t (*)(void *, uint32_t, void *, uint32_t, struct socket_address* from))linux_socket_recvfrom,
 	.socket_bind = (int32_t (*)(void *, uint32_t, uint16_t))linux_socket_bind,
 	.socket_listen = (int32_t (*)(void *, uint32_t, uint32_t))linux_socket_listen,
-	.socket_accept= (int32_t (*)(void *, uint32_t, uint32_t*))linux_socket_accept
+	.socket_accept= (int32_t (*)(void *, uint32_t, uint32_t*))linux_socket_accept,
+	.socket_poll = (int32_t (*)(void *, uint32_t *, uint32_t, uint32_t *, int32_t))linux_socket_poll
 };
 
 #endif
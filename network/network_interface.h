@@ -47,6 +47,15 @@
 
 #include <stdint.h>
 
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/* Maximum number of sockets socket_poll() can wait for at once */
+#ifndef SOCKET_POLL_MAX
+#define SOCKET_POLL_MAX		16
+#endif
+
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
@@ -218,6 +227,27 @@ struct network_interface {
 	 */
 	int32_t (*socket_accept)(void *net, uint32_t sock_id,
 				 uint32_t *client_socket_id);
+
+	/**
+	 * @brief Wait until one of the sockets is ready to be read.
+	 *
+	 * A listening socket is ready when a connection is pending, a
+	 * connected socket when data arrived or the connection was closed.
+	 * Optional, may be NULL if the interface can't wait for sockets.
+	 * @param net - Network interface
+	 * @param sock_ids - Sockets to wait for
+	 * @param nb_socks - Number of sockets in sock_ids, at most
+	 * SOCKET_POLL_MAX
+	 * @param ready - Address where to store the index in sock_ids of the
+	 * first socket that is ready.
+	 * @param timeout_ms - Maximum time to wait, -1 to wait forever
+	 * @return
+	 *  - \ref SUCCESS : On success
+	 *  - -ETIMEDOUT : No socket got ready in time
+	 *  - \ref Negative error code on failure
+	 */
+	int32_t (*socket_poll)(void *net, uint32_t *sock_ids, uint32_t nb_socks,
+			       uint32_t *ready, int32_t timeout_ms);
 };
 
 #endif
@@ -466,3 +466,47 @@ int32_t socket_accept(struct tcp_socket_desc *desc,
 	return SUCCESS;
 }
 
+/**
+ * @brief Wait until one of the sockets is ready to be read.
+ * All the sockets must belong to the same network interface.
+ * @param socks - Sockets to wait for
+ * @param nb_socks - Number of sockets, at most SOCKET_POLL_MAX
+ * @param ready - Address where to store the index of the first ready socket
+ * @param timeout_ms - Maximum time to wait, -1 to wait forever
+ * @return
+ *  - \ref SUCCESS : On success
+ *  - -ETIMEDOUT : No socket got ready in time
+ *  - -ENOSYS : The network interface can't wait for sockets
+ *  - \ref Negative error code on failure
+ */
+int32_t socket_poll(struct tcp_socket_desc **socks, uint32_t nb_socks,
+		    uint32_t *ready, int32_t timeout_ms)
+{
+	struct network_interface	*net;
+	uint32_t			ids[SOCKET_POLL_MAX];
+	uint32_t			i;
+
+	if (!socks || !nb_socks || nb_socks > SOCKET_POLL_MAX || !ready)
+		return -EINVAL;
+
+	net = socks[0]->net;
+	if (!net->socket_poll)
+		return -ENOSYS;
+
+#ifndef DISABLE_SECURE_SOCKET
+	/* Data already decrypted won't wake up the network interface */
+	for (i = 0; i < nb_socks; i++) {
+		if (socks[i]->secure &&
+		    mbedtls_ssl_get_bytes_avail(&socks[i]->secure->ssl)) {
+			*ready = i;
+			return SUCCESS;
+		}
+	}
+#endif /* DISABLE_SECURE_SOCKET */
+
+	for (i = 0; i < nb_socks; i++)
+		ids[i] = socks[i]->id;
+
+	return net->socket_poll(net->net, ids, nb_socks, ready, timeout_ms);
+}
+
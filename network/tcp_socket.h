@@ -155,4 +155,8 @@ int32_t socket_listen(struct tcp_socket_desc *desc, uint32_t back_log);
 int32_t socket_accept(struct tcp_socket_desc *desc,
 		      struct tcp_socket_desc **new_client);
 
+/* Wait until one of the sockets is ready to be read */
+int32_t socket_poll(struct tcp_socket_desc **socks, uint32_t nb_socks,
+		    uint32_t *ready, int32_t timeout_ms);
+
 #endif
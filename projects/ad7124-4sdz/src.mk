@@ -11,8 +11,11 @@
 
 SRCS += $(PROJECT)/src/ad7124-4sdz.c
 SRCS += $(DRIVERS)/spi/spi.c						\
+	$(DRIVERS)/gpio/gpio.c						\
 	$(DRIVERS)/adc/ad7124/ad7124.c					\
-	$(DRIVERS)/adc/ad7124/ad7124_regs.c				
+	$(DRIVERS)/adc/ad7124/ad7124_regs.c				\
+	$(NO-OS)/util/circular_buffer.c					\
+	$(NO-OS)/util/crc8.c
 SRCS +=	$(PLATFORM_DRIVERS)/axi_io.c					\
 	$(PLATFORM_DRIVERS)/xilinx_spi.c				\
 	$(PLATFORM_DRIVERS)/delay.c
@@ -26,6 +29,9 @@ INCS +=	$(PLATFORM_DRIVERS)/spi_extra.h					\
 INCS +=	$(INCLUDE)/axi_io.h						\
 	$(INCLUDE)/spi.h						\
 	$(INCLUDE)/gpio.h						\
+	$(INCLUDE)/circular_buffer.h					\
+	$(INCLUDE)/crc8.h						\
+	$(INCLUDE)/crc_table.h						\
 	$(INCLUDE)/error.h						\
 	$(INCLUDE)/delay.h						\
 	$(INCLUDE)/irq.h						\
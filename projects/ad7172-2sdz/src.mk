@@ -0,0 +1,20 @@
+#See No-OS/tool/scripts/src_model.mk for variable description
+
+SRC_DIRS += $(PROJECT)/src
+SRC_DIRS += $(NO-OS)/iio/iio_app
+
+# Add to SRCS source files to be build in the project
+SRCS += $(NO-OS)/drivers/adc/ad717x/ad717x.c \
+	$(NO-OS)/drivers/adc/ad717x/iio_ad717x.c
+
+# Add to INCS inlcude files to be build in the porject
+INCS += $(NO-OS)/drivers/adc/ad717x/ad717x.h \
+	$(NO-OS)/drivers/adc/ad717x/ad7172_2_regs.h \
+	$(NO-OS)/drivers/adc/ad717x/iio_ad717x.h
+
+SRC_DIRS += $(PLATFORM_DRIVERS)
+SRC_DIRS += $(NO-OS)/util
+SRC_DIRS += $(INCLUDE)
+
+TINYIIOD=y
+
@@ -0,0 +1,118 @@
+/***************************************************************************//**
+ *   @file   ad7172-2sdz/src/main.c
+ *   @brief  Implementation of Main Function.
+********************************************************************************
+ * Copyright 2021(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include "app_config.h"
+#include "error.h"
+#include "util.h"
+#include "iio.h"
+#include "irq.h"
+#include "irq_extra.h"
+#include "uart.h"
+#include "uart_extra.h"
+#include "iio_ad717x.h"
+#define AD7172_2_INIT
+#include "ad7172_2_regs.h"
+#include "spi_extra.h"
+#include "iio_app.h"
+
+#include <sys/platform.h>
+#include "adi_initialize.h"
+#include <drivers/pwr/adi_pwr.h>
+
+#define MAX_SIZE_BASE_ADDR		1024
+
+static uint8_t in_buff[MAX_SIZE_BASE_ADDR];
+
+#define ADC_DDR_BASEADDR	((uint32_t)in_buff)
+#define NUMBER_OF_DEVICES	1
+
+/***************************************************************************//**
+ * @brief main
+*******************************************************************************/
+int main(void)
+{
+	int32_t status;
+
+	status = platform_init();
+	if (IS_ERR_VALUE(status))
+		return status;
+
+	ad717x_dev *ad717x_device;
+	struct aducm_spi_init_param aducm_spi_ini = {
+		.continuous_mode = true,
+		.dma = false,
+		.half_duplex = false,
+		.master_mode = MASTER
+	};
+	/*
+	 * Without the DOUT/RDY GPIO the buffered captures poll the status
+	 * register, the continuous read mode needs an SPI platform that keeps
+	 * the chip select asserted between transfers.
+	 */
+	ad717x_init_param ad717x_initial = {
+		.spi_init = {
+			.chip_select = 0x00,
+			.max_speed_hz = 10000000,
+			.mode = SPI_MODE_3,
+			.device_id = 1,
+			.extra = &aducm_spi_ini
+		},
+		.gpio_rdy = NULL,
+		.regs = ad7172_2_regs,
+		.num_regs = ARRAY_SIZE(ad7172_2_regs)
+	};
+	struct iio_data_buffer iio_ad717x_read_buff = {
+		.buff = (void *)ADC_DDR_BASEADDR,
+		.size = MAX_SIZE_BASE_ADDR,
+	};
+
+	status = AD717X_Init(&ad717x_device, ad717x_initial);
+	if (status < 0)
+		return status;
+
+	struct iio_app_device devices[] = {
+		IIO_APP_DEVICE("ad7172-2", ad717x_device, &iio_ad717x_device,
+			       &iio_ad717x_read_buff, NULL)
+	};
+
+	return iio_app_run(devices, NUMBER_OF_DEVICES);
+}
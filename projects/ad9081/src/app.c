@@ -67,8 +67,9 @@ extern struct axi_jesd204_tx *tx_jesd;
 
 int main(void)
 {
-	struct clk app_clk[MULTIDEVICE_INSTANCE_COUNT];
-	struct clk jesd_clk[2];
+	struct clk app_clk[MULTIDEVICE_INSTANCE_COUNT] = { 0 };
+	struct clk jesd_clk[2] = { 0 };
+	struct clk fpga_refclk = { 0 };
 	struct xil_gpio_init_param  xil_gpio_param = {
 #ifdef PLATFORM_MB
 		.type = GPIO_PL,
@@ -231,11 +232,11 @@ int main(void)
 		return status;
 #endif
 
-	status = app_clock_init(app_clk);
+	status = app_clock_init(app_clk, &fpga_refclk);
 	if (status != SUCCESS)
 		printf("app_clock_init() error: %" PRId32 "\n", status);
 
-	status = app_jesd_init(jesd_clk,
+	status = app_jesd_init(jesd_clk, &fpga_refclk,
 			       500000, 250000, 250000, 10000000, 10000000);
 	if (status != SUCCESS)
 		printf("app_jesd_init() error: %" PRId32 "\n", status);
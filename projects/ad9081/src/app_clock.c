@@ -70,9 +70,13 @@ struct clk_hw adf4371_hw[MULTIDEVICE_INSTANCE_COUNT];
 /******************************************************************************/
 /**
  * @brief Application clock setup.
+ * @param dev_refclk - Reference clocks of the MxFE devices.
+ * @param fpga_refclk - Reference clock of the FPGA transceivers, the root of
+ *                      the JESD204 link clocks.
  * @return SUCCESS in case of success, FAILURE otherwise.
  */
-int32_t app_clock_init(struct clk dev_refclk[MULTIDEVICE_INSTANCE_COUNT])
+int32_t app_clock_init(struct clk dev_refclk[MULTIDEVICE_INSTANCE_COUNT],
+		       struct clk *fpga_refclk)
 {
 	int32_t ret;
 
@@ -337,18 +341,40 @@ int32_t app_clock_init(struct clk dev_refclk[MULTIDEVICE_INSTANCE_COUNT])
 		dev_refclk[i].hw = &adf4371_hw[i];
 		dev_refclk[i].hw_ch_num = 2;
 		dev_refclk[i].name = "dev_refclk";
+
+		ret = clk_register(&dev_refclk[i], NULL);
+		if (ret)
+			return ret;
 	}
-#else
+#endif
 	hmc7044_hw.dev = hmc7044_dev;
 	hmc7044_hw.dev_clk_recalc_rate = hmc7044_clk_recalc_rate;
 	hmc7044_hw.dev_clk_round_rate = hmc7044_clk_round_rate;
 	hmc7044_hw.dev_clk_set_rate = hmc7044_clk_set_rate;
 
+#ifndef QUAD_MXFE
 	dev_refclk[0].hw = &hmc7044_hw;
 	dev_refclk[0].hw_ch_num = 0;
 	dev_refclk[0].name = "dev_refclk";
+
+	ret = clk_register(&dev_refclk[0], NULL);
+	if (ret)
+		return ret;
 #endif
 
+	/* Index of FPGA_REFCLK in chan_spec */
+	fpga_refclk->hw = &hmc7044_hw;
+#ifdef QUAD_MXFE
+	fpga_refclk->hw_ch_num = 0;
+#else
+	fpga_refclk->hw_ch_num = 6;
+#endif
+	fpga_refclk->name = "fpga_refclk";
+
+	ret = clk_register(fpga_refclk, NULL);
+	if (ret)
+		return ret;
+
 	return SUCCESS;
 }
 
@@ -51,7 +51,8 @@
 /******************************************************************************/
 
 /* Application clocks initialization. */
-int32_t app_clock_init(struct clk dev_refclk[MULTIDEVICE_INSTANCE_COUNT]);
+int32_t app_clock_init(struct clk dev_refclk[MULTIDEVICE_INSTANCE_COUNT],
+		       struct clk *fpga_refclk);
 
 /* Application clocks remove. */
 int32_t app_clock_remove(void);
@@ -88,7 +88,7 @@ int32_t iio_server_init(struct iio_axi_adc_init_param *adc_init,
 		.extra = &xil_uart_init_par,
 	};
 
-	struct iio_init_param iio_init_par;
+	struct iio_init_param iio_init_par = { 0 };
 	struct iio_desc *iio_app_desc;
 	struct iio_axi_adc_desc *iio_axi_adc_desc;
 	struct iio_axi_dac_desc *iio_axi_dac_desc;
@@ -71,9 +71,14 @@ struct clk_hw jesd_tx_hw;
 
 /**
  * @brief Application JESD setup.
+ *
+ * The link clocks are registered as children of the transceiver reference
+ * clock: enabling a link enables the reference clock, and a new lane rate is
+ * computed from its current rate.
  * @return SUCCESS in case of success, FAILURE otherwise.
  */
 int32_t app_jesd_init(struct clk clk[2],
+		      struct clk *ref_clk,
 		      uint32_t reference_clk_khz,
 		      uint32_t rx_device_clk_khz,
 		      uint32_t tx_device_clk_khz,
@@ -160,15 +165,19 @@ int32_t app_jesd_init(struct clk clk[2],
 	tx_jesd_clk.xcvr = tx_adxcvr;
 #endif
 	tx_jesd_clk.jesd_tx = tx_jesd;
+	rx_jesd_clk.ref_clk = ref_clk;
+	tx_jesd_clk.ref_clk = ref_clk;
 
 	jesd_rx_hw.dev = &rx_jesd_clk;
 	jesd_rx_hw.dev_clk_enable = jesd204_clk_enable;
 	jesd_rx_hw.dev_clk_disable = jesd204_clk_disable;
+	jesd_rx_hw.dev_clk_recalc_rate = jesd204_clk_recalc_rate;
 	jesd_rx_hw.dev_clk_set_rate = jesd204_clk_set_rate;
 
 	jesd_tx_hw.dev = &tx_jesd_clk;
 	jesd_tx_hw.dev_clk_enable = jesd204_clk_enable;
 	jesd_tx_hw.dev_clk_disable = jesd204_clk_disable;
+	jesd_tx_hw.dev_clk_recalc_rate = jesd204_clk_recalc_rate;
 	jesd_tx_hw.dev_clk_set_rate = jesd204_clk_set_rate;
 
 	clk[0].name = "jesd_rx";
@@ -177,5 +186,9 @@ int32_t app_jesd_init(struct clk clk[2],
 	clk[1].name = "jesd_tx";
 	clk[1].hw = &jesd_tx_hw;
 
-	return SUCCESS;
+	ret = clk_register(&clk[0], ref_clk);
+	if (ret)
+		return ret;
+
+	return clk_register(&clk[1], ref_clk);
 }
@@ -118,10 +118,18 @@ int32_t app_jesd_init(struct app_jesd **app, struct app_jesd_init *init_param)
 	app_jesd->jesd_rx_clk.name = "jesd_rx";
 	app_jesd->jesd_rx_clk.hw = &app_jesd->jesd_rx_hw;
 
+	status = clk_register(&app_jesd->jesd_rx_clk, NULL);
+	if (status != SUCCESS) {
+		pr_err("error: %s: clk_register() failed\n", rx_jesd_init.name);
+		goto error_2;
+	}
+
 	*app = app_jesd;
 
 	return SUCCESS;
 
+error_2:
+	adxcvr_remove(app_jesd->rx_adxcvr);
 error_1:
 	axi_jesd204_rx_remove(app_jesd->rx_jesd);
 error_0:
@@ -97,7 +97,7 @@ int32_t iio_server_init(struct iio_axi_dac_init_param *dac_init)
 	};
 	struct iio_desc *iio_app_desc;
 	struct iio_axi_dac_desc *iio_axi_dac_desc;
-	struct iio_init_param iio_init_par;
+	struct iio_init_param iio_init_par = { 0 };
 	struct iio_device *dac_dev_desc;
 
 	status = irq_global_enable(irq_desc);
@@ -118,14 +118,21 @@ struct axi_dmac_init rx_dmac_init = {
 	"rx_dmac",
 	CF_AD9361_RX_DMA_BASEADDR,
 	DMA_DEV_TO_MEM,
-	0
+	0,
+#if defined ADC_DMA_EXAMPLE && defined ADC_DMA_IRQ_EXAMPLE
+	true
+#endif
 };
 struct axi_dmac *rx_dmac;
 struct axi_dmac_init tx_dmac_init = {
 	"tx_dmac",
 	CF_AD9361_TX_DMA_BASEADDR,
 	DMA_MEM_TO_DEV,
-	0
+	0,
+#if defined ADC_DMA_EXAMPLE && defined ADC_DMA_IRQ_EXAMPLE && \
+	defined DAC_DMA_EXAMPLE
+	true
+#endif
 };
 struct axi_dmac *tx_dmac;
 
@@ -717,7 +724,7 @@ int main(void)
 	/**
 	 * iio application configurations.
 	 */
-	struct iio_init_param iio_init_par;
+	struct iio_init_param iio_init_par = { 0 };
 
 	/**
 	 * iio axi adc configurations.
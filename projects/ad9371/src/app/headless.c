@@ -950,7 +950,7 @@ int main(void)
 	/**
 	 * iio application configurations.
 	 */
-	struct iio_init_param iio_init_par;
+	struct iio_init_param iio_init_par = { 0 };
 
 	/**
 	 * iio axi adc configurations.
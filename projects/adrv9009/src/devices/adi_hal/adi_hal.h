@@ -21,6 +21,7 @@ struct adi_hal {
 	struct gpio_desc	*gpio_adrv_resetb;
 	struct gpio_desc	*gpio_adrv_sysref_req;
 	struct spi_desc		*spi_adrv_desc;
+	struct spi_wr_queue	*spi_adrv_wr_queue;
 	uint32_t		log_level;
 	void 			*extra_spi;
 	uint8_t			spi_adrv_csn;
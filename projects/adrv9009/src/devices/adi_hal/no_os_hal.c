@@ -50,10 +50,22 @@
 #include "error.h"
 #include "delay.h"
 
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+#define ADIHAL_SPI_WR_QUEUE_SIZE	64
+
 /******************************************************************************/
 /************************** Functions Implementation **************************/
 /******************************************************************************/
 
+static void ADIHAL_spiWriteHeader(uint8_t *hdr, uint32_t addr, uint32_t count)
+{
+	hdr[0] = (addr >> 8) & 0x7F;
+	hdr[1] = addr & 0xFF;
+}
+
 adiHalErr_t ADIHAL_setTimeout(void *devHalInfo, uint32_t halTimeout_ms)
 {
 	return ADIHAL_OK;
@@ -63,6 +75,7 @@ adiHalErr_t ADIHAL_openHw(void *devHalInfo, uint32_t halTimeout_ms)
 {
 	struct adi_hal *dev_hal_data = (struct adi_hal *)devHalInfo;
 	struct spi_init_param spi_param;
+	struct spi_wr_queue_init_param wr_queue_param;
 	struct gpio_init_param gpio_adrv_resetb_param;
 	struct gpio_init_param gpio_adrv_sysref_req_param;
 	int32_t status = 0;
@@ -101,6 +114,17 @@ adiHalErr_t ADIHAL_openHw(void *devHalInfo, uint32_t halTimeout_ms)
 
 	status |= spi_init(&dev_hal_data->spi_adrv_desc, &spi_param);
 
+	/* No streaming, the device is not configured for it. */
+	wr_queue_param.spi = dev_hal_data->spi_adrv_desc;
+	wr_queue_param.max_entries = ADIHAL_SPI_WR_QUEUE_SIZE;
+	wr_queue_param.max_burst = 1;
+	wr_queue_param.addr_step = 1;
+	wr_queue_param.hdr_len = 2;
+	wr_queue_param.build_header = ADIHAL_spiWriteHeader;
+	if (status == SUCCESS)
+		status |= spi_wr_queue_init(&dev_hal_data->spi_adrv_wr_queue,
+					    &wr_queue_param);
+
 	status |= gpio_get(&dev_hal_data->gpio_adrv_sysref_req,
 			   &gpio_adrv_sysref_req_param);
 
@@ -119,6 +143,8 @@ adiHalErr_t ADIHAL_closeHw(void *devHalInfo)
 
 	status |= gpio_remove(dev_hal_data->gpio_adrv_sysref_req);
 
+	status |= spi_wr_queue_remove(dev_hal_data->spi_adrv_wr_queue);
+
 	status |= spi_remove(dev_hal_data->spi_adrv_desc);
 
 	if (status != SUCCESS)
@@ -181,16 +207,22 @@ adiHalErr_t ADIHAL_spiWriteByte(void *devHalInfo,
 adiHalErr_t ADIHAL_spiWriteBytes(void *devHalInfo,
 				 uint16_t *addr, uint8_t *data, uint32_t count)
 {
-	adiHalErr_t errVal;
+	struct adi_hal *devHalData = (struct adi_hal *)devHalInfo;
+	int32_t status;
 	uint32_t i;
 
 	for (i = 0; i < count; i++) {
-		errVal = ADIHAL_spiWriteByte(devHalInfo, addr[i], data[i]);
-		if (errVal)
-			return errVal;
+		status = spi_wr_queue_push(devHalData->spi_adrv_wr_queue,
+					   addr[i], data[i]);
+		if (status != SUCCESS)
+			return ADIHAL_SPI_FAIL;
 	}
 
-	return ADIHAL_OK;
+	status = spi_wr_queue_flush(devHalData->spi_adrv_wr_queue);
+	if (status != SUCCESS)
+		return ADIHAL_SPI_FAIL;
+	else
+		return ADIHAL_OK;
 }
 
 adiHalErr_t ADIHAL_spiReadByte(void *devHalInfo,
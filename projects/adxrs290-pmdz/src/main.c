@@ -103,7 +103,7 @@ int main(void)
 	struct iio_desc  *iio_desc;
 
 	/* iio init param */
-	struct iio_init_param iio_init_param;
+	struct iio_init_param iio_init_param = { 0 };
 
 	/* Initialization for UART. */
 	struct uart_init_param uart_init_par;
@@ -51,6 +51,8 @@
 #include <xil_printf.h>
 #include <xil_cache.h>
 #include "axi_adxcvr.h"
+#include "clk.h"
+#include "jesd204_clk.h"
 #else
 #include "clk_altera_a10_fpll.h"
 #include "altera_adxcvr.h"
@@ -98,6 +100,21 @@ struct fmcdaq2_dev {
 
 	struct axi_dmac *ad9144_dmac;
 	struct axi_dmac *ad9680_dmac;
+
+#ifndef ALTERA_PLATFORM
+	/* FPGA reference clocks, outputs of the AD9523 */
+	struct clk_hw ad9523_hw;
+	struct clk ad9144_ref_clk;
+	struct clk ad9680_ref_clk;
+
+	/* Lane clocks of the transceivers, children of the reference clocks */
+	struct jesd204_clk ad9144_jesd_clk;
+	struct jesd204_clk ad9680_jesd_clk;
+	struct clk_hw ad9144_lane_hw;
+	struct clk_hw ad9680_lane_hw;
+	struct clk ad9144_lane_clk;
+	struct clk ad9680_lane_clk;
+#endif
 } fmcdaq2;
 
 struct fmcdaq2_init_param {
@@ -339,7 +356,8 @@ static int fmcdaq2_jesd_init(struct fmcdaq2_init_param *dev_init)
 		.out_clk_sel = 4,
 		.lpm_enable = 1,
 		.cpll_enable = 0,
-		.ref_rate_khz = 500000,
+		/* The PLL is set through the clock tree, from the AD9523 rate */
+		.ref_rate_khz = 0,
 		.lane_rate_khz = 10000000,
 	};
 	dev_init->ad9680_xcvr_param = (struct adxcvr_init) {
@@ -349,7 +367,7 @@ static int fmcdaq2_jesd_init(struct fmcdaq2_init_param *dev_init)
 		.out_clk_sel = 4,
 		.lpm_enable = 1,
 		.cpll_enable = 1,
-		.ref_rate_khz = 500000,
+		.ref_rate_khz = 0,
 		.lane_rate_khz = 10000000
 	};
 #else
@@ -455,6 +473,74 @@ static int fmcdaq2_altera_pll_setup()
 	return SUCCESS;
 }
 
+#ifndef ALTERA_PLATFORM
+/**
+ * Register the FPGA reference clocks, outputs of the AD9523. Their rate only
+ * changes through the clock tree, so it is cached.
+ */
+static int fmcdaq2_ref_clk_init(struct fmcdaq2_dev *dev)
+{
+	int status;
+
+	dev->ad9523_hw.dev = dev->ad9523_device;
+	dev->ad9523_hw.dev_clk_recalc_rate = ad9523_clk_recalc_rate;
+	dev->ad9523_hw.dev_clk_round_rate = ad9523_clk_round_rate;
+	dev->ad9523_hw.dev_clk_set_rate = ad9523_clk_set_rate;
+
+	dev->ad9144_ref_clk.hw = &dev->ad9523_hw;
+	dev->ad9144_ref_clk.hw_ch_num =
+		dev->ad9523_channels[DAC_FPGA_CLK].channel_num;
+	dev->ad9144_ref_clk.name = "ad9144_ref_clk";
+	dev->ad9144_ref_clk.flags = CLK_CACHE_RATE;
+
+	status = clk_register(&dev->ad9144_ref_clk, NULL);
+	if (status != SUCCESS)
+		return status;
+
+	dev->ad9680_ref_clk.hw = &dev->ad9523_hw;
+	dev->ad9680_ref_clk.hw_ch_num =
+		dev->ad9523_channels[ADC_FPGA_CLK].channel_num;
+	dev->ad9680_ref_clk.name = "ad9680_ref_clk";
+	dev->ad9680_ref_clk.flags = CLK_CACHE_RATE;
+
+	return clk_register(&dev->ad9680_ref_clk, NULL);
+}
+
+/**
+ * Register the lane clock of a transceiver as a child of its reference clock,
+ * and set the lane rate through it. The transceiver PLL is computed from the
+ * rate the AD9523 actually outputs, and again whenever that rate changes.
+ *
+ * The clock has no enable operation: the links are brought up by hand, in the
+ * recommended order.
+ */
+static int fmcdaq2_lane_clk_init(struct clk *lane_clk,
+				 struct clk_hw *lane_hw,
+				 struct jesd204_clk *jesd_clk,
+				 struct adxcvr *xcvr,
+				 struct clk *ref_clk)
+{
+	int status;
+
+	jesd_clk->xcvr = xcvr;
+	jesd_clk->ref_clk = ref_clk;
+
+	lane_hw->dev = jesd_clk;
+	lane_hw->dev_clk_recalc_rate = jesd204_clk_recalc_rate;
+	lane_hw->dev_clk_set_rate = jesd204_clk_set_rate;
+
+	lane_clk->hw = lane_hw;
+	lane_clk->name = xcvr->name;
+	lane_clk->flags = CLK_CACHE_RATE;
+
+	status = clk_register(lane_clk, ref_clk);
+	if (status != SUCCESS)
+		return status;
+
+	return clk_set_rate(lane_clk, (uint64_t)xcvr->lane_rate_khz * 1000);
+}
+#endif
+
 static int fmcdaq2_trasnceiver_setup(struct fmcdaq2_dev *dev,
 				     struct fmcdaq2_init_param *dev_init)
 {
@@ -476,6 +562,16 @@ static int fmcdaq2_trasnceiver_setup(struct fmcdaq2_dev *dev,
 		printf("error: %s: adxcvr_init() failed\n", dev->ad9144_xcvr->name);
 	}
 #ifndef ALTERA_PLATFORM
+	status = fmcdaq2_lane_clk_init(&dev->ad9144_lane_clk,
+				       &dev->ad9144_lane_hw,
+				       &dev->ad9144_jesd_clk,
+				       dev->ad9144_xcvr,
+				       &dev->ad9144_ref_clk);
+	if (status != SUCCESS) {
+		printf("error: %s: fmcdaq2_lane_clk_init() failed\n",
+		       dev->ad9144_xcvr->name);
+	}
+
 	status = adxcvr_clk_enable(dev->ad9144_xcvr);
 	if (status != SUCCESS) {
 		printf("error: %s: adxcvr_clk_enable() failed\n", dev->ad9144_xcvr->name);
@@ -486,6 +582,16 @@ static int fmcdaq2_trasnceiver_setup(struct fmcdaq2_dev *dev,
 		printf("error: %s: adxcvr_init() failed\n", dev->ad9680_xcvr->name);
 	}
 #ifndef ALTERA_PLATFORM
+	status = fmcdaq2_lane_clk_init(&dev->ad9680_lane_clk,
+				       &dev->ad9680_lane_hw,
+				       &dev->ad9680_jesd_clk,
+				       dev->ad9680_xcvr,
+				       &dev->ad9680_ref_clk);
+	if (status != SUCCESS) {
+		printf("error: %s: fmcdaq2_lane_clk_init() failed\n",
+		       dev->ad9680_xcvr->name);
+	}
+
 	status = adxcvr_clk_enable(dev->ad9680_xcvr);
 	if (status != SUCCESS) {
 		printf("error: %s: adxcvr_clk_enable() failed\n", dev->ad9680_xcvr->name);
@@ -665,6 +771,14 @@ static void fmcdaq2_remove(struct fmcdaq2_dev *dev)
 	ad9523_remove(dev->ad9523_device);
 	ad9680_remove(dev->ad9680_device);
 
+#ifndef ALTERA_PLATFORM
+	/* Children are removed from the clock tree first */
+	clk_unregister(&dev->ad9144_lane_clk);
+	clk_unregister(&dev->ad9680_lane_clk);
+	clk_unregister(&dev->ad9144_ref_clk);
+	clk_unregister(&dev->ad9680_ref_clk);
+#endif
+
 	/* Memory deallocation for PHY and LINK layers */
 	adxcvr_remove(dev->ad9144_xcvr);
 	adxcvr_remove(dev->ad9680_xcvr);
@@ -729,16 +843,12 @@ int fmcdaq2_reconfig(struct ad9144_init_param *p_ad9144_param,
 		channel_divider = 128;
 		p_ad9144_param->lane_rate_kbps = 6000000;
 		ad9144_xcvr_param->lane_rate_khz = 6000000;
-#ifndef ALTERA_PLATFORM
-		ad9144_xcvr_param->ref_rate_khz = 300000;
-#else
+#ifdef ALTERA_PLATFORM
 		ad9144_xcvr_param->parent_rate_khz = 300000;
 #endif
 		p_ad9680_param->lane_rate_kbps = 6000000;
 		ad9680_xcvr_param->lane_rate_khz = 6000000;
-#ifndef ALTERA_PLATFORM
-		ad9680_xcvr_param->ref_rate_khz = 300000;
-#else
+#ifdef ALTERA_PLATFORM
 		ad9680_xcvr_param->parent_rate_khz = 300000;
 #endif
 #ifndef ALTERA_PLATFORM
@@ -773,16 +883,12 @@ int fmcdaq2_reconfig(struct ad9144_init_param *p_ad9144_param,
 		channel_divider = 256;
 		p_ad9144_param->lane_rate_kbps = 5000000;
 		ad9144_xcvr_param->lane_rate_khz = 5000000;
-#ifndef ALTERA_PLATFORM
-		ad9144_xcvr_param->ref_rate_khz = 250000;
-#else
+#ifdef ALTERA_PLATFORM
 		ad9144_xcvr_param->parent_rate_khz = 250000;
 #endif
 		p_ad9680_param->lane_rate_kbps = 5000000;
 		ad9680_xcvr_param->lane_rate_khz = 5000000;
-#ifndef ALTERA_PLATFORM
-		ad9680_xcvr_param->ref_rate_khz = 250000;
-#else
+#ifdef ALTERA_PLATFORM
 		ad9680_xcvr_param->parent_rate_khz = 250000;
 #endif
 #ifndef ALTERA_PLATFORM
@@ -817,16 +923,12 @@ int fmcdaq2_reconfig(struct ad9144_init_param *p_ad9144_param,
 		channel_divider = 256;
 		p_ad9144_param->lane_rate_kbps = 10000000;
 		ad9144_xcvr_param->lane_rate_khz = 10000000;
-#ifndef ALTERA_PLATFORM
-		ad9144_xcvr_param->ref_rate_khz = 500000;
-#else
+#ifdef ALTERA_PLATFORM
 		ad9144_xcvr_param->parent_rate_khz = 500000;
 #endif
 		p_ad9680_param->lane_rate_kbps = 5000000;
 		ad9680_xcvr_param->lane_rate_khz = 5000000;
-#ifndef ALTERA_PLATFORM
-		ad9680_xcvr_param->ref_rate_khz = 500000;
-#else
+#ifdef ALTERA_PLATFORM
 		ad9680_xcvr_param->parent_rate_khz = 500000;
 #endif
 #ifndef ALTERA_PLATFORM
@@ -841,10 +943,7 @@ int fmcdaq2_reconfig(struct ad9144_init_param *p_ad9144_param,
 		break;
 	default:
 		printf ("1 - ADC 1000 MSPS; DAC 1000 MSPS\n");
-#ifndef ALTERA_PLATFORM
-		ad9144_xcvr_param->ref_rate_khz = 500000;
-		ad9680_xcvr_param->ref_rate_khz = 500000;
-#else
+#ifdef ALTERA_PLATFORM
 		ad9144_xcvr_param->parent_rate_khz = 500000;
 		ad9680_xcvr_param->parent_rate_khz = 500000;
 #endif
@@ -915,6 +1014,11 @@ static int fmcdaq2_setup(struct fmcdaq2_dev *dev,
 	if (status != SUCCESS) {
 		printf("error: ad9523_setup() failed\n");
 	}
+#ifndef ALTERA_PLATFORM
+	status = fmcdaq2_ref_clk_init(dev);
+	if (status != SUCCESS)
+		return status;
+#endif
 	// Recommended DAC JESD204 link startup sequence
 	//   1. FPGA JESD204 Link Layer
 	//   2. FPGA JESD204 PHY Layer
@@ -0,0 +1,113 @@
+/***************************************************************************//**
+ *   @file   tinyiiod.h
+ *   @brief  Test double of the libtinyiiod interface used by iio.c.
+********************************************************************************
+ * Copyright 2021(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+#ifndef TINYIIOD_H
+#define TINYIIOD_H
+
+/*
+ * The unit tests are built without the libtinyiiod submodule. The operations
+ * below have the prototypes of the iio.c callbacks, so a mismatch with iio.c
+ * is caught by the compiler.
+ */
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+enum iio_attr_type {
+	IIO_ATTR_TYPE_DEVICE,
+	IIO_ATTR_TYPE_DEBUG,
+	IIO_ATTR_TYPE_BUFFER,
+};
+
+struct tinyiiod;
+
+struct tinyiiod_ops {
+	ssize_t (*read)(char *buf, size_t len);
+	ssize_t (*write)(const char *buf, size_t len);
+
+	ssize_t (*read_attr)(const char *device, const char *attr, char *buf,
+			     size_t len, enum iio_attr_type type);
+	ssize_t (*write_attr)(const char *device, const char *attr,
+			      const char *buf, size_t len,
+			      enum iio_attr_type type);
+	ssize_t (*ch_read_attr)(const char *device, const char *channel,
+				bool ch_out, const char *attr, char *buf,
+				size_t len);
+	ssize_t (*ch_write_attr)(const char *device, const char *channel,
+				 bool ch_out, const char *attr,
+				 const char *buf, size_t len);
+
+	int32_t (*open)(const char *device, size_t sample_size,
+			uint32_t mask, bool cyclic);
+	int32_t (*close)(const char *device);
+	int32_t (*get_mask)(const char *device, uint32_t *mask);
+
+	ssize_t (*transfer_dev_to_mem)(const char *device, size_t bytes_count);
+	ssize_t (*read_data)(const char *device, char *buf, size_t offset,
+			     size_t bytes_count);
+	ssize_t (*transfer_mem_to_dev)(const char *device, size_t bytes_count);
+	ssize_t (*write_data)(const char *device, const char *buf,
+			      size_t offset, size_t bytes_count);
+
+	ssize_t (*get_xml)(char **outxml);
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+struct tinyiiod *tinyiiod_create(struct tinyiiod_ops *ops);
+void tinyiiod_destroy(struct tinyiiod *iiod);
+int32_t tinyiiod_read_command(struct tinyiiod *iiod);
+
+/*
+ * Called by tinyiiod_read_command() in place of parsing a command, with the
+ * operations given to tinyiiod_create(). Set by the test.
+ */
+extern int32_t (*tinyiiod_test_command)(struct tinyiiod_ops *ops);
+
+#endif // TINYIIOD_H
@@ -0,0 +1,276 @@
+/***************************************************************************//**
+ *   @file   test_axi_io.c
+ *   @brief  Unit tests of the Linux AXI IO register window cache.
+********************************************************************************
+ * Copyright 2021(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "error.h"
+#include "axi_io.h"
+#include "test.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+/*
+ * The Makefile points the device paths of axi_io.c into this directory, the
+ * devices are regular files created by the test.
+ */
+#define TEST_AXI_IO_DIR		"test_axi_io.tmp"
+
+#ifdef DEVMEM
+/* Physical address of the core, not page aligned, and size of /dev/mem */
+#define TEST_AXI_IO_BASE	0x11000
+#define TEST_AXI_IO_MEM_SIZE	0x100000
+/* Default window mapped by axi_io.c */
+#define TEST_AXI_IO_MAP_SIZE	0x10000
+#else
+#define TEST_AXI_IO_UIO_SIZE	0x2000
+#endif
+
+/******************************************************************************/
+/************************** Functions Implementation **************************/
+/******************************************************************************/
+static void test_axi_io_create(const char *path, size_t size)
+{
+	int fd;
+
+	fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0600);
+	TEST_ASSERT(fd >= 0);
+	TEST_ASSERT(!ftruncate(fd, size));
+	close(fd);
+}
+
+static uint32_t test_axi_io_peek(const char *path, off_t offset)
+{
+	uint32_t val;
+	int fd;
+
+	fd = open(path, O_RDONLY);
+	TEST_ASSERT(fd >= 0);
+	TEST_ASSERT_EQUAL(pread(fd, &val, sizeof(val), offset), sizeof(val));
+	close(fd);
+
+	return val;
+}
+
+/* Number of windows of the file currently mapped by the process */
+static int test_axi_io_nb_maps(const char *path)
+{
+	char *name = realpath(path, NULL);
+	char line[512];
+	int n = 0;
+	FILE *f;
+
+	TEST_ASSERT(name);
+	f = fopen("/proc/self/maps", "r");
+	TEST_ASSERT(f);
+	while (fgets(line, sizeof(line), f))
+		if (strstr(line, name))
+			n++;
+	fclose(f);
+	free(name);
+
+	return n;
+}
+
+#ifdef DEVMEM
+
+#define TEST_AXI_IO_MEM		TEST_AXI_IO_DIR"/mem"
+
+/* Accesses past the window unmap it and map a larger one */
+static void test_axi_io_devmem_grow(void)
+{
+	uint32_t val;
+
+	TEST_ASSERT_EQUAL(axi_io_write(TEST_AXI_IO_BASE, 0, 0x1234), SUCCESS);
+	TEST_ASSERT_EQUAL(test_axi_io_nb_maps(TEST_AXI_IO_MEM), 1);
+
+	TEST_ASSERT_EQUAL(axi_io_write(TEST_AXI_IO_BASE,
+				       3 * TEST_AXI_IO_MAP_SIZE, 0x5678), SUCCESS);
+	TEST_ASSERT_EQUAL(test_axi_io_nb_maps(TEST_AXI_IO_MEM), 1);
+
+	TEST_ASSERT_EQUAL(axi_io_read(TEST_AXI_IO_BASE, 0, &val), SUCCESS);
+	TEST_ASSERT_EQUAL(val, 0x1234);
+	TEST_ASSERT_EQUAL(test_axi_io_peek(TEST_AXI_IO_MEM, TEST_AXI_IO_BASE),
+			  0x1234);
+	TEST_ASSERT_EQUAL(test_axi_io_peek(TEST_AXI_IO_MEM, TEST_AXI_IO_BASE +
+					   3 * TEST_AXI_IO_MAP_SIZE), 0x5678);
+}
+
+static void *test_axi_io_reader(void *arg)
+{
+	uint32_t val;
+	int i;
+
+	for (i = 0; i < 100000; i++) {
+		TEST_ASSERT_EQUAL(axi_io_read(TEST_AXI_IO_BASE, 0, &val), SUCCESS);
+		TEST_ASSERT_EQUAL(val, 0x1234);
+	}
+
+	return NULL;
+}
+
+/* A thread keeps reading while the window is remapped under it */
+static void test_axi_io_devmem_grow_concurrent(void)
+{
+	pthread_t thread;
+	uint32_t offset;
+
+	TEST_ASSERT(!pthread_create(&thread, NULL, test_axi_io_reader, NULL));
+	for (offset = 4 * TEST_AXI_IO_MAP_SIZE;
+	     offset < TEST_AXI_IO_MEM_SIZE - TEST_AXI_IO_BASE;
+	     offset += 0x1000)
+		TEST_ASSERT_EQUAL(axi_io_write(TEST_AXI_IO_BASE, offset, offset),
+				  SUCCESS);
+	TEST_ASSERT(!pthread_join(thread, NULL));
+
+	TEST_ASSERT_EQUAL(test_axi_io_nb_maps(TEST_AXI_IO_MEM), 1);
+}
+
+int main(void)
+{
+	TEST_ASSERT(!system("rm -rf "TEST_AXI_IO_DIR" && mkdir "TEST_AXI_IO_DIR));
+	test_axi_io_create(TEST_AXI_IO_MEM, TEST_AXI_IO_MEM_SIZE);
+
+	TEST_RUN(test_axi_io_devmem_grow);
+	TEST_RUN(test_axi_io_devmem_grow_concurrent);
+
+	TEST_ASSERT(!system("rm -rf "TEST_AXI_IO_DIR));
+
+	return 0;
+}
+
+#else
+
+#define TEST_AXI_IO_UIO(n)	TEST_AXI_IO_DIR"/uio"#n
+
+/* Device n whose map0 in sysfs holds size, size 0 for no sysfs entry */
+static void test_axi_io_create_uio(const char *path, int n, size_t size)
+{
+	char buf[128];
+	FILE *f;
+
+	test_axi_io_create(path, TEST_AXI_IO_UIO_SIZE);
+	if (!size)
+		return;
+
+	snprintf(buf, sizeof(buf), "mkdir -p "TEST_AXI_IO_DIR"/sys/uio%d/maps/map0",
+		 n);
+	TEST_ASSERT(!system(buf));
+	snprintf(buf, sizeof(buf), TEST_AXI_IO_DIR"/sys/uio%d/maps/map0/size", n);
+	f = fopen(buf, "w");
+	TEST_ASSERT(f);
+	fprintf(f, "0x%zx\n", size);
+	fclose(f);
+}
+
+/* The window is mapped once and reused by the following accesses */
+static void test_axi_io_uio_cache(void)
+{
+	uint32_t data[4] = {1, 2, 3, 4};
+	uint32_t val, i;
+
+	for (i = 0; i < 100; i++) {
+		TEST_ASSERT_EQUAL(axi_io_write(0, 0, i), SUCCESS);
+		TEST_ASSERT_EQUAL(axi_io_read(0, 0, &val), SUCCESS);
+		TEST_ASSERT_EQUAL(val, i);
+	}
+	TEST_ASSERT_EQUAL(axi_io_write_burst(0, TEST_AXI_IO_UIO_SIZE - 16,
+					     data, 4), SUCCESS);
+	TEST_ASSERT_EQUAL(test_axi_io_nb_maps(TEST_AXI_IO_UIO(0)), 1);
+
+	TEST_ASSERT_EQUAL(test_axi_io_peek(TEST_AXI_IO_UIO(0), 0), 99);
+	TEST_ASSERT_EQUAL(test_axi_io_peek(TEST_AXI_IO_UIO(0),
+					   TEST_AXI_IO_UIO_SIZE - 4), 4);
+}
+
+/* Accesses past the window fail, an UIO window is never grown */
+static void test_axi_io_uio_range(void)
+{
+	uint32_t data[2];
+
+	TEST_ASSERT_EQUAL(axi_io_read(0, TEST_AXI_IO_UIO_SIZE, data), FAILURE);
+	TEST_ASSERT_EQUAL(axi_io_read_burst(0, TEST_AXI_IO_UIO_SIZE - 4,
+					    data, 2), FAILURE);
+	TEST_ASSERT_EQUAL(test_axi_io_nb_maps(TEST_AXI_IO_UIO(0)), 1);
+}
+
+/* The size of map0 in sysfs bounds the window, not the device file */
+static void test_axi_io_uio_sysfs_size(void)
+{
+	uint32_t val;
+
+	/* The first access is out of range, nothing gets mapped */
+	TEST_ASSERT_EQUAL(axi_io_read(1, TEST_AXI_IO_UIO_SIZE / 2, &val),
+			  FAILURE);
+	TEST_ASSERT_EQUAL(test_axi_io_nb_maps(TEST_AXI_IO_UIO(1)), 0);
+
+	TEST_ASSERT_EQUAL(axi_io_read(1, TEST_AXI_IO_UIO_SIZE / 2 - 4, &val),
+			  SUCCESS);
+	TEST_ASSERT_EQUAL(axi_io_read(1, TEST_AXI_IO_UIO_SIZE / 2, &val),
+			  FAILURE);
+
+	/* Without sysfs entry, the size of the file is used */
+	TEST_ASSERT_EQUAL(axi_io_read(2, TEST_AXI_IO_UIO_SIZE - 4, &val),
+			  SUCCESS);
+	TEST_ASSERT_EQUAL(axi_io_read(2, TEST_AXI_IO_UIO_SIZE, &val), FAILURE);
+}
+
+int main(void)
+{
+	TEST_ASSERT(!system("rm -rf "TEST_AXI_IO_DIR" && mkdir "TEST_AXI_IO_DIR));
+	test_axi_io_create_uio(TEST_AXI_IO_UIO(0), 0, TEST_AXI_IO_UIO_SIZE);
+	test_axi_io_create_uio(TEST_AXI_IO_UIO(1), 1, TEST_AXI_IO_UIO_SIZE / 2);
+	test_axi_io_create_uio(TEST_AXI_IO_UIO(2), 2, 0);
+
+	TEST_RUN(test_axi_io_uio_cache);
+	TEST_RUN(test_axi_io_uio_range);
+	TEST_RUN(test_axi_io_uio_sysfs_size);
+
+	TEST_ASSERT(!system("rm -rf "TEST_AXI_IO_DIR));
+
+	return 0;
+}
+
+#endif
@@ -0,0 +1,361 @@
+/***************************************************************************//**
+ *   @file   test_circular_buffer.c
+ *   @brief  Unit tests of the circular buffer.
+********************************************************************************
+ * Copyright 2021(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <string.h>
+#include "error.h"
+#include "circular_buffer.h"
+#include "test.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+/* Power of two, other, and page multiple (mirrored with LINUX_PLATFORM) */
+#define TEST_CB_POW2_SIZE	64
+#define TEST_CB_ODD_SIZE	100
+#define TEST_CB_PAGE_SIZE	4096
+
+/* Bytes exchanged by the producer and consumer threads */
+#define TEST_CB_STRESS_SIZE	(4 << 20)
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+struct test_cb_stream {
+	struct circular_buffer *cb;
+	uint32_t size;
+	uint32_t chunk;
+};
+
+/******************************************************************************/
+/************************** Functions Implementation **************************/
+/******************************************************************************/
+static struct circular_buffer *test_cb_init(uint32_t size)
+{
+	struct circular_buffer *cb;
+
+	TEST_ASSERT_EQUAL(cb_init(&cb, size), SUCCESS);
+
+	return cb;
+}
+
+/* Byte n of the test stream */
+static uint8_t test_cb_byte(uint64_t n)
+{
+	return n * 7 + (n >> 8);
+}
+
+static void test_cb_span_fill(struct cb_span *span, uint64_t n)
+{
+	uint32_t i, j;
+
+	for (j = 0; j < 2; j++)
+		for (i = 0; i < span->size[j]; i++)
+			((uint8_t *)span->buff[j])[i] = test_cb_byte(n++);
+}
+
+static bool test_cb_span_check(struct cb_span *span, uint64_t n)
+{
+	uint32_t i, j;
+
+	for (j = 0; j < 2; j++)
+		for (i = 0; i < span->size[j]; i++)
+			if (((uint8_t *)span->buff[j])[i] != test_cb_byte(n++))
+				return false;
+
+	return true;
+}
+
+/* Move both pointers forward by n bytes, without touching the data */
+static void test_cb_skip(struct circular_buffer *cb, uint32_t size,
+			 uint64_t n)
+{
+	uint32_t step;
+
+	while (n) {
+		step = n < size ? n : size;
+		TEST_ASSERT_EQUAL(cb_commit_write(cb, step), SUCCESS);
+		TEST_ASSERT_EQUAL(cb_commit_read(cb, step), SUCCESS);
+		n -= step;
+	}
+}
+
+/* Data goes through cb_write() and cb_read() in chunks of every size */
+static void test_cb_write_read_size(uint32_t size, uint64_t skip)
+{
+	struct circular_buffer *cb = test_cb_init(size);
+	uint8_t tx[TEST_CB_PAGE_SIZE], rx[TEST_CB_PAGE_SIZE];
+	uint32_t chunk, avail, i;
+	uint64_t n = 0;
+
+	test_cb_skip(cb, size, skip);
+
+	for (chunk = 1; chunk <= size; chunk += chunk < 8 ? 1 : chunk / 3) {
+		for (i = 0; i < chunk; i++)
+			tx[i] = test_cb_byte(n + i);
+		TEST_ASSERT_EQUAL(cb_write(cb, tx, chunk), SUCCESS);
+		TEST_ASSERT_EQUAL(cb_size(cb, &avail), SUCCESS);
+		TEST_ASSERT_EQUAL(avail, chunk);
+
+		memset(rx, 0, chunk);
+		TEST_ASSERT_EQUAL(cb_read(cb, rx, chunk), SUCCESS);
+		TEST_ASSERT(!memcmp(tx, rx, chunk));
+		n += chunk;
+	}
+	TEST_ASSERT_EQUAL(cb_size(cb, &avail), SUCCESS);
+	TEST_ASSERT_EQUAL(avail, 0);
+
+	TEST_ASSERT_EQUAL(cb_remove(cb), SUCCESS);
+}
+
+static void test_cb_write_read(void)
+{
+	test_cb_write_read_size(TEST_CB_POW2_SIZE, 0);
+	test_cb_write_read_size(TEST_CB_ODD_SIZE, 0);
+	test_cb_write_read_size(TEST_CB_PAGE_SIZE, 0);
+}
+
+/*
+ * The pointer counters wrap at 2^32 for power of two sizes, at a multiple of
+ * the size below it otherwise. Both are crossed while data goes through.
+ */
+static void test_cb_counter_wrap(void)
+{
+	uint64_t skip = UINT32_MAX - 1000;
+
+	test_cb_write_read_size(TEST_CB_POW2_SIZE, skip);
+	test_cb_write_read_size(TEST_CB_ODD_SIZE, skip);
+	test_cb_write_read_size(TEST_CB_PAGE_SIZE, skip);
+}
+
+/* A region crossing the end of the buffer comes in two segments */
+static void test_cb_peek_commit_size(uint32_t size, bool mirrored)
+{
+	struct circular_buffer *cb = test_cb_init(size);
+	uint32_t offset = size - size / 4;
+	struct cb_span span;
+	uint32_t avail;
+
+	test_cb_skip(cb, size, offset);
+
+	TEST_ASSERT_EQUAL(cb_peek_write(cb, size / 2, &span), SUCCESS);
+	if (mirrored) {
+		TEST_ASSERT_EQUAL(span.size[0], size / 2);
+		TEST_ASSERT_EQUAL(span.size[1], 0);
+	} else {
+		TEST_ASSERT_EQUAL(span.size[0], size / 4);
+		TEST_ASSERT_EQUAL(span.size[1], size / 2 - size / 4);
+		TEST_ASSERT(span.buff[1] ==
+			    (uint8_t *)span.buff[0] - offset);
+	}
+	test_cb_span_fill(&span, 0);
+
+	/* Nothing is visible before the commit */
+	TEST_ASSERT_EQUAL(cb_peek_read(cb, size, &span), -EAGAIN);
+	TEST_ASSERT_EQUAL(cb_commit_write(cb, size / 2), SUCCESS);
+
+	/* The reader gets the same region, in the same segments */
+	TEST_ASSERT_EQUAL(cb_peek_read(cb, size, &span), SUCCESS);
+	TEST_ASSERT_EQUAL(span.size[0] + span.size[1], size / 2);
+	TEST_ASSERT_EQUAL(span.size[1], mirrored ? 0 : size / 2 - size / 4);
+	TEST_ASSERT(test_cb_span_check(&span, 0));
+
+	/* Release it in two steps */
+	TEST_ASSERT_EQUAL(cb_commit_read(cb, 1), SUCCESS);
+	TEST_ASSERT_EQUAL(cb_size(cb, &avail), SUCCESS);
+	TEST_ASSERT_EQUAL(avail, size / 2 - 1);
+	TEST_ASSERT_EQUAL(cb_commit_read(cb, size / 2), -EINVAL);
+	TEST_ASSERT_EQUAL(cb_commit_read(cb, size / 2 - 1), SUCCESS);
+	TEST_ASSERT_EQUAL(cb_peek_read(cb, size, &span), -EAGAIN);
+
+	TEST_ASSERT_EQUAL(cb_remove(cb), SUCCESS);
+}
+
+static void test_cb_peek_commit(void)
+{
+	test_cb_peek_commit_size(TEST_CB_POW2_SIZE, false);
+	test_cb_peek_commit_size(TEST_CB_ODD_SIZE, false);
+#ifdef LINUX_PLATFORM
+	test_cb_peek_commit_size(TEST_CB_PAGE_SIZE, true);
+#else
+	test_cb_peek_commit_size(TEST_CB_PAGE_SIZE, false);
+#endif
+}
+
+/* The writer never waits, the reader skips to the oldest data left */
+static void test_cb_overrun(void)
+{
+	struct circular_buffer *cb = test_cb_init(TEST_CB_ODD_SIZE);
+	uint8_t tx[TEST_CB_ODD_SIZE + 50], rx[TEST_CB_ODD_SIZE];
+	struct cb_span span;
+	uint32_t avail, i;
+
+	for (i = 0; i < sizeof(tx); i++)
+		tx[i] = test_cb_byte(i);
+	TEST_ASSERT_EQUAL(cb_write(cb, tx, sizeof(tx)), SUCCESS);
+	TEST_ASSERT_EQUAL(cb_size(cb, &avail), -EOVERRUN);
+	TEST_ASSERT_EQUAL(avail, TEST_CB_ODD_SIZE);
+
+	TEST_ASSERT_EQUAL(cb_read(cb, rx, sizeof(rx)), -EOVERRUN);
+	TEST_ASSERT(!memcmp(rx, tx + 50, sizeof(rx)));
+	TEST_ASSERT_EQUAL(cb_size(cb, &avail), SUCCESS);
+	TEST_ASSERT_EQUAL(avail, 0);
+
+	/* Lapped while the region was being read */
+	TEST_ASSERT_EQUAL(cb_write(cb, tx, 10), SUCCESS);
+	TEST_ASSERT_EQUAL(cb_peek_read(cb, 10, &span), SUCCESS);
+	TEST_ASSERT_EQUAL(cb_write(cb, tx, TEST_CB_ODD_SIZE), SUCCESS);
+	TEST_ASSERT_EQUAL(cb_commit_read(cb, 10), -EOVERRUN);
+
+	TEST_ASSERT_EQUAL(cb_remove(cb), SUCCESS);
+}
+
+/* The async calls only return the part up to the end of the buffer */
+static void test_cb_async(void)
+{
+	struct circular_buffer *cb = test_cb_init(TEST_CB_ODD_SIZE);
+	uint32_t avail;
+	void *buff;
+
+	test_cb_skip(cb, TEST_CB_ODD_SIZE, 90);
+
+	TEST_ASSERT_EQUAL(cb_prepare_async_write(cb, 30, &buff, &avail),
+			  SUCCESS);
+	TEST_ASSERT_EQUAL(avail, 10);
+	TEST_ASSERT_EQUAL(cb_prepare_async_write(cb, 30, &buff, &avail),
+			  -EBUSY);
+	memset(buff, 0x5a, avail);
+	TEST_ASSERT_EQUAL(cb_end_async_write(cb), SUCCESS);
+	TEST_ASSERT_EQUAL(cb_end_async_write(cb), FAILURE);
+
+	TEST_ASSERT_EQUAL(cb_prepare_async_read(cb, 30, &buff, &avail),
+			  SUCCESS);
+	TEST_ASSERT_EQUAL(avail, 10);
+	TEST_ASSERT_EQUAL(((uint8_t *)buff)[9], 0x5a);
+	TEST_ASSERT_EQUAL(cb_end_async_read(cb), SUCCESS);
+
+	TEST_ASSERT_EQUAL(cb_prepare_async_read(cb, 30, &buff, &avail),
+			  -EAGAIN);
+
+	TEST_ASSERT_EQUAL(cb_remove(cb), SUCCESS);
+}
+
+/* Producer side of the stress test, never overruns the consumer */
+static void *test_cb_producer(void *arg)
+{
+	struct test_cb_stream *s = arg;
+	struct cb_span span;
+	uint32_t used, len;
+	uint64_t n = 0;
+
+	while (n < TEST_CB_STRESS_SIZE) {
+		TEST_ASSERT_EQUAL(cb_size(s->cb, &used), SUCCESS);
+		len = s->size - used;
+		if (len > s->chunk)
+			len = s->chunk;
+		if (len > TEST_CB_STRESS_SIZE - n)
+			len = TEST_CB_STRESS_SIZE - n;
+		if (!len) {
+			sched_yield();
+			continue;
+		}
+
+		TEST_ASSERT_EQUAL(cb_peek_write(s->cb, len, &span), SUCCESS);
+		test_cb_span_fill(&span, n);
+		TEST_ASSERT_EQUAL(cb_commit_write(s->cb, len), SUCCESS);
+		n += len;
+	}
+
+	return NULL;
+}
+
+/* One thread writes and one reads, without locks, and no byte is lost */
+static void test_cb_spsc_size(uint32_t size, uint32_t chunk)
+{
+	struct test_cb_stream s = {
+		.cb = test_cb_init(size),
+		.size = size,
+		.chunk = chunk,
+	};
+	struct cb_span span;
+	pthread_t producer;
+	uint32_t len;
+	uint64_t n = 0;
+	int32_t ret;
+
+	TEST_ASSERT(!pthread_create(&producer, NULL, test_cb_producer, &s));
+	while (n < TEST_CB_STRESS_SIZE) {
+		ret = cb_peek_read(s.cb, chunk + 1, &span);
+		if (ret == -EAGAIN) {
+			sched_yield();
+			continue;
+		}
+		TEST_ASSERT_EQUAL(ret, SUCCESS);
+		TEST_ASSERT(test_cb_span_check(&span, n));
+		len = span.size[0] + span.size[1];
+		TEST_ASSERT_EQUAL(cb_commit_read(s.cb, len), SUCCESS);
+		n += len;
+	}
+	TEST_ASSERT(!pthread_join(producer, NULL));
+
+	TEST_ASSERT_EQUAL(cb_remove(s.cb), SUCCESS);
+}
+
+static void test_cb_spsc(void)
+{
+	test_cb_spsc_size(TEST_CB_POW2_SIZE, 17);
+	test_cb_spsc_size(TEST_CB_ODD_SIZE, 33);
+	test_cb_spsc_size(TEST_CB_PAGE_SIZE, 1000);
+}
+
+int main(void)
+{
+	TEST_RUN(test_cb_write_read);
+	TEST_RUN(test_cb_counter_wrap);
+	TEST_RUN(test_cb_peek_commit);
+	TEST_RUN(test_cb_overrun);
+	TEST_RUN(test_cb_async);
+	TEST_RUN(test_cb_spsc);
+
+	return 0;
+}
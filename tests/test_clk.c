@@ -0,0 +1,273 @@
+/***************************************************************************//**
+ *   @file   test_clk.c
+ *   @brief  Unit tests of the clock tree.
+********************************************************************************
+ * Copyright 2021(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include "clk.h"
+#include "error.h"
+#include "test.h"
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+/* Clock generator with an integer divider, fed by a reference oscillator */
+struct test_osc {
+	uint64_t rate;
+	uint32_t set_rate_calls;
+};
+
+/* Transceiver-like PLL: the multiplier is computed from the parent rate */
+struct test_pll {
+	struct clk *ref;
+	uint64_t mult;
+	uint32_t set_rate_calls;
+};
+
+/******************************************************************************/
+/************************** Functions Implementation **************************/
+/******************************************************************************/
+static int32_t test_osc_recalc_rate(struct test_osc *osc, uint32_t chan,
+				    uint64_t *rate)
+{
+	*rate = osc->rate;
+
+	return SUCCESS;
+}
+
+static int32_t test_osc_set_rate(struct test_osc *osc, uint32_t chan,
+				 uint64_t rate)
+{
+	osc->rate = rate;
+	osc->set_rate_calls++;
+
+	return SUCCESS;
+}
+
+static int32_t test_pll_recalc_rate(struct test_pll *pll, uint32_t chan,
+				    uint64_t *rate)
+{
+	uint64_t ref_rate;
+	int32_t ret;
+
+	ret = clk_recalc_rate(pll->ref, &ref_rate);
+	if (ret)
+		return ret;
+
+	*rate = ref_rate * pll->mult;
+
+	return SUCCESS;
+}
+
+static int32_t test_pll_set_rate(struct test_pll *pll, uint32_t chan,
+				 uint64_t rate)
+{
+	uint64_t ref_rate;
+	int32_t ret;
+
+	ret = clk_recalc_rate(pll->ref, &ref_rate);
+	if (ret)
+		return ret;
+
+	if (!ref_rate || rate % ref_rate)
+		return -EINVAL;
+
+	pll->mult = rate / ref_rate;
+	pll->set_rate_calls++;
+
+	return SUCCESS;
+}
+
+static struct test_osc osc_a, osc_b;
+static struct test_pll pll;
+static struct clk_hw osc_a_hw, osc_b_hw, pll_hw, div_hw;
+static struct clk ref_a, ref_b, lane, link;
+
+/*
+ * ref_a -> lane -> link, ref_b unused. The lane clock is a PLL, the link
+ * clock has no operation and runs at the lane rate.
+ */
+static void test_clk_setup(void)
+{
+	osc_a = (struct test_osc) {
+		.rate = 100
+	};
+	osc_b = (struct test_osc) {
+		.rate = 250
+	};
+	pll = (struct test_pll) {
+		.ref = &ref_a,
+		.mult = 1
+	};
+
+	osc_a_hw = (struct clk_hw) {
+		.dev = &osc_a,
+		.dev_clk_recalc_rate = test_osc_recalc_rate,
+		.dev_clk_set_rate = test_osc_set_rate,
+	};
+	osc_b_hw = (struct clk_hw) {
+		.dev = &osc_b,
+		.dev_clk_recalc_rate = test_osc_recalc_rate,
+		.dev_clk_set_rate = test_osc_set_rate,
+	};
+	pll_hw = (struct clk_hw) {
+		.dev = &pll,
+		.dev_clk_recalc_rate = test_pll_recalc_rate,
+		.dev_clk_set_rate = test_pll_set_rate,
+	};
+	div_hw = (struct clk_hw) {
+		0
+	};
+
+	ref_a = (struct clk) {
+		.hw = &osc_a_hw, .name = "ref_a", .flags = CLK_CACHE_RATE
+	};
+	ref_b = (struct clk) {
+		.hw = &osc_b_hw, .name = "ref_b", .flags = CLK_CACHE_RATE
+	};
+	lane = (struct clk) {
+		.hw = &pll_hw, .name = "lane", .flags = CLK_CACHE_RATE
+	};
+	link = (struct clk) {
+		.hw = &div_hw, .name = "link", .flags = CLK_CACHE_RATE
+	};
+
+	TEST_ASSERT_EQUAL(clk_register(&ref_a, NULL), SUCCESS);
+	TEST_ASSERT_EQUAL(clk_register(&ref_b, NULL), SUCCESS);
+	TEST_ASSERT_EQUAL(clk_register(&lane, &ref_a), SUCCESS);
+	TEST_ASSERT_EQUAL(clk_register(&link, &lane), SUCCESS);
+}
+
+/* A new parent rate sets the child PLL again and refreshes the cached rates */
+static void test_clk_set_rate_propagates(void)
+{
+	uint64_t rate;
+
+	test_clk_setup();
+
+	TEST_ASSERT_EQUAL(clk_set_rate(&lane, 1000), SUCCESS);
+	TEST_ASSERT_EQUAL(pll.mult, 10);
+	TEST_ASSERT_EQUAL(clk_recalc_rate(&link, &rate), SUCCESS);
+	TEST_ASSERT_EQUAL(rate, 1000);
+
+	TEST_ASSERT_EQUAL(clk_set_rate(&ref_a, 200), SUCCESS);
+	TEST_ASSERT_EQUAL(pll.mult, 5);
+	TEST_ASSERT_EQUAL(pll.set_rate_calls, 2);
+
+	/* Served from the caches refreshed by the propagation */
+	osc_a.rate = 0;
+	TEST_ASSERT_EQUAL(clk_recalc_rate(&ref_a, &rate), SUCCESS);
+	TEST_ASSERT_EQUAL(rate, 200);
+	TEST_ASSERT_EQUAL(clk_recalc_rate(&link, &rate), SUCCESS);
+	TEST_ASSERT_EQUAL(rate, 1000);
+}
+
+/* A child without a requested rate follows its parent */
+static void test_clk_set_rate_follows(void)
+{
+	uint64_t rate;
+
+	test_clk_setup();
+
+	TEST_ASSERT_EQUAL(clk_recalc_rate(&link, &rate), SUCCESS);
+	TEST_ASSERT_EQUAL(rate, 100);
+
+	TEST_ASSERT_EQUAL(clk_set_rate(&ref_a, 300), SUCCESS);
+	TEST_ASSERT_EQUAL(pll.set_rate_calls, 0);
+	TEST_ASSERT_EQUAL(clk_recalc_rate(&link, &rate), SUCCESS);
+	TEST_ASSERT_EQUAL(rate, 300);
+}
+
+/* A failing child is reported, the rest of the tree is still updated */
+static void test_clk_set_rate_child_error(void)
+{
+	uint64_t rate;
+
+	test_clk_setup();
+
+	TEST_ASSERT_EQUAL(clk_set_rate(&lane, 1000), SUCCESS);
+	TEST_ASSERT_EQUAL(clk_set_rate(&ref_a, 300), -EINVAL);
+	TEST_ASSERT_EQUAL(clk_recalc_rate(&ref_a, &rate), SUCCESS);
+	TEST_ASSERT_EQUAL(rate, 300);
+	TEST_ASSERT_EQUAL(clk_recalc_rate(&link, &rate), SUCCESS);
+	TEST_ASSERT_EQUAL(rate, 3000);
+}
+
+/* A clock without set_rate forwards the request with CLK_SET_RATE_PARENT */
+static void test_clk_set_rate_parent(void)
+{
+	uint64_t rate;
+
+	test_clk_setup();
+
+	TEST_ASSERT(clk_set_rate(&link, 2000) != SUCCESS);
+
+	link.flags |= CLK_SET_RATE_PARENT;
+	TEST_ASSERT_EQUAL(clk_set_rate(&link, 2000), SUCCESS);
+	TEST_ASSERT_EQUAL(pll.mult, 20);
+	TEST_ASSERT_EQUAL(clk_recalc_rate(&link, &rate), SUCCESS);
+	TEST_ASSERT_EQUAL(rate, 2000);
+}
+
+/* A reparented PLL is set to its rate again, from the new parent */
+static void test_clk_set_parent(void)
+{
+	uint64_t rate;
+
+	test_clk_setup();
+
+	TEST_ASSERT_EQUAL(clk_set_rate(&lane, 1000), SUCCESS);
+
+	/* The reference mux of the PLL has no operation, it follows the tree */
+	pll.ref = &ref_b;
+	TEST_ASSERT_EQUAL(clk_set_parent(&lane, &ref_b), SUCCESS);
+	TEST_ASSERT_EQUAL(pll.mult, 4);
+	TEST_ASSERT_EQUAL(clk_recalc_rate(&link, &rate), SUCCESS);
+	TEST_ASSERT_EQUAL(rate, 1000);
+}
+
+int main(void)
+{
+	TEST_RUN(test_clk_set_rate_propagates);
+	TEST_RUN(test_clk_set_rate_follows);
+	TEST_RUN(test_clk_set_rate_child_error);
+	TEST_RUN(test_clk_set_rate_parent);
+	TEST_RUN(test_clk_set_parent);
+
+	return 0;
+}
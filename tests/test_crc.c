@@ -0,0 +1,230 @@
+/***************************************************************************//**
+ *   @file   test_crc.c
+ *   @brief  Unit tests and throughput of the CRC kernels.
+********************************************************************************
+ * Copyright 2021(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdint.h>
+#include <time.h>
+#include "crc8.h"
+#include "crc16.h"
+#include "crc24.h"
+#include "util.h"
+#include "test.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+/* Polynomials of the drivers: ad7124/ad717x, adas1000 and a CRC-16 */
+#define TEST_CRC8_POLY		0x07
+#define TEST_CRC16_POLY		0x1021
+#define TEST_CRC24_POLY		0x5d6dcb
+
+/* Bytes processed by each throughput measurement */
+#define TEST_CRC_BENCH_BYTES	(2 * 1024 * 1024)
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+DECLARE_CRC8_CONST_TABLE(crc8_table, TEST_CRC8_POLY);
+DECLARE_CRC8_CONST_SLICE4_TABLE(crc8_slice4_table, TEST_CRC8_POLY);
+DECLARE_CRC16_CONST_TABLE(crc16_table, TEST_CRC16_POLY);
+DECLARE_CRC16_CONST_SLICE4_TABLE(crc16_slice4_table, TEST_CRC16_POLY);
+DECLARE_CRC24_CONST_TABLE(crc24_table, TEST_CRC24_POLY);
+DECLARE_CRC24_CONST_SLICE4_TABLE(crc24_slice4_table, TEST_CRC24_POLY);
+
+static uint8_t test_data[4096];
+
+/* Keeps the measured computations from being optimized out */
+static volatile uint32_t test_crc_sink;
+
+/******************************************************************************/
+/************************** Functions Implementation **************************/
+/******************************************************************************/
+/* Reference msb-first CRC, one bit at a time */
+static uint32_t test_crc_bitwise(uint32_t poly, uint8_t width,
+				 const uint8_t *pdata, size_t nbytes,
+				 uint32_t crc)
+{
+	uint32_t mask = (width == 32) ? 0xffffffff : (1ul << width) - 1;
+	uint8_t bit;
+
+	while (nbytes--) {
+		crc ^= (uint32_t)*pdata++ << (width - 8);
+		for (bit = 0; bit < 8; bit++)
+			crc = (crc & (1ul << (width - 1))) ?
+			      (crc << 1) ^ poly : crc << 1;
+		crc &= mask;
+	}
+
+	return crc;
+}
+
+static void test_crc_fill(void)
+{
+	uint32_t seed = 0x12345678;
+	size_t i;
+
+	for (i = 0; i < ARRAY_SIZE(test_data); i++) {
+		seed = seed * 1103515245 + 12345;
+		test_data[i] = seed >> 16;
+	}
+}
+
+/* The compile time tables match the ones built at runtime */
+static void test_crc_const_tables(void)
+{
+	uint16_t table16[CRC16_TABLE_SIZE];
+	uint32_t table24[CRC24_TABLE_SIZE];
+	uint8_t table8[CRC8_TABLE_SIZE];
+	int i;
+
+	crc8_populate_msb(table8, TEST_CRC8_POLY);
+	crc16_populate_msb(table16, TEST_CRC16_POLY);
+	crc24_populate_msb(table24, TEST_CRC24_POLY);
+
+	for (i = 0; i < CRC8_TABLE_SIZE; i++) {
+		TEST_ASSERT_EQUAL(crc8_table[i], table8[i]);
+		TEST_ASSERT_EQUAL(crc8_slice4_table[0][i], table8[i]);
+		TEST_ASSERT_EQUAL(crc16_table[i], table16[i]);
+		TEST_ASSERT_EQUAL(crc16_slice4_table[0][i], table16[i]);
+		TEST_ASSERT_EQUAL(crc24_table[i], table24[i]);
+		TEST_ASSERT_EQUAL(crc24_slice4_table[0][i], table24[i]);
+	}
+}
+
+/* Every length and alignment, with a non zero initial value */
+static void test_crc_kernels(void)
+{
+	size_t off, len;
+
+	for (off = 0; off < 4; off++) {
+		for (len = 0; len < 70; len++) {
+			const uint8_t *p = test_data + off;
+
+			TEST_ASSERT_EQUAL(crc8(crc8_table, p, len, 0x5a),
+					  test_crc_bitwise(TEST_CRC8_POLY, 8,
+							   p, len, 0x5a));
+			TEST_ASSERT_EQUAL(crc8_slice4(crc8_slice4_table, p,
+						      len, 0x5a),
+					  crc8(crc8_table, p, len, 0x5a));
+
+			TEST_ASSERT_EQUAL(crc16(crc16_table, p, len, 0xa55a),
+					  test_crc_bitwise(TEST_CRC16_POLY, 16,
+							   p, len, 0xa55a));
+			TEST_ASSERT_EQUAL(crc16_slice4(crc16_slice4_table, p,
+						       len, 0xa55a),
+					  crc16(crc16_table, p, len, 0xa55a));
+
+			TEST_ASSERT_EQUAL(crc24(crc24_table, p, len, 0xa5a55a),
+					  test_crc_bitwise(TEST_CRC24_POLY, 24,
+							   p, len, 0xa5a55a));
+			TEST_ASSERT_EQUAL(crc24_slice4(crc24_slice4_table, p,
+						       len, 0xa5a55a),
+					  crc24(crc24_table, p, len, 0xa5a55a));
+		}
+	}
+}
+
+static double test_crc_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* MB/s of a CRC-24 kernel over frames of the given length */
+static double test_crc_bench(int kernel, size_t len)
+{
+	uint32_t table24[CRC24_TABLE_SIZE];
+	size_t n = TEST_CRC_BENCH_BYTES / len;
+	uint32_t crc = 0;
+	double t;
+
+	t = test_crc_now();
+	while (n--) {
+		switch (kernel) {
+		case 0:
+			/* adas1000 before the const tables: table per frame */
+			crc24_populate_msb(table24, TEST_CRC24_POLY);
+			crc ^= crc24(table24, test_data, len, 0xffffff);
+			break;
+		case 1:
+			crc ^= test_crc_bitwise(TEST_CRC24_POLY, 24, test_data,
+						len, 0xffffff);
+			break;
+		case 2:
+			crc ^= crc24(crc24_table, test_data, len, 0xffffff);
+			break;
+		default:
+			crc ^= crc24_slice4(crc24_slice4_table, test_data, len,
+					    0xffffff);
+			break;
+		}
+	}
+	t = test_crc_now() - t;
+	test_crc_sink = crc;
+
+	return (TEST_CRC_BENCH_BYTES / len) * len / t / 1e6;
+}
+
+/* Not a pass/fail check: the numbers depend on the host */
+static void test_crc_throughput(void)
+{
+	static const size_t lens[] = { 3, 45, 256, 4096 };
+	size_t i;
+
+	printf("CRC-24 MB/s   populate  bitwise   table  slice4\n");
+	for (i = 0; i < ARRAY_SIZE(lens); i++)
+		printf("%5zu bytes  %9.1f %8.1f %7.1f %7.1f\n", lens[i],
+		       test_crc_bench(0, lens[i]), test_crc_bench(1, lens[i]),
+		       test_crc_bench(2, lens[i]), test_crc_bench(3, lens[i]));
+}
+
+int main(void)
+{
+	test_crc_fill();
+
+	TEST_RUN(test_crc_const_tables);
+	TEST_RUN(test_crc_kernels);
+	TEST_RUN(test_crc_throughput);
+
+	return 0;
+}
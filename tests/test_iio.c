@@ -0,0 +1,643 @@
+/***************************************************************************//**
+ *   @file   test_iio.c
+ *   @brief  Unit tests of the IIO layer, on top of a libtinyiiod double.
+********************************************************************************
+ * Copyright 2021(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "iio.h"
+#include "iio_types.h"
+#include "error.h"
+#include "tinyiiod.h"
+#include "test.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+/* Bytes captured by a buffer read: 32 samples of 2 channels of 16 bits */
+#define TEST_IIO_RD_SIZE	128
+#define TEST_IIO_RD_CHUNK	32
+
+/* priv of the attributes of the cache tests, indexes of their counters */
+enum test_iio_attr_id {
+	TEST_IIO_ATTR_STATIC,
+	TEST_IIO_ATTR_CACHED,
+	TEST_IIO_ATTR_LIVE,
+	TEST_IIO_ATTR_SCALE,
+	TEST_IIO_ATTR_NB
+};
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+static struct iio_device test_iio_dev;
+
+static struct scan_type test_iio_scan = {
+	.sign = 's',
+	.realbits = 16,
+	.storagebits = 16,
+};
+
+static struct iio_channel test_iio_channels[] = {
+	{.ch_type = IIO_VOLTAGE, .channel = 0, .scan_type = &test_iio_scan,
+	 .indexed = true},
+	{.ch_type = IIO_VOLTAGE, .channel = 1, .scan_type = &test_iio_scan,
+	 .indexed = true},
+};
+
+/* Samples left by read_dev_zc in a buffer of the device */
+static uint8_t test_iio_dev_buff[TEST_IIO_RD_SIZE];
+
+/* Bytes sent to the client through uart_write() */
+static uint8_t test_iio_tx[2 * TEST_IIO_RD_SIZE];
+static uint32_t test_iio_tx_len;
+
+/* Hook of the UART double, see stubs/uart.c */
+extern int32_t (*uart_test_write)(const uint8_t *data,
+				  uint32_t bytes_number);
+
+/* Prebuilt context listing device0 as "dev0" */
+static const char prebuilt_xml[] =
+	"<?xml version=\"1.0\" encoding=\"utf-8\"?><context name=\"tiny\">"
+	"<device id=\"device0\" name=\"dev0\"></device></context>";
+
+/* Values shown by the attributes of the cache tests and their show calls */
+static int32_t test_iio_attr_val[TEST_IIO_ATTR_NB];
+static uint32_t test_iio_attr_shows[TEST_IIO_ATTR_NB];
+
+static ssize_t test_iio_attr_show(void *device, char *buf, size_t len,
+				  const struct iio_ch_info *channel,
+				  intptr_t priv);
+static ssize_t test_iio_attr_store(void *device, char *buf, size_t len,
+				   const struct iio_ch_info *channel,
+				   intptr_t priv);
+
+static struct iio_attribute test_iio_attrs[] = {
+	{.name = "static", .priv = TEST_IIO_ATTR_STATIC,
+	 .show = test_iio_attr_show, .cache = IIO_ATTR_STATIC},
+	{.name = "cached", .priv = TEST_IIO_ATTR_CACHED,
+	 .show = test_iio_attr_show, .store = test_iio_attr_store,
+	 .cache = IIO_ATTR_CACHED},
+	{.name = "live", .priv = TEST_IIO_ATTR_LIVE,
+	 .show = test_iio_attr_show},
+	END_ATTRIBUTES_ARRAY
+};
+
+/* Shared by both channels, cached per channel */
+static struct iio_attribute test_iio_ch_attrs[] = {
+	{.name = "scale", .priv = TEST_IIO_ATTR_SCALE,
+	 .show = test_iio_attr_show, .store = test_iio_attr_store,
+	 .cache = IIO_ATTR_CACHED},
+	END_ATTRIBUTES_ARRAY
+};
+
+static struct iio_channel test_iio_attr_channels[] = {
+	{.ch_type = IIO_VOLTAGE, .channel = 0, .scan_type = &test_iio_scan,
+	 .attributes = test_iio_ch_attrs, .indexed = true},
+	{.ch_type = IIO_VOLTAGE, .channel = 1, .scan_type = &test_iio_scan,
+	 .attributes = test_iio_ch_attrs, .indexed = true},
+};
+
+/* Xml returned by the last get_xml operation */
+static char *test_xml;
+static ssize_t test_xml_size;
+
+/******************************************************************************/
+/************************** Functions Implementation **************************/
+/******************************************************************************/
+static int32_t test_get_xml(struct tinyiiod_ops *ops)
+{
+	test_xml_size = ops->get_xml(&test_xml);
+
+	return SUCCESS;
+}
+
+static struct iio_desc *test_iio_init(const char *xml, uint32_t xml_size)
+{
+	struct iio_init_param param = {
+		.phy_type = USE_UART,
+		.xml = xml,
+		.xml_size = xml_size,
+	};
+	struct iio_desc *desc;
+
+	TEST_ASSERT_EQUAL(iio_init(&desc, &param), SUCCESS);
+	tinyiiod_test_command = test_get_xml;
+
+	return desc;
+}
+
+static const char *test_iio_get_xml(struct iio_desc *desc)
+{
+	TEST_ASSERT_EQUAL(iio_step(desc), SUCCESS);
+	TEST_ASSERT(test_xml_size > 0);
+
+	return test_xml;
+}
+
+/* The prebuilt xml is served while it lists the registered devices */
+static void test_iio_prebuilt_xml(void)
+{
+	struct iio_desc *desc;
+	const char *xml;
+
+	desc = test_iio_init(prebuilt_xml, sizeof(prebuilt_xml));
+	TEST_ASSERT_EQUAL(iio_register(desc, &test_iio_dev, "dev0", NULL,
+				       NULL, NULL), SUCCESS);
+	TEST_ASSERT(test_iio_get_xml(desc) == prebuilt_xml);
+	TEST_ASSERT_EQUAL(test_xml_size, sizeof(prebuilt_xml));
+
+	/* Not in the prebuilt xml, it is generated from now on */
+	TEST_ASSERT_EQUAL(iio_register(desc, &test_iio_dev, "dev1", NULL,
+				       NULL, NULL), SUCCESS);
+	xml = test_iio_get_xml(desc);
+	TEST_ASSERT(xml != prebuilt_xml);
+	TEST_ASSERT(strstr(xml, "<device id=\"device1\" name=\"dev1\">"));
+
+	/* Back to the devices it describes */
+	TEST_ASSERT_EQUAL(iio_unregister(desc, "dev1"), SUCCESS);
+	TEST_ASSERT(test_iio_get_xml(desc) == prebuilt_xml);
+
+	TEST_ASSERT_EQUAL(iio_remove(desc), SUCCESS);
+}
+
+/* A prebuilt xml describing other devices is not served */
+static void test_iio_prebuilt_xml_mismatch(void)
+{
+	struct iio_desc *desc;
+	const char *xml;
+
+	desc = test_iio_init(prebuilt_xml, sizeof(prebuilt_xml));
+	TEST_ASSERT_EQUAL(iio_register(desc, &test_iio_dev, "other", NULL,
+				       NULL, NULL), SUCCESS);
+	xml = test_iio_get_xml(desc);
+	TEST_ASSERT(xml != prebuilt_xml);
+	TEST_ASSERT(strstr(xml, "name=\"other\""));
+	TEST_ASSERT_EQUAL(iio_remove(desc), SUCCESS);
+
+	/* Missing device */
+	desc = test_iio_init(prebuilt_xml, sizeof(prebuilt_xml));
+	TEST_ASSERT(test_iio_get_xml(desc) != prebuilt_xml);
+	TEST_ASSERT_EQUAL(iio_remove(desc), SUCCESS);
+
+	/* Not null terminated */
+	desc = test_iio_init(prebuilt_xml, sizeof(prebuilt_xml) - 1);
+	TEST_ASSERT_EQUAL(iio_register(desc, &test_iio_dev, "dev0", NULL,
+				       NULL, NULL), SUCCESS);
+	TEST_ASSERT(test_iio_get_xml(desc) != prebuilt_xml);
+	TEST_ASSERT_EQUAL(iio_remove(desc), SUCCESS);
+}
+
+/* Unregistering leaves no hole, the next devices move down one id */
+static void test_iio_unregister(void)
+{
+	struct iio_desc *desc;
+	const char *xml;
+
+	desc = test_iio_init(NULL, 0);
+	TEST_ASSERT_EQUAL(iio_register(desc, &test_iio_dev, "dev0", NULL,
+				       NULL, NULL), SUCCESS);
+	TEST_ASSERT_EQUAL(iio_register(desc, &test_iio_dev, "dev1", NULL,
+				       NULL, NULL), SUCCESS);
+	TEST_ASSERT_EQUAL(iio_register(desc, &test_iio_dev, "dev2", NULL,
+				       NULL, NULL), SUCCESS);
+
+	TEST_ASSERT_EQUAL(iio_unregister(desc, "dev1"), SUCCESS);
+	TEST_ASSERT_EQUAL(iio_unregister(desc, "dev1"), -ENOENT);
+	xml = test_iio_get_xml(desc);
+	TEST_ASSERT(strstr(xml, "<device id=\"device0\" name=\"dev0\">"));
+	TEST_ASSERT(strstr(xml, "<device id=\"device1\" name=\"dev2\">"));
+	TEST_ASSERT(!strstr(xml, "device2"));
+
+	/* The next device takes the first free id */
+	TEST_ASSERT_EQUAL(iio_register(desc, &test_iio_dev, "dev3", NULL,
+				       NULL, NULL), SUCCESS);
+	TEST_ASSERT_EQUAL(iio_unregister(desc, "dev0"), SUCCESS);
+	xml = test_iio_get_xml(desc);
+	TEST_ASSERT(strstr(xml, "<device id=\"device0\" name=\"dev2\">"));
+	TEST_ASSERT(strstr(xml, "<device id=\"device1\" name=\"dev3\">"));
+	TEST_ASSERT(!strstr(xml, "device2"));
+
+	/* Down to no device, then up again */
+	TEST_ASSERT_EQUAL(iio_unregister(desc, "dev2"), SUCCESS);
+	TEST_ASSERT_EQUAL(iio_unregister(desc, "dev3"), SUCCESS);
+	TEST_ASSERT(!strstr(test_iio_get_xml(desc), "<device "));
+	TEST_ASSERT_EQUAL(iio_register(desc, &test_iio_dev, "dev4", NULL,
+				       NULL, NULL), SUCCESS);
+	TEST_ASSERT(strstr(test_iio_get_xml(desc),
+			   "<device id=\"device0\" name=\"dev4\">"));
+
+	TEST_ASSERT_EQUAL(iio_remove(desc), SUCCESS);
+}
+
+static int32_t test_iio_uart_write(const uint8_t *data, uint32_t bytes_number)
+{
+	TEST_ASSERT(test_iio_tx_len + bytes_number <= sizeof(test_iio_tx));
+	memcpy(test_iio_tx + test_iio_tx_len, data, bytes_number);
+	test_iio_tx_len += bytes_number;
+
+	return bytes_number;
+}
+
+static int32_t test_iio_dev_read_dev(void *dev, void *buff, uint32_t nb_samples)
+{
+	uint32_t i;
+
+	TEST_ASSERT_EQUAL(nb_samples, TEST_IIO_RD_SIZE / 4);
+	for (i = 0; i < TEST_IIO_RD_SIZE; i++)
+		((uint8_t *)buff)[i] = i;
+
+	return nb_samples;
+}
+
+static int32_t test_iio_dev_read_dev_zc(void *dev, void **buff,
+				    uint32_t nb_samples)
+{
+	uint32_t i;
+
+	TEST_ASSERT_EQUAL(nb_samples, TEST_IIO_RD_SIZE / 4);
+	for (i = 0; i < TEST_IIO_RD_SIZE; i++)
+		test_iio_dev_buff[i] = ~i;
+	*buff = test_iio_dev_buff;
+
+	return nb_samples;
+}
+
+/*
+ * What libtinyiiod does for a READBUF command: each chunk is read into its
+ * own buffer, then written to the client, here in two writes.
+ */
+static int32_t test_iio_readbuf(struct tinyiiod_ops *ops)
+{
+	char pbuf[TEST_IIO_RD_CHUNK];
+	size_t offset;
+
+	TEST_ASSERT_EQUAL(ops->open("device0", 4, 0x3, false), SUCCESS);
+	TEST_ASSERT_EQUAL(ops->transfer_dev_to_mem("device0", TEST_IIO_RD_SIZE),
+			  TEST_IIO_RD_SIZE);
+	for (offset = 0; offset < TEST_IIO_RD_SIZE; offset += sizeof(pbuf)) {
+		/* Never filled, the data comes from the device buffer */
+		memset(pbuf, 0xaa, sizeof(pbuf));
+		TEST_ASSERT_EQUAL(ops->read_data("device0", pbuf, offset,
+						 sizeof(pbuf)), sizeof(pbuf));
+		TEST_ASSERT_EQUAL(ops->write(pbuf, 10), 10);
+		TEST_ASSERT_EQUAL(ops->write(pbuf + 10, sizeof(pbuf) - 10),
+				  sizeof(pbuf) - 10);
+	}
+
+	return ops->close("device0");
+}
+
+/* Calls out of the libtinyiiod order are refused, not sent */
+static int32_t test_iio_readbuf_order(struct tinyiiod_ops *ops)
+{
+	char pbuf[TEST_IIO_RD_CHUNK], other[TEST_IIO_RD_CHUNK];
+
+	TEST_ASSERT_EQUAL(ops->open("device0", 4, 0x3, false), SUCCESS);
+	TEST_ASSERT_EQUAL(ops->transfer_dev_to_mem("device0", TEST_IIO_RD_SIZE),
+			  TEST_IIO_RD_SIZE);
+	TEST_ASSERT_EQUAL(ops->read_data("device0", pbuf, 0, sizeof(pbuf)),
+			  sizeof(pbuf));
+
+	/* The next chunk while this one is unsent */
+	TEST_ASSERT_EQUAL(ops->read_data("device0", pbuf, sizeof(pbuf),
+					 sizeof(pbuf)), -EINVAL);
+	/* Another buffer, a skipped byte or past the end of the chunk */
+	TEST_ASSERT_EQUAL(ops->write(other, sizeof(other)), -EINVAL);
+	TEST_ASSERT_EQUAL(ops->write(pbuf + 1, 4), -EINVAL);
+	TEST_ASSERT_EQUAL(ops->write(pbuf, sizeof(pbuf) + 1), -EINVAL);
+	TEST_ASSERT_EQUAL(test_iio_tx_len, 0);
+
+	/* Part of it is sent, then a new request drops the rest */
+	TEST_ASSERT_EQUAL(ops->write(pbuf, 4), 4);
+	TEST_ASSERT(ops->read(other, 1) < 0);
+	/* Other writes are sent as they are again */
+	memset(other, 0x55, sizeof(other));
+	TEST_ASSERT_EQUAL(ops->write(other, 4), 4);
+	TEST_ASSERT_EQUAL(ops->read_data("device0", pbuf, sizeof(pbuf),
+					 sizeof(pbuf)), sizeof(pbuf));
+	TEST_ASSERT_EQUAL(ops->write(pbuf, sizeof(pbuf)), sizeof(pbuf));
+
+	return ops->close("device0");
+}
+
+static struct iio_desc *test_iio_init_rd(struct iio_data_buffer *rd_buff)
+{
+	struct iio_desc *desc;
+
+	test_iio_dev.num_ch = 2;
+	test_iio_dev.channels = test_iio_channels;
+	test_iio_tx_len = 0;
+	uart_test_write = test_iio_uart_write;
+
+	desc = test_iio_init(NULL, 0);
+	TEST_ASSERT_EQUAL(iio_register(desc, &test_iio_dev, "adc", NULL,
+				       rd_buff, NULL), SUCCESS);
+
+	return desc;
+}
+
+static void test_iio_remove_rd(struct iio_desc *desc)
+{
+	TEST_ASSERT_EQUAL(iio_remove(desc), SUCCESS);
+	memset(&test_iio_dev, 0, sizeof(test_iio_dev));
+	uart_test_write = NULL;
+}
+
+/* The chunks handed to libtinyiiod are sent from the read buffer */
+static void test_iio_read_zero_copy(void)
+{
+	uint8_t buff[TEST_IIO_RD_SIZE];
+	struct iio_data_buffer rd_buff = {
+		.size = sizeof(buff),
+		.buff = buff,
+	};
+	struct iio_desc *desc;
+	uint32_t i;
+
+	test_iio_dev.read_dev = test_iio_dev_read_dev;
+	desc = test_iio_init_rd(&rd_buff);
+	tinyiiod_test_command = test_iio_readbuf;
+	TEST_ASSERT_EQUAL(iio_step(desc), SUCCESS);
+
+	TEST_ASSERT_EQUAL(test_iio_tx_len, TEST_IIO_RD_SIZE);
+	for (i = 0; i < TEST_IIO_RD_SIZE; i++)
+		TEST_ASSERT_EQUAL(test_iio_tx[i], i);
+
+	test_iio_remove_rd(desc);
+}
+
+/* Devices implementing read_dev_zc are sent from their own buffer */
+static void test_iio_read_dev_zc(void)
+{
+	struct iio_desc *desc;
+	uint32_t i;
+
+	test_iio_dev.read_dev_zc = test_iio_dev_read_dev_zc;
+	desc = test_iio_init_rd(NULL);
+	tinyiiod_test_command = test_iio_readbuf;
+	TEST_ASSERT_EQUAL(iio_step(desc), SUCCESS);
+
+	TEST_ASSERT_EQUAL(test_iio_tx_len, TEST_IIO_RD_SIZE);
+	for (i = 0; i < TEST_IIO_RD_SIZE; i++)
+		TEST_ASSERT_EQUAL(test_iio_tx[i], (uint8_t)~i);
+
+	test_iio_remove_rd(desc);
+}
+
+/* The zero-copy path only follows the libtinyiiod call order */
+static void test_iio_read_zero_copy_order(void)
+{
+	uint8_t buff[TEST_IIO_RD_SIZE];
+	struct iio_data_buffer rd_buff = {
+		.size = sizeof(buff),
+		.buff = buff,
+	};
+	struct iio_desc *desc;
+	uint32_t i;
+
+	test_iio_dev.read_dev = test_iio_dev_read_dev;
+	desc = test_iio_init_rd(&rd_buff);
+	tinyiiod_test_command = test_iio_readbuf_order;
+	TEST_ASSERT_EQUAL(iio_step(desc), SUCCESS);
+
+	/* 4 bytes of the first chunk, a plain write, then the second chunk */
+	TEST_ASSERT_EQUAL(test_iio_tx_len, 4 + 4 + TEST_IIO_RD_CHUNK);
+	for (i = 0; i < 4; i++) {
+		TEST_ASSERT_EQUAL(test_iio_tx[i], i);
+		TEST_ASSERT_EQUAL(test_iio_tx[4 + i], 0x55);
+	}
+	for (i = 0; i < TEST_IIO_RD_CHUNK; i++)
+		TEST_ASSERT_EQUAL(test_iio_tx[8 + i], TEST_IIO_RD_CHUNK + i);
+
+	test_iio_remove_rd(desc);
+}
+
+static ssize_t test_iio_attr_show(void *device, char *buf, size_t len,
+				  const struct iio_ch_info *channel,
+				  intptr_t priv)
+{
+	int32_t val = test_iio_attr_val[priv];
+
+	test_iio_attr_shows[priv]++;
+	if (channel)
+		val = val * 10 + channel->ch_num;
+
+	return snprintf(buf, len, "%"PRIi32, val);
+}
+
+static ssize_t test_iio_attr_store(void *device, char *buf, size_t len,
+				   const struct iio_ch_info *channel,
+				   intptr_t priv)
+{
+	test_iio_attr_val[priv] = strtol(buf, NULL, 0);
+
+	return len;
+}
+
+static int32_t test_iio_reg_write(void *dev, uint32_t reg, uint32_t writeval)
+{
+	test_iio_attr_val[TEST_IIO_ATTR_CACHED] = writeval;
+
+	return SUCCESS;
+}
+
+/* Read an attribute of device0, check its value and the show calls so far */
+static void test_iio_check_attr(struct tinyiiod_ops *ops, const char *attr,
+				enum test_iio_attr_id id, const char *val,
+				uint32_t shows)
+{
+	char buf[16];
+
+	TEST_ASSERT_EQUAL(ops->read_attr("device0", attr, buf, sizeof(buf),
+					 IIO_ATTR_TYPE_DEVICE), strlen(val));
+	TEST_ASSERT(!strcmp(buf, val));
+	TEST_ASSERT_EQUAL(test_iio_attr_shows[id], shows);
+}
+
+/* Same for the scale of a channel */
+static void test_iio_check_scale(struct tinyiiod_ops *ops, const char *ch,
+				 const char *val, uint32_t shows)
+{
+	char buf[16];
+
+	TEST_ASSERT_EQUAL(ops->ch_read_attr("device0", ch, false, "scale", buf,
+					    sizeof(buf)), strlen(val));
+	TEST_ASSERT(!strcmp(buf, val));
+	TEST_ASSERT_EQUAL(test_iio_attr_shows[TEST_IIO_ATTR_SCALE], shows);
+}
+
+static int32_t test_iio_attr_cache_cmd(struct tinyiiod_ops *ops)
+{
+	/* Shown once, then served from the cache */
+	test_iio_check_attr(ops, "static", TEST_IIO_ATTR_STATIC, "1", 1);
+	test_iio_check_attr(ops, "static", TEST_IIO_ATTR_STATIC, "1", 1);
+	test_iio_check_attr(ops, "cached", TEST_IIO_ATTR_CACHED, "2", 1);
+	test_iio_check_attr(ops, "cached", TEST_IIO_ATTR_CACHED, "2", 1);
+	/* Shown on every read */
+	test_iio_check_attr(ops, "live", TEST_IIO_ATTR_LIVE, "3", 1);
+	test_iio_check_attr(ops, "live", TEST_IIO_ATTR_LIVE, "3", 2);
+
+	/* A store drops the cached values, not the static ones */
+	TEST_ASSERT_EQUAL(ops->write_attr("device0", "cached", "5", 1,
+					  IIO_ATTR_TYPE_DEVICE), 1);
+	test_iio_check_attr(ops, "cached", TEST_IIO_ATTR_CACHED, "5", 2);
+	test_iio_check_attr(ops, "cached", TEST_IIO_ATTR_CACHED, "5", 2);
+	test_iio_check_attr(ops, "static", TEST_IIO_ATTR_STATIC, "1", 1);
+
+	/* So does a register write */
+	TEST_ASSERT_EQUAL(ops->write_attr("device0", "direct_reg_access",
+					  "0x10 0x7", 8, IIO_ATTR_TYPE_DEBUG),
+			  8);
+	test_iio_check_attr(ops, "cached", TEST_IIO_ATTR_CACHED, "7", 3);
+
+	/* Channels sharing an attribute array have their own values */
+	test_iio_check_scale(ops, "voltage0", "40", 1);
+	test_iio_check_scale(ops, "voltage1", "41", 2);
+	test_iio_check_scale(ops, "voltage0", "40", 2);
+	test_iio_check_scale(ops, "voltage1", "41", 2);
+	/* And a store on one channel drops the cached values of both */
+	TEST_ASSERT_EQUAL(ops->ch_write_attr("device0", "voltage1", false,
+					     "scale", "6", 1), 1);
+	test_iio_check_scale(ops, "voltage0", "60", 3);
+	test_iio_check_scale(ops, "voltage1", "61", 4);
+	test_iio_check_attr(ops, "cached", TEST_IIO_ATTR_CACHED, "7", 4);
+
+	return SUCCESS;
+}
+
+/* Values which do not fit the read buffer are not cached */
+static int32_t test_iio_attr_cache_trunc_cmd(struct tinyiiod_ops *ops)
+{
+	char buf[4];
+
+	TEST_ASSERT_EQUAL(ops->read_attr("device0", "cached", buf, sizeof(buf),
+					 IIO_ATTR_TYPE_DEVICE), 5);
+	TEST_ASSERT(!strcmp(buf, "123"));
+	TEST_ASSERT_EQUAL(test_iio_attr_shows[TEST_IIO_ATTR_CACHED], 1);
+	test_iio_check_attr(ops, "cached", TEST_IIO_ATTR_CACHED, "12345", 2);
+	test_iio_check_attr(ops, "cached", TEST_IIO_ATTR_CACHED, "12345", 2);
+	/* A cached value too long for the buffer is shown again */
+	TEST_ASSERT_EQUAL(ops->read_attr("device0", "cached", buf, sizeof(buf),
+					 IIO_ATTR_TYPE_DEVICE), 5);
+	TEST_ASSERT_EQUAL(test_iio_attr_shows[TEST_IIO_ATTR_CACHED], 3);
+
+	return SUCCESS;
+}
+
+/* Reading all the attributes at once goes through the cache too */
+static int32_t test_iio_attr_cache_all_cmd(struct tinyiiod_ops *ops)
+{
+	char buf[64];
+
+	test_iio_check_attr(ops, "static", TEST_IIO_ATTR_STATIC, "1", 1);
+	test_iio_check_attr(ops, "cached", TEST_IIO_ATTR_CACHED, "2", 1);
+	/* Length of each value, big endian, then the value padded to 4 bytes */
+	TEST_ASSERT_EQUAL(ops->read_attr("device0", "", buf, sizeof(buf),
+					 IIO_ATTR_TYPE_DEVICE), 3 * 8);
+	TEST_ASSERT(!memcmp(buf, "\0\0\0\1" "1\0\0\0"
+			    "\0\0\0\1" "2\0\0\0"
+			    "\0\0\0\1" "3", 8 * 2 + 5));
+	TEST_ASSERT_EQUAL(test_iio_attr_shows[TEST_IIO_ATTR_STATIC], 1);
+	TEST_ASSERT_EQUAL(test_iio_attr_shows[TEST_IIO_ATTR_CACHED], 1);
+	TEST_ASSERT_EQUAL(test_iio_attr_shows[TEST_IIO_ATTR_LIVE], 1);
+
+	return SUCCESS;
+}
+
+static void test_iio_attr_cache_run(int32_t (*cmd)(struct tinyiiod_ops *ops),
+				    const int32_t *vals)
+{
+	struct iio_desc *desc;
+
+	memcpy(test_iio_attr_val, vals, sizeof(test_iio_attr_val));
+	memset(test_iio_attr_shows, 0, sizeof(test_iio_attr_shows));
+	test_iio_dev.num_ch = 2;
+	test_iio_dev.channels = test_iio_attr_channels;
+	test_iio_dev.attributes = test_iio_attrs;
+	test_iio_dev.debug_reg_write = test_iio_reg_write;
+
+	desc = test_iio_init(NULL, 0);
+	TEST_ASSERT_EQUAL(iio_register(desc, &test_iio_dev, "dev0", NULL,
+				       NULL, NULL), SUCCESS);
+	tinyiiod_test_command = cmd;
+	TEST_ASSERT_EQUAL(iio_step(desc), SUCCESS);
+
+	TEST_ASSERT_EQUAL(iio_remove(desc), SUCCESS);
+	memset(&test_iio_dev, 0, sizeof(test_iio_dev));
+}
+
+/* Static and cached values are only shown again when they may have changed */
+static void test_iio_attr_cache(void)
+{
+	static const int32_t vals[TEST_IIO_ATTR_NB] = {1, 2, 3, 4};
+
+	test_iio_attr_cache_run(test_iio_attr_cache_cmd, vals);
+}
+
+static void test_iio_attr_cache_trunc(void)
+{
+	static const int32_t vals[TEST_IIO_ATTR_NB] = {1, 12345, 3, 4};
+
+	test_iio_attr_cache_run(test_iio_attr_cache_trunc_cmd, vals);
+}
+
+static void test_iio_attr_cache_all(void)
+{
+	static const int32_t vals[TEST_IIO_ATTR_NB] = {1, 2, 3, 4};
+
+	test_iio_attr_cache_run(test_iio_attr_cache_all_cmd, vals);
+}
+
+int main(void)
+{
+	TEST_RUN(test_iio_prebuilt_xml);
+	TEST_RUN(test_iio_prebuilt_xml_mismatch);
+	TEST_RUN(test_iio_unregister);
+	TEST_RUN(test_iio_read_zero_copy);
+	TEST_RUN(test_iio_read_dev_zc);
+	TEST_RUN(test_iio_read_zero_copy_order);
+	TEST_RUN(test_iio_attr_cache);
+	TEST_RUN(test_iio_attr_cache_trunc);
+	TEST_RUN(test_iio_attr_cache_all);
+
+	return 0;
+}
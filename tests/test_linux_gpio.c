@@ -0,0 +1,343 @@
+/***************************************************************************//**
+ *   @file   test_linux_gpio.c
+ *   @brief  Unit tests of the Linux GPIO character device backend.
+********************************************************************************
+ * Copyright 2021(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <errno.h>
+#include <poll.h>
+#include <stdarg.h>
+#include <string.h>
+#include <time.h>
+#include <linux/gpio.h>
+#include "error.h"
+#include "gpio.h"
+#include "linux_gpio.h"
+#include "test.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+/* File descriptors of the mocked chip and line request */
+#define MOCK_CHIP_FD		1000
+#define MOCK_LINE_FD		1001
+
+/* Time it takes to read an event */
+#define MOCK_EVENT_COST_US	50
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+/*
+ * The backend is linked with open(), close(), ioctl(), poll(), read() and
+ * clock_gettime() wrapped (see the Makefile). The mock is one line of one
+ * chip, with a queue of edge events and a clock that only moves when the
+ * backend sleeps or reads an event.
+ */
+static struct {
+	bool chip_open;
+	bool line_open;
+	uint64_t flags;
+	uint64_t value;
+	uint32_t offset;
+	uint32_t events[256];
+	uint32_t nb_events;
+	uint32_t next_event;
+	uint64_t now_us;
+} mock;
+
+int __real_open(const char *path, int flags, ...);
+int __real_close(int fd);
+int __real_ioctl(int fd, unsigned long request, ...);
+int __real_poll(struct pollfd *fds, nfds_t nfds, int timeout);
+ssize_t __real_read(int fd, void *buf, size_t count);
+
+/******************************************************************************/
+/************************** Functions Implementation **************************/
+/******************************************************************************/
+int __wrap_open(const char *path, int flags, ...)
+{
+	if (strcmp(path, "/dev/gpiochip0"))
+		return __real_open(path, flags, 0);
+
+	mock.chip_open = true;
+
+	return MOCK_CHIP_FD;
+}
+
+int __wrap_close(int fd)
+{
+	if (fd == MOCK_CHIP_FD)
+		mock.chip_open = false;
+	else if (fd == MOCK_LINE_FD)
+		mock.line_open = false;
+	else
+		return __real_close(fd);
+
+	return 0;
+}
+
+int __wrap_ioctl(int fd, unsigned long request, ...)
+{
+	struct gpio_v2_line_request *req;
+	struct gpio_v2_line_config *config;
+	struct gpio_v2_line_values *values;
+	struct gpio_v2_line_info *info;
+	va_list args;
+	void *arg;
+
+	va_start(args, request);
+	arg = va_arg(args, void *);
+	va_end(args);
+
+	if (fd != MOCK_CHIP_FD && fd != MOCK_LINE_FD)
+		return __real_ioctl(fd, request, arg);
+
+	switch (request) {
+	case GPIO_V2_GET_LINE_IOCTL:
+		req = arg;
+		mock.offset = req->offsets[0];
+		mock.flags = req->config.flags;
+		mock.line_open = true;
+		req->fd = MOCK_LINE_FD;
+		return 0;
+	case GPIO_V2_LINE_SET_CONFIG_IOCTL:
+		config = arg;
+		mock.flags = config->flags;
+		if (config->num_attrs)
+			mock.value = config->attrs[0].attr.values & 1;
+		return 0;
+	case GPIO_V2_LINE_GET_VALUES_IOCTL:
+		values = arg;
+		values->bits = mock.value & values->mask;
+		return 0;
+	case GPIO_V2_LINE_SET_VALUES_IOCTL:
+		values = arg;
+		if (!(mock.flags & GPIO_V2_LINE_FLAG_OUTPUT)) {
+			errno = EPERM;
+			return -1;
+		}
+		mock.value = (mock.value & ~values->mask) |
+			     (values->bits & values->mask);
+		return 0;
+	case GPIO_V2_GET_LINEINFO_IOCTL:
+		info = arg;
+		info->flags = mock.flags;
+		return 0;
+	default:
+		errno = EINVAL;
+		return -1;
+	}
+}
+
+int __wrap_poll(struct pollfd *fds, nfds_t nfds, int timeout)
+{
+	if (fds[0].fd != MOCK_LINE_FD)
+		return __real_poll(fds, nfds, timeout);
+
+	if (mock.next_event < mock.nb_events) {
+		fds[0].revents = POLLIN;
+		return 1;
+	}
+
+	/* Sleep through the whole timeout */
+	mock.now_us += timeout * 1000ull;
+	fds[0].revents = 0;
+
+	return 0;
+}
+
+ssize_t __wrap_read(int fd, void *buf, size_t count)
+{
+	struct gpio_v2_line_event *event = buf;
+
+	if (fd != MOCK_LINE_FD)
+		return __real_read(fd, buf, count);
+
+	if (mock.next_event == mock.nb_events) {
+		errno = EAGAIN;
+		return -1;
+	}
+
+	memset(event, 0, sizeof(*event));
+	event->id = mock.events[mock.next_event++];
+	event->offset = mock.offset;
+	mock.now_us += MOCK_EVENT_COST_US;
+
+	return sizeof(*event);
+}
+
+int __wrap_clock_gettime(clockid_t clk, struct timespec *ts)
+{
+	ts->tv_sec = mock.now_us / 1000000;
+	ts->tv_nsec = (mock.now_us % 1000000) * 1000;
+
+	return 0;
+}
+
+static void mock_queue(uint32_t id, uint32_t n)
+{
+	while (n--)
+		mock.events[mock.nb_events++] = id;
+}
+
+static struct gpio_desc *test_gpio_get(void)
+{
+	struct linux_gpio_init_param linux_param = {
+		.chip = "gpiochip0",
+	};
+	struct gpio_init_param param = {
+		.number = 5,
+		.platform_ops = &linux_gpiochip_platform_ops,
+		.extra = &linux_param,
+	};
+	struct gpio_desc *desc;
+
+	memset(&mock, 0, sizeof(mock));
+	mock.now_us = 1000000;
+
+	TEST_ASSERT_EQUAL(gpio_get(&desc, &param), SUCCESS);
+	TEST_ASSERT(mock.chip_open && mock.line_open);
+	TEST_ASSERT_EQUAL(mock.offset, 5);
+
+	return desc;
+}
+
+/* Direction and value go through the line request ioctls */
+static void test_gpio_chardev(void)
+{
+	struct gpio_desc *desc = test_gpio_get();
+	uint8_t val;
+
+	TEST_ASSERT_EQUAL(gpio_direction_output(desc, GPIO_HIGH), SUCCESS);
+	TEST_ASSERT_EQUAL(gpio_get_direction(desc, &val), SUCCESS);
+	TEST_ASSERT_EQUAL(val, GPIO_OUT);
+	TEST_ASSERT_EQUAL(mock.value, 1);
+	TEST_ASSERT_EQUAL(gpio_set_value(desc, GPIO_LOW), SUCCESS);
+	TEST_ASSERT_EQUAL(mock.value, 0);
+
+	TEST_ASSERT_EQUAL(gpio_direction_input(desc), SUCCESS);
+	TEST_ASSERT_EQUAL(gpio_get_direction(desc, &val), SUCCESS);
+	TEST_ASSERT_EQUAL(val, GPIO_IN);
+	TEST_ASSERT(mock.flags & GPIO_V2_LINE_FLAG_EDGE_FALLING);
+	mock.value = 1;
+	TEST_ASSERT_EQUAL(gpio_get_value(desc, &val), SUCCESS);
+	TEST_ASSERT_EQUAL(val, GPIO_HIGH);
+	TEST_ASSERT(gpio_set_value(desc, GPIO_LOW) < 0);
+
+	TEST_ASSERT_EQUAL(gpio_remove(desc), SUCCESS);
+	TEST_ASSERT(!mock.chip_open && !mock.line_open);
+}
+
+/* Other edges are skipped and the time spent is taken off the timeout */
+static void test_gpio_wait_edge(void)
+{
+	struct gpio_desc *desc = test_gpio_get();
+	uint32_t timeout = 1000;
+
+	/* Edges are only reported on inputs */
+	TEST_ASSERT_EQUAL(gpio_direction_output(desc, GPIO_LOW), SUCCESS);
+	TEST_ASSERT_EQUAL(gpio_wait_edge(desc, GPIO_EDGE_FALLING, &timeout),
+			  -EINVAL);
+	TEST_ASSERT_EQUAL(gpio_wait_edge(NULL, GPIO_EDGE_FALLING, &timeout),
+			  -EINVAL);
+	TEST_ASSERT_EQUAL(gpio_direction_input(desc), SUCCESS);
+
+	mock_queue(GPIO_V2_LINE_EVENT_RISING_EDGE, 1);
+	mock_queue(GPIO_V2_LINE_EVENT_FALLING_EDGE, 1);
+	TEST_ASSERT_EQUAL(gpio_wait_edge(desc, GPIO_EDGE_FALLING, &timeout),
+			  SUCCESS);
+	TEST_ASSERT_EQUAL(mock.next_event, 2);
+	TEST_ASSERT_EQUAL(timeout, 1000 - 2 * MOCK_EVENT_COST_US);
+
+	mock_queue(GPIO_V2_LINE_EVENT_RISING_EDGE, 1);
+	TEST_ASSERT_EQUAL(gpio_wait_edge(desc, GPIO_EDGE_BOTH, &timeout),
+			  SUCCESS);
+	TEST_ASSERT_EQUAL(timeout, 1000 - 3 * MOCK_EVENT_COST_US);
+
+	/* Nothing queued: sleeps for the time left, rounded up to a
+	 * millisecond, then gives up */
+	TEST_ASSERT_EQUAL(gpio_wait_edge(desc, GPIO_EDGE_FALLING, &timeout),
+			  -ETIMEDOUT);
+	TEST_ASSERT_EQUAL(timeout, 0);
+	TEST_ASSERT_EQUAL(mock.now_us, 1000000 + 3 * MOCK_EVENT_COST_US + 1000);
+
+	gpio_remove(desc);
+}
+
+/*
+ * The loop of ad7606_read(): stale edges with BUSY still high. Each one
+ * costs time, and the loop runs out of it instead of restarting the full
+ * timeout on every edge.
+ */
+static void test_gpio_wait_edge_deadline(void)
+{
+	struct gpio_desc *desc = test_gpio_get();
+	uint32_t timeout = 1000, nb_edges = 0;
+	uint8_t busy;
+	int32_t ret;
+
+	TEST_ASSERT_EQUAL(gpio_direction_input(desc), SUCCESS);
+	mock.value = 1;
+	mock_queue(GPIO_V2_LINE_EVENT_FALLING_EDGE, 200);
+
+	while (true) {
+		ret = gpio_wait_edge(desc, GPIO_EDGE_FALLING, &timeout);
+		if (ret != SUCCESS)
+			break;
+		nb_edges++;
+		TEST_ASSERT_EQUAL(gpio_get_value(desc, &busy), SUCCESS);
+		if (!busy)
+			break;
+	}
+
+	TEST_ASSERT_EQUAL(ret, -ETIMEDOUT);
+	TEST_ASSERT_EQUAL(nb_edges, 1000 / MOCK_EVENT_COST_US);
+	TEST_ASSERT_EQUAL(timeout, 0);
+
+	gpio_remove(desc);
+}
+
+int main(void)
+{
+	TEST_RUN(test_gpio_chardev);
+	TEST_RUN(test_gpio_wait_edge);
+	TEST_RUN(test_gpio_wait_edge_deadline);
+
+	return 0;
+}
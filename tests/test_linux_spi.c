@@ -0,0 +1,362 @@
+/***************************************************************************//**
+ *   @file   test_linux_spi.c
+ *   @brief  Unit tests of the Linux spidev SPI backend.
+********************************************************************************
+ * Copyright 2021(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include "error.h"
+#include "spi.h"
+#include "linux_spi.h"
+#include "test.h"
+
+#include <errno.h>
+#include <stdarg.h>
+#include <stdbool.h>
+#include <string.h>
+#include <linux/spi/spidev.h>
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+/* File descriptor of the mocked /dev/spidev0.1 */
+#define MOCK_SPIDEV_FD		1000
+
+/* Transfers recorded, over all the SPI_IOC_MESSAGE() ioctls */
+#define MOCK_MAX_TRANSFERS	512
+#define MOCK_MAX_IOCTLS		16
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+/*
+ * The backend is linked with open(), close() and ioctl() wrapped (see the
+ * Makefile). The mock records the SPI_IOC_MESSAGE() ioctls and loops the
+ * transmitted bytes back to the receive buffers.
+ */
+static struct {
+	bool open;
+	uint8_t mode;
+	uint32_t max_speed_hz;
+	struct spi_ioc_transfer tr[MOCK_MAX_TRANSFERS];
+	uint32_t nb_tr;
+	uint32_t ioctl_len[MOCK_MAX_IOCTLS];
+	uint32_t nb_ioctls;
+	bool fail;
+} mock;
+
+int __real_open(const char *path, int flags, ...);
+int __real_close(int fd);
+int __real_ioctl(int fd, unsigned long request, ...);
+
+/******************************************************************************/
+/************************** Functions Implementation **************************/
+/******************************************************************************/
+int __wrap_open(const char *path, int flags, ...)
+{
+	if (strcmp(path, "/dev/spidev0.1"))
+		return __real_open(path, flags, 0);
+
+	mock.open = true;
+
+	return MOCK_SPIDEV_FD;
+}
+
+int __wrap_close(int fd)
+{
+	if (fd != MOCK_SPIDEV_FD)
+		return __real_close(fd);
+
+	mock.open = false;
+
+	return 0;
+}
+
+static int mock_message(struct spi_ioc_transfer *tr, uint32_t n)
+{
+	uint32_t i;
+	int len = 0;
+
+	if (mock.fail || mock.nb_ioctls == MOCK_MAX_IOCTLS ||
+	    mock.nb_tr + n > MOCK_MAX_TRANSFERS) {
+		errno = EIO;
+		return -1;
+	}
+
+	mock.ioctl_len[mock.nb_ioctls++] = n;
+	for (i = 0; i < n; i++) {
+		mock.tr[mock.nb_tr++] = tr[i];
+		if (tr[i].rx_buf && tr[i].tx_buf)
+			memmove((void *)(uintptr_t)tr[i].rx_buf,
+				(void *)(uintptr_t)tr[i].tx_buf, tr[i].len);
+		else if (tr[i].rx_buf)
+			memset((void *)(uintptr_t)tr[i].rx_buf, 0, tr[i].len);
+		len += tr[i].len;
+	}
+
+	return len;
+}
+
+int __wrap_ioctl(int fd, unsigned long request, ...)
+{
+	va_list args;
+	void *arg;
+
+	va_start(args, request);
+	arg = va_arg(args, void *);
+	va_end(args);
+
+	if (fd != MOCK_SPIDEV_FD)
+		return __real_ioctl(fd, request, arg);
+
+	switch (request) {
+	case SPI_IOC_WR_MODE:
+		mock.mode = *(uint8_t *)arg;
+		return 0;
+	case SPI_IOC_WR_BITS_PER_WORD:
+		return *(uint8_t *)arg == 8 ? 0 : -1;
+	case SPI_IOC_WR_MAX_SPEED_HZ:
+		mock.max_speed_hz = *(uint32_t *)arg;
+		return 0;
+	default:
+		if (_IOC_TYPE(request) != SPI_IOC_MAGIC || _IOC_NR(request) != 0 ||
+		    _IOC_SIZE(request) % sizeof(struct spi_ioc_transfer)) {
+			errno = EINVAL;
+			return -1;
+		}
+		return mock_message(arg, _IOC_SIZE(request) /
+				    sizeof(struct spi_ioc_transfer));
+	}
+}
+
+static struct spi_desc *test_spi_open(void)
+{
+	struct spi_init_param param = {
+		.device_id = 0,
+		.chip_select = 1,
+		.max_speed_hz = 10000000,
+		.mode = SPI_MODE_3,
+		.platform_ops = &linux_spi_platform_ops,
+	};
+	struct spi_desc *desc;
+
+	memset(&mock, 0, sizeof(mock));
+	TEST_ASSERT_EQUAL(spi_init(&desc, &param), SUCCESS);
+	TEST_ASSERT(mock.open);
+	TEST_ASSERT_EQUAL(mock.mode, SPI_MODE_3);
+	TEST_ASSERT_EQUAL(mock.max_speed_hz, 10000000);
+
+	return desc;
+}
+
+static void test_spi_close(struct spi_desc *desc)
+{
+	TEST_ASSERT_EQUAL(spi_remove(desc), SUCCESS);
+	TEST_ASSERT(!mock.open);
+}
+
+/* spi_write_and_read() is one full duplex transfer */
+static void test_spi_write_and_read(void)
+{
+	struct spi_desc *desc = test_spi_open();
+	uint8_t data[3] = {0x80, 0x12, 0x34};
+
+	TEST_ASSERT_EQUAL(spi_write_and_read(desc, data, 3), SUCCESS);
+	TEST_ASSERT_EQUAL(mock.nb_ioctls, 1);
+	TEST_ASSERT_EQUAL(mock.ioctl_len[0], 1);
+	TEST_ASSERT_EQUAL(mock.tr[0].len, 3);
+	TEST_ASSERT_EQUAL(mock.tr[0].tx_buf, (uintptr_t)data);
+	TEST_ASSERT_EQUAL(mock.tr[0].rx_buf, (uintptr_t)data);
+
+	/* A single byte transfer is not an error */
+	TEST_ASSERT_EQUAL(spi_write_and_read(desc, data, 1), SUCCESS);
+
+	mock.fail = true;
+	TEST_ASSERT_EQUAL(spi_write_and_read(desc, data, 3), FAILURE);
+
+	test_spi_close(desc);
+}
+
+/* A message array goes out in ioctls of up to 64 transfers */
+static void test_spi_transfer_batches(void)
+{
+	struct spi_desc *desc = test_spi_open();
+	uint8_t tx[130][2], rx[130][2];
+	struct spi_msg msgs[130];
+	uint32_t i;
+
+	memset(msgs, 0, sizeof(msgs));
+	for (i = 0; i < 130; i++) {
+		tx[i][0] = i;
+		tx[i][1] = ~i;
+		msgs[i].tx_buff = tx[i];
+		msgs[i].rx_buff = rx[i];
+		msgs[i].bytes_number = 2;
+		msgs[i].speed_hz = i & 1 ? 1000000 : 0;
+	}
+
+	TEST_ASSERT_EQUAL(spi_transfer(desc, msgs, 130), SUCCESS);
+	TEST_ASSERT_EQUAL(mock.nb_ioctls, 3);
+	TEST_ASSERT_EQUAL(mock.ioctl_len[0], 64);
+	TEST_ASSERT_EQUAL(mock.ioctl_len[1], 64);
+	TEST_ASSERT_EQUAL(mock.ioctl_len[2], 2);
+	TEST_ASSERT_EQUAL(mock.nb_tr, 130);
+
+	for (i = 0; i < 130; i++) {
+		TEST_ASSERT_EQUAL(mock.tr[i].tx_buf, (uintptr_t)tx[i]);
+		TEST_ASSERT_EQUAL(mock.tr[i].rx_buf, (uintptr_t)rx[i]);
+		TEST_ASSERT_EQUAL(mock.tr[i].len, 2);
+		TEST_ASSERT_EQUAL(mock.tr[i].bits_per_word, 8);
+		/* 0 keeps the speed set at init */
+		TEST_ASSERT_EQUAL(mock.tr[i].speed_hz, i & 1 ? 1000000 : 0);
+	}
+	TEST_ASSERT(!memcmp(tx, rx, sizeof(tx)));
+
+	test_spi_close(desc);
+}
+
+/*
+ * cs_change of spi_msg deasserts CS after the message. spidev has the same
+ * meaning inside an ioctl, but inverted on the last transfer of each ioctl.
+ */
+static void test_spi_transfer_cs_change(void)
+{
+	struct spi_desc *desc = test_spi_open();
+	struct spi_msg msgs[70];
+	uint8_t buf[70];
+	uint32_t i;
+
+	memset(msgs, 0, sizeof(msgs));
+	for (i = 0; i < 70; i++) {
+		msgs[i].tx_buff = &buf[i];
+		msgs[i].rx_buff = &buf[i];
+		msgs[i].bytes_number = 1;
+		msgs[i].cs_change = i % 3 == 0;
+	}
+
+	TEST_ASSERT_EQUAL(spi_transfer(desc, msgs, 70), SUCCESS);
+	TEST_ASSERT_EQUAL(mock.nb_ioctls, 2);
+	for (i = 0; i < 70; i++) {
+		if (i == 63 || i == 69)
+			TEST_ASSERT_EQUAL(mock.tr[i].cs_change, i % 3 != 0);
+		else
+			TEST_ASSERT_EQUAL(mock.tr[i].cs_change, i % 3 == 0);
+	}
+
+	test_spi_close(desc);
+}
+
+/* Errors stop the transfer, an empty array does nothing */
+static void test_spi_transfer_errors(void)
+{
+	struct spi_desc *desc = test_spi_open();
+	struct spi_msg msgs[100];
+	uint8_t buf[100];
+	uint32_t i;
+
+	memset(msgs, 0, sizeof(msgs));
+	for (i = 0; i < 100; i++) {
+		msgs[i].tx_buff = &buf[i];
+		msgs[i].bytes_number = 1;
+	}
+
+	TEST_ASSERT_EQUAL(spi_transfer(desc, msgs, 0), SUCCESS);
+	TEST_ASSERT_EQUAL(mock.nb_ioctls, 0);
+	TEST_ASSERT_EQUAL(spi_transfer(desc, NULL, 1), -EINVAL);
+
+	mock.fail = true;
+	TEST_ASSERT_EQUAL(spi_transfer(desc, msgs, 100), FAILURE);
+	TEST_ASSERT_EQUAL(mock.nb_ioctls, 0);
+
+	test_spi_close(desc);
+}
+
+static void test_spi_build_header(uint8_t *hdr, uint32_t addr, uint32_t count)
+{
+	(void)count;
+	hdr[0] = addr >> 8;
+	hdr[1] = addr;
+}
+
+/* Dozens of queued register writes are flushed with a single ioctl */
+static void test_spi_wr_queue(void)
+{
+	struct spi_desc *desc = test_spi_open();
+	struct spi_wr_queue_init_param param = {
+		.spi = desc,
+		.max_entries = 48,
+		.max_burst = 1,
+		.hdr_len = 2,
+		.build_header = test_spi_build_header,
+	};
+	struct spi_wr_queue *queue;
+	uint8_t *tx;
+	uint32_t i;
+
+	TEST_ASSERT_EQUAL(spi_wr_queue_init(&queue, &param), SUCCESS);
+	for (i = 0; i < 40; i++)
+		TEST_ASSERT_EQUAL(spi_wr_queue_push(queue, 0x100 + 2 * i, i),
+				  SUCCESS);
+	TEST_ASSERT_EQUAL(mock.nb_ioctls, 0);
+	TEST_ASSERT_EQUAL(spi_wr_queue_flush(queue), SUCCESS);
+
+	TEST_ASSERT_EQUAL(mock.nb_ioctls, 1);
+	TEST_ASSERT_EQUAL(mock.ioctl_len[0], 40);
+	for (i = 0; i < 40; i++) {
+		tx = (uint8_t *)(uintptr_t)mock.tr[i].tx_buf;
+		TEST_ASSERT_EQUAL(mock.tr[i].len, 3);
+		TEST_ASSERT_EQUAL(tx[0], 0x01);
+		TEST_ASSERT_EQUAL(tx[1], 2 * i);
+		TEST_ASSERT_EQUAL(tx[2], i);
+		/* CS goes up between the writes, and after the last one */
+		TEST_ASSERT_EQUAL(mock.tr[i].cs_change, i != 39);
+	}
+
+	TEST_ASSERT_EQUAL(spi_wr_queue_remove(queue), SUCCESS);
+	test_spi_close(desc);
+}
+
+int main(void)
+{
+	TEST_RUN(test_spi_write_and_read);
+	TEST_RUN(test_spi_transfer_batches);
+	TEST_RUN(test_spi_transfer_cs_change);
+	TEST_RUN(test_spi_transfer_errors);
+	TEST_RUN(test_spi_wr_queue);
+
+	return 0;
+}
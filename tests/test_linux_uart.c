@@ -0,0 +1,193 @@
+/***************************************************************************//**
+ *   @file   test_linux_uart.c
+ *   @brief  Unit tests of the Linux UART driver, looped back through a pty.
+********************************************************************************
+ * Copyright 2021(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#define _GNU_SOURCE
+#include <fcntl.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "error.h"
+#include "uart.h"
+#include "linux_uart.h"
+#include "test.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+#define TEST_UART_TIMEOUT_MS	100
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+/* Master side of the pty, the driver opens the slave */
+static int test_uart_master;
+
+/******************************************************************************/
+/************************** Functions Implementation **************************/
+/******************************************************************************/
+static struct uart_desc *test_uart_open(void)
+{
+	struct linux_uart_init_param linux_param = {
+		.read_timeout_ms = TEST_UART_TIMEOUT_MS,
+		.write_timeout_ms = TEST_UART_TIMEOUT_MS,
+	};
+	struct uart_init_param param = {
+		.baud_rate = 115200,
+		.size = UART_CS_8,
+		.parity = UART_PAR_NO,
+		.stop = UART_STOP_1,
+		.extra = &linux_param,
+	};
+	struct uart_desc *desc;
+
+	test_uart_master = posix_openpt(O_RDWR | O_NOCTTY);
+	TEST_ASSERT(test_uart_master >= 0);
+	TEST_ASSERT(!grantpt(test_uart_master) && !unlockpt(test_uart_master));
+
+	/* ptsname() is /dev/pts/N, the driver adds /dev/ */
+	linux_param.device_id = ptsname(test_uart_master) + strlen("/dev/");
+	TEST_ASSERT_EQUAL(uart_init(&desc, &param), SUCCESS);
+
+	return desc;
+}
+
+static void test_uart_close(struct uart_desc *desc)
+{
+	uart_remove(desc);
+	close(test_uart_master);
+}
+
+static uint32_t test_uart_elapsed_ms(const struct timespec *start)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return (now.tv_sec - start->tv_sec) * 1000 +
+	       (now.tv_nsec - start->tv_nsec) / 1000000;
+}
+
+/* Bytes written to the master come out of uart_read(), small and large */
+static void test_uart_read(void)
+{
+	struct uart_desc *desc = test_uart_open();
+	uint8_t tx[1000], rx[1000];
+	uint32_t i;
+
+	for (i = 0; i < sizeof(tx); i++)
+		tx[i] = i * 7;
+	TEST_ASSERT_EQUAL(write(test_uart_master, tx, sizeof(tx)), sizeof(tx));
+
+	/* Byte reads served from the receive buffer, then a large read */
+	for (i = 0; i < 10; i++)
+		TEST_ASSERT_EQUAL(uart_read(desc, &rx[i], 1), SUCCESS);
+	TEST_ASSERT_EQUAL(uart_read(desc, &rx[10], sizeof(rx) - 10), SUCCESS);
+	TEST_ASSERT(!memcmp(tx, rx, sizeof(tx)));
+
+	test_uart_close(desc);
+}
+
+/* uart_write() reaches the master */
+static void test_uart_write(void)
+{
+	struct uart_desc *desc = test_uart_open();
+	const uint8_t tx[] = "loopback";
+	uint8_t rx[sizeof(tx)];
+	ssize_t ret;
+	size_t n = 0;
+
+	TEST_ASSERT_EQUAL(uart_write(desc, tx, sizeof(tx)), SUCCESS);
+	while (n < sizeof(rx)) {
+		ret = read(test_uart_master, rx + n, sizeof(rx) - n);
+		TEST_ASSERT(ret > 0);
+		n += ret;
+	}
+	TEST_ASSERT(!memcmp(tx, rx, sizeof(tx)));
+
+	test_uart_close(desc);
+}
+
+/* A read that only gets part of its bytes still returns on time */
+static void test_uart_read_timeout(void)
+{
+	struct uart_desc *desc = test_uart_open();
+	struct timespec start;
+	uint8_t rx[16];
+	uint32_t ms;
+
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	TEST_ASSERT_EQUAL(uart_read(desc, rx, 1), -ETIMEDOUT);
+	ms = test_uart_elapsed_ms(&start);
+	TEST_ASSERT(ms >= TEST_UART_TIMEOUT_MS - 1 &&
+		    ms < 2 * TEST_UART_TIMEOUT_MS);
+
+	TEST_ASSERT_EQUAL(write(test_uart_master, "abc", 3), 3);
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	TEST_ASSERT_EQUAL(uart_read(desc, rx, sizeof(rx)), -ETIMEDOUT);
+	ms = test_uart_elapsed_ms(&start);
+	TEST_ASSERT(ms >= TEST_UART_TIMEOUT_MS - 1 &&
+		    ms < 2 * TEST_UART_TIMEOUT_MS);
+
+	test_uart_close(desc);
+}
+
+/* Once the other side is gone, reads fail instead of waiting */
+static void test_uart_hangup(void)
+{
+	struct uart_desc *desc = test_uart_open();
+	uint8_t rx;
+
+	close(test_uart_master);
+	TEST_ASSERT(uart_read(desc, &rx, 1) < 0);
+
+	uart_remove(desc);
+}
+
+int main(void)
+{
+	TEST_RUN(test_uart_read);
+	TEST_RUN(test_uart_write);
+	TEST_RUN(test_uart_read_timeout);
+	TEST_RUN(test_uart_hangup);
+
+	return 0;
+}
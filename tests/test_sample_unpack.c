@@ -0,0 +1,251 @@
+/***************************************************************************//**
+ *   @file   test_sample_unpack.c
+ *   @brief  Unit tests and throughput of the sample unpack helpers.
+********************************************************************************
+ * Copyright 2021(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdint.h>
+#include <time.h>
+#include "sample_unpack.h"
+#include "error.h"
+#include "util.h"
+#include "test.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+#define TEST_UNPACK_MAX_SAMPLES	4096
+
+/* Samples unpacked by each throughput measurement */
+#define TEST_UNPACK_BENCH_SAMPLES	(16 * 1024 * 1024)
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+static uint8_t test_src[TEST_UNPACK_MAX_SAMPLES * 4];
+static uint32_t test_dst[TEST_UNPACK_MAX_SAMPLES];
+static uint32_t test_ref[TEST_UNPACK_MAX_SAMPLES];
+
+/* Keeps the measured computations from being optimized out */
+static volatile uint32_t test_unpack_sink;
+
+/******************************************************************************/
+/************************** Functions Implementation **************************/
+/******************************************************************************/
+/* Reference unpacker, one bit at a time */
+static void test_unpack_bitwise(const uint8_t *src, uint32_t nb_samples,
+				uint8_t bits, uint32_t *dst)
+{
+	uint32_t i, pos = 0;
+	uint8_t b;
+
+	for (i = 0; i < nb_samples; i++) {
+		dst[i] = 0;
+		for (b = 0; b < bits; b++, pos++)
+			dst[i] = (dst[i] << 1) |
+				 ((src[pos / 8] >> (7 - pos % 8)) & 1);
+	}
+}
+
+/* The per sample loops ad7606 used before sample_unpack_be() */
+static void test_unpack_per_sample(const uint8_t *src, uint32_t nb_samples,
+				   uint8_t bits, uint32_t *dst)
+{
+	uint32_t i, j;
+
+	switch (bits) {
+	case 16:
+		for (i = 0; i < nb_samples; i++) {
+			dst[i] = (uint32_t)src[i * 2] << 8;
+			dst[i] |= (uint32_t)src[i * 2 + 1];
+		}
+		break;
+	case 24:
+		for (i = 0; i < nb_samples; i++) {
+			dst[i] = (uint32_t)src[i * 3] << 16;
+			dst[i] |= (uint32_t)src[i * 3 + 1] << 8;
+			dst[i] |= (uint32_t)src[i * 3 + 2];
+		}
+		break;
+	case 18:
+		for (i = 0; i < nb_samples / 4 * 9; i += 9) {
+			j = 4 * (i / 9);
+			dst[j + 0] = ((uint32_t)src[i + 0] << 10) |
+				     ((uint32_t)src[i + 1] << 2) | (src[i + 2] >> 6);
+			dst[j + 1] = ((uint32_t)(src[i + 2] & 0x3f) << 12) |
+				     ((uint32_t)src[i + 3] << 4) | (src[i + 4] >> 4);
+			dst[j + 2] = ((uint32_t)(src[i + 4] & 0x0f) << 14) |
+				     ((uint32_t)src[i + 5] << 6) | (src[i + 6] >> 2);
+			dst[j + 3] = ((uint32_t)(src[i + 6] & 0x03) << 16) |
+				     ((uint32_t)src[i + 7] << 8) | src[i + 8];
+		}
+		break;
+	case 26:
+		for (i = 0; i < nb_samples / 4 * 13; i += 13) {
+			j = 4 * (i / 13);
+			dst[j + 0] = ((uint32_t)src[i + 0] << 18) |
+				     ((uint32_t)src[i + 1] << 10) |
+				     ((uint32_t)src[i + 2] << 2) | (src[i + 3] >> 6);
+			dst[j + 1] = ((uint32_t)(src[i + 3] & 0x3f) << 20) |
+				     ((uint32_t)src[i + 4] << 12) |
+				     ((uint32_t)src[i + 5] << 4) | (src[i + 6] >> 4);
+			dst[j + 2] = ((uint32_t)(src[i + 6] & 0x0f) << 22) |
+				     ((uint32_t)src[i + 7] << 14) |
+				     ((uint32_t)src[i + 8] << 6) | (src[i + 9] >> 2);
+			dst[j + 3] = ((uint32_t)(src[i + 9] & 0x03) << 24) |
+				     ((uint32_t)src[i + 10] << 16) |
+				     ((uint32_t)src[i + 11] << 8) | src[i + 12];
+		}
+		break;
+	default:
+		/* 12 bits had no driver code, a sample at a time */
+		for (i = 0; i < nb_samples; i++) {
+			j = i * bits / 8;
+			dst[i] = (((uint32_t)src[j] << 8 | src[j + 1]) >>
+				  (4 - i * bits % 8)) & 0xfff;
+		}
+		break;
+	}
+}
+
+static void test_unpack_fill(void)
+{
+	uint32_t seed = 0x12345678;
+	size_t i;
+
+	for (i = 0; i < ARRAY_SIZE(test_src); i++) {
+		seed = seed * 1103515245 + 12345;
+		test_src[i] = seed >> 16;
+	}
+}
+
+/* Every width, every length around the vector and unrolled group sizes */
+static void test_unpack_widths(void)
+{
+	uint32_t n, i;
+	uint8_t bits;
+
+	for (bits = 1; bits <= 32; bits++) {
+		for (n = 0; n < 80; n++) {
+			/* Canary after the last sample */
+			test_dst[n] = 0xdeadbeef;
+			TEST_ASSERT_EQUAL(sample_unpack_be(test_src, n, bits,
+							   test_dst), SUCCESS);
+			test_unpack_bitwise(test_src, n, bits, test_ref);
+			for (i = 0; i < n; i++)
+				TEST_ASSERT_EQUAL(test_dst[i], test_ref[i]);
+			TEST_ASSERT_EQUAL(test_dst[n], 0xdeadbeef);
+		}
+	}
+
+	TEST_ASSERT_EQUAL(sample_unpack_be(test_src, 1, 0, test_dst), -EINVAL);
+	TEST_ASSERT_EQUAL(sample_unpack_be(test_src, 1, 33, test_dst), -EINVAL);
+}
+
+/* The old per sample loops give the same samples, so the benchmark is fair */
+static void test_unpack_per_sample_ref(void)
+{
+	static const uint8_t widths[] = { 12, 16, 18, 24, 26 };
+	uint32_t i, w;
+
+	for (w = 0; w < ARRAY_SIZE(widths); w++) {
+		test_unpack_per_sample(test_src, 64, widths[w], test_dst);
+		test_unpack_bitwise(test_src, 64, widths[w], test_ref);
+		for (i = 0; i < 64; i++)
+			TEST_ASSERT_EQUAL(test_dst[i], test_ref[i]);
+	}
+}
+
+static double test_unpack_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Msamples/s of unpacking blocks of nb_samples */
+static double test_unpack_bench(bool per_sample, uint32_t nb_samples,
+				uint8_t bits)
+{
+	uint32_t n = TEST_UNPACK_BENCH_SAMPLES / nb_samples;
+	uint32_t sum = 0;
+	double t;
+
+	t = test_unpack_now();
+	while (n--) {
+		if (per_sample)
+			test_unpack_per_sample(test_src, nb_samples, bits,
+					       test_dst);
+		else
+			sample_unpack_be(test_src, nb_samples, bits, test_dst);
+		sum += test_dst[n % nb_samples];
+	}
+	t = test_unpack_now() - t;
+	test_unpack_sink = sum;
+
+	return (double)TEST_UNPACK_BENCH_SAMPLES / nb_samples * nb_samples /
+	       t / 1e6;
+}
+
+/* Not a pass/fail check: the numbers depend on the host */
+static void test_unpack_throughput(void)
+{
+	static const uint8_t widths[] = { 12, 16, 18, 24, 26 };
+	static const uint32_t lens[] = { 8, 4096 };
+	uint32_t w, l;
+
+	printf("Msamples/s       per sample  sample_unpack_be\n");
+	for (w = 0; w < ARRAY_SIZE(widths); w++)
+		for (l = 0; l < ARRAY_SIZE(lens); l++)
+			printf("%2u bits x %4u %11.1f %17.1f\n", widths[w],
+			       lens[l], test_unpack_bench(true, lens[l], widths[w]),
+			       test_unpack_bench(false, lens[l], widths[w]));
+}
+
+int main(void)
+{
+	test_unpack_fill();
+
+	TEST_RUN(test_unpack_widths);
+	TEST_RUN(test_unpack_per_sample_ref);
+	TEST_RUN(test_unpack_throughput);
+
+	return 0;
+}
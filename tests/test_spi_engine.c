@@ -0,0 +1,401 @@
+/***************************************************************************//**
+ *   @file   test_spi_engine.c
+ *   @brief  Unit tests of the SPI Engine program compiler.
+********************************************************************************
+ * Copyright 2021(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <string.h>
+#include "error.h"
+#include "axi_io.h"
+#include "axi_dmac.h"
+#include "delay.h"
+#include "spi_engine.h"
+#include "test.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+#define TEST_ENGINE_BASE	0x44a00000
+
+/* 100 MHz reference and 10 MHz SCLK, a prescaler of 4 */
+#define TEST_REF_CLK_HZ		100000000
+#define TEST_SPEED_HZ		10000000
+#define TEST_CLK_DIV		4
+#define TEST_CS_DELAY		1
+#define TEST_CHIP_SELECT	2
+
+/* Instructions of the program header */
+#define TEST_HEADER(width)						\
+	SPI_ENGINE_CMD_CONFIG(SPI_ENGINE_CMD_REG_CONFIG, SPI_MODE_3),	\
+	SPI_ENGINE_CMD_CONFIG(SPI_ENGINE_CMD_DATA_TRANSFER_LEN, width),	\
+	SPI_ENGINE_CMD_CONFIG(SPI_ENGINE_CMD_REG_CLK_DIV, TEST_CLK_DIV)
+
+#define TEST_CS_ASSERT							\
+	SPI_ENGINE_CMD_ASSERT(TEST_CS_DELAY, 0xff ^ BIT(TEST_CHIP_SELECT))
+#define TEST_CS_DEASSERT	SPI_ENGINE_CMD_ASSERT(TEST_CS_DELAY, 0xff)
+
+#define MOCK_MAX_WRITES		256
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+/*
+ * The registers of the engine and the DMACs are mocked. The engine shifts the
+ * SDO words back on SDI, completes a program as soon as its SYNC instruction
+ * is written and the DMACs complete their transfers at once.
+ */
+static struct {
+	/* Writes to the command FIFO and to the offload memories */
+	uint32_t cmd[MOCK_MAX_WRITES];
+	uint32_t nb_cmd;
+	uint32_t sdo[MOCK_MAX_WRITES];
+	uint32_t nb_sdo;
+	uint32_t sdi_next;
+	uint32_t sync_id;
+	uint32_t offload_ctrl;
+	/* Last DMA transfer */
+	uint32_t dma_addr;
+	uint32_t dma_size;
+	bool dma_eot;
+	/* Allocations, see the Makefile */
+	uint32_t nb_allocs;
+} mock;
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t nmemb, size_t size);
+
+/******************************************************************************/
+/************************** Functions Implementation **************************/
+/******************************************************************************/
+void *__wrap_malloc(size_t size)
+{
+	mock.nb_allocs++;
+
+	return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t nmemb, size_t size)
+{
+	mock.nb_allocs++;
+
+	return __real_calloc(nmemb, size);
+}
+
+int32_t axi_io_write(uint32_t base, uint32_t offset, uint32_t data)
+{
+	TEST_ASSERT_EQUAL(base, TEST_ENGINE_BASE);
+
+	switch (offset) {
+	case SPI_ENGINE_REG_CMD_FIFO:
+	case SPI_ENGINE_REG_OFFLOAD_CMD_MEM(0):
+		TEST_ASSERT(mock.nb_cmd < MOCK_MAX_WRITES);
+		mock.cmd[mock.nb_cmd++] = data;
+		if ((data & 0xff00) == SPI_ENGINE_CMD_SYNC(0))
+			mock.sync_id = data & 0xff;
+		break;
+	case SPI_ENGINE_REG_SDO_DATA_FIFO:
+	case SPI_ENGINE_REG_OFFLOAD_SDO_MEM(0):
+		TEST_ASSERT(mock.nb_sdo < MOCK_MAX_WRITES);
+		mock.sdo[mock.nb_sdo++] = data;
+		break;
+	case SPI_ENGINE_REG_OFFLOAD_CTRL(0):
+		mock.offload_ctrl = data;
+		break;
+	}
+
+	return SUCCESS;
+}
+
+int32_t axi_io_read(uint32_t base, uint32_t offset, uint32_t *data)
+{
+	TEST_ASSERT_EQUAL(base, TEST_ENGINE_BASE);
+
+	switch (offset) {
+	case SPI_ENGINE_REG_DATA_WIDTH:
+		*data = 32;
+		break;
+	case SPI_ENGINE_REG_SYNC_ID:
+		*data = mock.sync_id;
+		break;
+	case SPI_ENGINE_REG_SDI_DATA_FIFO:
+		TEST_ASSERT(mock.sdi_next < mock.nb_sdo);
+		*data = mock.sdo[mock.sdi_next++];
+		break;
+	default:
+		*data = 0;
+		break;
+	}
+
+	return SUCCESS;
+}
+
+void udelay(uint32_t usecs)
+{
+}
+
+int32_t axi_dmac_init(struct axi_dmac **dmac,
+		      const struct axi_dmac_init *init)
+{
+	*dmac = __real_calloc(1, sizeof(**dmac));
+	TEST_ASSERT(*dmac);
+	(*dmac)->base = init->base;
+	(*dmac)->direction = init->direction;
+	(*dmac)->flags = init->flags;
+
+	return SUCCESS;
+}
+
+int32_t axi_dmac_remove(struct axi_dmac *dmac)
+{
+	free(dmac);
+
+	return SUCCESS;
+}
+
+int32_t axi_dmac_transfer(struct axi_dmac *dmac, uint32_t address,
+			  uint32_t size)
+{
+	mock.dma_addr = address;
+	mock.dma_size = size;
+
+	return SUCCESS;
+}
+
+int32_t axi_dmac_read(struct axi_dmac *dmac, uint32_t reg_addr,
+		      uint32_t *reg_data)
+{
+	TEST_ASSERT_EQUAL(reg_addr, AXI_DMAC_REG_IRQ_PENDING);
+	*reg_data = mock.dma_eot ? AXI_DMAC_IRQ_EOT : 0;
+
+	return SUCCESS;
+}
+
+static struct spi_desc *test_engine_init(uint8_t data_width)
+{
+	struct spi_engine_init_param engine_param = {
+		.ref_clk_hz = TEST_REF_CLK_HZ,
+		.type = SPI_ENGINE,
+		.spi_engine_baseaddr = TEST_ENGINE_BASE,
+		.cs_delay = TEST_CS_DELAY,
+		.data_width = data_width,
+	};
+	struct spi_init_param param = {
+		.max_speed_hz = TEST_SPEED_HZ,
+		.chip_select = TEST_CHIP_SELECT,
+		.mode = SPI_MODE_3,
+		.platform_ops = &spi_eng_platform_ops,
+		.extra = &engine_param,
+	};
+	struct spi_desc *desc;
+
+	TEST_ASSERT_EQUAL(spi_init(&desc, &param), SUCCESS);
+	memset(&mock, 0, sizeof(mock));
+
+	return desc;
+}
+
+/* The commands are translated into the engine instructions, once */
+static void test_engine_compile(void)
+{
+	struct spi_desc *desc = test_engine_init(16);
+	const uint32_t commands[] = {
+		CS_LOW, WRITE(2), READ(3), WRITE_READ(4), CS_HIGH
+	};
+	const uint32_t expected[] = {
+		TEST_HEADER(16),
+		TEST_CS_ASSERT,
+		SPI_ENGINE_CMD_TRANSFER(SPI_ENGINE_INSTRUCTION_TRANSFER_W, 0),
+		SPI_ENGINE_CMD_TRANSFER(SPI_ENGINE_INSTRUCTION_TRANSFER_R, 1),
+		SPI_ENGINE_CMD_TRANSFER(SPI_ENGINE_INSTRUCTION_TRANSFER_RW, 1),
+		TEST_CS_DEASSERT,
+	};
+	const uint32_t invalid[] = {CS_LOW, 0x4000, CS_HIGH};
+	struct spi_engine_program *prog;
+
+	TEST_ASSERT_EQUAL(spi_engine_program_init(&prog, desc, commands,
+			  ARRAY_SIZE(commands)), SUCCESS);
+	TEST_ASSERT_EQUAL(prog->no_cmds, ARRAY_SIZE(expected));
+	TEST_ASSERT(!memcmp(prog->cmds, expected, sizeof(expected)));
+
+	/* 16-bit words, 1 + 2 + 2 of them */
+	TEST_ASSERT_EQUAL(prog->no_words, 5);
+	TEST_ASSERT_EQUAL(prog->no_sdo_words, 3);
+	TEST_ASSERT_EQUAL(prog->no_sdi_words, 4);
+
+	/* Nothing is sent to the engine when compiling */
+	TEST_ASSERT_EQUAL(mock.nb_cmd, 0);
+	TEST_ASSERT_EQUAL(spi_engine_program_remove(prog), SUCCESS);
+
+	TEST_ASSERT_EQUAL(spi_engine_program_init(&prog, desc, invalid,
+			  ARRAY_SIZE(invalid)), -EINVAL);
+
+	TEST_ASSERT_EQUAL(spi_remove(desc), SUCCESS);
+}
+
+/* A compiled program is replayed through the FIFOs without allocating */
+static void test_engine_program_transfer(void)
+{
+	struct spi_desc *desc = test_engine_init(32);
+	const uint32_t commands[] = {CS_LOW, WRITE_READ(8), CS_HIGH};
+	const uint32_t tx[2] = {0x01020304, 0x05060708};
+	struct spi_engine_program *prog;
+	uint32_t rx[2], sync_id, run;
+
+	TEST_ASSERT_EQUAL(spi_engine_program_init(&prog, desc, commands,
+			  ARRAY_SIZE(commands)), SUCCESS);
+
+	mock.nb_allocs = 0;
+	for (run = 0; run < 2; run++) {
+		mock.nb_cmd = 0;
+		mock.nb_sdo = 0;
+		mock.sdi_next = 0;
+		memset(rx, 0, sizeof(rx));
+		TEST_ASSERT_EQUAL(spi_engine_program_transfer(desc, prog, tx, rx),
+				  SUCCESS);
+
+		/* The program, then a new SYNC id at each run */
+		TEST_ASSERT_EQUAL(mock.nb_cmd, prog->no_cmds + 1);
+		TEST_ASSERT(!memcmp(mock.cmd, prog->cmds,
+				    prog->no_cmds * sizeof(*prog->cmds)));
+		if (run)
+			TEST_ASSERT_EQUAL(mock.sync_id, (sync_id + 1) & 0xff);
+		sync_id = mock.sync_id;
+
+		TEST_ASSERT_EQUAL(mock.nb_sdo, 2);
+		TEST_ASSERT(!memcmp(rx, tx, sizeof(tx)));
+	}
+	TEST_ASSERT_EQUAL(mock.nb_allocs, 0);
+
+	TEST_ASSERT_EQUAL(spi_engine_program_transfer(desc, prog, NULL, rx),
+			  -EINVAL);
+	TEST_ASSERT_EQUAL(spi_engine_program_remove(prog), SUCCESS);
+	TEST_ASSERT_EQUAL(spi_remove(desc), SUCCESS);
+}
+
+/* spi_write_and_read() packs the bytes in words, msb first */
+static void test_engine_write_and_read(void)
+{
+	struct spi_desc *desc = test_engine_init(16);
+	const uint32_t expected[] = {
+		TEST_HEADER(16),
+		TEST_CS_DEASSERT,
+		TEST_CS_ASSERT,
+		SPI_ENGINE_CMD_TRANSFER(SPI_ENGINE_INSTRUCTION_TRANSFER_RW, 1),
+		TEST_CS_DEASSERT,
+	};
+	uint8_t data[300] = {0x12, 0x34, 0x56};
+
+	mock.nb_allocs = 0;
+	TEST_ASSERT_EQUAL(spi_write_and_read(desc, data, 3), SUCCESS);
+	TEST_ASSERT_EQUAL(mock.nb_allocs, 0);
+
+	/* Followed by the SYNC instruction */
+	TEST_ASSERT_EQUAL(mock.nb_cmd, ARRAY_SIZE(expected) + 1);
+	TEST_ASSERT(!memcmp(mock.cmd, expected, sizeof(expected)));
+	TEST_ASSERT_EQUAL(mock.cmd[ARRAY_SIZE(expected)],
+			  SPI_ENGINE_CMD_SYNC(mock.sync_id));
+	TEST_ASSERT_EQUAL(mock.nb_sdo, 2);
+	TEST_ASSERT_EQUAL(mock.sdo[0], 0x1234);
+	TEST_ASSERT_EQUAL(mock.sdo[1], 0x5600);
+	TEST_ASSERT_EQUAL(data[0], 0x12);
+	TEST_ASSERT_EQUAL(data[1], 0x34);
+	TEST_ASSERT_EQUAL(data[2], 0x56);
+
+	/* The length of a transfer instruction is 8 bits */
+	TEST_ASSERT_EQUAL(spi_write_and_read(desc, data, sizeof(data)),
+			  -EINVAL);
+
+	TEST_ASSERT_EQUAL(spi_remove(desc), SUCCESS);
+}
+
+/* In offload mode, only the SDO words are loaded and the DMA is waited for */
+static void test_engine_offload(void)
+{
+	struct spi_desc *desc = test_engine_init(32);
+	struct spi_engine_offload_init_param offload = {
+		.rx_dma_baseaddr = 0x44a30000,
+		.offload_config = OFFLOAD_RX_EN,
+	};
+	const uint32_t commands[] = {CS_LOW, WRITE(4), READ(8), CS_HIGH};
+	uint32_t commands_data[] = {0xa5a5a5a5};
+	uint32_t too_long[SPI_ENGINE_PROGRAM_MAX_LEN] = {0};
+	struct spi_engine_offload_message msg = {
+		.commands = too_long,
+		.no_commands = ARRAY_SIZE(too_long),
+	};
+	struct spi_engine_program *prog;
+
+	TEST_ASSERT_EQUAL(spi_engine_offload_init(desc, &offload), SUCCESS);
+	TEST_ASSERT_EQUAL(spi_engine_program_init(&prog, desc, commands,
+			  ARRAY_SIZE(commands)), SUCCESS);
+
+	/* Cyclic by default, the end of the first period is waited for */
+	mock.nb_allocs = 0;
+	mock.dma_eot = true;
+	TEST_ASSERT_EQUAL(spi_engine_offload_program_transfer(desc, prog,
+			  commands_data, 0, 0x100000, 16), SUCCESS);
+	TEST_ASSERT_EQUAL(mock.nb_allocs, 0);
+	TEST_ASSERT_EQUAL(mock.nb_cmd, prog->no_cmds + 1);
+	TEST_ASSERT(!memcmp(mock.cmd, prog->cmds,
+			    prog->no_cmds * sizeof(*prog->cmds)));
+	TEST_ASSERT_EQUAL(mock.nb_sdo, 1);
+	TEST_ASSERT_EQUAL(mock.sdo[0], 0xa5a5a5a5);
+	TEST_ASSERT_EQUAL(mock.offload_ctrl, 1);
+	TEST_ASSERT_EQUAL(mock.dma_addr, 0x100000);
+	TEST_ASSERT_EQUAL(mock.dma_size, 4 * 3 * 16);
+
+	/* No fixed sleep, a transfer that never ends times out */
+	mock.dma_eot = false;
+	TEST_ASSERT_EQUAL(spi_engine_offload_program_transfer(desc, prog,
+			  commands_data, 0, 0x100000, 16), -ETIMEDOUT);
+
+	TEST_ASSERT_EQUAL(spi_engine_offload_transfer(desc, msg, 1), -EINVAL);
+
+	TEST_ASSERT_EQUAL(spi_engine_program_remove(prog), SUCCESS);
+	TEST_ASSERT_EQUAL(spi_remove(desc), SUCCESS);
+}
+
+int main(void)
+{
+	TEST_RUN(test_engine_compile);
+	TEST_RUN(test_engine_program_transfer);
+	TEST_RUN(test_engine_write_and_read);
+	TEST_RUN(test_engine_offload);
+
+	return 0;
+}
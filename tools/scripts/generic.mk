@@ -208,6 +208,17 @@ ifeq (y,$(strip $(ENABLE_IIO_NETWORK)))
 CFLAGS += -DENABLE_IIO_NETWORK
 endif
 
+ifeq (y,$(strip $(ENABLE_IIO_THREADS)))
+CFLAGS += -DENABLE_IIO_THREADS -pthread
+LDFLAGS += -pthread
+endif
+
+# Prebuilt context xml source, generated with tools/scripts/iio_xml2c.py
+ifneq (,$(strip $(IIO_CONTEXT_XML)))
+CFLAGS += -DIIO_CONTEXT_XML
+SRCS += $(IIO_CONTEXT_XML)
+endif
+
 ifeq (y,$(strip $(DISABLE_SECURE_SOCKET)))
 CFLAGS += -DDISABLE_SECURE_SOCKET
 endif
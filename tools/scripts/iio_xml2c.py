@@ -0,0 +1,115 @@
+#!/bin/python
+
+import argparse
+import re
+import socket
+import sys
+
+description_help='''Generate a C source holding a prebuilt IIO context xml
+The generated arrays are meant to be passed as iio_init_param.xml and
+iio_init_param.xml_size, so the target serves the context as is instead of
+building it from the registered devices at startup.
+Examples:\n
+	Capture the context from a target running the IIO network backend
+	>python iio_xml2c.py -host 192.168.1.10 -o src/iio_context_xml.c
+	Convert a context saved with iio_genxml or a previous capture
+	>python iio_xml2c.py -xml context.xml -o src/iio_context_xml.c
+
+	Note: the devices must be registered in the same order as in the
+	captured context, since clients address them by their device id.
+'''
+
+IIOD_PORT = 30431
+
+def parse_input():
+	parser = argparse.ArgumentParser(description=description_help,\
+				formatter_class=argparse.RawTextHelpFormatter)
+	source = parser.add_mutually_exclusive_group(required=True)
+	source.add_argument('-xml', help="Path to a context xml, - for stdin")
+	source.add_argument('-host', help="Address of a target to capture the context from")
+	parser.add_argument('-port', type=int, default=IIOD_PORT, help="IIOD port of the target")
+	parser.add_argument('-name', default='iio_context_xml', help="Name of the generated array")
+	parser.add_argument('-o', dest='output', default='-', help="Generated C source, - for stdout")
+	return parser.parse_args()
+
+def read_line(sock):
+	line = b''
+	while not line.endswith(b'\n'):
+		c = sock.recv(1)
+		if not c:
+			raise IOError("Connection closed by target")
+		line += c
+	return line.strip()
+
+def capture_xml(host, port):
+	sock = socket.create_connection((host, port), timeout=10)
+	sock.sendall(b'PRINT\r\n')
+	size = int(read_line(sock))
+	if size < 0:
+		raise IOError("Target returned error %d" % size)
+	xml = b''
+	while len(xml) < size:
+		chunk = sock.recv(size - len(xml))
+		if not chunk:
+			raise IOError("Connection closed by target")
+		xml += chunk
+	sock.close()
+	return xml.decode('utf-8')
+
+def minify_xml(xml):
+	# Whitespace between elements is not part of the context
+	xml = xml.replace('\0', '').strip()
+	return re.sub(r'>\s+<', '><', xml)
+
+C_ESCAPES = {'\\': '\\\\', '"': '\\"', '?': '\\?', '\n': '\\n', '\r': '\\r',
+	     '\t': '\\t'}
+
+def c_escape(byte):
+	c = chr(byte)
+	if c in C_ESCAPES:
+		return C_ESCAPES[c]
+	if 0x20 <= byte < 0x7f:
+		return c
+	# Always 3 digits, so a following digit is not part of the escape
+	return '\\%03o' % byte
+
+def c_string_lines(data, width = 72):
+	lines = []
+	line = ''
+	for byte in bytearray(data.encode('utf-8')):
+		line += c_escape(byte)
+		if len(line) >= width:
+			lines.append('\t"%s"' % line)
+			line = ''
+	if line or not lines:
+		lines.append('\t"%s"' % line)
+	return '\n'.join(lines)
+
+def generate_c(xml, name):
+	return '''/* Generated by tools/scripts/iio_xml2c.py, do not edit. */
+#include <stdint.h>
+
+const char %s[] =
+%s;
+
+const uint32_t %s_size = sizeof(%s);
+''' % (name, c_string_lines(xml), name, name)
+
+def main():
+	args = parse_input()
+	if args.host:
+		xml = capture_xml(args.host, args.port)
+	elif args.xml == '-':
+		xml = sys.stdin.read()
+	else:
+		with open(args.xml, 'r') as f:
+			xml = f.read()
+
+	source = generate_c(minify_xml(xml), args.name)
+	if args.output == '-':
+		sys.stdout.write(source)
+	else:
+		with open(args.output, 'w') as f:
+			f.write(source)
+
+main()
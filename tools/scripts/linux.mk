@@ -8,6 +8,10 @@ PLATFORM_FULL_PATH = $1
 CFLAGS +=  -g3 \
 		-DLINUX_PLATFORM \
 
+# The platform drivers lock shared state with pthread mutexes
+CFLAGS += -pthread
+LDFLAGS += -pthread
+
 $(PROJECT_TARGET):
 	$(MUTE) $(call mk_dir, $(BUILD_DIR)) $(HIDE)
 	$(MUTE) $(call set_one_time_rule,$@)
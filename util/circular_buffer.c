@@ -42,13 +42,26 @@
 /***************************** Include Files **********************************/
 /******************************************************************************/
 
+#ifdef LINUX_PLATFORM
+#define _GNU_SOURCE
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
 #include <string.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdatomic.h>
 #include "circular_buffer.h"
 #include "error.h"
 #include "util.h"
 
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/* Padding keeping the producer and consumer data on separate cache lines */
+#define CB_CACHE_LINE_SIZE	64
+
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
@@ -58,14 +71,12 @@
  * @brief Circular buffer pointer
  */
 struct cb_ptr {
-	/** Index of data in the buffer */
-	uint32_t	idx;
-	/** Counts the number of times idx exceeds the liniar buffer */
-	uint32_t	spin_count;
+	/** Number of bytes passed through the pointer, modulo the wrap value */
+	_Atomic uint32_t	count;
 	/** Set if async transaction is active */
-	bool		async_started;
+	bool			async_started;
 	/** Number of bytes to update after an async transaction is finished */
-	uint32_t	async_size;
+	uint32_t		async_size;
 };
 
 /**
@@ -75,11 +86,17 @@ struct cb_ptr {
 struct circular_buffer {
 	/** Size of the buffer in bytes */
 	uint32_t	size;
+	/** Value where the pointer counters wrap, 0 for 2^32 */
+	uint32_t	wrap;
 	/** Address of the buffer */
 	int8_t		*buff;
-	/** Write pointer */
+	/** Set if the buffer is mapped twice, back to back */
+	bool		mirrored;
+	uint8_t		pad0[CB_CACHE_LINE_SIZE];
+	/** Write pointer, only updated by the producer */
 	struct cb_ptr	write;
-	/** Read pointer */
+	uint8_t		pad1[CB_CACHE_LINE_SIZE];
+	/** Read pointer, only updated by the consumer */
 	struct cb_ptr	read;
 };
 
@@ -87,14 +104,121 @@ struct circular_buffer {
 /************************ Functions Definitions *******************************/
 /******************************************************************************/
 
+/* Move a pointer counter forward */
+static inline uint32_t cb_advance(struct circular_buffer *desc,
+				  uint32_t count, uint32_t size)
+{
+	count += size;
+	if (desc->wrap && count >= desc->wrap)
+		count -= desc->wrap;
+
+	return count;
+}
+
+/* Move a pointer counter backward */
+static inline uint32_t cb_retreat(struct circular_buffer *desc,
+				  uint32_t count, uint32_t size)
+{
+	if (desc->wrap && count < size)
+		return count + desc->wrap - size;
+
+	return count - size;
+}
+
+/* Number of bytes between the read and the write pointer counters */
+static inline uint32_t cb_distance(struct circular_buffer *desc,
+				   uint32_t write, uint32_t read)
+{
+	if (desc->wrap && write < read)
+		return write + desc->wrap - read;
+
+	return write - read;
+}
+
+/* Convert a pointer counter to an index in the buffer */
+static inline uint32_t cb_index(struct circular_buffer *desc, uint32_t count)
+{
+	if (desc->wrap)
+		return count % desc->size;
+
+	return count & (desc->size - 1);
+}
+
+/* Describe the region of a given size starting at a pointer counter */
+static void cb_get_span(struct circular_buffer *desc, uint32_t count,
+			uint32_t size, struct cb_span *span)
+{
+	uint32_t idx = cb_index(desc, count);
+
+	span->buff[0] = desc->buff + idx;
+	span->size[0] = desc->mirrored ? size : min(size, desc->size - idx);
+	span->buff[1] = desc->buff;
+	span->size[1] = size - span->size[0];
+}
+
+#ifdef LINUX_PLATFORM
+/*
+ * Map the same memory twice, back to back, so a region crossing the end of
+ * the buffer is contiguous. The size must be a multiple of the page size.
+ */
+static int32_t cb_alloc_mirrored(struct circular_buffer *desc)
+{
+	long	page_size = sysconf(_SC_PAGESIZE);
+	int8_t	*addr;
+	int	fd;
+
+	if (page_size <= 0 || desc->size % page_size)
+		return -EINVAL;
+
+	fd = memfd_create("circular_buffer", 0);
+	if (fd < 0)
+		return -ENOMEM;
+
+	if (ftruncate(fd, desc->size))
+		goto error_fd;
+
+	addr = mmap(NULL, 2 * (size_t)desc->size, PROT_NONE,
+		    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (addr == MAP_FAILED)
+		goto error_fd;
+
+	if (mmap(addr, desc->size, PROT_READ | PROT_WRITE,
+		 MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED)
+		goto error_map;
+
+	if (mmap(addr + desc->size, desc->size, PROT_READ | PROT_WRITE,
+		 MAP_SHARED | MAP_FIXED, fd, 0) == MAP_FAILED)
+		goto error_map;
+
+	close(fd);
+	desc->buff = addr;
+	desc->mirrored = true;
+
+	return SUCCESS;
+
+error_map:
+	munmap(addr, 2 * (size_t)desc->size);
+error_fd:
+	close(fd);
+
+	return -ENOMEM;
+}
+#endif
+
 /**
  * @brief Create circular buffer structure
  *
- * @note Circular buffer implementation is thread safe for one write
- * and one reader.
+ * @note Circular buffer implementation is lock free for one writer
+ * and one reader, running concurrently (e.g. an interrupt handler and a
+ * thread).
  * If multiple writer or multiple readers access the circular buffer then
  * function that updates the structure should be called inside a critical
  * critical section.
+ * The writer never waits for the reader, data not read in time is
+ * overwritten and reported to the reader with -EOVERRUN.
+ * A power of two size avoids a division on every index computation. On Linux,
+ * a size multiple of the page size maps the buffer twice, so that all regions
+ * are contiguous.
  *
  * @param desc - Where to store the circular buffer reference
  * @param buff_size - Buffer size
@@ -105,23 +229,42 @@ struct circular_buffer {
 int32_t cb_init(struct circular_buffer **desc, uint32_t buff_size)
 {
 	struct circular_buffer	*ldesc;
+	uint32_t		nb_wraps;
 
 	if (!desc || !buff_size)
 		return -EINVAL;
 
+	/*
+	 * The counters wrap at a multiple of the size, leaving room to add one
+	 * more buffer size without overflowing.
+	 */
+	nb_wraps = 0;
+	if (buff_size & (buff_size - 1)) {
+		nb_wraps = UINT32_MAX / buff_size - 1;
+		if (nb_wraps < 2)
+			return -EINVAL;
+	}
+
 	ldesc = (struct circular_buffer*)calloc(1, sizeof(*ldesc));
 	if (!ldesc)
 		return -ENOMEM;
 
-	*desc = ldesc;
-
 	ldesc->size = buff_size;
-	ldesc->buff = calloc(1, buff_size);
+	ldesc->wrap = nb_wraps * buff_size;
+	atomic_init(&ldesc->write.count, 0);
+	atomic_init(&ldesc->read.count, 0);
+
+#ifdef LINUX_PLATFORM
+	if (cb_alloc_mirrored(ldesc) != SUCCESS)
+#endif
+		ldesc->buff = calloc(1, buff_size);
 	if (!ldesc->buff) {
 		free(ldesc);
 		return -ENOMEM;
 	}
 
+	*desc = ldesc;
+
 	return SUCCESS;
 }
 
@@ -137,8 +280,13 @@ int32_t cb_remove(struct circular_buffer *desc)
 	if (!desc)
 		return FAILURE;
 
-	if (desc->buff)
-		free(desc->buff);
+#ifdef LINUX_PLATFORM
+	if (desc->mirrored)
+		munmap(desc->buff, 2 * (size_t)desc->size);
+	else
+#endif
+		if (desc->buff)
+			free(desc->buff);
 	free(desc);
 
 	return SUCCESS;
@@ -155,23 +303,15 @@ int32_t cb_remove(struct circular_buffer *desc)
  */
 int32_t cb_size(struct circular_buffer *desc, uint32_t *size)
 {
-	uint32_t nb_spins;
+	uint32_t read, write;
 
 	if (!desc || !size)
 		return -EINVAL;
 
-	if (desc->write.spin_count > desc->read.spin_count)
-		nb_spins = desc->write.spin_count - desc->read.spin_count;
-	else
-		/* Integer overflow on desc->write.spin_count */
-		nb_spins = UINT32_MAX - desc->read.spin_count +
-			   desc->write.spin_count + 1;
-
-	if (nb_spins > 0)
-		*size = desc->size + desc->write.idx - desc->read.idx;
-	else
-		*size = desc->write.idx - desc->read.idx;
+	read = atomic_load_explicit(&desc->read.count, memory_order_acquire);
+	write = atomic_load_explicit(&desc->write.count, memory_order_acquire);
 
+	*size = cb_distance(desc, write, read);
 	if (*size > desc->size) {
 		*size = desc->size;
 		return -EOVERRUN;
@@ -180,6 +320,145 @@ int32_t cb_size(struct circular_buffer *desc, uint32_t *size)
 	return SUCCESS;
 }
 
+/**
+ * @brief Get the region where data can be written, without copying
+ *
+ * The region starts at the write pointer and may wrap around the end of the
+ * buffer, in which case it is described by two segments. Only the producer
+ * may call this function.
+ *
+ * @param desc - Circular buffer reference
+ * @param size - Number of bytes needed to write to the buffer.
+ * @param span - Region of min(size, buffer size) bytes.
+ * @return
+ *  - \ref SUCCESS   - No errors
+ *  - -EINVAL   - Wrong parameters used
+ */
+int32_t cb_peek_write(struct circular_buffer *desc, uint32_t size,
+		      struct cb_span *span)
+{
+	uint32_t write;
+
+	if (!desc || !span)
+		return -EINVAL;
+
+	write = atomic_load_explicit(&desc->write.count, memory_order_relaxed);
+	cb_get_span(desc, write, min(size, desc->size), span);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Make the data written in a region returned by cb_peek_write()
+ * available to the reader
+ * @param desc - Circular buffer reference
+ * @param size - Number of bytes written.
+ * @return
+ *  - \ref SUCCESS   - No errors
+ *  - -EINVAL   - Wrong parameters used
+ */
+int32_t cb_commit_write(struct circular_buffer *desc, uint32_t size)
+{
+	uint32_t write;
+
+	if (!desc || size > desc->size)
+		return -EINVAL;
+
+	write = atomic_load_explicit(&desc->write.count, memory_order_relaxed);
+	/* Publish the data before the new pointer */
+	atomic_store_explicit(&desc->write.count, cb_advance(desc, write, size),
+			      memory_order_release);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Get the region holding data to read, without copying
+ *
+ * The region starts at the read pointer and may wrap around the end of the
+ * buffer, in which case it is described by two segments. Only the consumer
+ * may call this function.
+ *
+ * @param desc - Circular buffer reference
+ * @param size - Number of bytes needed to read from the buffer.
+ * @param span - Region of min(size, available data) bytes.
+ * @return
+ *  - \ref SUCCESS   - No errors
+ *  - -EAGAIN   - No data available at this moment
+ *  - -EINVAL   - Wrong parameters used
+ *  - -EOVERRUN - An overrun occurred and some data have been overwritten. The
+ *		  region starts with the oldest data still in the buffer.
+ */
+int32_t cb_peek_read(struct circular_buffer *desc, uint32_t size,
+		     struct cb_span *span)
+{
+	uint32_t	read, write;
+	uint32_t	available_size;
+	int32_t		ret;
+
+	if (!desc || !span)
+		return -EINVAL;
+
+	ret = SUCCESS;
+	read = atomic_load_explicit(&desc->read.count, memory_order_relaxed);
+	/* Pairs with the release in cb_commit_write(), the data is visible */
+	write = atomic_load_explicit(&desc->write.count, memory_order_acquire);
+
+	available_size = cb_distance(desc, write, read);
+	if (available_size > desc->size) {
+		/* Skip the overwritten data */
+		read = cb_retreat(desc, write, desc->size);
+		atomic_store_explicit(&desc->read.count, read,
+				      memory_order_release);
+		available_size = desc->size;
+		ret = -EOVERRUN;
+	}
+
+	/* We can only read available data */
+	size = min(size, available_size);
+	if (!size)
+		return -EAGAIN;
+
+	cb_get_span(desc, read, size, span);
+
+	return ret;
+}
+
+/**
+ * @brief Release the data read from a region returned by cb_peek_read()
+ * @param desc - Circular buffer reference
+ * @param size - Number of bytes read.
+ * @return
+ *  - \ref SUCCESS   - No errors
+ *  - -EINVAL   - Wrong parameters used
+ *  - -EOVERRUN - The writer overwrote the region while it was read
+ */
+int32_t cb_commit_read(struct circular_buffer *desc, uint32_t size)
+{
+	uint32_t	read, write;
+	uint32_t	available_size;
+
+	if (!desc || size > desc->size)
+		return -EINVAL;
+
+	read = atomic_load_explicit(&desc->read.count, memory_order_relaxed);
+	/* Finish reading the data before checking if it was overwritten */
+	atomic_thread_fence(memory_order_acquire);
+	write = atomic_load_explicit(&desc->write.count, memory_order_relaxed);
+
+	available_size = cb_distance(desc, write, read);
+	if (size > available_size)
+		return -EINVAL;
+
+	atomic_store_explicit(&desc->read.count, cb_advance(desc, read, size),
+			      memory_order_release);
+
+	if (available_size > desc->size)
+		return -EOVERRUN;
+
+	return SUCCESS;
+}
+
 /*
  * Functionality described at cb_prepare_async_write/read having the is_read
  * parameter to specifiy if it is a read or write operation
@@ -191,13 +470,12 @@ static int32_t cb_prepare_async_operation(struct circular_buffer *desc,
 		bool is_read)
 {
 	struct cb_ptr	*ptr;
-	uint32_t	available_size;
-	uint32_t	ret;
+	struct cb_span	span;
+	int32_t		ret;
 
 	if (!desc || !buff || !raw_size_available)
 		return -EINVAL;
 
-	ret = SUCCESS;
 	/* Select if read or write index will be updated */
 	ptr = is_read ? &desc->read : &desc->write;
 
@@ -205,27 +483,18 @@ static int32_t cb_prepare_async_operation(struct circular_buffer *desc,
 	if (ptr->async_started)
 		return -EBUSY;
 
-	if (is_read) {
-		ret = cb_size(desc, &available_size);
-		if (ret == -EOVERRUN) {
-			/* Update read index */
-			desc->read.spin_count = desc->write.spin_count - 1;
-			desc->read.idx = desc->write.idx;
-		}
-
-		/* We can only read available data */
-		requested_size = min(requested_size, available_size);
-		if (!requested_size)
-			return -EAGAIN;
-	}
+	if (is_read)
+		ret = cb_peek_read(desc, requested_size, &span);
+	else
+		ret = cb_peek_write(desc, requested_size, &span);
+	if (ret != SUCCESS && ret != -EOVERRUN)
+		return ret;
 
 	/* Size to end of buffer */
-	ptr->async_size = min(requested_size, desc->size - ptr->idx);
+	ptr->async_size = span.size[0];
 
 	*raw_size_available = ptr->async_size;
-
-	/* Convert index to address in the buffer */
-	*buff = (void *)(desc->buff + ptr->idx);
+	*buff = span.buff[0];
 
 	ptr->async_started = true;
 
@@ -240,8 +509,7 @@ static int32_t cb_end_async_operation(struct circular_buffer *desc,
 				      bool is_read)
 {
 	struct cb_ptr	*ptr;
-	uint32_t	new_val;
-
+	int32_t		ret;
 
 	if (!desc)
 		return -EINVAL;
@@ -254,16 +522,14 @@ static int32_t cb_end_async_operation(struct circular_buffer *desc,
 		return FAILURE;
 
 	/* Update pointer value */
-	new_val = ptr->idx + ptr->async_size;
-	if (new_val >= desc->size) {
-		ptr->spin_count++;
-		new_val %= desc->size;
-	}
-	ptr->idx = new_val;
+	if (is_read)
+		ret = cb_commit_read(desc, ptr->async_size);
+	else
+		ret = cb_commit_write(desc, ptr->async_size);
 	ptr->async_size = 0;
 	ptr->async_started = false;
 
-	return SUCCESS;
+	return ret;
 }
 
 /*
@@ -274,10 +540,10 @@ static int32_t cb_operation(struct circular_buffer *desc,
 			    void *data, uint32_t size,
 			    bool is_read)
 {
+	struct cb_span	span;
 	uint8_t		*buff;
-	uint32_t	available_size;
 	int32_t		ret;
-	uint32_t	i;
+	uint32_t	i, j;
 	bool		sticky_overrun;
 
 	if (!desc || !data || !size)
@@ -287,22 +553,31 @@ static int32_t cb_operation(struct circular_buffer *desc,
 	i = 0;
 	while (i < size) {
 		do {
-			ret = cb_prepare_async_operation(desc, size - i,
-							 (void **)&buff,
-							 &available_size,
-							 is_read);
-		} while (ret == -EBUSY || ret == -EAGAIN);
+			if (is_read)
+				ret = cb_peek_read(desc, size - i, &span);
+			else
+				ret = cb_peek_write(desc, size - i, &span);
+		} while (ret == -EAGAIN);
 		if (ret == -EOVERRUN)
 			sticky_overrun = true;
 
+		buff = (uint8_t *)data + i;
+		for (j = 0; j < 2; j++) {
+			if (is_read)
+				memcpy(buff, span.buff[j], span.size[j]);
+			else
+				memcpy(span.buff[j], buff, span.size[j]);
+			buff += span.size[j];
+		}
+
 		if (is_read)
-			memcpy((uint8_t *)data + i, buff, available_size);
+			ret = cb_commit_read(desc, span.size[0] + span.size[1]);
 		else
-			memcpy(buff, (uint8_t *)data + i, available_size);
-
-		cb_end_async_operation(desc, is_read);
+			ret = cb_commit_write(desc, span.size[0] + span.size[1]);
+		if (ret == -EOVERRUN)
+			sticky_overrun = true;
 
-		i += available_size;
+		i += span.size[0] + span.size[1];
 	}
 
 	if (sticky_overrun)
@@ -368,6 +643,7 @@ int32_t cb_prepare_async_read(struct circular_buffer *desc,
  *  - \ref SUCCESS   - No errors
  *  - \ref FAILURE   - Asynchronous transaction not started
  *  - -EINVAL        - Wrong parameters used
+ *  - -EOVERRUN      - The writer overwrote the data while it was read
  * @{
  */
 int32_t cb_end_async_write(struct circular_buffer *desc)
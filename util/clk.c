@@ -40,6 +40,7 @@
 /******************************************************************************/
 /***************************** Include Files **********************************/
 /******************************************************************************/
+#include <stddef.h>
 #include "error.h"
 #include "clk.h"
 
@@ -47,34 +48,186 @@
 /************************** Functions Implementation **************************/
 /******************************************************************************/
 
+/**
+ * Add the clock to the children of a parent.
+ * @param clk - The clock structure.
+ * @param parent - The parent clock, NULL for a root clock.
+ */
+static void clk_link(struct clk *clk, struct clk *parent)
+{
+	clk->parent = parent;
+	if (!parent)
+		return;
+
+	clk->sibling = parent->children;
+	parent->children = clk;
+}
+
+/**
+ * Remove the clock from the children of its parent.
+ * @param clk - The clock structure.
+ */
+static void clk_unlink(struct clk *clk)
+{
+	struct clk **child;
+
+	if (!clk->parent)
+		return;
+
+	for (child = &clk->parent->children; *child; child = &(*child)->sibling) {
+		if (*child == clk) {
+			*child = clk->sibling;
+			break;
+		}
+	}
+
+	clk->sibling = NULL;
+	clk->parent = NULL;
+}
+
+/**
+ * Get the index of a clock in the list of possible parents.
+ * @param clk - The clock structure.
+ * @param parent - The parent clock.
+ * @return The index of the parent, negative error code if it is not a
+ *         possible parent of the clock.
+ */
+static int32_t clk_parent_index(struct clk *clk, struct clk *parent)
+{
+	uint8_t i;
+
+	for (i = 0; i < clk->num_parents; i++)
+		if (clk->parents[i] == parent)
+			return i;
+
+	return -EINVAL;
+}
+
+/**
+ * Add the clock to the clock tree.
+ *
+ * The parent must be the one currently selected in hardware. It must be
+ * registered before its children.
+ * @param clk - The clock structure.
+ * @param parent - The parent clock, NULL for a root clock.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t clk_register(struct clk *clk,
+		     struct clk *parent)
+{
+	if (!clk || !clk->hw || clk == parent)
+		return -EINVAL;
+
+	if (parent && clk->parents && clk_parent_index(clk, parent) < 0)
+		return -EINVAL;
+
+	clk->children = NULL;
+	clk->sibling = NULL;
+	clk->rate_valid = false;
+	clk->req_rate = 0;
+	clk->enable_count = 0;
+	clk_link(clk, parent);
+
+	return SUCCESS;
+}
+
+/**
+ * Remove the clock from the clock tree.
+ * @param clk - The clock structure.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t clk_unregister(struct clk *clk)
+{
+	if (!clk)
+		return -EINVAL;
+
+	if (clk->children || clk->enable_count)
+		return -EBUSY;
+
+	clk_unlink(clk);
+
+	return SUCCESS;
+}
+
 /**
  * Start the clock.
+ *
+ * The clock is reference counted: the parents are enabled first and only the
+ * first call starts the hardware. A clock without an enable operation is
+ * considered always running, enabling it only enables its parents.
  * @param clk - The clock structure.
  * @return SUCCESS in case of success, negative error code otherwise.
  */
 int32_t clk_enable(struct clk * clk)
 {
-	if (clk->hw->dev_clk_enable)
-		return clk->hw->dev_clk_enable(clk->hw->dev);
-	else
-		return FAILURE;
+	int32_t ret;
+
+	if (clk->enable_count) {
+		clk->enable_count++;
+		return SUCCESS;
+	}
+
+	if (clk->parent) {
+		ret = clk_enable(clk->parent);
+		if (ret != SUCCESS)
+			return ret;
+	}
+
+	if (clk->hw->dev_clk_enable) {
+		ret = clk->hw->dev_clk_enable(clk->hw->dev);
+		if (ret != SUCCESS) {
+			if (clk->parent)
+				clk_disable(clk->parent);
+			return ret;
+		}
+	}
+
+	clk->enable_count = 1;
+
+	return SUCCESS;
 }
 
 /**
  * Stop the clock.
+ *
+ * The hardware is stopped, and the parents released, by the call balancing
+ * the first clk_enable(). A call without a matching clk_enable() only stops
+ * the clock itself.
  * @param clk - The clock structure.
  * @return SUCCESS in case of success, negative error code otherwise.
  */
 int32_t clk_disable(struct clk * clk)
 {
+	int32_t ret;
+
+	if (clk->enable_count > 1) {
+		clk->enable_count--;
+		return SUCCESS;
+	}
+
 	if (clk->hw->dev_clk_disable)
-		return clk->hw->dev_clk_disable(clk->hw->dev);
+		ret = clk->hw->dev_clk_disable(clk->hw->dev);
 	else
-		return FAILURE;
+		ret = SUCCESS;
+
+	if (!clk->enable_count)
+		return ret;
+
+	clk->enable_count = 0;
+	if (clk->parent)
+		clk_disable(clk->parent);
+
+	return ret;
 }
 
 /**
  * Get the current frequency of the clock.
+ *
+ * The hardware is read on every call, since the driver of the clock may
+ * change the rate without going through this framework. With CLK_CACHE_RATE
+ * the rate is only read again after the rate of the clock or of one of its
+ * parents changes through this framework. A clock without a recalc_rate
+ * operation runs at the rate of its parent.
  * @param clk - The clock structure.
  * @param rate - The current frequency.
  * @return SUCCESS in case of success, negative error code otherwise.
@@ -82,16 +235,89 @@ int32_t clk_disable(struct clk * clk)
 int32_t clk_recalc_rate(struct clk *clk,
 			uint64_t *rate)
 {
+	int32_t ret;
+
+	if (clk->rate_valid && (clk->flags & CLK_CACHE_RATE)) {
+		*rate = clk->rate;
+		return SUCCESS;
+	}
+
 	if (clk->hw->dev_clk_recalc_rate)
-		return clk->hw->dev_clk_recalc_rate(clk->hw->dev,
-						    clk->hw_ch_num,
-						    rate);
+		ret = clk->hw->dev_clk_recalc_rate(clk->hw->dev,
+						   clk->hw_ch_num,
+						   rate);
+	else if (clk->parent)
+		ret = clk_recalc_rate(clk->parent, rate);
 	else
 		return FAILURE;
+
+	if (ret != SUCCESS)
+		return ret;
+
+	clk->rate = *rate;
+	clk->rate_valid = true;
+
+	return SUCCESS;
+}
+
+/**
+ * Get the rate a parent could provide for the clock.
+ * @param clk - The clock structure.
+ * @param parent - The parent clock.
+ * @param rate - The desired frequency.
+ * @param parent_rate - The frequency the parent would provide.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+static int32_t clk_parent_rate(struct clk *clk,
+			       struct clk *parent,
+			       uint64_t rate,
+			       uint64_t *parent_rate)
+{
+	if (clk->flags & CLK_SET_RATE_PARENT)
+		return clk_round_rate(parent, rate, parent_rate);
+
+	return clk_recalc_rate(parent, parent_rate);
+}
+
+/**
+ * Choose the parent providing the rate closest to the desired one.
+ * @param clk - The clock structure.
+ * @param rate - The desired frequency.
+ * @param best - The chosen parent.
+ * @param best_rate - The frequency the chosen parent would provide.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+static int32_t clk_best_parent(struct clk *clk,
+			       uint64_t rate,
+			       struct clk **best,
+			       uint64_t *best_rate)
+{
+	uint64_t parent_rate, diff, best_diff;
+	uint8_t i;
+
+	*best = NULL;
+	best_diff = UINT64_MAX;
+	for (i = 0; i < clk->num_parents; i++) {
+		if (clk_parent_rate(clk, clk->parents[i], rate, &parent_rate))
+			continue;
+
+		diff = parent_rate > rate ? parent_rate - rate : rate - parent_rate;
+		if (diff < best_diff) {
+			*best = clk->parents[i];
+			*best_rate = parent_rate;
+			best_diff = diff;
+		}
+		if (!diff)
+			break;
+	}
+
+	return *best ? SUCCESS : -EINVAL;
 }
 
 /**
  * Round the desired frequency to a rate that the clock can actually output.
+ *
+ * A clock without a round_rate operation outputs the rate of its best parent.
  * @param clk - The clock structure.
  * @param rate - The desired frequency.
  * @param rounded_rate - The rounded frequency.
@@ -101,17 +327,68 @@ int32_t clk_round_rate(struct clk *clk,
 		       uint64_t rate,
 		       uint64_t *rounded_rate)
 {
+	struct clk *parent;
+
 	if (clk->hw->dev_clk_round_rate)
 		return clk->hw->dev_clk_round_rate(clk->hw->dev,
 						   clk->hw_ch_num,
 						   rate,
 						   rounded_rate);
-	else
-		return FAILURE;
+
+	if (clk->num_parents > 1)
+		return clk_best_parent(clk, rate, &parent, rounded_rate);
+
+	if (clk->parent)
+		return clk_parent_rate(clk, clk->parent, rate, rounded_rate);
+
+	return FAILURE;
+}
+
+/**
+ * Update the clocks derived from a clock whose rate changed.
+ *
+ * A child that was given a rate with clk_set_rate() and has a set_rate
+ * operation is set to that rate again, computed from the new rate of its
+ * parent. The cached rates are read again from the hardware.
+ * @param clk - The clock structure.
+ * @return SUCCESS in case of success, the first error otherwise. The whole
+ *         subtree is updated even if a child fails.
+ */
+static int32_t clk_propagate_rate(struct clk *clk)
+{
+	struct clk *child;
+	uint64_t rate;
+	int32_t ret = SUCCESS;
+	int32_t err;
+
+	clk->rate_valid = false;
+	if (clk->flags & CLK_CACHE_RATE)
+		clk_recalc_rate(clk, &rate);
+
+	for (child = clk->children; child; child = child->sibling) {
+		if (child->req_rate && child->hw->dev_clk_set_rate) {
+			err = child->hw->dev_clk_set_rate(child->hw->dev,
+							  child->hw_ch_num,
+							  child->req_rate);
+			if (err != SUCCESS && ret == SUCCESS)
+				ret = err;
+		}
+
+		err = clk_propagate_rate(child);
+		if (err != SUCCESS && ret == SUCCESS)
+			ret = err;
+	}
+
+	return ret;
 }
 
 /**
  * Change the frequency of the clock.
+ *
+ * A clock without a set_rate operation switches to the parent providing the
+ * closest rate. With CLK_SET_RATE_PARENT the rate of that parent is changed
+ * too. The clocks derived from the clock follow the new rate: the ones that
+ * were given a rate are set to it again, and the cached rates are refreshed.
  * @param clk - The clock structure.
  * @param rate - The desired frequency.
  * @return SUCCESS in case of success, negative error code otherwise.
@@ -119,10 +396,119 @@ int32_t clk_round_rate(struct clk *clk,
 int32_t clk_set_rate(struct clk *clk,
 		     uint64_t rate)
 {
-	if (clk->hw->dev_clk_set_rate)
-		return clk->hw->dev_clk_set_rate(clk->hw->dev,
-						 clk->hw_ch_num,
-						 rate);
-	else
-		return FAILURE;
+	struct clk *parent;
+	uint64_t parent_rate;
+	int32_t ret;
+
+	if (clk->hw->dev_clk_set_rate) {
+		ret = clk->hw->dev_clk_set_rate(clk->hw->dev,
+						clk->hw_ch_num,
+						rate);
+		if (ret != SUCCESS)
+			return ret;
+
+		clk->req_rate = rate;
+
+		return clk_propagate_rate(clk);
+	}
+
+	parent = clk->parent;
+	if (clk->num_parents > 1) {
+		ret = clk_best_parent(clk, rate, &parent, &parent_rate);
+		if (ret != SUCCESS)
+			return ret;
+
+		ret = clk_set_parent(clk, parent);
+		if (ret != SUCCESS)
+			return ret;
+
+		if (!(clk->flags & CLK_SET_RATE_PARENT))
+			return SUCCESS;
+	}
+
+	if (parent && (clk->flags & CLK_SET_RATE_PARENT))
+		return clk_set_rate(parent, rate);
+
+	return FAILURE;
+}
+
+/**
+ * Get the parent of the clock.
+ * @param clk - The clock structure.
+ * @return The parent clock, NULL for a root clock.
+ */
+struct clk *clk_get_parent(struct clk *clk)
+{
+	return clk->parent;
+}
+
+/**
+ * Change the parent of the clock.
+ *
+ * An enabled clock keeps its new parent enabled and releases the old one.
+ * A clock that was given a rate is set to it again from the new parent, and
+ * the clocks derived from it follow, as for clk_set_rate().
+ * @param clk - The clock structure.
+ * @param parent - The new parent, one of the possible parents of the clock.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t clk_set_parent(struct clk *clk,
+		       struct clk *parent)
+{
+	struct clk *old_parent = clk->parent;
+	struct clk *p;
+	int32_t index;
+	int32_t ret;
+
+	if (!parent)
+		return -EINVAL;
+
+	if (parent == old_parent)
+		return SUCCESS;
+
+	/* The new parent must not be derived from the clock */
+	for (p = parent; p; p = p->parent)
+		if (p == clk)
+			return -EINVAL;
+
+	if (clk->parents) {
+		index = clk_parent_index(clk, parent);
+		if (index < 0)
+			return index;
+		if (!clk->hw->dev_clk_set_parent)
+			return FAILURE;
+	}
+
+	if (clk->enable_count) {
+		ret = clk_enable(parent);
+		if (ret != SUCCESS)
+			return ret;
+	}
+
+	if (clk->parents) {
+		ret = clk->hw->dev_clk_set_parent(clk->hw->dev,
+						  clk->hw_ch_num,
+						  index);
+		if (ret != SUCCESS) {
+			if (clk->enable_count)
+				clk_disable(parent);
+			return ret;
+		}
+	}
+
+	clk_unlink(clk);
+	clk_link(clk, parent);
+
+	if (clk->enable_count && old_parent)
+		clk_disable(old_parent);
+
+	if (clk->req_rate && clk->hw->dev_clk_set_rate) {
+		ret = clk->hw->dev_clk_set_rate(clk->hw->dev,
+						clk->hw_ch_num,
+						clk->req_rate);
+		if (ret != SUCCESS)
+			return ret;
+	}
+
+	return clk_propagate_rate(clk);
 }
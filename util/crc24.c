@@ -101,3 +101,37 @@ uint32_t crc24(const uint32_t * table, const uint8_t *pdata, size_t nbytes,
 
 	return (crc & 0xffffff);
 }
+
+/***************************************************************************//**
+ * @brief Computes the CRC-24 over a buffer of data, 4 bytes at a time.
+ *
+ * Gives the same result as crc24(), with 4 table lookups for every 4 bytes
+ * instead of a dependent lookup per byte. It is faster on buffers of a few
+ * hundred bytes or more, at the cost of 4 times the table size.
+ *
+ * @param table     - CRC-24 slicing-by-4 lookup tables for the desired
+ *                    polynomial, see DECLARE_CRC24_CONST_SLICE4_TABLE().
+ * @param pdata     - Pointer to data buffer.
+ * @param nbytes    - Number of bytes to compute the CRC-24 over.
+ * @param crc       - Initial value for the CRC-24 computation.
+ *
+ * @return crc      - Computed CRC-24 value.
+*******************************************************************************/
+uint32_t crc24_slice4(const uint32_t (*table)[CRC24_TABLE_SIZE],
+		      const uint8_t *pdata, size_t nbytes, uint32_t crc)
+{
+	uint32_t x;
+
+	while (nbytes >= 4) {
+		/* The CRC register is aligned with the first byte */
+		x = ((uint32_t)crc << 8) ^ ((uint32_t)pdata[0] << 24) ^
+		    ((uint32_t)pdata[1] << 16) ^ ((uint32_t)pdata[2] << 8) ^
+		    pdata[3];
+		crc = table[3][x >> 24] ^ table[2][(x >> 16) & 0xff] ^
+		      table[1][(x >> 8) & 0xff] ^ table[0][x & 0xff];
+		pdata += 4;
+		nbytes -= 4;
+	}
+
+	return crc24(table[0], pdata, nbytes, crc);
+}
@@ -98,3 +98,37 @@ uint8_t crc8(const uint8_t * table, const uint8_t *pdata, size_t nbytes,
 
 	return crc;
 }
+
+/***************************************************************************//**
+ * @brief Computes the CRC-8 over a buffer of data, 4 bytes at a time.
+ *
+ * Gives the same result as crc8(), with 4 table lookups for every 4 bytes
+ * instead of a dependent lookup per byte. It is faster on buffers of a few
+ * hundred bytes or more, at the cost of 4 times the table size.
+ *
+ * @param table     - CRC-8 slicing-by-4 lookup tables for the desired
+ *                    polynomial, see DECLARE_CRC8_CONST_SLICE4_TABLE().
+ * @param pdata     - Pointer to data buffer.
+ * @param nbytes    - Number of bytes to compute the CRC-8 over.
+ * @param crc       - Initial value for the CRC-8 computation.
+ *
+ * @return crc      - Computed CRC-8 value.
+*******************************************************************************/
+uint8_t crc8_slice4(const uint8_t (*table)[CRC8_TABLE_SIZE],
+		    const uint8_t *pdata, size_t nbytes, uint8_t crc)
+{
+	uint32_t x;
+
+	while (nbytes >= 4) {
+		/* The CRC register is aligned with the first byte */
+		x = ((uint32_t)crc << 24) ^ ((uint32_t)pdata[0] << 24) ^
+		    ((uint32_t)pdata[1] << 16) ^ ((uint32_t)pdata[2] << 8) ^
+		    pdata[3];
+		crc = table[3][x >> 24] ^ table[2][(x >> 16) & 0xff] ^
+		      table[1][(x >> 8) & 0xff] ^ table[0][x & 0xff];
+		pdata += 4;
+		nbytes -= 4;
+	}
+
+	return crc8(table[0], pdata, nbytes, crc);
+}
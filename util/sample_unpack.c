@@ -0,0 +1,524 @@
+/***************************************************************************//**
+ *   @file   sample_unpack.c
+ *   @brief  Sample unpacking and deinterleaving helpers.
+********************************************************************************
+ * Copyright 2021(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <string.h>
+#include "error.h"
+#include "sample_unpack.h"
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define SAMPLE_UNPACK_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define SAMPLE_UNPACK_SSE2
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#define SAMPLE_UNPACK_SSSE3
+#endif
+#endif
+#endif
+
+#if defined(SAMPLE_UNPACK_SSSE3) || defined(SAMPLE_UNPACK_NEON)
+/*
+ * Byte shuffles of the packed widths. Lane k of a group of 4 samples gets the
+ * 4 bytes starting at the first byte of sample k, in little endian order, so
+ * that it holds them as a big endian 32-bit word.
+ */
+#define SAMPLE_UNPACK_LANE(first)					\
+	(first) + 3, (first) + 2, (first) + 1, (first)
+#define SAMPLE_UNPACK_SHUFFLE(bits)					\
+	{ SAMPLE_UNPACK_LANE(0), SAMPLE_UNPACK_LANE((bits) / 8),	\
+	  SAMPLE_UNPACK_LANE((bits) / 4), SAMPLE_UNPACK_LANE(3 * (bits) / 8) }
+
+/* Bits before sample k in the first byte of lane k */
+#define SAMPLE_UNPACK_OFFSETS(bits)					\
+	{ 0, (bits) % 8, (2 * (bits)) % 8, (3 * (bits)) % 8 }
+
+static const uint8_t sample_unpack_shuffle[4][16] = {
+	SAMPLE_UNPACK_SHUFFLE(12), SAMPLE_UNPACK_SHUFFLE(18),
+	SAMPLE_UNPACK_SHUFFLE(24), SAMPLE_UNPACK_SHUFFLE(26)
+};
+
+static const uint32_t sample_unpack_offsets[4][4] = {
+	SAMPLE_UNPACK_OFFSETS(12), SAMPLE_UNPACK_OFFSETS(18),
+	SAMPLE_UNPACK_OFFSETS(24), SAMPLE_UNPACK_OFFSETS(26)
+};
+#endif
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Unpack 16-bit big endian samples, 8 at a time when vectorized.
+ * @param src - Samples.
+ * @param nb_samples - Number of samples.
+ * @param dst - Where to store the 32-bit words.
+ * @return Number of samples unpacked.
+ */
+static uint32_t sample_unpack_be16(const uint8_t *src, uint32_t nb_samples,
+				   uint32_t *dst)
+{
+	uint32_t i = 0;
+
+#if defined(SAMPLE_UNPACK_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	__m128i v;
+
+	for (; i + 8 <= nb_samples; i += 8) {
+		v = _mm_loadu_si128((const __m128i *)(src + 2 * i));
+		v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_unpacklo_epi16(v, zero));
+		_mm_storeu_si128((__m128i *)(dst + i + 4),
+				 _mm_unpackhi_epi16(v, zero));
+	}
+#elif defined(SAMPLE_UNPACK_NEON)
+	uint16x8_t v;
+
+	for (; i + 8 <= nb_samples; i += 8) {
+		v = vreinterpretq_u16_u8(vrev16q_u8(vld1q_u8(src + 2 * i)));
+		vst1q_u32(dst + i, vmovl_u16(vget_low_u16(v)));
+		vst1q_u32(dst + i + 4, vmovl_u16(vget_high_u16(v)));
+	}
+#endif
+	for (; i < nb_samples; i++)
+		dst[i] = ((uint32_t)src[2 * i] << 8) | src[2 * i + 1];
+
+	return nb_samples;
+}
+
+/**
+ * @brief Unpack 12, 18, 24 or 26-bit packed samples, 4 at a time.
+ * A group of 4 samples is a whole number of bytes, and its samples start in
+ * the first 13 of them. Each lane is loaded with the 4 bytes starting at its
+ * sample, shifted left over the bits of the previous sample, then right down
+ * to the width.
+ * @param src - Packed samples.
+ * @param nb_samples - Number of samples.
+ * @param bits - Width of a sample: 12, 18, 24 or 26.
+ * @param dst - Where to store the 32-bit words.
+ * @return Number of samples unpacked, a multiple of 4. The last groups are
+ * left to the caller, so that the 16 byte loads stay inside src.
+ */
+static uint32_t sample_unpack_be_packed(const uint8_t *src,
+					uint32_t nb_samples, uint8_t bits,
+					uint32_t *dst)
+{
+	uint32_t i = 0;
+#if defined(SAMPLE_UNPACK_SSSE3) || defined(SAMPLE_UNPACK_NEON)
+	uint64_t nb_bytes = ((uint64_t)nb_samples * bits + 7) / 8;
+	uint32_t k;
+
+	switch (bits) {
+	case 12:
+		k = 0;
+		break;
+	case 18:
+		k = 1;
+		break;
+	case 24:
+		k = 2;
+		break;
+	case 26:
+		k = 3;
+		break;
+	default:
+		return 0;
+	}
+#endif
+
+#if defined(SAMPLE_UNPACK_SSSE3)
+	const __m128i shuffle = _mm_loadu_si128(
+					(const __m128i *)sample_unpack_shuffle[k]);
+	const __m128i mul = _mm_setr_epi32(1 << sample_unpack_offsets[k][0],
+					   1 << sample_unpack_offsets[k][1],
+					   1 << sample_unpack_offsets[k][2],
+					   1 << sample_unpack_offsets[k][3]);
+	const __m128i mul_odd = _mm_srli_epi64(mul, 32);
+	const __m128i rcount = _mm_cvtsi32_si128(32 - bits);
+	__m128i v, even, odd;
+
+	for (; i + 4 <= nb_samples &&
+	     (uint64_t)i * bits / 8 + 16 <= nb_bytes; i += 4) {
+		v = _mm_loadu_si128((const __m128i *)(src + i * bits / 8));
+		v = _mm_shuffle_epi8(v, shuffle);
+		/* No 32-bit multiply on SSSE3: the even and odd lanes are
+		 * shifted left as 64-bit products, then merged */
+		even = _mm_mul_epu32(v, mul);
+		odd = _mm_mul_epu32(_mm_srli_epi64(v, 32), mul_odd);
+		v = _mm_unpacklo_epi32(_mm_shuffle_epi32(even, 0x08),
+				       _mm_shuffle_epi32(odd, 0x08));
+		_mm_storeu_si128((__m128i *)(dst + i), _mm_srl_epi32(v, rcount));
+	}
+#elif defined(SAMPLE_UNPACK_NEON)
+	const uint8x16_t shuffle = vld1q_u8(sample_unpack_shuffle[k]);
+	const int32x4_t lcount = vreinterpretq_s32_u32(
+					 vld1q_u32(sample_unpack_offsets[k]));
+	const int32x4_t rcount = vdupq_n_s32(bits - 32);
+	uint8x16_t v;
+#if !defined(__aarch64__)
+	uint8x8x2_t t;
+#endif
+
+	for (; i + 4 <= nb_samples &&
+	     (uint64_t)i * bits / 8 + 16 <= nb_bytes; i += 4) {
+		v = vld1q_u8(src + i * bits / 8);
+#if defined(__aarch64__)
+		v = vqtbl1q_u8(v, shuffle);
+#else
+		t.val[0] = vget_low_u8(v);
+		t.val[1] = vget_high_u8(v);
+		v = vcombine_u8(vtbl2_u8(t, vget_low_u8(shuffle)),
+				vtbl2_u8(t, vget_high_u8(shuffle)));
+#endif
+		vst1q_u32(dst + i, vshlq_u32(vshlq_u32(vreinterpretq_u32_u8(v),
+						       lcount), rcount));
+	}
+#endif
+
+	return i;
+}
+
+/**
+ * @brief Unpack big endian, bit-packed samples into 32-bit words.
+ * The common widths have unrolled paths: 12 bits (2 samples in 3 bytes),
+ * 18 bits (4 samples in 9 bytes), 26 bits (4 samples in 13 bytes),
+ * 16 and 24 bits. Other widths go through a bit accumulator.
+ * The 12, 16, 18, 24 and 26-bit paths are vectorized on little endian NEON
+ * and SSSE3 hosts; plain SSE2 builds only vectorize 16 bits.
+ * @param src - Packed samples, ceil(nb_samples * bits / 8) bytes.
+ * @param nb_samples - Number of samples.
+ * @param bits - Width of a sample, 1 to 32.
+ * @param dst - Where to store the samples, right aligned.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t sample_unpack_be(const uint8_t *src, uint32_t nb_samples,
+			 uint8_t bits, uint32_t *dst)
+{
+	uint32_t i = 0, nb_bits = 0, mask;
+	uint64_t acc = 0;
+
+	if (!src || !dst || !bits || bits > 32)
+		return -EINVAL;
+
+	if (bits == 12 || bits == 18 || bits == 24 || bits == 26) {
+		i = sample_unpack_be_packed(src, nb_samples, bits, dst);
+		src += i * bits / 8;
+	}
+
+	switch (bits) {
+	case 12:
+		for (; i + 2 <= nb_samples; i += 2, src += 3) {
+			dst[i] = ((uint32_t)src[0] << 4) | (src[1] >> 4);
+			dst[i + 1] = ((uint32_t)(src[1] & 0x0f) << 8) | src[2];
+		}
+		break;
+	case 16:
+		sample_unpack_be16(src, nb_samples, dst);
+		return SUCCESS;
+	case 18:
+		for (; i + 4 <= nb_samples; i += 4, src += 9) {
+			dst[i] = ((uint32_t)src[0] << 10) |
+				 ((uint32_t)src[1] << 2) | (src[2] >> 6);
+			dst[i + 1] = ((uint32_t)(src[2] & 0x3f) << 12) |
+				     ((uint32_t)src[3] << 4) | (src[4] >> 4);
+			dst[i + 2] = ((uint32_t)(src[4] & 0x0f) << 14) |
+				     ((uint32_t)src[5] << 6) | (src[6] >> 2);
+			dst[i + 3] = ((uint32_t)(src[6] & 0x03) << 16) |
+				     ((uint32_t)src[7] << 8) | src[8];
+		}
+		break;
+	case 24:
+		for (; i < nb_samples; i++, src += 3)
+			dst[i] = ((uint32_t)src[0] << 16) |
+				 ((uint32_t)src[1] << 8) | src[2];
+		return SUCCESS;
+	case 26:
+		for (; i + 4 <= nb_samples; i += 4, src += 13) {
+			dst[i] = ((uint32_t)src[0] << 18) |
+				 ((uint32_t)src[1] << 10) |
+				 ((uint32_t)src[2] << 2) | (src[3] >> 6);
+			dst[i + 1] = ((uint32_t)(src[3] & 0x3f) << 20) |
+				     ((uint32_t)src[4] << 12) |
+				     ((uint32_t)src[5] << 4) | (src[6] >> 4);
+			dst[i + 2] = ((uint32_t)(src[6] & 0x0f) << 22) |
+				     ((uint32_t)src[7] << 14) |
+				     ((uint32_t)src[8] << 6) | (src[9] >> 2);
+			dst[i + 3] = ((uint32_t)(src[9] & 0x03) << 24) |
+				     ((uint32_t)src[10] << 16) |
+				     ((uint32_t)src[11] << 8) | src[12];
+		}
+		break;
+	default:
+		break;
+	}
+
+	/* Remaining samples, the unrolled paths stop on a byte boundary */
+	mask = bits == 32 ? 0xffffffff : ((uint32_t)1 << bits) - 1;
+	for (; i < nb_samples; i++) {
+		while (nb_bits < bits) {
+			acc = (acc << 8) | *src++;
+			nb_bits += 8;
+		}
+		nb_bits -= bits;
+		dst[i] = (uint32_t)(acc >> nb_bits) & mask;
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Convert 16-bit little endian samples, 8 at a time.
+ * @param src - Samples.
+ * @param nb_samples - Number of samples.
+ * @param fmt - Format of the samples.
+ * @param dst - Where to store the values.
+ * @return Number of samples converted.
+ */
+static uint32_t sample_extract_le16(const uint8_t *src, uint32_t nb_samples,
+				    const struct sample_format *fmt,
+				    int32_t *dst)
+{
+	uint32_t i = 0;
+#if defined(SAMPLE_UNPACK_SSE2) || defined(SAMPLE_UNPACK_NEON)
+	/* Move the valid bits to the top, then back down with sign or zero
+	 * extension */
+	const int lshift = 16 - fmt->shift - fmt->realbits;
+	const int rshift = 16 - fmt->realbits;
+#endif
+
+#if defined(SAMPLE_UNPACK_SSE2)
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i lcount = _mm_cvtsi32_si128(lshift);
+	const __m128i rcount = _mm_cvtsi32_si128(rshift);
+	__m128i v;
+
+	for (; i + 8 <= nb_samples; i += 8) {
+		v = _mm_loadu_si128((const __m128i *)(src + 2 * i));
+		v = _mm_sll_epi16(v, lcount);
+		if (fmt->is_signed) {
+			v = _mm_sra_epi16(v, rcount);
+			_mm_storeu_si128((__m128i *)(dst + i),
+					 _mm_srai_epi32(_mm_unpacklo_epi16(v, v), 16));
+			_mm_storeu_si128((__m128i *)(dst + i + 4),
+					 _mm_srai_epi32(_mm_unpackhi_epi16(v, v), 16));
+		} else {
+			v = _mm_srl_epi16(v, rcount);
+			_mm_storeu_si128((__m128i *)(dst + i),
+					 _mm_unpacklo_epi16(v, zero));
+			_mm_storeu_si128((__m128i *)(dst + i + 4),
+					 _mm_unpackhi_epi16(v, zero));
+		}
+	}
+#elif defined(SAMPLE_UNPACK_NEON)
+	const int16x8_t lcount = vdupq_n_s16(lshift);
+	const int16x8_t rcount = vdupq_n_s16(-rshift);
+	uint16x8_t v;
+	int16x8_t s;
+
+	for (; i + 8 <= nb_samples; i += 8) {
+		v = vshlq_u16(vld1q_u16((const uint16_t *)(src + 2 * i)), lcount);
+		if (fmt->is_signed) {
+			s = vshlq_s16(vreinterpretq_s16_u16(v), rcount);
+			vst1q_s32(dst + i, vmovl_s16(vget_low_s16(s)));
+			vst1q_s32(dst + i + 4, vmovl_s16(vget_high_s16(s)));
+		} else {
+			v = vshlq_u16(v, rcount);
+			vst1q_s32(dst + i, vreinterpretq_s32_u32(
+					  vmovl_u16(vget_low_u16(v))));
+			vst1q_s32(dst + i + 4, vreinterpretq_s32_u32(
+					  vmovl_u16(vget_high_u16(v))));
+		}
+	}
+#endif
+
+	return i;
+}
+
+/**
+ * @brief Convert samples stored in a given format to 32-bit values.
+ * Each sample is read with the storage size and endianness of the format,
+ * shifted right, masked to realbits and sign extended if signed.
+ * @param src - Samples, fmt->storagebits / 8 bytes each.
+ * @param nb_samples - Number of samples.
+ * @param fmt - Format of the samples.
+ * @param dst - Where to store the values.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t sample_extract(const void *src, uint32_t nb_samples,
+		       const struct sample_format *fmt, int32_t *dst)
+{
+	const uint8_t *p = src;
+	uint32_t i = 0, j, bytes, mask, val;
+
+	if (!src || !fmt || !dst)
+		return -EINVAL;
+
+	bytes = fmt->storagebits / 8;
+	if (!bytes || bytes > 4 || fmt->storagebits % 8 || !fmt->realbits ||
+	    fmt->shift + fmt->realbits > fmt->storagebits)
+		return -EINVAL;
+
+	if (bytes == 2 && !fmt->is_big_endian)
+		i = sample_extract_le16(p, nb_samples, fmt, dst);
+
+	mask = fmt->realbits == 32 ? 0xffffffff :
+	       ((uint32_t)1 << fmt->realbits) - 1;
+	for (p += i * bytes; i < nb_samples; i++, p += bytes) {
+		val = 0;
+		for (j = 0; j < bytes; j++)
+			if (fmt->is_big_endian)
+				val = (val << 8) | p[j];
+			else
+				val |= (uint32_t)p[j] << (8 * j);
+		val = (val >> fmt->shift) & mask;
+		if (fmt->is_signed && fmt->realbits < 32 &&
+		    (val & ((uint32_t)1 << (fmt->realbits - 1))))
+			val |= ~mask;
+		dst[i] = (int32_t)val;
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Split 16-bit samples of 2 or 4 channels, 8 at a time.
+ * @param src - Interleaved samples.
+ * @param nb_samples - Number of samples of each channel.
+ * @param nb_ch - Number of interleaved channels.
+ * @param dst - Buffer of each channel, none of them NULL.
+ * @return Number of samples of each channel split.
+ */
+static uint32_t sample_deinterleave16(const uint16_t *src, uint32_t nb_samples,
+				      uint32_t nb_ch, uint16_t **dst)
+{
+	uint32_t i = 0;
+
+#if defined(SAMPLE_UNPACK_SSE2)
+	__m128i a, b, lo, hi;
+
+	if (nb_ch != 2)
+		return 0;
+
+	/* Even and odd halfwords of two vectors, packed back to 8 halfwords.
+	 * The sign extension keeps packs_epi32 from saturating. */
+	for (; i + 8 <= nb_samples; i += 8) {
+		a = _mm_loadu_si128((const __m128i *)(src + 2 * i));
+		b = _mm_loadu_si128((const __m128i *)(src + 2 * i + 8));
+		lo = _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(a, 16), 16),
+				     _mm_srai_epi32(_mm_slli_epi32(b, 16), 16));
+		hi = _mm_packs_epi32(_mm_srai_epi32(a, 16), _mm_srai_epi32(b, 16));
+		_mm_storeu_si128((__m128i *)(dst[0] + i), lo);
+		_mm_storeu_si128((__m128i *)(dst[1] + i), hi);
+	}
+#elif defined(SAMPLE_UNPACK_NEON)
+	uint16x8x2_t v2;
+	uint16x8x4_t v4;
+
+	if (nb_ch == 2) {
+		for (; i + 8 <= nb_samples; i += 8) {
+			v2 = vld2q_u16(src + 2 * i);
+			vst1q_u16(dst[0] + i, v2.val[0]);
+			vst1q_u16(dst[1] + i, v2.val[1]);
+		}
+	} else if (nb_ch == 4) {
+		for (; i + 8 <= nb_samples; i += 8) {
+			v4 = vld4q_u16(src + 4 * i);
+			vst1q_u16(dst[0] + i, v4.val[0]);
+			vst1q_u16(dst[1] + i, v4.val[1]);
+			vst1q_u16(dst[2] + i, v4.val[2]);
+			vst1q_u16(dst[3] + i, v4.val[3]);
+		}
+	}
+#endif
+
+	return i;
+}
+
+/**
+ * @brief Split interleaved samples into one buffer per channel.
+ * The source holds nb_samples scans, each one made of a sample of every
+ * channel set in mask, in ascending channel order.
+ * @param src - Interleaved samples.
+ * @param nb_samples - Number of samples of each channel.
+ * @param sample_bytes - Size of a sample: 1, 2 or 4 bytes.
+ * @param mask - Channels present in src.
+ * @param dst - Buffers indexed by channel number. The samples of a channel
+ * with a NULL buffer are dropped.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t sample_deinterleave(const void *src, uint32_t nb_samples,
+			    uint8_t sample_bytes, uint32_t mask,
+			    void * const *dst)
+{
+	const uint8_t *scan;
+	uint8_t *ch_dst[32];
+	uint32_t nb_ch = 0, i = 0, ch, k;
+	bool all = true;
+
+	if (!src || !dst || !mask ||
+	    (sample_bytes != 1 && sample_bytes != 2 && sample_bytes != 4))
+		return -EINVAL;
+
+	for (ch = 0; ch < 32; ch++) {
+		if (!(mask & ((uint32_t)1 << ch)))
+			continue;
+		ch_dst[nb_ch] = dst[ch];
+		if (!ch_dst[nb_ch])
+			all = false;
+		nb_ch++;
+	}
+
+	if (sample_bytes == 2 && all && !((uintptr_t)src & 1))
+		i = sample_deinterleave16(src, nb_samples, nb_ch,
+					  (uint16_t **)ch_dst);
+
+	scan = (const uint8_t *)src + i * nb_ch * sample_bytes;
+	for (; i < nb_samples; i++)
+		for (k = 0; k < nb_ch; k++, scan += sample_bytes)
+			if (ch_dst[k])
+				memcpy(ch_dst[k] + i * sample_bytes, scan,
+				       sample_bytes);
+
+	return SUCCESS;
+}